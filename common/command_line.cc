@@ -0,0 +1,83 @@
+#include "command_line.h"
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+
+CommandLine ParseCommandLine(int argc, char* argv[]) {
+    CommandLine cmd;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) == 0) {
+            size_t eq = arg.find('=');
+            if (eq == std::string::npos) {
+                cmd.options[arg.substr(2)] = "";
+            } else {
+                cmd.options[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+            }
+        } else {
+            cmd.positional.push_back(arg);
+        }
+    }
+    return cmd;
+}
+
+bool ParseInt(const std::string& text, int* value) {
+    if (text.empty() || std::isspace(static_cast<unsigned char>(text[0]))) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    if (errno != 0 || *end != '\0' || parsed < INT_MIN || parsed > INT_MAX) {
+        return false;
+    }
+    *value = static_cast<int>(parsed);
+    return true;
+}
+
+bool ParseDouble(const std::string& text, double* value) {
+    if (text.empty() || std::isspace(static_cast<unsigned char>(text[0]))) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    double parsed = std::strtod(text.c_str(), &end);
+    if (errno != 0 || *end != '\0' || !std::isfinite(parsed)) {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+int CommandLine::GetInt(const std::string& key, int default_value) const {
+    int value = default_value;
+    return ParseInt(Get(key), &value) ? value : default_value;
+}
+
+double CommandLine::GetDouble(const std::string& key, double default_value) const {
+    double value = default_value;
+    return ParseDouble(Get(key), &value) ? value : default_value;
+}
+
+bool CommandLine::CheckNumbers(const std::vector<std::string>& integer_keys, const std::vector<std::string>& number_keys,
+                               std::string* error) const {
+    for (const auto& key : integer_keys) {
+        int value = 0;
+        const std::string text = Get(key);
+        if (!text.empty() && !ParseInt(text, &value)) {
+            *error = "--" + key + " expects an integer, got \"" + text + "\"";
+            return false;
+        }
+    }
+    for (const auto& key : number_keys) {
+        double value = 0;
+        const std::string text = Get(key);
+        if (!text.empty() && !ParseDouble(text, &value)) {
+            *error = "--" + key + " expects a number, got \"" + text + "\"";
+            return false;
+        }
+    }
+    return true;
+}
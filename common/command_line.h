@@ -0,0 +1,69 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 命令行：位置参数 + "--key=value" 形式的可选参数，接收端与发送端共用
+ *
+ * 数值参数先用CheckNumbers统一校验，非法时在初始化之前报告用法错误，
+ * 之后GetInt/GetDouble读取时不会再失败。
+ */
+struct CommandLine {
+    std::vector<std::string> positional;
+    std::map<std::string, std::string> options;
+
+    bool Has(const std::string& key) const { return options.count(key) > 0; }
+    std::string Get(const std::string& key, const std::string& default_value = "") const {
+        auto it = options.find(key);
+        return it != options.end() ? it->second : default_value;
+    }
+
+    /**
+     * @brief 读取整数参数
+     * @param key 参数名
+     * @param default_value 未给出、值为空或不是合法整数时返回的值
+     */
+    int GetInt(const std::string& key, int default_value) const;
+
+    /**
+     * @brief 读取小数参数
+     * @param key 参数名
+     * @param default_value 未给出、值为空或不是合法数值时返回的值
+     */
+    double GetDouble(const std::string& key, double default_value) const;
+
+    /**
+     * @brief 校验数值参数：给出的值必须完整地是一个整数/数值（空值表示使用默认值）
+     * @param integer_keys 整数参数名
+     * @param number_keys 小数参数名
+     * @param error 输出第一个非法参数的描述
+     * @return 是否全部合法
+     */
+    bool CheckNumbers(const std::vector<std::string>& integer_keys, const std::vector<std::string>& number_keys,
+                      std::string* error) const;
+};
+
+/**
+ * @brief 解析命令行
+ * @param argc 参数个数
+ * @param argv 参数数组
+ * @return 解析结果
+ */
+CommandLine ParseCommandLine(int argc, char* argv[]);
+
+/**
+ * @brief 把整段文本解析为int，不接受前后多余字符和越界值
+ * @param text 文本
+ * @param value 输出
+ * @return 是否合法
+ */
+bool ParseInt(const std::string& text, int* value);
+
+/**
+ * @brief 把整段文本解析为有限的double，不接受前后多余字符
+ * @param text 文本
+ * @param value 输出
+ * @return 是否合法
+ */
+bool ParseDouble(const std::string& text, double* value);
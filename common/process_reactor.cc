@@ -0,0 +1,244 @@
+#include "process_reactor.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+int64_t NowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t MakeEventData(uint32_t source, uint32_t id) {
+    return (static_cast<uint64_t>(source) << 32) | id;
+}
+
+}  // namespace
+
+ProcessReactor::ProcessReactor() = default;
+
+ProcessReactor::~ProcessReactor() {
+    for (auto& entry : timers_) {
+        close(entry.second.fd);
+    }
+    if (signal_fd_ >= 0) close(signal_fd_);
+    if (event_fd_ >= 0) close(event_fd_);
+    if (epoll_fd_ >= 0) close(epoll_fd_);
+}
+
+bool ProcessReactor::Initialize() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        std::cerr << "Failed to create epoll: " << strerror(errno) << std::endl;
+        return false;
+    }
+    event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event_fd_ < 0) {
+        std::cerr << "Failed to create eventfd: " << strerror(errno) << std::endl;
+        return false;
+    }
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = MakeEventData(kWakeup, 0);
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &event) != 0) {
+        std::cerr << "Failed to watch eventfd: " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ProcessReactor::HandleSignals(const std::vector<int>& signals, SignalCallback callback) {
+    if (epoll_fd_ < 0 || signal_fd_ >= 0) {
+        return false;
+    }
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (int signal : signals) {
+        sigaddset(&mask, signal);
+    }
+    // 屏蔽后信号只能通过signalfd读取；之后创建的线程继承这一屏蔽字
+    int ret = pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+    if (ret != 0) {
+        std::cerr << "Failed to block signals: " << strerror(ret) << std::endl;
+        return false;
+    }
+    signal_fd_ = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd_ < 0) {
+        std::cerr << "Failed to create signalfd: " << strerror(errno) << std::endl;
+        return false;
+    }
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = MakeEventData(kSignal, 0);
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, signal_fd_, &event) != 0) {
+        std::cerr << "Failed to watch signalfd: " << strerror(errno) << std::endl;
+        return false;
+    }
+    signal_callback_ = std::move(callback);
+    return true;
+}
+
+int ProcessReactor::AddTimer(int interval_ms, Task callback, bool repeat) {
+    if (epoll_fd_ < 0 || interval_ms <= 0) {
+        return -1;
+    }
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Failed to create timerfd: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    itimerspec spec = {};
+    spec.it_value.tv_sec = interval_ms / 1000;
+    spec.it_value.tv_nsec = static_cast<long>(interval_ms % 1000) * 1000000;
+    if (repeat) {
+        spec.it_interval = spec.it_value;
+    }
+    const int timer_id = next_timer_id_++;
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = MakeEventData(kTimer, static_cast<uint32_t>(timer_id));
+    if (timerfd_settime(fd, 0, &spec, nullptr) != 0 || epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+        std::cerr << "Failed to arm timer: " << strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+    Timer& timer = timers_[timer_id];
+    timer.fd = fd;
+    timer.callback = std::move(callback);
+    timer.repeat = repeat;
+    return timer_id;
+}
+
+void ProcessReactor::CancelTimer(int timer_id) {
+    auto it = timers_.find(timer_id);
+    if (it == timers_.end()) {
+        return;
+    }
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, it->second.fd, nullptr);
+    close(it->second.fd);
+    timers_.erase(it);
+}
+
+void ProcessReactor::Post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        pending_tasks_.push_back(std::move(task));
+    }
+    uint64_t one = 1;
+    if (write(event_fd_, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        std::cerr << "Failed to wake reactor: " << strerror(errno) << std::endl;
+    }
+}
+
+void ProcessReactor::Stop() {
+    stop_requested_ = true;
+    uint64_t one = 1;
+    if (event_fd_ >= 0 && write(event_fd_, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        std::cerr << "Failed to wake reactor: " << strerror(errno) << std::endl;
+    }
+}
+
+void ProcessReactor::Run() {
+    const int kMaxEvents = 16;
+    epoll_event events[kMaxEvents];
+    while (!stop_requested_) {
+        int count = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "epoll_wait failed: " << strerror(errno) << std::endl;
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            stats_.wakeups++;
+        }
+        for (int i = 0; i < count && !stop_requested_; ++i) {
+            const uint32_t source = static_cast<uint32_t>(events[i].data.u64 >> 32);
+            const uint32_t id = static_cast<uint32_t>(events[i].data.u64 & 0xffffffffu);
+            if (source == kWakeup) {
+                HandleWakeup();
+            } else if (source == kSignal) {
+                HandleSignalFd();
+            } else if (source == kTimer) {
+                HandleTimer(static_cast<int>(id));
+            }
+        }
+    }
+}
+
+void ProcessReactor::HandleWakeup() {
+    uint64_t value;
+    while (read(event_fd_, &value, sizeof(value)) > 0) {
+    }
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        tasks.swap(pending_tasks_);
+    }
+    for (auto& task : tasks) {
+        const int64_t start_us = NowUs();
+        task();
+        RecordCallback(start_us);
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.tasks++;
+    }
+}
+
+void ProcessReactor::HandleSignalFd() {
+    signalfd_siginfo info;
+    while (read(signal_fd_, &info, sizeof(info)) == sizeof(info)) {
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            stats_.signals++;
+        }
+        if (signal_callback_) {
+            const int64_t start_us = NowUs();
+            signal_callback_(static_cast<int>(info.ssi_signo));
+            RecordCallback(start_us);
+        }
+    }
+}
+
+void ProcessReactor::HandleTimer(int timer_id) {
+    auto it = timers_.find(timer_id);
+    if (it == timers_.end()) {
+        return;
+    }
+    uint64_t expirations = 0;
+    if (read(it->second.fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return;
+    }
+    // 回调期间可能取消自己或添加新定时器，先复制回调
+    Task callback = it->second.callback;
+    const bool repeat = it->second.repeat;
+    if (!repeat) {
+        CancelTimer(timer_id);
+    }
+    const int64_t start_us = NowUs();
+    callback();
+    RecordCallback(start_us);
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.timer_runs++;
+}
+
+void ProcessReactor::RecordCallback(int64_t start_us) {
+    const uint64_t elapsed_us = static_cast<uint64_t>(std::max<int64_t>(0, NowUs() - start_us));
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.max_callback_us = std::max(stats_.max_callback_us, elapsed_us);
+}
+
+ProcessReactor::Stats ProcessReactor::GetStats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
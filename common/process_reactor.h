@@ -0,0 +1,116 @@
+#pragma once
+#include <csignal>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief 主线程上的事件循环（epoll）
+ *
+ * 信号（signalfd）、定时器（timerfd）和跨线程投递的任务（eventfd）都作为文件描述符
+ * 交给同一个epoll等待，回调全部在调用Run的线程上执行，不再需要每100毫秒轮询一次标志位：
+ * 收到SIGTERM后立即退出，统计采样、健康检查等周期任务各用一个定时器，不另开线程。
+ *
+ * 信号必须在任何线程创建之前由HandleSignals屏蔽，新线程继承屏蔽字，
+ * 信号只会通过signalfd交给事件循环，而不是打断任意一个线程。
+ */
+class ProcessReactor {
+public:
+    using SignalCallback = std::function<void(int signal)>;
+    using Task = std::function<void()>;
+
+    ProcessReactor();
+    ~ProcessReactor();
+
+    ProcessReactor(const ProcessReactor&) = delete;
+    ProcessReactor& operator=(const ProcessReactor&) = delete;
+
+    /**
+     * @brief 创建epoll和用于唤醒的eventfd
+     * @return 是否成功
+     */
+    bool Initialize();
+
+    /**
+     * @brief 屏蔽这些信号并通过signalfd接收，需在创建任何线程之前调用（只能调用一次）
+     * @param signals 信号列表
+     * @param callback 在事件循环线程上调用
+     * @return 是否成功
+     */
+    bool HandleSignals(const std::vector<int>& signals, SignalCallback callback);
+
+    /**
+     * @brief 添加定时器，首次在interval_ms之后触发
+     * @param interval_ms 周期（毫秒）
+     * @param callback 在事件循环线程上调用
+     * @param repeat 为false时只触发一次
+     * @return 定时器ID，失败时返回-1
+     */
+    int AddTimer(int interval_ms, Task callback, bool repeat = true);
+
+    /**
+     * @brief 取消定时器（只能在事件循环线程上调用，或在Run之前调用）
+     */
+    void CancelTimer(int timer_id);
+
+    /**
+     * @brief 投递任务到事件循环线程执行（任意线程可调用）
+     */
+    void Post(Task task);
+
+    /**
+     * @brief 运行事件循环直到Stop
+     */
+    void Run();
+
+    /**
+     * @brief 让Run返回（任意线程可调用，包括Run之前）
+     */
+    void Stop();
+
+    /**
+     * @brief 事件循环的处理统计
+     */
+    struct Stats {
+        uint64_t wakeups = 0;
+        uint64_t signals = 0;
+        uint64_t timer_runs = 0;
+        uint64_t tasks = 0;
+        uint64_t max_callback_us = 0;
+    };
+    Stats GetStats() const;
+
+private:
+    struct Timer {
+        int fd = -1;
+        Task callback;
+        bool repeat = true;
+    };
+
+    // epoll事件数据：高32位为来源类型，低32位为定时器ID
+    enum Source : uint32_t { kWakeup = 1, kSignal = 2, kTimer = 3 };
+
+    void HandleWakeup();
+    void HandleSignalFd();
+    void HandleTimer(int timer_id);
+    void RecordCallback(int64_t start_us);
+
+    int epoll_fd_ = -1;
+    int event_fd_ = -1;
+    int signal_fd_ = -1;
+    SignalCallback signal_callback_;
+
+    std::map<int, Timer> timers_;
+    int next_timer_id_ = 1;
+
+    std::vector<Task> pending_tasks_;
+    std::mutex tasks_mutex_;
+
+    std::atomic<bool> stop_requested_{false};
+
+    mutable std::mutex stats_mutex_;
+    Stats stats_;
+};
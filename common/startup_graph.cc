@@ -0,0 +1,174 @@
+#include "startup_graph.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+StartupGraph::StartupGraph(std::chrono::steady_clock::time_point origin) : origin_(origin) {}
+
+void StartupGraph::AddTask(const std::string& name, const std::vector<std::string>& dependencies, Task task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& dependency : dependencies) {
+        if (index_.count(dependency) == 0) {
+            std::cerr << "[WARN] Startup task " << name << " depends on unknown task " << dependency << std::endl;
+        }
+    }
+    Node node;
+    node.name = name;
+    node.dependencies = dependencies;
+    node.task = std::move(task);
+    index_[name] = nodes_.size();
+    nodes_.push_back(std::move(node));
+}
+
+int64_t StartupGraph::ElapsedUs() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin_).count();
+}
+
+int StartupGraph::Readiness(const Node& node) const {
+    int readiness = 1;
+    for (const auto& dependency : node.dependencies) {
+        auto it = index_.find(dependency);
+        if (it == index_.end()) {
+            return -1;
+        }
+        State state = nodes_[it->second].state;
+        if (state == State::kFailed || state == State::kSkipped) {
+            return -1;
+        }
+        if (state != State::kSucceeded) {
+            readiness = 0;
+        }
+    }
+    return readiness;
+}
+
+void StartupGraph::Execute(size_t index) {
+    Task task;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nodes_[index].start_us = ElapsedUs();
+        task = nodes_[index].task;
+    }
+    bool ok = task();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nodes_[index].end_us = ElapsedUs();
+        nodes_[index].state = ok ? State::kSucceeded : State::kFailed;
+    }
+    if (!ok) {
+        std::cerr << "Startup task " << nodes_[index].name << " failed" << std::endl;
+    }
+    finished_cv_.notify_all();
+}
+
+bool StartupGraph::Run(bool parallel) {
+    parallel_ = parallel;
+    if (!parallel) {
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            int readiness;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                readiness = Readiness(nodes_[i]);
+                nodes_[i].state = readiness > 0 ? State::kRunning : State::kSkipped;
+            }
+            if (readiness > 0) {
+                Execute(i);
+            }
+        }
+    } else {
+        std::vector<std::thread> threads;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            bool running = false;
+            for (size_t i = 0; i < nodes_.size(); ++i) {
+                Node& node = nodes_[i];
+                if (node.state == State::kPending) {
+                    int readiness = Readiness(node);
+                    if (readiness > 0) {
+                        node.state = State::kRunning;
+                        threads.emplace_back([this, i]() { Execute(i); });
+                    } else if (readiness < 0) {
+                        node.state = State::kSkipped;
+                    }
+                }
+                if (node.state == State::kRunning || node.state == State::kPending) {
+                    running = true;
+                }
+            }
+            if (!running) {
+                break;
+            }
+            // 等任意一个任务结束后再检查哪些任务可以开始
+            size_t finished = 0;
+            for (const auto& node : nodes_) {
+                if (node.end_us >= 0) finished++;
+            }
+            finished_cv_.wait(lock, [this, finished]() {
+                size_t count = 0;
+                for (const auto& node : nodes_) {
+                    if (node.end_us >= 0) count++;
+                }
+                return count > finished;
+            });
+        }
+        lock.unlock();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::all_of(nodes_.begin(), nodes_.end(), [](const Node& node) { return node.state == State::kSucceeded; });
+}
+
+bool StartupGraph::Succeeded(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(name);
+    return it != index_.end() && nodes_[it->second].state == State::kSucceeded;
+}
+
+int64_t StartupGraph::Mark(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& milestone : milestones_) {
+        if (milestone.first == name) {
+            return milestone.second / 1000;
+        }
+    }
+    int64_t elapsed_us = ElapsedUs();
+    milestones_.emplace_back(name, elapsed_us);
+    return elapsed_us / 1000;
+}
+
+void StartupGraph::LogTimeline() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t span_us = 1;
+    for (const auto& node : nodes_) {
+        span_us = std::max(span_us, node.end_us);
+    }
+    for (const auto& milestone : milestones_) {
+        span_us = std::max(span_us, milestone.second);
+    }
+    // 每个任务一行，横条按整个时间线的跨度缩放到40个字符
+    const int kWidth = 40;
+    std::cout << "[Timing] Startup timeline (" << (parallel_ ? "parallel" : "serial") << ", ms since process start):"
+              << std::endl;
+    for (const auto& node : nodes_) {
+        if (node.start_us < 0) {
+            std::cout << "[Timing]   " << std::left << std::setw(12) << node.name << std::right << " skipped" << std::endl;
+            continue;
+        }
+        int begin = static_cast<int>(node.start_us * kWidth / span_us);
+        int end = std::max(begin + 1, static_cast<int>(node.end_us * kWidth / span_us));
+        std::string bar(kWidth, ' ');
+        std::fill(bar.begin() + begin, bar.begin() + std::min(end, kWidth), '#');
+        std::cout << "[Timing]   " << std::left << std::setw(12) << node.name << std::right << " |" << bar << "| "
+                  << std::setw(5) << node.start_us / 1000 << " - " << std::setw(5) << node.end_us / 1000 << " ("
+                  << (node.end_us - node.start_us) / 1000 << " ms" << (node.state == State::kFailed ? ", failed" : "")
+                  << ")" << std::endl;
+    }
+    for (const auto& milestone : milestones_) {
+        std::cout << "[Timing]   " << std::left << std::setw(12) << milestone.first << std::right << " at "
+                  << milestone.second / 1000 << " ms" << std::endl;
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 启动阶段的依赖图
+ *
+ * 各初始化步骤登记为任务并声明依赖，Run时依赖已完成的任务各自在一个线程上并发执行，
+ * 例如MPI/VO/AO初始化、PeerConnectionFactory创建与信令连接互不等待。
+ * 某个任务失败时，依赖它的任务不再执行。
+ * 每个任务的开始/结束时间和Mark记录的里程碑都相对进程启动时间输出为时间线，
+ * 串行模式按登记顺序逐个执行，用于对比并行带来的收益。
+ */
+class StartupGraph {
+public:
+    using Task = std::function<bool()>;
+
+    /**
+     * @brief 构造函数
+     * @param origin 时间线的零点（通常为进程启动时间）
+     */
+    explicit StartupGraph(std::chrono::steady_clock::time_point origin);
+
+    /**
+     * @brief 登记任务，依赖必须已经登记
+     * @param name 任务名
+     * @param dependencies 依赖的任务名
+     * @param task 任务函数，返回是否成功
+     */
+    void AddTask(const std::string& name, const std::vector<std::string>& dependencies, Task task);
+
+    /**
+     * @brief 执行所有任务（阻塞到全部结束）
+     * @param parallel 为false时按登记顺序串行执行
+     * @return 所有任务都成功时返回true
+     */
+    bool Run(bool parallel);
+
+    /**
+     * @brief 任务是否已成功完成
+     */
+    bool Succeeded(const std::string& name) const;
+
+    /**
+     * @brief 记录一个里程碑（如信令注册完成），可在任意线程调用，同名只记录第一次
+     * @return 距时间线零点的毫秒数
+     */
+    int64_t Mark(const std::string& name);
+
+    /**
+     * @brief 输出任务与里程碑的时间线
+     */
+    void LogTimeline() const;
+
+private:
+    enum class State { kPending, kRunning, kSucceeded, kFailed, kSkipped };
+
+    struct Node {
+        std::string name;
+        std::vector<std::string> dependencies;
+        Task task;
+        State state = State::kPending;
+        int64_t start_us = -1;
+        int64_t end_us = -1;
+    };
+
+    int64_t ElapsedUs() const;
+    // 在持锁状态下调用：依赖全部成功返回1，有依赖失败或被跳过返回-1，否则返回0
+    int Readiness(const Node& node) const;
+    void Execute(size_t index);
+
+    std::chrono::steady_clock::time_point origin_;
+    std::vector<Node> nodes_;
+    std::map<std::string, size_t> index_;
+    std::vector<std::pair<std::string, int64_t>> milestones_;
+    bool parallel_ = true;
+    mutable std::mutex mutex_;
+    std::condition_variable finished_cv_;
+};
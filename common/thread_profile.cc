@@ -0,0 +1,217 @@
+#include "thread_profile.h"
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+thread_local ThreadProfile::ThreadRecord* ThreadProfile::current_ = nullptr;
+
+namespace {
+
+int64_t GetMonotonicTimeUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 读取/proc/self/task/<tid>/stat中的utime+stime和最近运行的CPU
+bool ReadTaskStat(pid_t tid, uint64_t* cpu_ticks, int* processor) {
+    std::ifstream file("/proc/self/task/" + std::to_string(tid) + "/stat");
+    std::string content;
+    if (!file || !std::getline(file, content)) {
+        return false;
+    }
+    // 线程名可能包含空格，从最后一个')'之后开始按空格切分；其后第一个字段是第3个字段
+    size_t pos = content.rfind(')');
+    if (pos == std::string::npos) {
+        return false;
+    }
+    std::istringstream fields(content.substr(pos + 2));
+    std::string value;
+    uint64_t utime = 0, stime = 0;
+    for (int index = 3; fields >> value; ++index) {
+        if (index == 14) utime = std::stoull(value);
+        else if (index == 15) stime = std::stoull(value);
+        else if (index == 39) {
+            *processor = std::stoi(value);
+            break;
+        }
+    }
+    *cpu_ticks = utime + stime;
+    return true;
+}
+
+// 读取/proc/self/task/<tid>/schedstat：运行时间、运行队列等待时间（纳秒）、调度次数
+bool ReadTaskSchedstat(pid_t tid, uint64_t* wait_ns, uint64_t* slices) {
+    std::ifstream file("/proc/self/task/" + std::to_string(tid) + "/schedstat");
+    uint64_t run_ns = 0;
+    return static_cast<bool>(file >> run_ns >> *wait_ns >> *slices);
+}
+
+}  // namespace
+
+ThreadProfile& ThreadProfile::Instance() {
+    static ThreadProfile instance;
+    return instance;
+}
+
+const char* ThreadProfile::RoleName(Role role) {
+    switch (role) {
+        case Role::kNetwork: return "network";
+        case Role::kWorker: return "worker";
+        case Role::kSignaling: return "signaling";
+        case Role::kAudio: return "audio";
+        case Role::kSignalingIo: return "io";
+        case Role::kDispatcher: return "dispatcher";
+        default: return "other";
+    }
+}
+
+bool ThreadProfile::ParseCpuList(const std::string& list, cpu_set_t* set) {
+    CPU_ZERO(set);
+    long cpu_count = sysconf(_SC_NPROCESSORS_CONF);
+    std::istringstream items(list);
+    std::string item;
+    while (std::getline(items, item, '+')) {
+        size_t dash = item.find('-');
+        int first = 0, last = 0;
+        try {
+            first = std::stoi(item.substr(0, dash));
+            last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (first < 0 || last < first || last >= cpu_count) {
+            return false;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            CPU_SET(cpu, set);
+        }
+    }
+    return CPU_COUNT(set) > 0;
+}
+
+bool ThreadProfile::ParseAffinity(const std::string& spec) {
+    std::istringstream entries(spec);
+    std::string entry;
+    while (std::getline(entries, entry, ',')) {
+        size_t eq = entry.find('=');
+        if (eq == std::string::npos) {
+            std::cerr << "Invalid CPU affinity entry: " << entry << std::endl;
+            return false;
+        }
+        std::string name = entry.substr(0, eq);
+        Role role = Role::kOther;
+        for (Role candidate : {Role::kNetwork, Role::kWorker, Role::kSignaling, Role::kAudio,
+                               Role::kSignalingIo, Role::kDispatcher}) {
+            if (name == RoleName(candidate)) {
+                role = candidate;
+            }
+        }
+        cpu_set_t set;
+        if (role == Role::kOther || !ParseCpuList(entry.substr(eq + 1), &set)) {
+            std::cerr << "Invalid CPU affinity entry: " << entry << std::endl;
+            return false;
+        }
+        affinity_[role] = set;
+    }
+    return true;
+}
+
+bool ThreadProfile::LockMemory() {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        std::cerr << "[WARN] mlockall failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    std::cout << "[INFO] Process memory locked" << std::endl;
+    return true;
+}
+
+void ThreadProfile::RegisterCurrentThread(Role role, const std::string& name) {
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+
+    auto it = affinity_.find(role);
+    if (it != affinity_.end()) {
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &it->second) != 0) {
+            std::cerr << "[WARN] Failed to pin thread " << name << std::endl;
+        }
+    }
+    if (role == Role::kAudio && audio_priority_ > 0) {
+        sched_param param;
+        param.sched_priority = audio_priority_;
+        int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (ret != 0) {
+            std::cerr << "[WARN] Failed to set SCHED_FIFO " << audio_priority_ << " on " << name << ": "
+                      << strerror(ret) << std::endl;
+        }
+    }
+
+    auto record = std::make_unique<ThreadRecord>();
+    record->name = name;
+    record->role = role;
+    record->tid = static_cast<pid_t>(syscall(SYS_gettid));
+    int processor = -1;
+    ReadTaskStat(record->tid, &record->last_cpu_ticks, &processor);
+    ReadTaskSchedstat(record->tid, &record->last_wait_ns, &record->last_slices);
+    current_ = record.get();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads_.push_back(std::move(record));
+}
+
+void ThreadProfile::RecordWakeupLatency(int64_t latency_us) {
+    ThreadRecord* record = current_;
+    if (!record) {
+        return;
+    }
+    record->wakeup_count++;
+    record->wakeup_sum_us += latency_us;
+    if (latency_us > record->wakeup_max_us) {
+        record->wakeup_max_us = latency_us;
+    }
+}
+
+void ThreadProfile::LogReport() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now_us = GetMonotonicTimeUs();
+    double elapsed_s = last_report_us_ > 0 ? (now_us - last_report_us_) / 1e6 : 0;
+    last_report_us_ = now_us;
+    long ticks_per_s = sysconf(_SC_CLK_TCK);
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1) << "[INFO] Thread report:";
+    for (auto it = threads_.begin(); it != threads_.end();) {
+        ThreadRecord& record = **it;
+        uint64_t cpu_ticks = 0, wait_ns = 0, slices = 0;
+        int processor = -1;
+        if (!ReadTaskStat(record.tid, &cpu_ticks, &processor)) {
+            it = threads_.erase(it); // 线程已退出
+            continue;
+        }
+        ReadTaskSchedstat(record.tid, &wait_ns, &slices);
+
+        double cpu_percent = elapsed_s > 0
+            ? 100.0 * (cpu_ticks - record.last_cpu_ticks) / ticks_per_s / elapsed_s : 0;
+        uint64_t delta_slices = slices - record.last_slices;
+        double avg_wait_us = delta_slices > 0 ? (wait_ns - record.last_wait_ns) / 1000.0 / delta_slices : 0;
+        record.last_cpu_ticks = cpu_ticks;
+        record.last_wait_ns = wait_ns;
+        record.last_slices = slices;
+
+        report << "\n  " << std::left << std::setw(16) << record.name << std::right
+               << " tid " << record.tid << " cpu" << processor << " " << cpu_percent << "%"
+               << ", runqueue wait " << avg_wait_us << " us/slice";
+        int64_t wakeups = record.wakeup_count.exchange(0);
+        if (wakeups > 0) {
+            report << ", wakeup late avg " << record.wakeup_sum_us.exchange(0) / wakeups
+                   << " us max " << record.wakeup_max_us.exchange(0) << " us";
+        }
+        ++it;
+    }
+    std::cout << report.str() << std::endl;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <sched.h>
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 媒体线程调度配置：命名、绑核、实时优先级与运行统计
+ *
+ * RK3566只有4个核，WebRTC网络/工作线程和音频播放线程一旦与无关的系统服务挤在同一个核上，
+ * 音频就会断续。各线程启动时调用RegisterCurrentThread登记自己的角色：
+ * 设置线程名，按配置绑定到指定的核，音频线程可提升为SCHED_FIFO。
+ * LogReport按/proc/self/task统计每个线程的CPU占用和运行队列等待（调度延迟）。
+ */
+class ThreadProfile {
+public:
+    /**
+     * @brief 线程角色
+     */
+    enum class Role {
+        kNetwork,      // WebRTC网络线程
+        kWorker,       // WebRTC工作线程
+        kSignaling,    // WebRTC信令线程
+        kAudio,        // 音频播放线程
+        kSignalingIo,  // WebSocket/本地套接字IO线程
+        kDispatcher,   // 信令消息分发线程
+        kOther
+    };
+
+    static ThreadProfile& Instance();
+
+    /**
+     * @brief 解析绑核配置，需在各线程启动之前调用
+     * @param spec 形如"network=1,worker=2,signaling=2,audio=3,io=0,dispatcher=0"，
+     *             多个核用'+'连接，范围用'-'，如"worker=1+2"或"worker=1-2"
+     * @return 是否解析成功
+     */
+    bool ParseAffinity(const std::string& spec);
+
+    /**
+     * @brief 设置音频线程的SCHED_FIFO优先级
+     * @param priority 1~99，0表示保持普通调度
+     */
+    void SetAudioPriority(int priority) { audio_priority_ = priority; }
+
+    /**
+     * @brief 锁定进程当前及以后的全部内存，避免缺页导致的停顿
+     * @return 是否成功（通常需要root或CAP_IPC_LOCK）
+     */
+    bool LockMemory();
+
+    /**
+     * @brief 在线程自身上调用：命名、绑核、设置调度策略，并登记用于统计
+     * @param role 线程角色
+     * @param name 线程名（最长15个字符）
+     */
+    void RegisterCurrentThread(Role role, const std::string& name);
+
+    /**
+     * @brief 记录当前线程一次定时唤醒的迟到时间
+     * @param latency_us 实际唤醒时间与预期时间之差（微秒）
+     */
+    void RecordWakeupLatency(int64_t latency_us);
+
+    /**
+     * @brief 输出各线程自上次报告以来的CPU占用、所在核和调度延迟
+     */
+    void LogReport();
+
+private:
+    struct ThreadRecord {
+        std::string name;
+        Role role = Role::kOther;
+        pid_t tid = 0;
+        // 定时唤醒迟到统计（由线程自己写入）
+        std::atomic<int64_t> wakeup_count{0};
+        std::atomic<int64_t> wakeup_sum_us{0};
+        std::atomic<int64_t> wakeup_max_us{0};
+        // 上次报告时的累计值
+        uint64_t last_cpu_ticks = 0;
+        uint64_t last_wait_ns = 0;
+        uint64_t last_slices = 0;
+    };
+
+    ThreadProfile() = default;
+
+    static const char* RoleName(Role role);
+    static bool ParseCpuList(const std::string& list, cpu_set_t* set);
+
+    std::map<Role, cpu_set_t> affinity_;
+    int audio_priority_ = 0;
+
+    std::vector<std::unique_ptr<ThreadRecord>> threads_;
+    std::mutex mutex_;
+    int64_t last_report_us_ = 0;
+
+    static thread_local ThreadRecord* current_;
+};
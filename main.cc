@@ -1,25 +1,36 @@
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <csignal> // 用于 signal
 #include <thread>
 #include <chrono>
 #include <atomic>
 #include <memory>   // 用于智能指针
+#include <algorithm>
+#include <map>
+#include <vector>
 
 // 包含我们所有的核心模块
 #include "webrtc/webrtc_client.h"
 #include "webrtc/encoded_video_frame_handler_rockit.h"
 #include "webrtc/audio_receiver_rockit.h"
+#include "common/thread_profile.h"
+#include "common/startup_graph.h"
+#include "common/process_reactor.h"
+#include "common/command_line.h"
+#ifdef WITH_NETWORK_EMULATION
+#include "webrtc/network_emulation_test.h"
+#endif
 
 // 引入Rockchip MPP系统控制头文件
 extern "C" {
 #include "rk_mpi_sys.h"
 }
 
-// 全局运行状态标志 (来自您的版本)
+// 全局运行状态标志：只用于测完即退出的测试模式，常驻运行时由事件循环处理信号
 std::atomic<bool> g_running(true);
 
-// 信号处理函数，用于优雅地退出程序 (来自您的版本，更完整)
+// 信号处理函数，用于在测试模式中提前结束
 void SignalHandler(int signal) {
     if (signal == SIGINT || signal == SIGTERM) {
         std::cout << "\nCaught signal " << signal << ", shutting down gracefully..." << std::endl;
@@ -27,47 +38,268 @@ void SignalHandler(int signal) {
     }
 }
 
+// 拆分逗号分隔的列表（房间、ICE服务器、网卡）
+static std::vector<std::string> SplitList(const std::string& list) {
+    std::vector<std::string> rooms;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        if (end > start) rooms.push_back(list.substr(start, end - start));
+        start = end + 1;
+    }
+    return rooms;
+}
+
+// 读取"key=value"形式的配置文件，忽略空行和#开头的注释
+static bool ReadConfigFile(const std::string& path, std::map<std::string, std::string>* config) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        line.erase(0, line.find_first_not_of(" \t"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        size_t eq = line.find('=');
+        if (line.empty() || line[0] == '#' || eq == std::string::npos) {
+            continue;
+        }
+        (*config)[line.substr(0, eq)] = line.substr(eq + 1);
+    }
+    return true;
+}
+
+// 同时显示的会话上限：画中画小窗最多排成4列×4行，再多就小到无法辨认
+static const int kMaxDisplaySessions = 16;
+
+/**
+ * @brief 计算画中画小窗的位置：slot 1..max_sessions-1沿屏幕右侧从上到下排列，
+ * 一列排满后向左另起一列；小窗较多时缩小，保证互不重叠
+ */
+static void PipTileRect(int slot, int max_sessions, double* x, double* y, double* size) {
+    const double gap = 0.02;
+    const int tiles = std::max(1, max_sessions - 1);
+    int per_column = 3;
+    while (per_column * per_column < tiles) {
+        per_column++;
+    }
+    *size = std::min(0.24, (1.0 - gap * (per_column + 1)) / per_column);
+    const int index = slot - 1;
+    *x = 1.0 - (index / per_column + 1) * (*size + gap);
+    *y = gap + (index % per_column) * (*size + gap);
+}
+
+static void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " <signaling_url> <room_id[,room_id...]> [client_id]" << std::endl;
+    std::cerr << "       " << program << " --static-offer=<offer.sdp> [--static-answer=<answer.sdp>]" << std::endl;
+    std::cerr << "Options: --max-sessions=<n>   concurrent senders, extra ones shown picture-in-picture (default 4, max 16)" << std::endl;
+    std::cerr << "         --room-session-cap=<n>  concurrent senders per room (default 0, unlimited)" << std::endl;
+    std::cerr << "         --ice-profile=default|lan  lan: host UDP/IPv4 candidates only, fast checks" << std::endl;
+    std::cerr << "         --ice-servers=<uri,...>  STUN/TURN servers (default stun:stun.l.google.com:19302)" << std::endl;
+    std::cerr << "         --ice-username=<u> --ice-password=<p>  TURN credentials" << std::endl;
+    std::cerr << "         --ice-interfaces=<if,...>  only gather candidates on these interfaces (e.g. eth0)" << std::endl;
+    std::cerr << "         --cpu-affinity=<role=cpus,...>  pin threads; roles network,worker,signaling,audio,io,dispatcher;" << std::endl;
+    std::cerr << "                              cpus like 3, 1+2 or 1-2 (e.g. network=1,worker=2,audio=3)" << std::endl;
+    std::cerr << "         --audio-rt-priority=<1-99>  run the audio playout thread with SCHED_FIFO" << std::endl;
+    std::cerr << "         --mlockall           lock all process memory" << std::endl;
+    std::cerr << "         --thread-report=<s>  log per-thread CPU usage and scheduling latency every s seconds" << std::endl;
+    std::cerr << "         --udp-batch=<n>      receive up to n UDP datagrams per recvmmsg on the network thread (default 0, off)" << std::endl;
+    std::cerr << "         --udp-gro            enable UDP GRO with --udp-batch" << std::endl;
+    std::cerr << "         --udp-rcvbuf=<bytes> UDP receive buffer size with --udp-batch (default 1048576)" << std::endl;
+    std::cerr << "         --latency-profile=ultra-low|balanced|smooth  receive buffering (default balanced);" << std::endl;
+    std::cerr << "                              send SIGUSR1 to switch to the next profile at runtime" << std::endl;
+    std::cerr << "         --latency-report=<s> log jitter buffer / playout queue / decoder backlog every s seconds" << std::endl;
+    std::cerr << "         --bitrate-control    cap the senders' video bitrate (SDP b=AS) when decoding falls behind" << std::endl;
+    std::cerr << "         --bitrate-min=<kbps> --bitrate-max=<kbps>  cap range (default 300 / 8000; above max the cap is lifted)" << std::endl;
+    std::cerr << "         --layer-select       pick simulcast/temporal layers by display size and VDEC capacity" << std::endl;
+    std::cerr << "         --vdec-capacity=<Mpx/s>  decoder budget for --layer-select (default 250)" << std::endl;
+    std::cerr << "         --event-log=<dir>    write RTC event logs (RTP/RTCP headers, bandwidth estimates, ICE) to dir;" << std::endl;
+    std::cerr << "                              send SIGUSR2 to start/stop logging all sessions" << std::endl;
+    std::cerr << "         --event-log-auto     start logging every session as soon as it opens" << std::endl;
+    std::cerr << "         --event-log-max-mb=<n> --event-log-files=<n>  rotate at n MB per file, keep n files (default 16 / 8)" << std::endl;
+    std::cerr << "         --control-bench[=<n>]  measure n (default 1000) control channel round trips over a local loopback connection and exit" << std::endl;
+    std::cerr << "         --netem-test[=<name,...>]  run local sender->receiver sessions over emulated networks and exit;" << std::endl;
+    std::cerr << "                              scenarios clean,delay50,loss1,loss5,burst,jitter30,reorder,cap2m,lte (default all)" << std::endl;
+    std::cerr << "         --netem-duration=<s> media time per scenario (default 20), uses --latency-profile" << std::endl;
+    std::cerr << "         --ice-pool=<n>       prewarm a PeerConnection with n pooled ICE candidates (default 0, off)" << std::endl;
+    std::cerr << "         --ice-pool-refresh=<s>  rebuild the prewarmed connection every s seconds (default 60)" << std::endl;
+    std::cerr << "         --no-vdec-preconfigure  create VDEC/VO on the first frame instead of from the offer's codec/size hints" << std::endl;
+    std::cerr << "         --health-check=<s>   log sessions, memory, threads and signaling state every s seconds" << std::endl;
+    std::cerr << "         --config=<file>      re-read on SIGHUP: latency-profile=<name>, event-log=on|off, rooms=<id,...>" << std::endl;
+    std::cerr << "         --serial-init        initialize MPI/AO, WebRTC and signaling one after another (startup time comparison)" << std::endl;
+    std::cerr << "Example: " << program << " ws://192.168.1.10:8080 101 rk3566_receiver" << std::endl;
+    std::cerr << "         " << program << " unix:///run/receiver/signaling.sock 101   (local controller)" << std::endl;
+}
+
 int main(int argc, char* argv[]) {
-    // 1. 参数解析 (来自您的版本)
-    if (argc < 3) {
-        std::cerr << "Usage: " << argv[0] << " <signaling_url> <room_id> [client_id]" << std::endl;
-        std::cerr << "Example: " << argv[0] << " ws://192.168.1.10:8080 101 rk3566_receiver" << std::endl;
+    // 记录进程启动时间，用于统计启动到首帧的耗时
+    const auto start_time = std::chrono::steady_clock::now();
+
+    // 1. 参数解析
+    CommandLine cmd = ParseCommandLine(argc, argv);
+    std::string arg_error;
+    if (!cmd.CheckNumbers({"control-bench", "audio-rt-priority", "thread-report", "latency-report", "health-check",
+                           "max-sessions", "room-session-cap", "udp-batch", "udp-rcvbuf", "bitrate-min", "bitrate-max",
+                           "event-log-max-mb", "event-log-files", "ice-pool", "ice-pool-refresh", "netem-duration"},
+                          {"vdec-capacity"}, &arg_error)) {
+        std::cerr << "Invalid argument: " << arg_error << std::endl;
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    // 静态会话模式：使用预先配置的远端Offer，不连接信令服务器
+    const bool static_session = cmd.Has("static-offer");
+    // 控制通道回环测试：只需要PeerConnection工厂，测完即退出
+    const bool control_bench = cmd.Has("control-bench");
+    const int control_bench_count = std::max(1, cmd.GetInt("control-bench", 1000));
+    // 网络仿真测试：本进程内的发送端经仿真链路发送，测完即退出
+    const bool netem_test = cmd.Has("netem-test");
+#ifndef WITH_NETWORK_EMULATION
+    if (netem_test) {
+        std::cerr << "Network emulation is not built in (configure with -DRK_NETWORK_EMULATION=ON)" << std::endl;
+        return 1;
+    }
+#endif
+    const bool use_signaling = !static_session && !control_bench && !netem_test;
+    if (use_signaling && cmd.positional.size() < 2) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    std::string signaling_url = use_signaling ? cmd.positional[0] : "";
+    // 可同时加入多个房间，共用一条信令连接
+    std::vector<std::string> room_ids = use_signaling ? SplitList(cmd.positional[1]) : std::vector<std::string>();
+    if (use_signaling && room_ids.empty()) {
+        PrintUsage(argv[0]);
         return 1;
     }
-    std::string signaling_url = argv[1];
-    std::string room_id = argv[2];
-    std::string client_id = (argc > 3) ? argv[3] : "rk3566_receiver";
+    std::string client_id = (use_signaling && cmd.positional.size() > 2) ? cmd.positional[2] : "rk3566_receiver";
+
+    // 线程调度配置必须在任何线程启动之前设置好，各线程启动时自行应用
+    ThreadProfile& thread_profile = ThreadProfile::Instance();
+    if (cmd.Has("cpu-affinity") && !thread_profile.ParseAffinity(cmd.Get("cpu-affinity"))) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    thread_profile.SetAudioPriority(cmd.GetInt("audio-rt-priority", 0));
+    if (cmd.Has("mlockall")) {
+        thread_profile.LockMemory();
+    }
+    const int thread_report_s = cmd.GetInt("thread-report", 0);
+    const int latency_report_s = cmd.GetInt("latency-report", 0);
+    const int health_check_s = cmd.GetInt("health-check", 0);
+    const std::string config_path = cmd.Get("config");
 
     // 2. 打印友好的启动日志 (来自您的版本)
     std::cout << "--- RK3566 WebRTC Receiver ---" << std::endl;
-    std::cout << "Signaling Server: " << signaling_url << std::endl;
-    std::cout << "Room ID: " << room_id << std::endl;
-    std::cout << "Client ID: " << client_id << std::endl;
+    if (static_session) {
+        std::cout << "Static Offer: " << cmd.Get("static-offer") << std::endl;
+        std::cout << "Static Answer: " << cmd.Get("static-answer", "<stdout>") << std::endl;
+    } else if (control_bench) {
+        std::cout << "Control channel loopback benchmark: " << control_bench_count << " round trips" << std::endl;
+    } else if (netem_test) {
+        std::cout << "Network emulation test: " << (cmd.Get("netem-test").empty() ? "all scenarios" : cmd.Get("netem-test"))
+                  << std::endl;
+    } else {
+        std::cout << "Signaling Server: " << signaling_url << std::endl;
+        std::cout << "Room ID: " << cmd.positional[1] << std::endl;
+        std::cout << "Client ID: " << client_id << std::endl;
+    }
     std::cout << "---------------------------------" << std::endl;
     
-    // 3. 初始化Rockchip MPP系统 (来自我的版本，至关重要)
-    if (RK_MPI_SYS_Init() != RK_SUCCESS) {
-        std::cerr << "Fatal: Failed to initialize Rockchip MPP system." << std::endl;
-        return -1;
-    }
-    std::cout << "Rockchip MPP system initialized." << std::endl;
-
-    // 4. 设置信号处理 (来自您的版本)
-    signal(SIGINT, SignalHandler);
-    signal(SIGTERM, SignalHandler);
+    // 3. 启动依赖图：MPI/AO初始化、PeerConnectionFactory创建和信令连接并发执行（--serial-init时逐个执行）
+    StartupGraph startup(start_time);
+    const bool serial_init = cmd.Has("serial-init");
 
-    // 5. 创建核心对象 (使用智能指针)
+    // 4. 创建核心对象 (使用智能指针)
     auto webRTCClient = std::make_unique<WebRTCClient>();
     auto videoHandler = std::make_shared<EncodedVideoFrameHandler>();
     auto audioHandler = std::make_shared<AudioReceiver>();
 
+    // 5. 设置信号处理：常驻运行时信号在创建任何线程之前屏蔽，由主线程的事件循环通过signalfd处理，
+    // 启动期间收到的信号在事件循环开始后处理；测完即退出的测试模式仍使用普通的信号处理函数
+    ProcessReactor reactor;
+    const bool use_reactor = !control_bench && !netem_test;
+    // SIGHUP：重新读取--config指定的配置文件，调整延迟档位、事件日志与加入的房间
+    auto reload_config = [&webRTCClient, &config_path, use_signaling]() {
+        std::map<std::string, std::string> config;
+        if (config_path.empty() || !ReadConfigFile(config_path, &config)) {
+            std::cerr << "[WARN] No config file to reload (--config=" << config_path << ")" << std::endl;
+            return;
+        }
+        std::cout << "[INFO] Reloading config from " << config_path << std::endl;
+        if (config.count("latency-profile")) {
+            LatencyProfile profile;
+            if (LatencyProfile::FromName(config["latency-profile"], &profile)) {
+                webRTCClient->SetLatencyProfile(profile);
+            } else {
+                std::cerr << "[WARN] Unknown latency profile: " << config["latency-profile"] << std::endl;
+            }
+        }
+        if (config.count("event-log")) {
+            const bool enabled = config["event-log"] == "on";
+            if (enabled != webRTCClient->IsEventLogging()) {
+                webRTCClient->SetEventLogging(enabled);
+            }
+        }
+        // 房间列表与当前加入的房间取差集，只加入新增的、离开去掉的；列表为空时不离开所有房间
+        std::vector<std::string> rooms = SplitList(config["rooms"]);
+        if (use_signaling && !rooms.empty()) {
+            std::vector<std::string> current = webRTCClient->GetRoomIds();
+            for (const auto& room : rooms) {
+                if (std::find(current.begin(), current.end(), room) == current.end()) {
+                    webRTCClient->JoinRoom(room);
+                }
+            }
+            for (const auto& room : current) {
+                if (std::find(rooms.begin(), rooms.end(), room) == rooms.end()) {
+                    webRTCClient->LeaveRoom(room);
+                }
+            }
+        }
+    };
+    if (use_reactor) {
+        bool reactor_ok = reactor.Initialize() &&
+            reactor.HandleSignals({SIGINT, SIGTERM, SIGUSR1, SIGUSR2, SIGHUP}, [&](int signal) {
+                if (signal == SIGINT || signal == SIGTERM) {
+                    std::cout << "\nCaught signal " << signal << ", shutting down gracefully..." << std::endl;
+                    reactor.Stop();
+                } else if (signal == SIGUSR1) {
+                    // 切换到下一个延迟档位，便于对比各档位的实际延迟
+                    webRTCClient->SetLatencyProfile(webRTCClient->GetLatencyProfile().Next());
+                } else if (signal == SIGUSR2) {
+                    // 开关RTC事件日志，现场复现问题时再开始记录
+                    webRTCClient->SetEventLogging(!webRTCClient->IsEventLogging());
+                } else if (signal == SIGHUP) {
+                    reload_config();
+                }
+            });
+        if (!reactor_ok) {
+            std::cerr << "Fatal: Failed to set up the event loop." << std::endl;
+            return 1;
+        }
+    } else {
+        signal(SIGINT, SignalHandler);
+        signal(SIGTERM, SignalHandler);
+    }
+
     // 6. 设置回调，用于打印状态日志 (通用实践)
-    webRTCClient->SetStateChangeCallback([](const std::string& state, const std::string& description) {
+    webRTCClient->SetStateChangeCallback([&startup, serial_init](const std::string& state, const std::string& description) {
         std::cout << "[WebRTC State] " << state << ": " << description << std::endl;
+        // 连接建立后立即发送注册，以此作为启动完成的时刻
+        if (state == "signaling_connected") {
+            std::cout << "[Timing] Startup to registered: " << startup.Mark("registered") << " ms ("
+                      << (serial_init ? "serial" : "parallel") << " init)" << std::endl;
+        }
     });
     // (可以为 videoHandler 和 audioHandler 添加类似的回调)
-    videoHandler->SetVideoStateCallback([](int state, const std::string& msg){
+    videoHandler->SetVideoStateCallback([start_time, static_session](int state, const std::string& msg){
         std::cout << "[Video State] code " << state << ": " << msg << std::endl;
+        if (state == VIDEO_STATE_FIRST_FRAME) {
+            auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start_time).count();
+            std::cout << "[Timing] Startup to first video frame: " << elapsed_ms << " ms ("
+                      << (static_session ? "static session" : "signaling server") << ")" << std::endl;
+        }
     });
     audioHandler->SetAudioStateCallback([](int state, const std::string& msg){
         std::cout << "[Audio State] code " << state << ": " << msg << std::endl;
@@ -75,23 +307,184 @@ int main(int argc, char* argv[]) {
 
     // 7. 依赖注入与组件初始化 (来自我的版本，顺序很重要)
     webRTCClient->SetMediaHandlers(videoHandler, audioHandler);
+    // 额外的发送端各占一个解码/显示通道，以画中画的形式沿屏幕右侧排列
+    int max_sessions = std::max(1, cmd.GetInt("max-sessions", 4));
+    if (max_sessions > kMaxDisplaySessions) {
+        std::cerr << "[WARN] --max-sessions=" << max_sessions << " exceeds " << kMaxDisplaySessions
+                  << " displayable sessions, using " << kMaxDisplaySessions << std::endl;
+        max_sessions = kMaxDisplaySessions;
+    }
+    webRTCClient->SetMaxSessions(max_sessions);
+    webRTCClient->SetMaxSessionsPerRoom(std::max(0, cmd.GetInt("room-session-cap", 0)));
+    const int udp_batch = cmd.GetInt("udp-batch", 0);
+    if (udp_batch > 0) {
+        BatchedUdpSocketServer::Options udp_options;
+        udp_options.batch_size = udp_batch;
+        udp_options.enable_gro = cmd.Has("udp-gro");
+        udp_options.receive_buffer_bytes = cmd.GetInt("udp-rcvbuf", 1048576);
+        webRTCClient->SetBatchedUdpReceive(udp_options);
+    }
+    IceConfig ice_config;
+    if (!IceConfig::FromProfileName(cmd.Get("ice-profile", "default"), &ice_config)) {
+        std::cerr << "Unknown ICE profile: " << cmd.Get("ice-profile") << std::endl;
+        return 1;
+    }
+    if (cmd.Has("ice-servers")) {
+        ice_config.servers = SplitList(cmd.Get("ice-servers"));
+        ice_config.host_only = ice_config.servers.empty();
+    }
+    ice_config.username = cmd.Get("ice-username");
+    ice_config.password = cmd.Get("ice-password");
+    ice_config.interfaces = SplitList(cmd.Get("ice-interfaces"));
+    webRTCClient->SetIceConfig(ice_config);
+    LatencyProfile latency_profile;
+    if (!LatencyProfile::FromName(cmd.Get("latency-profile", "balanced"), &latency_profile)) {
+        std::cerr << "Unknown latency profile: " << cmd.Get("latency-profile") << std::endl;
+        return 1;
+    }
+    webRTCClient->SetLatencyProfile(latency_profile);
+    ReceiveBitrateController::Config bitrate_config;
+    bitrate_config.min_kbps = cmd.GetInt("bitrate-min", 300);
+    bitrate_config.max_kbps = cmd.GetInt("bitrate-max", 8000);
+    webRTCClient->SetReceiveBitrateControl(cmd.Has("bitrate-control"), bitrate_config);
+    LayerSelector::Config layer_config;
+    layer_config.vdec_capacity_mpps = cmd.GetDouble("vdec-capacity", 250);
+    webRTCClient->SetLayerSelection(cmd.Has("layer-select"), layer_config);
+    if (cmd.Has("event-log")) {
+        RtcEventLogWriter::Config event_log_config;
+        if (!cmd.Get("event-log").empty()) {
+            event_log_config.directory = cmd.Get("event-log");
+        }
+        event_log_config.max_file_bytes = static_cast<uint64_t>(std::max(1, cmd.GetInt("event-log-max-mb", 16))) << 20;
+        event_log_config.max_files = std::max(1, cmd.GetInt("event-log-files", 8));
+        webRTCClient->SetEventLog(event_log_config, cmd.Has("event-log-auto"));
+    }
+    // 预热：启动时就开始收集候选者，Offer到达后不必再等STUN查询
+    webRTCClient->SetIcePrewarm(std::max(0, cmd.GetInt("ice-pool", 0)),
+                                cmd.GetInt("ice-pool-refresh", 60));
+    webRTCClient->SetVideoPreconfigure(!cmd.Has("no-vdec-preconfigure"));
+    webRTCClient->SetVideoHandlerFactory([max_sessions](int slot) -> std::shared_ptr<EncodedVideoFrameHandler> {
+        auto handler = std::make_shared<EncodedVideoFrameHandler>();
+        handler->SetChannels(slot, slot);
+        double x, y, size;
+        PipTileRect(slot, max_sessions, &x, &y, &size);
+        handler->SetDisplayRect(x, y, size, size);
+        handler->SetVideoStateCallback([slot](int state, const std::string& msg) {
+            std::cout << "[Video State][slot " << slot << "] code " << state << ": " << msg << std::endl;
+        });
+        if (!handler->Initialize() || !handler->Start()) {
+            return nullptr;
+        }
+        return handler;
+    });
+    webRTCClient->SetStaticSessionMode(static_session);
 
-    if (!videoHandler->Initialize() || !audioHandler->Initialize() || !webRTCClient->Initialize()) {
+    // 依赖关系：VDEC/VO/AO需要MPI；PeerConnectionFactory与信令连接不依赖其他任务。
+    // 工厂和媒体处理器都就绪之前，信令消息在分发线程上等待，不会丢掉先到的Offer
+    startup.AddTask("mpi", {}, []() {
+        if (RK_MPI_SYS_Init() != RK_SUCCESS) {
+            std::cerr << "Fatal: Failed to initialize Rockchip MPP system." << std::endl;
+            return false;
+        }
+        std::cout << "Rockchip MPP system initialized." << std::endl;
+        return true;
+    });
+    startup.AddTask("video", {"mpi"}, [&videoHandler]() { return videoHandler->Initialize() && videoHandler->Start(); });
+    startup.AddTask("audio", {"mpi"}, [&audioHandler]() { return audioHandler->Initialize() && audioHandler->Start(); });
+    startup.AddTask("webrtc", {}, [&webRTCClient]() { return webRTCClient->Initialize(); });
+    if (use_signaling) {
+        webRTCClient->DeferSignalingUntilMediaReady();
+        startup.AddTask("signaling", {}, [&webRTCClient, &signaling_url, &room_ids, &client_id]() {
+            webRTCClient->ConnectToSignalingServer(signaling_url, room_ids[0], client_id);
+            for (size_t i = 1; i < room_ids.size(); ++i) {
+                webRTCClient->JoinRoom(room_ids[i]);
+            }
+            return true;
+        });
+    }
+    startup.AddTask("ready", {"video", "audio", "webrtc"}, [&webRTCClient]() {
+        webRTCClient->SetMediaReady();
+        return true;
+    });
+    const bool started = startup.Run(!serial_init);
+    startup.LogTimeline();
+    if (!started) {
         std::cerr << "Fatal: Failed to initialize one or more components." << std::endl;
-        RK_MPI_SYS_Exit();
+        webRTCClient->Cleanup();
+        audioHandler->Stop();
+        videoHandler->Stop();
+        if (startup.Succeeded("mpi")) {
+            RK_MPI_SYS_Exit();
+        }
         return -1;
     }
 
-    // 8. 启动处理流程 (来自我的版本，逻辑更清晰)
-    videoHandler->Start();
-    audioHandler->Start();
-    webRTCClient->ConnectToSignalingServer(signaling_url, room_id, client_id);
+    if (control_bench) {
+        bool ok = webRTCClient->RunControlChannelBenchmark(control_bench_count);
+        webRTCClient->Cleanup();
+        audioHandler->Stop();
+        videoHandler->Stop();
+        RK_MPI_SYS_Exit();
+        return ok ? 0 : 1;
+    }
+#ifdef WITH_NETWORK_EMULATION
+    if (netem_test) {
+        std::vector<NetworkEmulationTest::Scenario> scenarios;
+        bool ok = NetworkEmulationTest::SelectScenarios(cmd.Get("netem-test"), &scenarios);
+        NetworkEmulationTest::Config netem_config;
+        netem_config.duration_s = std::max(1, cmd.GetInt("netem-duration", 20));
+        netem_config.latency_profile = latency_profile;
+        NetworkEmulationTest netem(videoHandler, audioHandler);
+        std::vector<NetworkEmulationTest::Result> results;
+        for (size_t i = 0; i < scenarios.size() && g_running; ++i) {
+            NetworkEmulationTest::Result result;
+            if (!netem.Run(scenarios[i], netem_config, &result)) {
+                ok = false;
+            }
+            results.push_back(result);
+        }
+        NetworkEmulationTest::LogResults(latency_profile.Name(), results);
+        webRTCClient->Cleanup();
+        audioHandler->Stop();
+        videoHandler->Stop();
+        RK_MPI_SYS_Exit();
+        return ok ? 0 : 1;
+    }
+#endif
+
+    // 8. 启动处理流程：媒体处理器已在启动图中启动，信令连接也已发起
+    if (static_session) {
+        if (!webRTCClient->StartStaticSession(cmd.Get("static-offer"), cmd.Get("static-answer"))) {
+            std::cerr << "Fatal: Failed to start static session." << std::endl;
+            reactor.Stop();
+        }
+    }
 
-    // 9. 主循环 (来自您的版本)
+    // 9. 主循环：周期任务各用一个定时器，信号到达时立即处理，空闲时主线程不被唤醒
     std::cout << "Receiver is running. Press Ctrl+C to exit." << std::endl;
-    while (g_running) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (thread_report_s > 0) {
+        thread_profile.LogReport();  // 建立统计基线
+        reactor.AddTimer(thread_report_s * 1000, [&thread_profile]() { thread_profile.LogReport(); });
+    }
+    if (latency_report_s > 0) {
+        reactor.AddTimer(latency_report_s * 1000, [&webRTCClient]() { webRTCClient->LogLatencyReport(); });
+    }
+    if (health_check_s > 0) {
+        reactor.AddTimer(health_check_s * 1000, [&webRTCClient, &reactor, use_signaling]() {
+            PeerSession::ProcessUsage usage;
+            PeerSession::ReadProcessUsage(&usage);
+            ProcessReactor::Stats stats = reactor.GetStats();
+            std::cout << "[INFO] Health: sessions=" << webRTCClient->GetSessionUsage().size()
+                      << " rss=" << usage.rss_kb << "KB threads=" << usage.threads;
+            if (use_signaling) {
+                std::cout << " signaling=" << (webRTCClient->IsSignalingConnected() ? "up" : "down")
+                          << " rooms=" << webRTCClient->GetRoomIds().size();
+            }
+            std::cout << " loop_wakeups=" << stats.wakeups << " max_callback=" << stats.max_callback_us << "us"
+                      << std::endl;
+        });
     }
+    reactor.Run();
 
     // 10. [修改] 优化资源清理顺序，确保健壮性
     std::cout << "Shutting down all components..." << std::endl;
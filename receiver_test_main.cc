@@ -55,18 +55,9 @@ int main(int argc, char* argv[]) {
     // 3. 设置消息回调，这是测试的核心逻辑
     signaling_client->SetMessageCallback(
         // 使用[&]捕获外部变量，以便在lambda中使用signaling_client
-        [&signaling_client](SignalingClient::MessageType type, const std::string& message_str) {
+        [&signaling_client](SignalingClient::MessageType type, const Json::Value& root) {
             std::cout << "<- Received message. Type: " << static_cast<int>(type) << std::endl;
-
-            // 解析收到的JSON，以获取发送方ID
-            Json::CharReaderBuilder builder;
-            std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
-            Json::Value root;
-            if (!reader->parse(message_str.c_str(), message_str.c_str() + message_str.length(), &root, nullptr)) {
-                std::cerr << "Failed to parse message: " << message_str << std::endl;
-                return;
-            }
-            std::cout << "   Content: " << message_str << std::endl;
+            std::cout << "   Content: " << root.toStyledString() << std::endl;
             
             // 如果收到Offer，就模拟回复一个Answer
             if (type == SignalingClient::MessageType::OFFER) {
@@ -0,0 +1,617 @@
+#include "loopback_sender.h"
+#include "../signaling/signaling_client_ws.h"
+#include "../common/thread_profile.h"
+#include "../webrtc/session_description_observers.h"
+#include "api/audio_options.h"
+#include "api/create_peerconnection_factory.h"
+#include "api/audio_codecs/builtin_audio_decoder_factory.h"
+#include "api/audio_codecs/builtin_audio_encoder_factory.h"
+#include "api/video_codecs/builtin_video_decoder_factory.h"
+#include "api/video_codecs/builtin_video_encoder_factory.h"
+#include "api/environment/environment_factory.h"
+#include "api/stats/rtc_stats_collector_callback.h"
+#include "api/stats/rtcstats_objects.h"
+#include "modules/audio_device/include/test_audio_device.h"
+#include "rtc_base/network_constants.h"
+#include "rtc_base/ref_counted_object.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+int64_t NowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 读取本进程的常驻内存（kB）和线程数，用于浸泡测试观察是否泄漏
+void ReadProcessStatus(int64_t* rss_kb, int* threads) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            *rss_kb = std::stoll(line.substr(6));
+        } else if (line.rfind("Threads:", 0) == 0) {
+            *threads = std::stoi(line.substr(8));
+        }
+    }
+}
+
+int64_t HistogramPercentile(const std::array<uint64_t, 1001>& histogram, uint64_t total, double fraction) {
+    const uint64_t rank = static_cast<uint64_t>(fraction * (total - 1));
+    uint64_t seen = 0;
+    for (size_t ms = 0; ms < histogram.size(); ++ms) {
+        seen += histogram[ms];
+        if (seen > rank) {
+            return static_cast<int64_t>(ms);
+        }
+    }
+    return static_cast<int64_t>(histogram.size() - 1);
+}
+
+}  // namespace
+
+// 每个接收端一个观察者，把候选者与连通事件转交给发送端
+class LoopbackSender::PeerObserver : public webrtc::PeerConnectionObserver {
+public:
+    PeerObserver(LoopbackSender* sender, const std::string& room_id, const std::string& remote_id)
+        : sender_(sender), room_id_(room_id), remote_id_(remote_id) {}
+
+    void OnSignalingChange(webrtc::PeerConnectionInterface::SignalingState) override {}
+    void OnDataChannel(webrtc::scoped_refptr<webrtc::DataChannelInterface>) override {}
+    void OnIceGatheringChange(webrtc::PeerConnectionInterface::IceGatheringState) override {}
+
+    void OnIceCandidate(const webrtc::IceCandidateInterface* candidate) override {
+        sender_->OnIceCandidate(room_id_, remote_id_, candidate);
+    }
+
+    void OnIceConnectionChange(webrtc::PeerConnectionInterface::IceConnectionState new_state) override {
+        std::cout << "ICE connection state changed to: " << webrtc::PeerConnectionInterface::AsString(new_state)
+                  << " (peer " << remote_id_ << ")" << std::endl;
+        if (new_state == webrtc::PeerConnectionInterface::kIceConnectionConnected) {
+            sender_->OnIceConnected(room_id_, remote_id_);
+        }
+    }
+
+private:
+    LoopbackSender* sender_;
+    std::string room_id_;
+    std::string remote_id_;
+};
+
+/**
+ * @brief 收到发送统计后输出一行：分辨率、帧率、码率、编码器与受限原因、RTCP往返时延与丢包
+ */
+class LoopbackSender::StatsCallback : public webrtc::RTCStatsCollectorCallback {
+public:
+    StatsCallback(std::shared_ptr<Peer> peer, int64_t control_rtt_us)
+        : peer_(std::move(peer)), control_rtt_us_(control_rtt_us) {}
+
+    void OnStatsDelivered(const webrtc::scoped_refptr<const webrtc::RTCStatsReport>& report) override {
+        const int64_t now_us = NowUs();
+        std::ostringstream line;
+        line << "[INFO] Sender " << MakePeerKey(peer_->room_id, peer_->remote_id) << ":";
+        for (const auto* stats : report->GetStatsOfType<webrtc::RTCOutboundRtpStreamStats>()) {
+            if (stats->kind.value_or("") != "video") {
+                continue;
+            }
+            const uint64_t bytes = stats->bytes_sent.value_or(0);
+            const uint64_t frames = stats->frames_encoded.value_or(0);
+            const double elapsed_s = peer_->last_stats_us > 0 ? (now_us - peer_->last_stats_us) / 1e6 : 0;
+            line << " video " << stats->frame_width.value_or(0) << "x" << stats->frame_height.value_or(0) << " @ "
+                 << stats->frames_per_second.value_or(0) << " fps";
+            if (elapsed_s > 0) {
+                line << ", " << static_cast<int>((bytes - peer_->last_video_bytes) * 8 / elapsed_s / 1000) << " kbps";
+            }
+            line << " (target " << static_cast<int>(stats->target_bitrate.value_or(0) / 1000) << " kbps), "
+                 << stats->encoder_implementation.value_or("?") << " encoder";
+            if (frames > peer_->last_frames_encoded) {
+                line << " " << stats->total_encode_time.value_or(0) * 1000 / frames << " ms/frame";
+            }
+            line << ", limited by " << stats->quality_limitation_reason.value_or("none");
+            peer_->last_video_bytes = bytes;
+            peer_->last_frames_encoded = frames;
+        }
+        for (const auto* stats : report->GetStatsOfType<webrtc::RTCRemoteInboundRtpStreamStats>()) {
+            if (stats->kind.value_or("") == "video" && stats->round_trip_time.has_value()) {
+                line << "; RTCP RTT " << *stats->round_trip_time * 1000 << " ms, loss "
+                     << stats->fraction_lost.value_or(0) * 100 << "%";
+            }
+        }
+        if (control_rtt_us_ >= 0) {
+            line << "; control RTT " << control_rtt_us_ << " us";
+        }
+        peer_->last_stats_us = now_us;
+        std::cout << line.str() << std::endl;
+    }
+
+private:
+    std::shared_ptr<Peer> peer_;
+    int64_t control_rtt_us_;
+};
+
+LoopbackSender::LoopbackSender() = default;
+
+LoopbackSender::~LoopbackSender() {
+    Cleanup();
+}
+
+std::string LoopbackSender::MakePeerKey(const std::string& room_id, const std::string& remote_id) {
+    return room_id + "/" + remote_id;
+}
+
+bool LoopbackSender::Initialize(const Config& config) {
+    config_ = config;
+    start_us_ = NowUs();
+
+    network_thread_ = webrtc::Thread::CreateWithSocketServer();
+    worker_thread_ = webrtc::Thread::Create();
+    signaling_thread_ = webrtc::Thread::Create();
+    network_thread_->SetName("rtc-network", nullptr);
+    worker_thread_->SetName("rtc-worker", nullptr);
+    signaling_thread_->SetName("rtc-signaling", nullptr);
+    if (!network_thread_->Start() || !worker_thread_->Start() || !signaling_thread_->Start()) {
+        std::cerr << "Failed to start threads" << std::endl;
+        return false;
+    }
+
+    // 音频设备用WebRTC自带的测试设备：采集脉冲噪声、丢弃播放，不依赖声卡
+    webrtc::scoped_refptr<webrtc::AudioDeviceModule> adm = worker_thread_->BlockingCall([]() {
+        return webrtc::TestAudioDeviceModule::Create(
+            webrtc::CreateEnvironment(),
+            webrtc::TestAudioDeviceModule::CreatePulsedNoiseCapturer(8000, 48000, 1),
+            webrtc::TestAudioDeviceModule::CreateDiscardRenderer(48000, 1));
+    });
+
+    peer_connection_factory_ = webrtc::CreatePeerConnectionFactory(
+        network_thread_.get(), worker_thread_.get(), signaling_thread_.get(),
+        adm,
+        webrtc::CreateBuiltinAudioEncoderFactory(),
+        webrtc::CreateBuiltinAudioDecoderFactory(),
+        webrtc::CreateBuiltinVideoEncoderFactory(),
+        webrtc::CreateBuiltinVideoDecoderFactory(),
+        nullptr, nullptr);
+    if (!peer_connection_factory_) {
+        std::cerr << "Failed to create PeerConnectionFactory" << std::endl;
+        return false;
+    }
+
+    // 与接收端在同一台机器上，允许使用回环网卡
+    webrtc::PeerConnectionFactoryInterface::Options options;
+    options.network_ignore_mask &= ~webrtc::ADAPTER_TYPE_LOOPBACK;
+    peer_connection_factory_->SetOptions(options);
+
+    webrtc::RtpCapabilities capabilities = peer_connection_factory_->GetRtpSenderCapabilities(webrtc::MediaType::VIDEO);
+    bool has_h264 = std::any_of(capabilities.codecs.begin(), capabilities.codecs.end(),
+                                [](const webrtc::RtpCodecCapability& codec) { return codec.name == "H264"; });
+    if (!has_h264) {
+        std::cerr << "WebRTC video encoder factory has no H.264 encoder (build WebRTC with rtc_use_h264=true)"
+                  << std::endl;
+        return false;
+    }
+
+    video_source_ = webrtc::make_ref_counted<SyntheticVideoSource>(config_.width, config_.height, config_.fps);
+    video_track_ = peer_connection_factory_->CreateVideoTrack(video_source_, "synthetic_video");
+    if (config_.audio) {
+        auto audio_source = peer_connection_factory_->CreateAudioSource(webrtc::AudioOptions());
+        audio_track_ = peer_connection_factory_->CreateAudioTrack("synthetic_audio", audio_source.get());
+    }
+    video_source_->Start();
+
+    initialized_ = true;
+    std::cout << "LoopbackSender initialized: " << config_.width << "x" << config_.height << " @ " << config_.fps
+              << " fps, max " << config_.max_bitrate_kbps << " kbps" << (config_.audio ? ", audio" : "")
+              << ", ICE profile " << config_.ice.ProfileName() << std::endl;
+    return true;
+}
+
+void LoopbackSender::Connect(const std::string& url, const std::string& room_id, const std::string& client_id) {
+    if (!initialized_) {
+        return;
+    }
+    client_id_ = client_id;
+    signaling_client_ = std::make_unique<WebSocketSignalingClient>();
+    signaling_client_->SetStateCallback([](bool connected, const std::string& message) {
+        std::cout << "[Signaling] " << (connected ? "connected" : "disconnected") << ": " << message << std::endl;
+    });
+    signaling_client_->SetMessageCallback([this](SignalingClient::MessageType type, const Json::Value& message) {
+        HandleSignalingMessage(type, message);
+    });
+    signaling_client_->Connect(url);
+    signaling_client_->Register(room_id, client_id);
+}
+
+void LoopbackSender::HandleSignalingMessage(SignalingClient::MessageType type, const Json::Value& root) {
+    const std::string room_id = root.isMember("roomId") ? root["roomId"].asString() : signaling_client_->GetRoomId();
+    const std::string from = root["from"].asString();
+
+    switch (type) {
+        case SignalingClient::MessageType::REGISTER: {
+            // 房间里已有的客户端和之后加入的客户端都是接收端候选，由发送端主动发起
+            const std::string type_str = root["type"].asString();
+            if (type_str != "client_exists" && type_str != "client_joined") {
+                break;
+            }
+            const std::string remote_id = root["clientId"].asString();
+            if (remote_id.empty() || remote_id == signaling_client_->GetClientId() ||
+                (!config_.target_id.empty() && remote_id != config_.target_id)) {
+                break;
+            }
+            // 接收端重启后以同一ID重新加入：丢弃旧连接
+            ClosePeer(room_id, remote_id, "peer rejoined");
+            StartPeer(room_id, remote_id);
+            break;
+        }
+        case SignalingClient::MessageType::ANSWER:
+            if (auto peer = FindPeer(room_id, from)) {
+                OnAnswer(peer, root["sdp"].asString());
+            }
+            break;
+        case SignalingClient::MessageType::OFFER:
+            if (auto peer = FindPeer(room_id, from)) {
+                OnOffer(peer, root["sdp"].asString());
+            }
+            break;
+        case SignalingClient::MessageType::CANDIDATE:
+            if (auto peer = FindPeer(room_id, from)) {
+                OnCandidate(peer, root);
+            }
+            break;
+        case SignalingClient::MessageType::LEAVE: {
+            const std::string remote_id = root.isMember("clientId") ? root["clientId"].asString() : from;
+            ClosePeer(room_id, remote_id, "peer left");
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+bool LoopbackSender::PreferH264(webrtc::RtpTransceiverInterface* transceiver) const {
+    webrtc::RtpCapabilities capabilities = peer_connection_factory_->GetRtpSenderCapabilities(webrtc::MediaType::VIDEO);
+    std::vector<webrtc::RtpCodecCapability> preferred;
+    std::vector<webrtc::RtpCodecCapability> auxiliary;
+    for (const auto& codec : capabilities.codecs) {
+        if (codec.name == "H264") {
+            preferred.push_back(codec);
+        } else if (codec.name == "rtx" || codec.name == "red" || codec.name == "ulpfec") {
+            auxiliary.push_back(codec);
+        }
+    }
+    // packetization-mode=1（FU-A分片）优先，大帧不必拆成多个单NAL包
+    std::stable_partition(preferred.begin(), preferred.end(), [](const webrtc::RtpCodecCapability& codec) {
+        auto it = codec.parameters.find("packetization-mode");
+        return it != codec.parameters.end() && it->second == "1";
+    });
+    preferred.insert(preferred.end(), auxiliary.begin(), auxiliary.end());
+    webrtc::RTCError error = transceiver->SetCodecPreferences(preferred);
+    if (!error.ok()) {
+        std::cerr << "Failed to prefer H.264: " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void LoopbackSender::StartPeer(const std::string& room_id, const std::string& remote_id) {
+    const std::string key = MakePeerKey(room_id, remote_id);
+    auto peer = std::make_shared<Peer>();
+    peer->room_id = room_id;
+    peer->remote_id = remote_id;
+    peer->created_us = NowUs();
+    peer->observer = std::make_unique<PeerObserver>(this, room_id, remote_id);
+
+    webrtc::PeerConnectionInterface::RTCConfiguration rtc_config;
+    rtc_config.sdp_semantics = webrtc::SdpSemantics::kUnifiedPlan;
+    config_.ice.Apply(&rtc_config);
+    auto result = peer_connection_factory_->CreatePeerConnectionOrError(
+        rtc_config, webrtc::PeerConnectionDependencies(peer->observer.get()));
+    if (!result.ok()) {
+        std::cerr << "Failed to create PeerConnection for " << key << ": " << result.error().message() << std::endl;
+        return;
+    }
+    peer->peer_connection = result.MoveValue();
+    webrtc::PeerConnectionInterface* pc = peer->peer_connection.get();
+
+    // 控制通道由发送端创建，接收端在OnDataChannel中按标签接管
+    peer->control_channel = std::make_unique<ControlChannel>();
+    peer->control_channel->SetHandler(ControlChannel::kTypeFrameLatency,
+                                      [this](const ControlChannel::Message& message) { OnFrameLatency(message); });
+    if (!peer->control_channel->Create(pc)) {
+        std::cerr << "[WARN] " << key << ": no control channel, end-to-end latency will not be measured" << std::endl;
+    }
+
+    auto video_sender = pc->AddTrack(video_track_, {"synthetic"});
+    if (!video_sender.ok()) {
+        std::cerr << "Failed to add video track for " << key << ": " << video_sender.error().message() << std::endl;
+        pc->Close();
+        return;
+    }
+    webrtc::scoped_refptr<webrtc::RtpSenderInterface> sender = video_sender.MoveValue();
+    ControlChannel* control_channel = peer->control_channel.get();
+    peer->transformer = webrtc::make_ref_counted<FrameTimingTransformer>(
+        [control_channel](uint32_t rtp_timestamp, int64_t sent_us) {
+            uint8_t payload[12];
+            for (int i = 0; i < 4; ++i) {
+                payload[i] = static_cast<uint8_t>(rtp_timestamp >> (24 - 8 * i));
+            }
+            for (int i = 0; i < 8; ++i) {
+                payload[4 + i] = static_cast<uint8_t>(static_cast<uint64_t>(sent_us) >> (56 - 8 * i));
+            }
+            control_channel->Send(ControlChannel::kTypeFrameTiming, payload, sizeof(payload),
+                                  ControlChannel::Mode::kUnreliable);
+        });
+    sender->SetEncoderToPacketizerFrameTransformer(peer->transformer);
+    webrtc::RtpParameters parameters = sender->GetParameters();
+    if (!parameters.encodings.empty()) {
+        parameters.encodings[0].max_bitrate_bps = config_.max_bitrate_kbps * 1000;
+        parameters.encodings[0].max_framerate = config_.fps;
+        sender->SetParameters(parameters);
+    }
+    for (const auto& transceiver : pc->GetTransceivers()) {
+        if (transceiver->sender() == sender) {
+            PreferH264(transceiver.get());
+        }
+    }
+    if (audio_track_) {
+        auto audio_sender = pc->AddTrack(audio_track_, {"synthetic"});
+        if (!audio_sender.ok()) {
+            std::cerr << "[WARN] Failed to add audio track for " << key << ": " << audio_sender.error().message()
+                      << std::endl;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(peers_mutex_);
+        peers_[key] = peer;
+    }
+    peers_started_++;
+    std::cout << "[INFO] Sending to " << key << std::endl;
+
+    webrtc::PeerConnectionInterface::RTCOfferAnswerOptions options;
+    pc->CreateOffer(
+        CreateSessionDescriptionObserver::Create(
+            [this, peer](webrtc::SessionDescriptionInterface* desc) {
+                peer->peer_connection->SetLocalDescription(
+                    SetSessionDescriptionObserver::Create(
+                        [this, peer, desc]() {
+                            std::string sdp;
+                            desc->ToString(&sdp);
+                            signaling_client_->SendOffer(sdp, peer->remote_id, peer->room_id);
+                        },
+                        [](webrtc::RTCError error) { std::cerr << "SetLocalDescription failed: " << error.message() << std::endl; }
+                    ).get(),
+                    desc);
+            },
+            [](webrtc::RTCError error) { std::cerr << "CreateOffer failed: " << error.message() << std::endl; }
+        ).get(),
+        options);
+}
+
+std::shared_ptr<LoopbackSender::Peer> LoopbackSender::FindPeer(const std::string& room_id,
+                                                               const std::string& remote_id) const {
+    std::lock_guard<std::mutex> lock(peers_mutex_);
+    auto it = peers_.find(MakePeerKey(room_id, remote_id));
+    return it != peers_.end() ? it->second : nullptr;
+}
+
+void LoopbackSender::ClosePeer(const std::string& room_id, const std::string& remote_id, const std::string& reason) {
+    std::shared_ptr<Peer> peer;
+    {
+        std::lock_guard<std::mutex> lock(peers_mutex_);
+        auto it = peers_.find(MakePeerKey(room_id, remote_id));
+        if (it == peers_.end()) {
+            return;
+        }
+        peer = std::move(it->second);
+        peers_.erase(it);
+    }
+    // 先让变换器停止使用控制通道，再关闭通道和连接
+    if (peer->transformer) {
+        peer->transformer->Detach();
+    }
+    peer->control_channel->Close();
+    peer->peer_connection->Close();
+    std::cout << "[INFO] Stopped sending to " << MakePeerKey(room_id, remote_id) << " (" << reason << ") after "
+              << (NowUs() - peer->created_us) / 1000000 << " s" << std::endl;
+}
+
+void LoopbackSender::OnAnswer(const std::shared_ptr<Peer>& peer, const std::string& sdp) {
+    webrtc::SdpParseError error;
+    std::unique_ptr<webrtc::SessionDescriptionInterface> desc =
+        webrtc::CreateSessionDescription(webrtc::SdpType::kAnswer, sdp, &error);
+    if (!desc) {
+        std::cerr << "Failed to parse answer SDP: " << error.description << std::endl;
+        return;
+    }
+    peer->peer_connection->SetRemoteDescription(
+        SetSessionDescriptionObserver::Create(
+            []() {},
+            [](webrtc::RTCError error) { std::cerr << "SetRemoteDescription failed: " << error.message() << std::endl; }
+        ).get(),
+        desc.release());
+}
+
+void LoopbackSender::OnOffer(const std::shared_ptr<Peer>& peer, const std::string& sdp) {
+    // 双方同时发起时以本端的Offer为准，接收端收到后会回滚自己的Offer
+    if (peer->peer_connection->signaling_state() == webrtc::PeerConnectionInterface::kHaveLocalOffer) {
+        std::cout << "[INFO] Ignoring offer from " << peer->remote_id << " while our offer is pending" << std::endl;
+        return;
+    }
+    webrtc::SdpParseError error;
+    std::unique_ptr<webrtc::SessionDescriptionInterface> desc =
+        webrtc::CreateSessionDescription(webrtc::SdpType::kOffer, sdp, &error);
+    if (!desc) {
+        std::cerr << "Failed to parse offer SDP: " << error.description << std::endl;
+        return;
+    }
+    peer->peer_connection->SetRemoteDescription(
+        SetSessionDescriptionObserver::Create(
+            [this, peer]() {
+                webrtc::PeerConnectionInterface::RTCOfferAnswerOptions options;
+                peer->peer_connection->CreateAnswer(
+                    CreateSessionDescriptionObserver::Create(
+                        [this, peer](webrtc::SessionDescriptionInterface* desc) {
+                            peer->peer_connection->SetLocalDescription(
+                                SetSessionDescriptionObserver::Create(
+                                    [this, peer, desc]() {
+                                        std::string answer;
+                                        desc->ToString(&answer);
+                                        signaling_client_->SendAnswer(answer, peer->remote_id, peer->room_id);
+                                    },
+                                    [](webrtc::RTCError error) { std::cerr << "SetLocalDescription failed: " << error.message() << std::endl; }
+                                ).get(),
+                                desc);
+                        },
+                        [](webrtc::RTCError error) { std::cerr << "CreateAnswer failed: " << error.message() << std::endl; }
+                    ).get(),
+                    options);
+            },
+            [](webrtc::RTCError error) { std::cerr << "SetRemoteDescription failed: " << error.message() << std::endl; }
+        ).get(),
+        desc.release());
+}
+
+void LoopbackSender::OnCandidate(const std::shared_ptr<Peer>& peer, const Json::Value& message_json) {
+    if (message_json.isMember("candidates") && message_json["candidates"].isArray()) {
+        for (const auto& candidate_json : message_json["candidates"]) {
+            OnCandidate(peer, candidate_json);
+        }
+        return;
+    }
+    webrtc::SdpParseError error;
+    std::unique_ptr<webrtc::IceCandidateInterface> candidate(webrtc::CreateIceCandidate(
+        message_json["sdpMid"].asString(), message_json["sdpMLineIndex"].asInt(),
+        message_json["candidate"].asString(), &error));
+    if (!candidate) {
+        std::cerr << "Failed to parse ICE candidate: " << error.description << std::endl;
+        return;
+    }
+    if (!peer->peer_connection->AddIceCandidate(candidate.get())) {
+        std::cerr << "Failed to add ICE candidate" << std::endl;
+    }
+}
+
+void LoopbackSender::OnIceCandidate(const std::string& room_id, const std::string& remote_id,
+                                    const webrtc::IceCandidateInterface* candidate) {
+    std::string sdp;
+    if (!signaling_client_ || !candidate->ToString(&sdp)) {
+        return;
+    }
+    signaling_client_->SendCandidate(candidate->sdp_mid(), candidate->sdp_mline_index(), sdp, remote_id, room_id);
+}
+
+void LoopbackSender::OnIceConnected(const std::string& room_id, const std::string& remote_id) {
+    auto peer = FindPeer(room_id, remote_id);
+    if (!peer || peer->connected_us >= 0) {
+        return;
+    }
+    peer->connected_us = NowUs();
+    peers_connected_++;
+    std::cout << "[Timing] " << MakePeerKey(room_id, remote_id) << " connected "
+              << (peer->connected_us - peer->created_us) / 1000 << " ms after the offer was created" << std::endl;
+}
+
+void LoopbackSender::OnFrameLatency(const ControlChannel::Message& message) {
+    if (message.size < 12) {
+        return;
+    }
+    uint64_t value = 0;
+    for (int i = 4; i < 12; ++i) {
+        value = (value << 8) | message.data[i];
+    }
+    const int64_t latency_us = static_cast<int64_t>(value);
+    std::lock_guard<std::mutex> lock(latency_mutex_);
+    interval_latency_us_.push_back(latency_us);
+    const int64_t ms = std::max<int64_t>(0, latency_us / 1000);
+    latency_histogram_[std::min<int64_t>(ms, latency_histogram_.size() - 1)]++;
+    latency_samples_++;
+    latency_max_us_ = std::max(latency_max_us_, latency_us);
+}
+
+void LoopbackSender::LogReport() {
+    std::vector<std::shared_ptr<Peer>> peers;
+    {
+        std::lock_guard<std::mutex> lock(peers_mutex_);
+        for (const auto& entry : peers_) {
+            peers.push_back(entry.second);
+        }
+    }
+    for (const auto& peer : peers) {
+        const int64_t control_rtt_us = peer->control_channel->GetStats().last_rtt_us;
+        peer->control_channel->SendPing(ControlChannel::Mode::kUnreliable);
+        peer->peer_connection->GetStats(webrtc::make_ref_counted<StatsCallback>(peer, control_rtt_us).get());
+    }
+
+    std::vector<int64_t> samples;
+    {
+        std::lock_guard<std::mutex> lock(latency_mutex_);
+        samples.swap(interval_latency_us_);
+    }
+    std::ostringstream line;
+    line << "[INFO] Loopback: " << peers.size() << " peers, " << video_source_->GetFrameCount() << " frames generated ("
+         << video_source_->GetLateFrameCount() << " late)";
+    if (!samples.empty()) {
+        std::sort(samples.begin(), samples.end());
+        line << ", e2e latency " << samples.size() << " frames: p50 " << samples[samples.size() / 2] / 1000.0
+             << " ms, p99 " << samples[(samples.size() - 1) * 99 / 100] / 1000.0 << " ms, max "
+             << samples.back() / 1000.0 << " ms";
+    }
+    int64_t rss_kb = 0;
+    int threads = 0;
+    ReadProcessStatus(&rss_kb, &threads);
+    line << "; RSS " << rss_kb << " kB, threads " << threads;
+    std::cout << line.str() << std::endl;
+}
+
+bool LoopbackSender::LogSummary() {
+    std::lock_guard<std::mutex> lock(latency_mutex_);
+    std::cout << "[INFO] Loopback summary: " << (NowUs() - start_us_) / 1000000 << " s, " << peers_connected_ << "/"
+              << peers_started_ << " peers connected, " << (video_source_ ? video_source_->GetFrameCount() : 0)
+              << " frames generated";
+    if (latency_samples_ > 0) {
+        std::cout << ", e2e latency " << latency_samples_ << " frames: p50 "
+                  << HistogramPercentile(latency_histogram_, latency_samples_, 0.5) << " ms, p90 "
+                  << HistogramPercentile(latency_histogram_, latency_samples_, 0.9) << " ms, p99 "
+                  << HistogramPercentile(latency_histogram_, latency_samples_, 0.99) << " ms, max "
+                  << latency_max_us_ / 1000.0 << " ms";
+    } else {
+        std::cout << ", no end-to-end latency samples";
+    }
+    std::cout << std::endl;
+    return latency_samples_ > 0;
+}
+
+void LoopbackSender::Cleanup() {
+    if (!initialized_) {
+        return;
+    }
+    initialized_ = false;
+    if (signaling_client_) {
+        signaling_client_->SendLeave();
+        signaling_client_->Close();
+    }
+    std::vector<std::shared_ptr<Peer>> peers;
+    {
+        std::lock_guard<std::mutex> lock(peers_mutex_);
+        for (const auto& entry : peers_) {
+            peers.push_back(entry.second);
+        }
+    }
+    for (const auto& peer : peers) {
+        ClosePeer(peer->room_id, peer->remote_id, "shutdown");
+    }
+    signaling_client_.reset();
+    if (video_source_) {
+        video_source_->Stop();
+    }
+    video_track_ = nullptr;
+    audio_track_ = nullptr;
+    video_source_ = nullptr;
+    peer_connection_factory_ = nullptr;
+    network_thread_->Stop();
+    worker_thread_->Stop();
+    signaling_thread_->Stop();
+}
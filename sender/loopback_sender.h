@@ -0,0 +1,143 @@
+#pragma once
+#include "api/peer_connection_interface.h"
+#include "api/scoped_refptr.h"
+#include "rtc_base/thread.h"
+#include "../signaling/signaling_client.h"
+#include "../webrtc/control_channel.h"
+#include "../webrtc/frame_timing_transformer.h"
+#include "../webrtc/ice_config.h"
+#include "synthetic_video_source.h"
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <json/json.h>
+
+/**
+ * @brief 端到端测试用的发送端
+ *
+ * 与rk3566_receiver使用同一套信令协议：加入房间后向房间里的其他客户端（或指定的接收端）
+ * 发起Offer，发送合成的H.264视频和脉冲噪声音频，不需要浏览器、摄像头或声卡。
+ * 同时建立与接收端相同的控制通道，每个编码帧都通过不可靠通道告知发出时间，
+ * 接收端收齐该帧后回报单向延迟；两端在同一台机器上时使用同一个单调时钟，无需对时。
+ * 定期输出发送码率、编码帧率、RTCP往返时延、控制通道RTT和端到端延迟分布，
+ * 以及本进程的内存与线程数，用于无人值守的延迟、吞吐与长时间浸泡测试。
+ */
+class LoopbackSender {
+public:
+    struct Config {
+        int width = 1280;
+        int height = 720;
+        int fps = 30;
+        int max_bitrate_kbps = 4000;   // 视频编码码率上限
+        bool audio = true;             // 是否发送音频
+        std::string target_id;         // 只向该客户端发起，为空时向房间里的所有其他客户端发起
+        IceConfig ice;
+    };
+
+    LoopbackSender();
+    ~LoopbackSender();
+
+    /**
+     * @brief 创建线程、PeerConnection工厂和合成音视频源
+     * @param config 配置
+     * @return 是否成功（WebRTC编码器不支持H.264时失败）
+     */
+    bool Initialize(const Config& config);
+
+    /**
+     * @brief 连接信令服务器并加入房间
+     */
+    void Connect(const std::string& url, const std::string& room_id, const std::string& client_id);
+
+    /**
+     * @brief 输出一次周期报告（统计在信令线程异步返回）
+     */
+    void LogReport();
+
+    /**
+     * @brief 输出整个运行期间的汇总
+     * @return 至少测得一个端到端延迟样本时返回true，便于脚本判断测试是否成功
+     */
+    bool LogSummary();
+
+    /**
+     * @brief 离开房间并释放所有资源
+     */
+    void Cleanup();
+
+private:
+    struct Peer {
+        std::string room_id;
+        std::string remote_id;
+        std::unique_ptr<webrtc::PeerConnectionObserver> observer;
+        webrtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection;
+        std::unique_ptr<ControlChannel> control_channel;
+        webrtc::scoped_refptr<FrameTimingTransformer> transformer;
+        int64_t created_us = 0;
+        int64_t connected_us = -1;
+        // 上一次统计（只在信令线程访问）
+        uint64_t last_video_bytes = 0;
+        uint64_t last_frames_encoded = 0;
+        int64_t last_stats_us = 0;
+    };
+
+    class PeerObserver;
+    class StatsCallback;
+
+    static std::string MakePeerKey(const std::string& room_id, const std::string& remote_id);
+
+    void HandleSignalingMessage(SignalingClient::MessageType type, const Json::Value& root);
+
+    // 为新的接收端创建PeerConnection、添加轨道和控制通道并发起Offer
+    void StartPeer(const std::string& room_id, const std::string& remote_id);
+    void ClosePeer(const std::string& room_id, const std::string& remote_id, const std::string& reason);
+    std::shared_ptr<Peer> FindPeer(const std::string& room_id, const std::string& remote_id) const;
+
+    void OnAnswer(const std::shared_ptr<Peer>& peer, const std::string& sdp);
+    // 接收端发起的重新协商（如按解码余量限制码率）
+    void OnOffer(const std::shared_ptr<Peer>& peer, const std::string& sdp);
+    void OnCandidate(const std::shared_ptr<Peer>& peer, const Json::Value& message_json);
+
+    // 由观察者回调
+    void OnIceCandidate(const std::string& room_id, const std::string& remote_id,
+                        const webrtc::IceCandidateInterface* candidate);
+    void OnIceConnected(const std::string& room_id, const std::string& remote_id);
+
+    // 由接收端回报的单向延迟（在网络线程调用）
+    void OnFrameLatency(const ControlChannel::Message& message);
+
+    // 视频编码优先使用H.264（接收端的VDEC按H.264配置）
+    bool PreferH264(webrtc::RtpTransceiverInterface* transceiver) const;
+
+    Config config_;
+
+    std::unique_ptr<webrtc::Thread> network_thread_;
+    std::unique_ptr<webrtc::Thread> worker_thread_;
+    std::unique_ptr<webrtc::Thread> signaling_thread_;
+    webrtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> peer_connection_factory_;
+    webrtc::scoped_refptr<SyntheticVideoSource> video_source_;
+    webrtc::scoped_refptr<webrtc::VideoTrackInterface> video_track_;
+    webrtc::scoped_refptr<webrtc::AudioTrackInterface> audio_track_;
+
+    std::unique_ptr<SignalingClient> signaling_client_;
+    std::string client_id_;
+
+    std::map<std::string, std::shared_ptr<Peer>> peers_;
+    mutable std::mutex peers_mutex_;
+
+    // 端到端延迟：本周期的样本与整个运行期间的直方图（1毫秒一格，最后一格为1秒及以上）
+    std::vector<int64_t> interval_latency_us_;
+    std::array<uint64_t, 1001> latency_histogram_{};
+    uint64_t latency_samples_ = 0;
+    int64_t latency_max_us_ = 0;
+    std::mutex latency_mutex_;
+
+    int64_t start_us_ = 0;
+    std::atomic<uint64_t> peers_started_{0};
+    std::atomic<uint64_t> peers_connected_{0};
+    bool initialized_ = false;
+};
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <string>
+#include <csignal>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <vector>
+
+#include "loopback_sender.h"
+#include "common/command_line.h"
+
+// 全局运行状态标志
+std::atomic<bool> g_running(true);
+
+void SignalHandler(int signal) {
+    if (signal == SIGINT || signal == SIGTERM) {
+        std::cout << "\nCaught signal " << signal << ", shutting down gracefully..." << std::endl;
+        g_running = false;
+    }
+}
+
+static void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " <signaling_url> <room_id> [client_id]" << std::endl;
+    std::cerr << "Options: --width=<px> --height=<px>  synthetic video size (default 1280x720)" << std::endl;
+    std::cerr << "         --fps=<n>            frame rate (default 30)" << std::endl;
+    std::cerr << "         --bitrate=<kbps>     maximum video bitrate (default 4000)" << std::endl;
+    std::cerr << "         --no-audio           send video only" << std::endl;
+    std::cerr << "         --target=<client_id> only send to this receiver (default: every other client in the room)" << std::endl;
+    std::cerr << "         --ice-profile=default|lan  (default lan)" << std::endl;
+    std::cerr << "         --duration=<s>       stop after s seconds (default 0, run until SIGINT)" << std::endl;
+    std::cerr << "         --report=<s>         log bitrate, RTT and end-to-end latency every s seconds (default 5)" << std::endl;
+    std::cerr << "Example: " << program << " ws://127.0.0.1:8080 101 loopback_sender --target=rk3566_receiver" << std::endl;
+    std::cerr << "         (run the receiver with --ice-profile=lan --ice-interfaces=lo for a pure loopback path)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    CommandLine cmd = ParseCommandLine(argc, argv);
+    std::string arg_error;
+    if (!cmd.CheckNumbers({"width", "height", "fps", "bitrate", "duration", "report"}, {}, &arg_error)) {
+        std::cerr << "Invalid argument: " << arg_error << std::endl;
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    if (cmd.positional.size() < 2 || cmd.Has("help")) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    const std::string signaling_url = cmd.positional[0];
+    const std::string room_id = cmd.positional[1];
+    const std::string client_id = cmd.positional.size() > 2 ? cmd.positional[2] : "loopback_sender";
+
+    signal(SIGINT, SignalHandler);
+    signal(SIGTERM, SignalHandler);
+
+    LoopbackSender::Config config;
+    config.width = cmd.GetInt("width", 1280);
+    config.height = cmd.GetInt("height", 720);
+    config.fps = cmd.GetInt("fps", 30);
+    config.max_bitrate_kbps = cmd.GetInt("bitrate", 4000);
+    if (config.width <= 0 || config.height <= 0 || config.fps <= 0 || config.max_bitrate_kbps <= 0) {
+        std::cerr << "Invalid argument: --width, --height, --fps and --bitrate must be positive" << std::endl;
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    config.audio = !cmd.Has("no-audio");
+    config.target_id = cmd.Get("target");
+    if (!IceConfig::FromProfileName(cmd.Get("ice-profile", "lan"), &config.ice)) {
+        std::cerr << "Unknown ICE profile: " << cmd.Get("ice-profile") << std::endl;
+        return 1;
+    }
+    const int duration_s = cmd.GetInt("duration", 0);
+    const int report_s = std::max(1, cmd.GetInt("report", 5));
+
+    LoopbackSender sender;
+    if (!sender.Initialize(config)) {
+        std::cerr << "Failed to initialize loopback sender" << std::endl;
+        return 1;
+    }
+    sender.Connect(signaling_url, room_id, client_id);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto next_report = start + std::chrono::seconds(report_s);
+    while (g_running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= next_report) {
+            sender.LogReport();
+            next_report += std::chrono::seconds(report_s);
+        }
+        if (duration_s > 0 && now - start >= std::chrono::seconds(duration_s)) {
+            std::cout << "Duration of " << duration_s << " s reached" << std::endl;
+            break;
+        }
+    }
+
+    // 退出码：测到端到端延迟为0，否则为2（连接或控制通道未建立）
+    const bool ok = sender.LogSummary();
+    sender.Cleanup();
+    return ok ? 0 : 2;
+}
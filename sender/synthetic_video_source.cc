@@ -0,0 +1,98 @@
+#include "synthetic_video_source.h"
+#include "../common/thread_profile.h"
+#include "api/video/i420_buffer.h"
+#include "api/video/video_frame.h"
+#include "rtc_base/time_utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+SyntheticVideoSource::SyntheticVideoSource(int width, int height, int fps)
+    : width_(width), height_(height), fps_(std::max(1, fps)), buffer_pool_(false, 4) {}
+
+SyntheticVideoSource::~SyntheticVideoSource() {
+    Stop();
+}
+
+void SyntheticVideoSource::Start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    thread_ = std::thread(&SyntheticVideoSource::Run, this);
+}
+
+void SyntheticVideoSource::Stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void SyntheticVideoSource::Run() {
+    ThreadProfile::Instance().RegisterCurrentThread(ThreadProfile::Role::kOther, "synthetic-video");
+    const auto interval = std::chrono::microseconds(1000000 / fps_);
+    auto next = std::chrono::steady_clock::now();
+    uint64_t index = 0;
+    while (running_) {
+        webrtc::scoped_refptr<webrtc::I420Buffer> buffer = buffer_pool_.CreateI420Buffer(width_, height_);
+        if (buffer) {
+            Render(buffer.get(), index);
+            // 时间戳使用单调时钟，与接收端在同一台机器上可直接比较
+            OnFrame(webrtc::VideoFrame::Builder()
+                        .set_video_frame_buffer(buffer)
+                        .set_timestamp_us(webrtc::TimeMicros())
+                        .set_rotation(webrtc::kVideoRotation_0)
+                        .build());
+            frames_++;
+        }
+        index++;
+
+        // 按计划时刻出帧，不累积误差；落后超过一帧时直接追上，不连发补帧
+        next += interval;
+        auto now = std::chrono::steady_clock::now();
+        if (now > next) {
+            late_frames_++;
+            if (now - next > interval) {
+                next = now;
+            }
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void SyntheticVideoSource::Render(webrtc::I420Buffer* buffer, uint64_t index) const {
+    const int width = buffer->width();
+    const int height = buffer->height();
+
+    // 亮度：随帧号水平移动的渐变
+    uint8_t* y = buffer->MutableDataY();
+    const int stride_y = buffer->StrideY();
+    const int shift = static_cast<int>(index * 4 % 256);
+    for (int row = 0; row < height; ++row) {
+        uint8_t* line = y + row * stride_y;
+        for (int col = 0; col < width; ++col) {
+            line[col] = static_cast<uint8_t>((col + row / 4 + shift) & 0xFF);
+        }
+    }
+
+    // 来回移动的白色方块
+    const int box = std::max(16, height / 8);
+    const int travel = std::max(1, width - box);
+    const int period = travel * 2;
+    const int pos = static_cast<int>(index * 8 % period);
+    const int box_x = pos < travel ? pos : period - pos;
+    const int box_y = (height - box) / 2;
+    for (int row = box_y; row < box_y + box && row < height; ++row) {
+        memset(y + row * stride_y + box_x, 235, std::min(box, width - box_x));
+    }
+
+    // 色度：每秒缓慢变化的纯色
+    const uint8_t u = static_cast<uint8_t>(64 + (index / fps_) * 16 % 128);
+    const uint8_t v = static_cast<uint8_t>(192 - (index / fps_) * 16 % 128);
+    const int chroma_height = buffer->ChromaHeight();
+    const int chroma_width = buffer->ChromaWidth();
+    for (int row = 0; row < chroma_height; ++row) {
+        memset(buffer->MutableDataU() + row * buffer->StrideU(), u, chroma_width);
+        memset(buffer->MutableDataV() + row * buffer->StrideV(), v, chroma_width);
+    }
+}
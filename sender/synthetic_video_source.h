@@ -0,0 +1,64 @@
+#pragma once
+#include "media/base/adapted_video_track_source.h"
+#include "common_video/include/video_frame_buffer_pool.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+/**
+ * @brief 合成视频源：按固定帧率生成I420测试图像
+ *
+ * 图像是随帧号移动的亮度渐变加一个来回移动的方块，每帧都有运动，
+ * 编码器的码率和耗时接近真实画面而不是静止图像。帧缓冲取自缓冲池，
+ * 稳定运行时不再分配内存，长时间浸泡测试中发送端自身的内存不会增长。
+ */
+class SyntheticVideoSource : public webrtc::AdaptedVideoTrackSource {
+public:
+    /**
+     * @brief 构造函数
+     * @param width 宽度
+     * @param height 高度
+     * @param fps 帧率
+     */
+    SyntheticVideoSource(int width, int height, int fps);
+    ~SyntheticVideoSource() override;
+
+    /**
+     * @brief 启动出帧线程
+     */
+    void Start();
+
+    /**
+     * @brief 停止出帧线程
+     */
+    void Stop();
+
+    /**
+     * @brief 已生成的帧数
+     */
+    uint64_t GetFrameCount() const { return frames_; }
+
+    /**
+     * @brief 出帧晚于计划的次数（生成或投递一帧超过了帧间隔）
+     */
+    uint64_t GetLateFrameCount() const { return late_frames_; }
+
+    // VideoTrackSourceInterface
+    SourceState state() const override { return kLive; }
+    bool remote() const override { return false; }
+    bool is_screencast() const override { return false; }
+    std::optional<bool> needs_denoising() const override { return false; }
+
+private:
+    void Run();
+    void Render(webrtc::I420Buffer* buffer, uint64_t index) const;
+
+    int width_;
+    int height_;
+    int fps_;
+    webrtc::VideoFrameBufferPool buffer_pool_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> late_frames_{0};
+};
@@ -0,0 +1,187 @@
+/**
+ * 信令消息的CBOR（RFC 8949）编解码
+ *
+ * 与C++端 signaling/cbor_codec.cc 对应，只覆盖信令消息用到的JSON数据模型：
+ * 对象、数组、字符串、数字、布尔值和null。
+ */
+
+const MAX_DEPTH = 64;
+
+function writeHead(chunks, major, value) {
+    const prefix = major << 5;
+    if (value < 24) {
+        chunks.push(Buffer.from([prefix | value]));
+    } else if (value <= 0xff) {
+        chunks.push(Buffer.from([prefix | 24, value]));
+    } else if (value <= 0xffff) {
+        const buf = Buffer.alloc(3);
+        buf[0] = prefix | 25;
+        buf.writeUInt16BE(value, 1);
+        chunks.push(buf);
+    } else if (value <= 0xffffffff) {
+        const buf = Buffer.alloc(5);
+        buf[0] = prefix | 26;
+        buf.writeUInt32BE(value, 1);
+        chunks.push(buf);
+    } else {
+        const buf = Buffer.alloc(9);
+        buf[0] = prefix | 27;
+        buf.writeBigUInt64BE(BigInt(value), 1);
+        chunks.push(buf);
+    }
+}
+
+function encodeValue(chunks, value) {
+    if (value === null || value === undefined) {
+        chunks.push(Buffer.from([0xf6]));
+    } else if (typeof value === 'boolean') {
+        chunks.push(Buffer.from([value ? 0xf5 : 0xf4]));
+    } else if (typeof value === 'number') {
+        if (Number.isSafeInteger(value)) {
+            if (value >= 0) {
+                writeHead(chunks, 0, value);
+            } else {
+                writeHead(chunks, 1, -1 - value);
+            }
+        } else {
+            const buf = Buffer.alloc(9);
+            buf[0] = 0xfb;
+            buf.writeDoubleBE(value, 1);
+            chunks.push(buf);
+        }
+    } else if (typeof value === 'string') {
+        const text = Buffer.from(value, 'utf8');
+        writeHead(chunks, 3, text.length);
+        chunks.push(text);
+    } else if (Array.isArray(value)) {
+        writeHead(chunks, 4, value.length);
+        for (const item of value) {
+            encodeValue(chunks, item);
+        }
+    } else if (typeof value === 'object') {
+        const keys = Object.keys(value).filter((key) => value[key] !== undefined);
+        writeHead(chunks, 5, keys.length);
+        for (const key of keys) {
+            encodeValue(chunks, key);
+            encodeValue(chunks, value[key]);
+        }
+    } else {
+        throw new Error(`Unsupported CBOR value type: ${typeof value}`);
+    }
+}
+
+// 把JavaScript对象编码为CBOR
+function encode(value) {
+    const chunks = [];
+    encodeValue(chunks, value);
+    return Buffer.concat(chunks);
+}
+
+// 把CBOR数据解码为JavaScript对象，数据非法时抛出异常
+function decode(buffer) {
+    let pos = 0;
+
+    function need(count) {
+        if (pos + count > buffer.length) {
+            throw new Error('Truncated CBOR data');
+        }
+    }
+
+    function readArgument(info) {
+        if (info < 24) return info;
+        switch (info) {
+            case 24: need(1); return buffer[pos++];
+            case 25: need(2); pos += 2; return buffer.readUInt16BE(pos - 2);
+            case 26: need(4); pos += 4; return buffer.readUInt32BE(pos - 4);
+            case 27: {
+                need(8);
+                pos += 8;
+                const big = buffer.readBigUInt64BE(pos - 8);
+                if (big > BigInt(Number.MAX_SAFE_INTEGER)) {
+                    throw new Error('CBOR integer out of range');
+                }
+                return Number(big);
+            }
+            default: throw new Error('Indefinite-length CBOR is not supported');
+        }
+    }
+
+    function readValue(depth) {
+        if (depth > MAX_DEPTH) {
+            throw new Error('CBOR nesting too deep');
+        }
+        need(1);
+        const initial = buffer[pos++];
+        const major = initial >> 5;
+        const info = initial & 0x1f;
+
+        if (major === 7) {
+            switch (info) {
+                case 20: return false;
+                case 21: return true;
+                case 22:
+                case 23: return null;
+                case 25: {
+                    need(2);
+                    const half = buffer.readUInt16BE(pos);
+                    pos += 2;
+                    const exponent = (half >> 10) & 0x1f;
+                    const mantissa = half & 0x3ff;
+                    let value;
+                    if (exponent === 0) value = mantissa * Math.pow(2, -24);
+                    else if (exponent !== 31) value = (mantissa + 1024) * Math.pow(2, exponent - 25);
+                    else value = mantissa === 0 ? Infinity : NaN;
+                    return (half & 0x8000) ? -value : value;
+                }
+                case 26: need(4); pos += 4; return buffer.readFloatBE(pos - 4);
+                case 27: need(8); pos += 8; return buffer.readDoubleBE(pos - 8);
+                default: throw new Error(`Unsupported CBOR simple value: ${info}`);
+            }
+        }
+
+        const arg = readArgument(info);
+        switch (major) {
+            case 0: return arg;
+            case 1: return -1 - arg;
+            case 2:
+            case 3: {
+                need(arg);
+                const text = buffer.toString('utf8', pos, pos + arg);
+                pos += arg;
+                return text;
+            }
+            case 4: {
+                const items = [];
+                for (let i = 0; i < arg; i++) {
+                    items.push(readValue(depth + 1));
+                }
+                return items;
+            }
+            case 5: {
+                const object = {};
+                for (let i = 0; i < arg; i++) {
+                    const key = readValue(depth + 1);
+                    if (typeof key !== 'string') {
+                        throw new Error('CBOR map keys must be strings');
+                    }
+                    // 普通对象上赋值"__proto__"会替换其原型（原型污染），直接拒绝
+                    if (key === '__proto__') {
+                        throw new Error('CBOR map key "__proto__" is not allowed');
+                    }
+                    object[key] = readValue(depth + 1);
+                }
+                return object;
+            }
+            default:
+                throw new Error(`Unsupported CBOR major type: ${major}`);
+        }
+    }
+
+    const value = readValue(0);
+    if (pos !== buffer.length) {
+        throw new Error('Trailing bytes after CBOR value');
+    }
+    return value;
+}
+
+module.exports = { encode, decode };
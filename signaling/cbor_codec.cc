@@ -0,0 +1,281 @@
+#include "cbor_codec.h"
+#include <cmath>
+#include <cstring>
+
+namespace cbor {
+
+namespace {
+
+// CBOR主类型
+enum MajorType : uint8_t {
+    kUnsigned = 0,
+    kNegative = 1,
+    kByteString = 2,
+    kTextString = 3,
+    kArray = 4,
+    kMap = 5,
+    kSimple = 7,
+};
+
+const int kMaxDepth = 64;  // 防止恶意数据导致栈溢出
+
+void WriteHead(MajorType major, uint64_t value, std::string* out) {
+    uint8_t prefix = static_cast<uint8_t>(major << 5);
+    if (value < 24) {
+        out->push_back(static_cast<char>(prefix | value));
+        return;
+    }
+    int bytes;
+    if (value <= 0xff) {
+        out->push_back(static_cast<char>(prefix | 24));
+        bytes = 1;
+    } else if (value <= 0xffff) {
+        out->push_back(static_cast<char>(prefix | 25));
+        bytes = 2;
+    } else if (value <= 0xffffffffULL) {
+        out->push_back(static_cast<char>(prefix | 26));
+        bytes = 4;
+    } else {
+        out->push_back(static_cast<char>(prefix | 27));
+        bytes = 8;
+    }
+    for (int i = bytes - 1; i >= 0; --i) {
+        out->push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+    }
+}
+
+void WriteDouble(double value, std::string* out) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    out->push_back(static_cast<char>(0xfb));
+    for (int i = 7; i >= 0; --i) {
+        out->push_back(static_cast<char>((bits >> (i * 8)) & 0xff));
+    }
+}
+
+void WriteText(const char* begin, const char* end, std::string* out) {
+    WriteHead(kTextString, static_cast<uint64_t>(end - begin), out);
+    out->append(begin, end);
+}
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t len) : pos_(data), end_(data + len) {}
+
+    bool AtEnd() const { return pos_ == end_; }
+
+    bool ReadValue(Json::Value* out, int depth) {
+        if (depth > kMaxDepth || pos_ >= end_) {
+            return false;
+        }
+        uint8_t initial = *pos_++;
+        uint8_t major = initial >> 5;
+        uint8_t info = initial & 0x1f;
+
+        if (major == kSimple) {
+            return ReadSimple(info, out);
+        }
+
+        uint64_t arg;
+        if (!ReadArgument(info, &arg)) {
+            return false;
+        }
+
+        switch (major) {
+            case kUnsigned:
+                // 与jsoncpp解析文本时的行为一致：能放进有符号整数的都用intValue表示
+                if (arg <= static_cast<uint64_t>(INT64_MAX)) {
+                    *out = Json::Value(static_cast<Json::Int64>(arg));
+                } else {
+                    *out = Json::Value(static_cast<Json::UInt64>(arg));
+                }
+                return true;
+            case kNegative:
+                if (arg > static_cast<uint64_t>(INT64_MAX)) {
+                    return false;
+                }
+                *out = Json::Value(static_cast<Json::Int64>(-1 - static_cast<int64_t>(arg)));
+                return true;
+            case kByteString:
+            case kTextString: {
+                if (arg > static_cast<uint64_t>(end_ - pos_)) {
+                    return false;
+                }
+                const char* begin = reinterpret_cast<const char*>(pos_);
+                *out = Json::Value(begin, begin + arg);
+                pos_ += arg;
+                return true;
+            }
+            case kArray: {
+                // 每个元素至少占1字节，据此拒绝声明长度明显超出数据的数组
+                if (arg > static_cast<uint64_t>(end_ - pos_)) {
+                    return false;
+                }
+                *out = Json::Value(Json::arrayValue);
+                for (uint64_t i = 0; i < arg; ++i) {
+                    Json::Value item;
+                    if (!ReadValue(&item, depth + 1)) {
+                        return false;
+                    }
+                    out->append(std::move(item));
+                }
+                return true;
+            }
+            case kMap: {
+                if (arg > static_cast<uint64_t>(end_ - pos_) / 2) {
+                    return false;
+                }
+                *out = Json::Value(Json::objectValue);
+                for (uint64_t i = 0; i < arg; ++i) {
+                    Json::Value key;
+                    Json::Value item;
+                    if (!ReadValue(&key, depth + 1) || !key.isString() || !ReadValue(&item, depth + 1)) {
+                        return false;
+                    }
+                    (*out)[key.asString()] = std::move(item);
+                }
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+private:
+    bool ReadBytes(int count, uint64_t* value) {
+        if (end_ - pos_ < count) {
+            return false;
+        }
+        uint64_t result = 0;
+        for (int i = 0; i < count; ++i) {
+            result = (result << 8) | *pos_++;
+        }
+        *value = result;
+        return true;
+    }
+
+    bool ReadArgument(uint8_t info, uint64_t* value) {
+        if (info < 24) {
+            *value = info;
+            return true;
+        }
+        switch (info) {
+            case 24: return ReadBytes(1, value);
+            case 25: return ReadBytes(2, value);
+            case 26: return ReadBytes(4, value);
+            case 27: return ReadBytes(8, value);
+            default: return false;  // 不支持不定长编码
+        }
+    }
+
+    bool ReadSimple(uint8_t info, Json::Value* out) {
+        uint64_t bits;
+        switch (info) {
+            case 20: *out = Json::Value(false); return true;
+            case 21: *out = Json::Value(true); return true;
+            case 22:
+            case 23: *out = Json::Value(Json::nullValue); return true;
+            case 25: {
+                if (!ReadBytes(2, &bits)) return false;
+                *out = Json::Value(HalfToDouble(static_cast<uint16_t>(bits)));
+                return true;
+            }
+            case 26: {
+                if (!ReadBytes(4, &bits)) return false;
+                uint32_t bits32 = static_cast<uint32_t>(bits);
+                float value;
+                memcpy(&value, &bits32, sizeof(value));
+                *out = Json::Value(static_cast<double>(value));
+                return true;
+            }
+            case 27: {
+                if (!ReadBytes(8, &bits)) return false;
+                double value;
+                memcpy(&value, &bits, sizeof(value));
+                *out = Json::Value(value);
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    static double HalfToDouble(uint16_t half) {
+        int exponent = (half >> 10) & 0x1f;
+        int mantissa = half & 0x3ff;
+        double value;
+        if (exponent == 0) {
+            value = std::ldexp(mantissa, -24);
+        } else if (exponent != 31) {
+            value = std::ldexp(mantissa + 1024, exponent - 25);
+        } else {
+            value = mantissa == 0 ? INFINITY : NAN;
+        }
+        return (half & 0x8000) ? -value : value;
+    }
+
+    const uint8_t* pos_;
+    const uint8_t* end_;
+};
+
+}  // namespace
+
+void Encode(const Json::Value& value, std::string* out) {
+    switch (value.type()) {
+        case Json::nullValue:
+            out->push_back(static_cast<char>(0xf6));
+            break;
+        case Json::booleanValue:
+            out->push_back(static_cast<char>(value.asBool() ? 0xf5 : 0xf4));
+            break;
+        case Json::intValue: {
+            Json::Int64 v = value.asInt64();
+            if (v >= 0) {
+                WriteHead(kUnsigned, static_cast<uint64_t>(v), out);
+            } else {
+                WriteHead(kNegative, static_cast<uint64_t>(-1 - v), out);
+            }
+            break;
+        }
+        case Json::uintValue:
+            WriteHead(kUnsigned, value.asUInt64(), out);
+            break;
+        case Json::realValue:
+            WriteDouble(value.asDouble(), out);
+            break;
+        case Json::stringValue: {
+            const char* begin = nullptr;
+            const char* end = nullptr;
+            value.getString(&begin, &end);
+            WriteText(begin, end, out);
+            break;
+        }
+        case Json::arrayValue:
+            WriteHead(kArray, value.size(), out);
+            for (const auto& item : value) {
+                Encode(item, out);
+            }
+            break;
+        case Json::objectValue:
+            WriteHead(kMap, value.size(), out);
+            for (auto it = value.begin(); it != value.end(); ++it) {
+                const char* key_end = nullptr;
+                const char* key_begin = it.memberName(&key_end);
+                WriteText(key_begin, key_end, out);
+                Encode(*it, out);
+            }
+            break;
+    }
+}
+
+bool Decode(const uint8_t* data, size_t len, Json::Value* out) {
+    Reader reader(data, len);
+    Json::Value value;
+    if (!reader.ReadValue(&value, 0) || !reader.AtEnd()) {
+        return false;
+    }
+    *out = std::move(value);
+    return true;
+}
+
+}  // namespace cbor
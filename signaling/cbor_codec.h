@@ -0,0 +1,32 @@
+#pragma once
+#include <json/json.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief 信令消息的CBOR（RFC 8949）编解码
+ *
+ * 只覆盖信令消息用到的JSON数据模型：对象、数组、字符串、整数、浮点数、
+ * 布尔值和null。相比JSON文本，CBOR省去了引号、转义和数字的十进制表示，
+ * 在协商了"webrtc-signaling-cbor"子协议的连接上使用。
+ */
+namespace cbor {
+
+/**
+ * @brief 把JSON值编码为CBOR
+ * @param value JSON值
+ * @param out 输出缓冲区（追加写入）
+ */
+void Encode(const Json::Value& value, std::string* out);
+
+/**
+ * @brief 把CBOR数据解码为JSON值
+ * @param data CBOR数据
+ * @param len 数据长度
+ * @param out 输出JSON值
+ * @return 是否解码成功（数据不完整、存在多余字节或使用了不支持的类型时返回false）
+ */
+bool Decode(const uint8_t* data, size_t len, Json::Value* out);
+
+}  // namespace cbor
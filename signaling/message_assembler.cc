@@ -0,0 +1,62 @@
+#include "message_assembler.h"
+#include <iostream>
+
+MessageAssembler::MessageAssembler(size_t max_message_size)
+    : max_message_size_(max_message_size), fragment_count_(0), discarding_(false) {
+}
+
+MessageAssembler::Result MessageAssembler::Append(const char* data, size_t len, bool is_final) {
+    fragment_count_++;
+
+    if (!discarding_) {
+        if (buffer_.size() + len > max_message_size_) {
+            std::cerr << "[WARN] Signaling message exceeds " << max_message_size_
+                      << " bytes, dropping it" << std::endl;
+            discarding_ = true;
+            buffer_.clear();
+        } else if (is_final && fragment_count_ == 1) {
+            // 快速路径：单片段消息直接构造，不经过重组缓冲区
+            message_.assign(data, len);
+        } else {
+            buffer_.append(data, len);
+        }
+    }
+
+    if (!is_final) {
+        return Result::kIncomplete;
+    }
+
+    size_t fragments = fragment_count_;
+    fragment_count_ = 0;
+
+    if (discarding_) {
+        discarding_ = false;
+        stats_.dropped_messages++;
+        return Result::kDropped;
+    }
+
+    if (fragments > 1) {
+        // 拷贝而不是move，保留buffer_已经增长出来的容量供下一条大消息复用
+        message_.assign(buffer_);
+        buffer_.clear();
+        stats_.fragmented_messages++;
+    }
+    stats_.messages++;
+    if (message_.size() > stats_.max_message_size) {
+        stats_.max_message_size = message_.size();
+    }
+    return Result::kComplete;
+}
+
+std::string MessageAssembler::TakeMessage() {
+    std::string message;
+    message.swap(message_);
+    return message;
+}
+
+void MessageAssembler::Reset() {
+    buffer_.clear();
+    message_.clear();
+    fragment_count_ = 0;
+    discarding_ = false;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief WebSocket消息重组器
+ *
+ * libwebsockets会把超过rx_buffer_size的帧，或者对端分片发送的消息，
+ * 拆成多次LWS_CALLBACK_CLIENT_RECEIVE回调。该类把这些片段拼接到一个
+ * 可复用的缓冲区中，只在收到完整消息后才交给上层解析。
+ * 超过大小上限的消息会被整体丢弃，避免异常对端耗尽内存。
+ */
+class MessageAssembler {
+public:
+    /**
+     * @brief 追加片段的结果
+     */
+    enum class Result {
+        kIncomplete,  // 消息尚未接收完整
+        kComplete,    // 消息已完整，可通过TakeMessage取出
+        kDropped      // 消息超过大小上限，已被丢弃
+    };
+
+    /**
+     * @brief 重组统计信息
+     */
+    struct Stats {
+        uint64_t messages = 0;             // 完整消息数
+        uint64_t fragmented_messages = 0;  // 由多个片段组成的消息数
+        uint64_t dropped_messages = 0;     // 因超限被丢弃的消息数
+        size_t max_message_size = 0;       // 见过的最大完整消息（字节）
+    };
+
+    /**
+     * @brief 构造函数
+     * @param max_message_size 单条消息的大小上限（字节）
+     */
+    explicit MessageAssembler(size_t max_message_size = 1024 * 1024);
+
+    /**
+     * @brief 追加一个片段
+     * @param data 片段数据
+     * @param len 片段长度
+     * @param is_final 是否为消息的最后一个片段
+     * @return 追加结果
+     */
+    Result Append(const char* data, size_t len, bool is_final);
+
+    /**
+     * @brief 取出已完整的消息（仅在Append返回kComplete后调用）
+     * @return 完整消息
+     */
+    std::string TakeMessage();
+
+    /**
+     * @brief 丢弃正在重组的半条消息（例如连接断开时）
+     */
+    void Reset();
+
+    /**
+     * @brief 设置单条消息的大小上限
+     * @param max_message_size 上限（字节）
+     */
+    void SetMaxMessageSize(size_t max_message_size) { max_message_size_ = max_message_size; }
+
+    /**
+     * @brief 获取重组统计信息
+     */
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    size_t max_message_size_;
+    std::string buffer_;       // 可复用的重组缓冲区，容量在消息之间保留
+    std::string message_;      // 最近一条完整消息
+    size_t fragment_count_;    // 当前消息已收到的片段数
+    bool discarding_;          // 当前消息已超限，丢弃直到最后一个片段
+    Stats stats_;
+};
@@ -0,0 +1,214 @@
+#include "outbound_message_queue.h"
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+int64_t NowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+bool OutboundMessageQueue::IsSessionDescription(SignalingClient::MessageType type) {
+    return type == SignalingClient::MessageType::OFFER || type == SignalingClient::MessageType::ANSWER;
+}
+
+std::string OutboundMessageQueue::PeerKey(const OutboundMessage& message) {
+    // 客户端ID只在房间内唯一，不同房间的同名对端视为不同的协商
+    return message.room_id.empty() ? message.target_id : message.room_id + "/" + message.target_id;
+}
+
+size_t OutboundMessageQueue::CandidateCount(const OutboundMessage& message) {
+    if (message.coalesced) {
+        return message.content["candidates"].size();
+    }
+    return 1;
+}
+
+bool OutboundMessageQueue::IsHeld(const OutboundMessage& message) const {
+    return !message.target_id.empty() && described_targets_.count(PeerKey(message)) == 0;
+}
+
+// 丢弃等待过久的暂存候选者：对端的SDP迟迟没有发出，多半是协商已经失败
+void OutboundMessageQueue::DropExpiredHeld(int64_t now_us) {
+    size_t dropped = 0;
+    for (auto it = candidates_.begin(); it != candidates_.end();) {
+        if (IsHeld(*it) && now_us - it->enqueued_us > kMaxHeldAgeMs * 1000) {
+            it = candidates_.erase(it);
+            dropped++;
+        } else {
+            ++it;
+        }
+    }
+    if (dropped > 0) {
+        std::cerr << "[WARN] Dropped " << dropped << " ICE candidate(s) held for more than " << kMaxHeldAgeMs
+                  << " ms without an SDP" << std::endl;
+    }
+}
+
+void OutboundMessageQueue::Push(OutboundMessage message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (message.enqueued_us == 0) {
+        message.enqueued_us = NowUs();
+    }
+    if (message.type == SignalingClient::MessageType::CANDIDATE) {
+        if (candidates_.size() >= kMaxQueuedCandidates) {
+            DropExpiredHeld(message.enqueued_us);
+        }
+        if (candidates_.size() >= kMaxQueuedCandidates) {
+            // 仍然满：丢弃最早暂存的一条；没有暂存的说明都可发送，只是尚未写出，照常入队
+            for (auto it = candidates_.begin(); it != candidates_.end(); ++it) {
+                if (IsHeld(*it)) {
+                    std::cerr << "[WARN] Outbound candidate queue full, dropping held candidate for "
+                              << PeerKey(*it) << std::endl;
+                    candidates_.erase(it);
+                    break;
+                }
+            }
+        }
+        candidates_.push_back(std::move(message));
+    } else {
+        control_.push_back(std::move(message));
+    }
+}
+
+void OutboundMessageQueue::PushFront(OutboundMessage message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (message.type == SignalingClient::MessageType::CANDIDATE) {
+        candidates_.push_front(std::move(message));
+    } else {
+        control_.push_front(std::move(message));
+    }
+}
+
+bool OutboundMessageQueue::Pop(OutboundMessage* out, bool allow_coalescing) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // 1. 会话控制消息优先
+    if (!control_.empty()) {
+        *out = std::move(control_.front());
+        control_.pop_front();
+        if (IsSessionDescription(out->type)) {
+            described_targets_.insert(PeerKey(*out));
+        }
+        return true;
+    }
+
+    // 2. 找到第一个已可发送的候选者（对端的SDP已发出）
+    DropExpiredHeld(NowUs());
+    auto first = candidates_.begin();
+    while (first != candidates_.end() && IsHeld(*first)) {
+        ++first;
+    }
+    if (first == candidates_.end()) {
+        return false;
+    }
+
+    std::string peer_key = PeerKey(*first);
+    if (!allow_coalescing) {
+        *out = std::move(*first);
+        candidates_.erase(first);
+        return true;
+    }
+
+    // 3. 合并发往同一对端的所有待发候选者
+    Json::Value batch(Json::arrayValue);
+    size_t merged_messages = 0;
+    for (auto it = first; it != candidates_.end();) {
+        if (PeerKey(*it) != peer_key) {
+            ++it;
+            continue;
+        }
+        if (it->coalesced) {
+            for (const auto& candidate : it->content["candidates"]) {
+                batch.append(candidate);
+            }
+        } else {
+            batch.append(it->content);
+        }
+        merged_messages++;
+        if (merged_messages == 1) {
+            *out = std::move(*it);
+        }
+        it = candidates_.erase(it);
+    }
+
+    if (batch.size() > 1) {
+        out->content = Json::Value(Json::objectValue);
+        out->content["candidates"] = std::move(batch);
+        out->coalesced = true;
+    }
+    return true;
+}
+
+void OutboundMessageQueue::OnSent(const OutboundMessage& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (IsSessionDescription(message.type)) {
+        auto it = negotiations_.find(PeerKey(message));
+        if (it != negotiations_.end()) {
+            ReportNegotiation(it->first, it->second);
+        }
+        NegotiationStats& stats = negotiations_[PeerKey(message)];
+        stats = NegotiationStats();
+        stats.frames = 1;
+        return;
+    }
+    if (message.type == SignalingClient::MessageType::CANDIDATE) {
+        auto it = negotiations_.find(PeerKey(message));
+        if (it == negotiations_.end()) {
+            return;
+        }
+        it->second.frames++;
+        it->second.candidate_frames++;
+        it->second.candidates += CandidateCount(message);
+    }
+}
+
+size_t OutboundMessageQueue::DropPeer(const std::string& target_id, const std::string& room_id) {
+    OutboundMessage peer;
+    peer.target_id = target_id;
+    peer.room_id = room_id;
+    const std::string peer_key = PeerKey(peer);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t dropped = 0;
+    for (auto it = candidates_.begin(); it != candidates_.end();) {
+        if (PeerKey(*it) == peer_key) {
+            it = candidates_.erase(it);
+            dropped++;
+        } else {
+            ++it;
+        }
+    }
+    described_targets_.erase(peer_key);
+    auto it = negotiations_.find(peer_key);
+    if (it != negotiations_.end()) {
+        ReportNegotiation(it->first, it->second);
+        negotiations_.erase(it);
+    }
+    return dropped;
+}
+
+void OutboundMessageQueue::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : negotiations_) {
+        ReportNegotiation(entry.first, entry.second);
+    }
+    negotiations_.clear();
+    described_targets_.clear();
+    control_.clear();
+    candidates_.clear();
+}
+
+bool OutboundMessageQueue::Empty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return control_.empty() && candidates_.empty();
+}
+
+void OutboundMessageQueue::ReportNegotiation(const std::string& target_id, const NegotiationStats& stats) {
+    std::cout << "[INFO] Negotiation with " << (target_id.empty() ? "<server>" : target_id) << ": "
+              << stats.frames << " frames sent, " << stats.candidates << " candidates in "
+              << stats.candidate_frames << " frames" << std::endl;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include "signaling_client.h"
+#include <json/json.h>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+/**
+ * @brief 待发送的信令消息
+ */
+struct OutboundMessage {
+    SignalingClient::MessageType type;
+    Json::Value content;     // 直接存储JSON对象
+    std::string target_id;
+    std::string room_id;     // 为空时使用客户端的第一个房间
+    bool coalesced = false;  // 是否为合并后的批量候选者消息（"candidates"）
+    int64_t enqueued_us = 0; // 入队时间（单调时钟），由队列在Push时填写
+};
+
+/**
+ * @brief 带优先级的信令发送队列
+ *
+ * 队列分为两条通道：会话控制消息（注册、Offer/Answer、离开）优先发送，
+ * ICE候选者排在其后。发往同一对端的多个待发候选者会被合并成一条
+ * "candidates"批量消息，减少WebSocket帧数；在该对端的SDP发出之前，
+ * 它的候选者会被暂存，避免对端在设置远端描述前就收到候选者。
+ * 暂存的候选者在对端会话关闭时丢弃；等待超过kMaxHeldAgeMs的、
+ * 或候选者总数超过kMaxQueuedCandidates时最早暂存的，也会被丢弃。
+ * 同时按对端统计每次协商实际发送的帧数。
+ */
+class OutboundMessageQueue {
+public:
+    static constexpr int64_t kMaxHeldAgeMs = 30000;        // 暂存候选者的最长等待时间
+    static constexpr size_t kMaxQueuedCandidates = 256;     // 候选者通道的容量
+
+    /**
+     * @brief 单次协商的发送统计
+     */
+    struct NegotiationStats {
+        uint64_t frames = 0;            // 发送的WebSocket帧数（含SDP本身）
+        uint64_t candidates = 0;        // 发送的候选者个数
+        uint64_t candidate_frames = 0;  // 承载候选者的帧数
+    };
+
+    /**
+     * @brief 入队一条消息
+     * @param message 消息
+     */
+    void Push(OutboundMessage message);
+
+    /**
+     * @brief 将发送失败的消息放回其通道队首
+     * @param message 消息
+     */
+    void PushFront(OutboundMessage message);
+
+    /**
+     * @brief 取出下一帧要发送的消息
+     * @param out 输出消息
+     * @param allow_coalescing 是否允许合并候选者（需服务器支持"candidates"）
+     * @return 是否取到消息
+     */
+    bool Pop(OutboundMessage* out, bool allow_coalescing);
+
+    /**
+     * @brief 记录一帧已成功发送，用于协商统计
+     * @param message 已发送的消息
+     */
+    void OnSent(const OutboundMessage& message);
+
+    /**
+     * @brief 对端会话已关闭：丢弃发往它的待发候选者，并忘记它的SDP已发出，
+     * 之后同名对端的新会话需要重新发出SDP才能发送候选者
+     * @param target_id 对端ID
+     * @param room_id 房间ID
+     * @return 丢弃的候选者消息数
+     */
+    size_t DropPeer(const std::string& target_id, const std::string& room_id);
+
+    /**
+     * @brief 清空队列并输出尚未结束的协商统计
+     */
+    void Clear();
+
+    /**
+     * @brief 队列是否为空
+     */
+    bool Empty() const;
+
+private:
+    static bool IsSessionDescription(SignalingClient::MessageType type);
+    static std::string PeerKey(const OutboundMessage& message);
+    static size_t CandidateCount(const OutboundMessage& message);
+    bool IsHeld(const OutboundMessage& message) const;
+    void DropExpiredHeld(int64_t now_us);
+    void ReportNegotiation(const std::string& target_id, const NegotiationStats& stats);
+
+    std::deque<OutboundMessage> control_;     // 会话控制消息
+    std::deque<OutboundMessage> candidates_;  // ICE候选者
+    // 已发出过SDP的对端，只有这些对端的候选者才允许发送
+    std::unordered_set<std::string> described_targets_;
+    // 每个对端当前协商的发送统计
+    std::unordered_map<std::string, NegotiationStats> negotiations_;
+    mutable std::mutex mutex_;
+};
@@ -0,0 +1,36 @@
+#include "room_membership.h"
+#include <algorithm>
+
+bool RoomMembership::Add(const std::string& room_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (room_id.empty() || std::find(rooms_.begin(), rooms_.end(), room_id) != rooms_.end()) {
+        return false;
+    }
+    rooms_.push_back(room_id);
+    return true;
+}
+
+bool RoomMembership::Remove(const std::string& room_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find(rooms_.begin(), rooms_.end(), room_id);
+    if (it == rooms_.end()) {
+        return false;
+    }
+    rooms_.erase(it);
+    return true;
+}
+
+bool RoomMembership::Contains(const std::string& room_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::find(rooms_.begin(), rooms_.end(), room_id) != rooms_.end();
+}
+
+std::string RoomMembership::Primary() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rooms_.empty() ? std::string() : rooms_.front();
+}
+
+std::vector<std::string> RoomMembership::List() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rooms_;
+}
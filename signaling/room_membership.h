@@ -0,0 +1,46 @@
+#pragma once
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 信令连接加入的房间列表（线程安全）
+ *
+ * 第一个加入的房间作为主房间，用于未指定房间的消息以及兼容只支持单房间的接口。
+ * 断线重连后，信令客户端按此列表重新注册所有房间。
+ */
+class RoomMembership {
+public:
+    /**
+     * @brief 加入房间
+     * @param room_id 房间ID
+     * @return 是否为新加入（已在列表中时返回false）
+     */
+    bool Add(const std::string& room_id);
+
+    /**
+     * @brief 离开房间
+     * @param room_id 房间ID
+     * @return 是否在列表中
+     */
+    bool Remove(const std::string& room_id);
+
+    /**
+     * @brief 是否已加入房间
+     */
+    bool Contains(const std::string& room_id) const;
+
+    /**
+     * @brief 获取主房间，未加入任何房间时返回空字符串
+     */
+    std::string Primary() const;
+
+    /**
+     * @brief 获取所有房间（按加入顺序）
+     */
+    std::vector<std::string> List() const;
+
+private:
+    std::vector<std::string> rooms_;
+    mutable std::mutex mutex_;
+};
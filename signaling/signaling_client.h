@@ -1,13 +1,17 @@
 #pragma once
 #include <functional>
+#include <json/json.h>
 #include <string>
 #include <memory>
+#include <vector>
 
 /**
  * @brief 信令客户端接口类
  * 
  * 该类定义了信令客户端的通用接口，用于与信令服务器通信
- * 支持SDP交换、ICE候选收集与处理、房间管理和客户端状态通知
+ * 支持SDP交换、ICE候选收集与处理、房间管理和客户端状态通知。
+ * 一个连接可以同时加入多个房间：Register加入第一个房间，JoinRoom/LeaveRoom增减房间；
+ * 发送接口的room_id为空时使用第一个房间。
  */
 class SignalingClient {
 public:
@@ -31,9 +35,9 @@ public:
     /**
      * @brief 消息回调函数类型
      * @param type 消息类型
-     * @param message 消息内容
+     * @param message 已解码的消息（JSON文本与CBOR消息都只解析一次）
      */
-    using MessageCallback = std::function<void(MessageType type, const std::string& message)>;
+    using MessageCallback = std::function<void(MessageType type, const Json::Value& message)>;
 
     //析构函数
     virtual ~SignalingClient() = default;
@@ -56,21 +60,45 @@ public:
      */
     virtual bool Register(const std::string& room_id, const std::string& client_id = "") = 0;
 
+    /**
+     * @brief 通过同一连接再加入一个房间（断线重连后自动重新加入）
+     * @param room_id 房间ID
+     * @return 是否成功（未连接时只记录，连接后自动加入）
+     */
+    virtual bool JoinRoom(const std::string& room_id) = 0;
+
+    /**
+     * @brief 离开一个房间，其余房间不受影响
+     * @param room_id 房间ID
+     * @return 是否成功发送
+     */
+    virtual bool LeaveRoom(const std::string& room_id) = 0;
+
+    /**
+     * @brief 获取已加入的所有房间
+     * @return 房间ID列表
+     */
+    virtual std::vector<std::string> GetRoomIds() const = 0;
+
     /**
      * @brief 发送SDP Offer
      * @param sdp SDP字符串
      * @param target_id 目标客户端ID（可选）
+     * @param room_id 目标客户端所在房间（可选）
      * @return 是否成功发送
      */
-    virtual bool SendOffer(const std::string& sdp, const std::string& target_id = "") = 0;
+    virtual bool SendOffer(const std::string& sdp, const std::string& target_id = "",
+                   const std::string& room_id = "") = 0;
 
     /**
      * @brief 发送SDP Answer
      * @param sdp SDP字符串
      * @param target_id 目标客户端ID（可选）
+     * @param room_id 目标客户端所在房间（可选）
      * @return 是否成功发送
      */
-    virtual bool SendAnswer(const std::string& sdp, const std::string& target_id = "") = 0;
+    virtual bool SendAnswer(const std::string& sdp, const std::string& target_id = "",
+                   const std::string& room_id = "") = 0;
 
     /**
      * @brief 发送ICE候选
@@ -78,13 +106,15 @@ public:
      * @param sdp_mline_index SDP媒体行索引
      * @param candidate 候选字符串
      * @param target_id 目标客户端ID（可选）
+     * @param room_id 目标客户端所在房间（可选）
      * @return 是否成功发送
      */
     virtual bool SendCandidate(const std::string& sdp_mid, int sdp_mline_index,
-                              const std::string& candidate, const std::string& target_id = "") = 0;
+                              const std::string& candidate, const std::string& target_id = "",
+                              const std::string& room_id = "") = 0;
 
     /**
-     * @brief 发送离开房间消息
+     * @brief 发送离开消息（离开所有房间）
      * @return 是否成功发送
      */
     virtual bool SendLeave() = 0;
@@ -108,7 +138,7 @@ public:
     virtual bool IsConnected() const = 0;
 
     /**
-     * @brief 获取当前房间ID
+     * @brief 获取第一个房间ID
      * @return 房间ID
      */
     virtual std::string GetRoomId() const = 0;
@@ -118,4 +148,17 @@ public:
      * @return 客户端ID
      */
     virtual std::string GetClientId() const = 0;
+
+    /**
+     * @brief 获取到信令服务器的往返时延（平滑值）
+     * @return RTT（毫秒），尚未测得时返回-1
+     */
+    virtual int GetRttMs() const { return -1; }
+
+    /**
+     * @brief 与某个对端的会话已关闭，丢弃尚未发出的发往它的候选者
+     * @param target_id 对端ID
+     * @param room_id 房间ID
+     */
+    virtual void ForgetPeer(const std::string& /*target_id*/, const std::string& /*room_id*/) {}
 };
@@ -0,0 +1,480 @@
+#include "signaling_client_ipc.h"
+#include "signaling_message.h"
+#include "../common/thread_profile.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const char kUnixScheme[] = "unix:";
+
+UnixSocketSignalingClient::UnixSocketSignalingClient()
+    : abstract_namespace_(false), socket_fd_(-1), wake_fd_(-1),
+      should_exit_(false), is_connected_(false), write_blocked_(false), reconnect_attempts_(0),
+      peer_supports_batching_(false), use_binary_(false), max_message_size_(1024 * 1024),
+      tx_messages_(0), tx_bytes_(0), rx_messages_(0), rx_bytes_(0), dropped_messages_(0) {}
+
+UnixSocketSignalingClient::~UnixSocketSignalingClient() {
+    Close();
+}
+
+bool UnixSocketSignalingClient::IsUnixSocketUrl(const std::string& url) {
+    return url.compare(0, sizeof(kUnixScheme) - 1, kUnixScheme) == 0;
+}
+
+// unix:///path/to.sock 或 unix:/path/to.sock 为文件路径，unix:@name 为抽象命名空间
+bool UnixSocketSignalingClient::ParseSocketUrl(const std::string& url) {
+    if (!IsUnixSocketUrl(url)) {
+        return false;
+    }
+    std::string address = url.substr(sizeof(kUnixScheme) - 1);
+    if (address.compare(0, 2, "//") == 0) {
+        address = address.substr(2);
+    }
+    abstract_namespace_ = !address.empty() && address[0] == '@';
+    socket_path_ = abstract_namespace_ ? address.substr(1) : address;
+
+    // sun_path需要容纳路径（文件路径还需要结尾的'\0'，抽象命名空间需要开头的'\0'）
+    if (socket_path_.empty() || socket_path_.size() + 1 > sizeof(sockaddr_un::sun_path)) {
+        std::cerr << "Invalid UNIX socket address: " << url << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool UnixSocketSignalingClient::Connect(const std::string& url) {
+    if (io_thread_.joinable()) {
+        return false;
+    }
+    if (!ParseSocketUrl(url)) {
+        std::cerr << "Failed to parse server URL: " << url << std::endl;
+        return false;
+    }
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake_fd_ < 0) {
+        std::cerr << "Failed to create eventfd: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    should_exit_ = false;
+    reconnect_attempts_ = 0;
+    dispatcher_.Start();
+    io_thread_ = std::thread(&UnixSocketSignalingClient::IoLoop, this);
+    return true;
+}
+
+void UnixSocketSignalingClient::Close() {
+    if (!io_thread_.joinable()) {
+        return;
+    }
+    should_exit_ = true;
+    WakeIoThread();
+    io_thread_.join();
+
+    // IO线程退出后再停止分发线程，未处理的入站消息随之丢弃
+    dispatcher_.Stop();
+    TrafficStats stats = GetTrafficStats();
+    std::cout << "[INFO] Local signaling stats: tx " << stats.tx_messages << " msgs/" << stats.tx_bytes
+              << " bytes, rx " << stats.rx_messages << " msgs/" << stats.rx_bytes << " bytes, "
+              << stats.dropped_messages << " dropped" << std::endl;
+
+    outbound_queue_.Clear();
+    peer_supports_batching_ = false;
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+        wake_fd_ = -1;
+    }
+}
+
+void UnixSocketSignalingClient::WakeIoThread() {
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ret = write(wake_fd_, &one, sizeof(one));
+        (void)ret;
+    }
+}
+
+// IO线程：断线时按退避间隔重连（控制端可能晚于本进程启动或中途重启），
+// 连接后阻塞在poll上，消息到达即被唤醒，没有固定的轮询间隔
+void UnixSocketSignalingClient::IoLoop() {
+    ThreadProfile::Instance().RegisterCurrentThread(ThreadProfile::Role::kSignalingIo, "sig-ipc");
+    while (!should_exit_) {
+        if (socket_fd_ < 0) {
+            if (ConnectSocket()) {
+                reconnect_attempts_ = 0;
+                continue;
+            }
+            // 退避时间从100ms开始倍增，最长2秒
+            int backoff_ms = std::min(100 << std::min(reconnect_attempts_, 5), 2000);
+            if (reconnect_attempts_ == 0) {
+                std::cout << "[INFO] Waiting for local controller on " << (abstract_namespace_ ? "@" : "")
+                          << socket_path_ << std::endl;
+            }
+            reconnect_attempts_++;
+            struct pollfd wake = {wake_fd_, POLLIN, 0};
+            poll(&wake, 1, backoff_ms);
+            continue;
+        }
+
+        struct pollfd fds[2];
+        fds[0].fd = socket_fd_;
+        fds[0].events = POLLIN | (write_blocked_ ? POLLOUT : 0);
+        fds[0].revents = 0;
+        fds[1].fd = wake_fd_;
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+        if (poll(fds, 2, -1) < 0) {
+            if (errno != EINTR) {
+                std::cerr << "poll() failed on local signaling socket: " << strerror(errno) << std::endl;
+                Disconnect("Poll failed");
+            }
+            continue;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            uint64_t count;
+            ssize_t ret = read(wake_fd_, &count, sizeof(count));
+            (void)ret;
+        }
+        if (fds[0].revents & POLLIN) {
+            if (!ReadMessages()) {
+                Disconnect("Disconnected");
+                continue;
+            }
+        }
+        if (fds[0].revents & (POLLHUP | POLLERR)) {
+            Disconnect("Disconnected");
+            continue;
+        }
+        if (fds[0].revents & POLLOUT) {
+            std::lock_guard<std::mutex> lock(send_mutex_);
+            write_blocked_ = false;
+            FlushOutboundQueue();
+        }
+    }
+    Disconnect("Closed");
+}
+
+bool UnixSocketSignalingClient::ConnectSocket() {
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::cerr << "Failed to create UNIX socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    socklen_t addr_len;
+    if (abstract_namespace_) {
+        // 抽象命名空间：sun_path以'\0'开头，地址长度不含结尾
+        memcpy(addr.sun_path + 1, socket_path_.data(), socket_path_.size());
+        addr_len = static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + 1 + socket_path_.size());
+    } else {
+        memcpy(addr.sun_path, socket_path_.data(), socket_path_.size());
+        addr_len = sizeof(addr);
+    }
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), addr_len) < 0) {
+        close(fd);
+        return false;
+    }
+
+    struct ucred cred;
+    socklen_t cred_len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) == 0) {
+        std::cout << "[INFO] Connected to local controller (pid " << cred.pid << ", uid " << cred.uid << ")" << std::endl;
+    }
+
+    // 先把注册消息排到队首再公开套接字，断线期间积压的消息随后一并发出
+    RegisterAllRooms();
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        socket_fd_ = fd;
+        write_blocked_ = false;
+        FlushOutboundQueue();
+    }
+    is_connected_ = true;
+    PostStateChange(true, "Connected");
+    return true;
+}
+
+void UnixSocketSignalingClient::Disconnect(const std::string& reason) {
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        if (socket_fd_ < 0) {
+            return;
+        }
+        close(socket_fd_);
+        socket_fd_ = -1;
+    }
+    is_connected_ = false;
+    peer_supports_batching_ = false;
+    PostStateChange(false, reason);
+}
+
+// 按消息读取：先用MSG_PEEK|MSG_TRUNC取得下一条消息的真实长度，
+// 再直接读入交给分发线程的缓冲区，不经过中间缓冲区，也不需要重组
+bool UnixSocketSignalingClient::ReadMessages() {
+    while (true) {
+        ssize_t len = recv(socket_fd_, nullptr, 0, MSG_PEEK | MSG_TRUNC | MSG_DONTWAIT);
+        if (len < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        if (len == 0) {
+            return false;  // 对端关闭
+        }
+
+        if (static_cast<size_t>(len) > max_message_size_) {
+            // 读取0字节即可丢弃整条记录
+            char discard;
+            recv(socket_fd_, &discard, 0, MSG_DONTWAIT);
+            dropped_messages_++;
+            std::cerr << "[WARN] Dropping oversized local signaling message (" << len << " bytes)" << std::endl;
+            continue;
+        }
+
+        std::string message(static_cast<size_t>(len), '\0');
+        ssize_t received = recv(socket_fd_, &message[0], message.size(), MSG_DONTWAIT);
+        if (received <= 0) {
+            return received < 0 && (errno == EAGAIN || errno == EINTR);
+        }
+        message.resize(static_cast<size_t>(received));
+        rx_messages_++;
+        rx_bytes_ += message.size();
+        dispatcher_.Post([this, message = std::move(message)]() {
+            DispatchReceivedMessage(message);
+        });
+    }
+}
+
+// 在分发线程上解析消息并通知上层
+void UnixSocketSignalingClient::DispatchReceivedMessage(const std::string& message) {
+    // 顶层消息总是对象：JSON文本以'{'开头，CBOR映射的首字节为0xa0~0xbb，不会混淆
+    bool binary = message[0] != '{';
+    // 发送编码跟随控制端
+    use_binary_ = binary;
+
+    Json::Value json;
+    if (!signaling_message::Decode(message.data(), message.size(), binary, &json)) {
+        std::cerr << "Invalid local signaling message (" << message.size() << " bytes)" << std::endl;
+        return;
+    }
+
+    std::string type_str = json["type"].asString();
+    if (type_str == "register_success") {
+        if (json.isMember("clientId")) {
+            std::lock_guard<std::mutex> lock(info_mutex_);
+            client_id_ = json["clientId"].asString();
+        }
+        peer_supports_batching_ = signaling_message::SupportsCandidateBatching(json);
+    }
+
+    MessageCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        callback = message_callback_;
+    }
+    if (callback) {
+        callback(signaling_message::TypeFromString(type_str), json);
+    }
+}
+
+void UnixSocketSignalingClient::PostStateChange(bool connected, const std::string& message) {
+    dispatcher_.Post([this, connected, message]() {
+        StateCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(callback_mutex_);
+            callback = state_callback_;
+        }
+        if (callback) {
+            callback(connected, message);
+        }
+    });
+}
+
+bool UnixSocketSignalingClient::Register(const std::string& room_id, const std::string& client_id) {
+    {
+        std::lock_guard<std::mutex> lock(info_mutex_);
+        if (!client_id.empty()) {
+            client_id_ = client_id;
+        } else if (client_id_.empty()) {
+            client_id_ = "receiver-" + std::to_string(getpid());
+        }
+    }
+    rooms_.Add(room_id);
+    // 尚未连接时只保存注册信息，连接建立后自动注册
+    if (!IsConnected()) {
+        return true;
+    }
+    return SendRegister(room_id);
+}
+
+bool UnixSocketSignalingClient::JoinRoom(const std::string& room_id) {
+    if (room_id.empty()) {
+        return false;
+    }
+    if (!rooms_.Add(room_id)) {
+        return true;
+    }
+    std::cout << "[INFO] Joining room " << room_id << std::endl;
+    if (!IsConnected()) {
+        return true;
+    }
+    return SendRegister(room_id);
+}
+
+bool UnixSocketSignalingClient::LeaveRoom(const std::string& room_id) {
+    if (!rooms_.Remove(room_id)) {
+        std::cerr << "[WARN] Not a member of room " << room_id << std::endl;
+        return false;
+    }
+    std::cout << "[INFO] Leaving room " << room_id << std::endl;
+    if (!IsConnected()) {
+        return true;
+    }
+    return SendMessage(MessageType::LEAVE, Json::Value(Json::objectValue), "", room_id);
+}
+
+std::vector<std::string> UnixSocketSignalingClient::GetRoomIds() const {
+    return rooms_.List();
+}
+
+bool UnixSocketSignalingClient::SendRegister(const std::string& room_id) {
+    return SendMessage(MessageType::REGISTER, signaling_message::BuildRegister(room_id, GetClientId()), "", room_id);
+}
+
+// 断线期间积压的Offer/Answer可能早于注册入队，控制端必须先收到register才能转发，
+// 因此注册消息按房间顺序放回队首
+void UnixSocketSignalingClient::RegisterAllRooms() {
+    std::vector<std::string> room_ids = rooms_.List();
+    for (auto it = room_ids.rbegin(); it != room_ids.rend(); ++it) {
+        OutboundMessage msg;
+        msg.type = MessageType::REGISTER;
+        msg.content = signaling_message::BuildRegister(*it, GetClientId());
+        msg.room_id = *it;
+        outbound_queue_.PushFront(std::move(msg));
+    }
+}
+
+bool UnixSocketSignalingClient::SendOffer(const std::string& sdp, const std::string& target_id,
+                                          const std::string& room_id) {
+    Json::Value content;
+    content["sdp"] = sdp;
+    return SendMessage(MessageType::OFFER, content, target_id, room_id);
+}
+
+bool UnixSocketSignalingClient::SendAnswer(const std::string& sdp, const std::string& target_id,
+                                           const std::string& room_id) {
+    Json::Value content;
+    content["sdp"] = sdp;
+    return SendMessage(MessageType::ANSWER, content, target_id, room_id);
+}
+
+bool UnixSocketSignalingClient::SendCandidate(const std::string& sdp_mid, int sdp_mline_index,
+                                              const std::string& candidate, const std::string& target_id,
+                                              const std::string& room_id) {
+    Json::Value content;
+    content["candidate"] = candidate;
+    content["sdpMid"] = sdp_mid;
+    content["sdpMLineIndex"] = sdp_mline_index;
+    return SendMessage(MessageType::CANDIDATE, content, target_id, room_id);
+}
+
+bool UnixSocketSignalingClient::SendLeave() {
+    bool ok = true;
+    for (const auto& room_id : rooms_.List()) {
+        ok = SendMessage(MessageType::LEAVE, Json::Value(Json::objectValue), "", room_id) && ok;
+    }
+    return ok;
+}
+
+// 本地套接字的发送不会长时间阻塞，因此直接在调用线程上发送，省去一次线程切换；
+// 只有发送缓冲区已满时才交给IO线程在可写后补发
+bool UnixSocketSignalingClient::SendMessage(MessageType type, const Json::Value& content, const std::string& target_id,
+                                            const std::string& room_id) {
+    OutboundMessage msg;
+    msg.type = type;
+    msg.content = content;
+    msg.target_id = target_id;
+    msg.room_id = room_id;
+    outbound_queue_.Push(std::move(msg));
+
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (socket_fd_ >= 0 && !write_blocked_) {
+        FlushOutboundQueue();
+    }
+    return true;
+}
+
+void UnixSocketSignalingClient::FlushOutboundQueue() {
+    OutboundMessage msg;
+    std::string payload;
+    std::string room_id = GetRoomId();
+    while (socket_fd_ >= 0 && outbound_queue_.Pop(&msg, peer_supports_batching_)) {
+        payload.clear();
+        signaling_message::Encode(msg, room_id, use_binary_, &payload);
+        ssize_t ret = send(socket_fd_, payload.data(), payload.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (ret < 0) {
+            outbound_queue_.PushFront(std::move(msg));
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                write_blocked_ = true;
+                WakeIoThread();
+            } else {
+                std::cerr << "Failed to send local signaling message: " << strerror(errno) << std::endl;
+            }
+            break;
+        }
+        tx_messages_++;
+        tx_bytes_ += payload.size();
+        outbound_queue_.OnSent(msg);
+    }
+}
+
+UnixSocketSignalingClient::TrafficStats UnixSocketSignalingClient::GetTrafficStats() const {
+    TrafficStats stats;
+    stats.tx_messages = tx_messages_;
+    stats.tx_bytes = tx_bytes_;
+    stats.rx_messages = rx_messages_;
+    stats.rx_bytes = rx_bytes_;
+    stats.dropped_messages = dropped_messages_;
+    return stats;
+}
+
+// --- Getter/Setter ---
+void UnixSocketSignalingClient::SetStateCallback(StateCallback callback) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    state_callback_ = std::move(callback);
+}
+
+void UnixSocketSignalingClient::SetMessageCallback(MessageCallback callback) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    message_callback_ = std::move(callback);
+}
+
+bool UnixSocketSignalingClient::IsConnected() const {
+    return is_connected_;
+}
+
+std::string UnixSocketSignalingClient::GetRoomId() const {
+    return rooms_.Primary();
+}
+
+std::string UnixSocketSignalingClient::GetClientId() const {
+    std::lock_guard<std::mutex> lock(info_mutex_);
+    return client_id_;
+}
+
+void UnixSocketSignalingClient::ForgetPeer(const std::string& target_id, const std::string& room_id) {
+    size_t dropped = outbound_queue_.DropPeer(target_id, room_id);
+    if (dropped > 0) {
+        std::cout << "[INFO] Dropped " << dropped << " pending candidate message(s) for closed peer "
+                  << target_id << std::endl;
+    }
+}
@@ -0,0 +1,208 @@
+#pragma once
+#include "signaling_client.h"
+#include "signaling_dispatcher.h"
+#include "outbound_message_queue.h"
+#include "room_membership.h"
+#include <json/json.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 基于UNIX域套接字的本地信令客户端实现
+ *
+ * 用于控制程序与本接收端运行在同一块板子上的场景：控制程序监听一个
+ * SOCK_SEQPACKET套接字，本端作为客户端连接，双方直接交换与WebSocket信令
+ * 相同的消息（JSON文本或CBOR），无需单独的信令服务器进程。
+ * SEQPACKET由内核保证消息边界，一次recv恰好得到一条完整消息，
+ * 不需要长度前缀，也不需要分片重组；消息直接读入交给分发线程的缓冲区。
+ *
+ * 地址格式：unix:///run/receiver/signaling.sock（文件路径）
+ *          unix:@receiver-signaling（Linux抽象命名空间）
+ */
+class UnixSocketSignalingClient : public SignalingClient {
+public:
+    /**
+     * @brief 本地连接的流量统计
+     */
+    struct TrafficStats {
+        uint64_t tx_messages = 0;
+        uint64_t tx_bytes = 0;
+        uint64_t rx_messages = 0;
+        uint64_t rx_bytes = 0;
+        uint64_t dropped_messages = 0;  // 超过大小上限而被丢弃的消息
+    };
+
+    UnixSocketSignalingClient();
+    ~UnixSocketSignalingClient() override;
+
+    // SignalingClient接口实现
+    bool Connect(const std::string& url) override;
+    void Close() override;
+    bool Register(const std::string& room_id, const std::string& client_id = "") override;
+    bool JoinRoom(const std::string& room_id) override;
+    bool LeaveRoom(const std::string& room_id) override;
+    std::vector<std::string> GetRoomIds() const override;
+    bool SendOffer(const std::string& sdp, const std::string& target_id = "",
+                   const std::string& room_id = "") override;
+    bool SendAnswer(const std::string& sdp, const std::string& target_id = "",
+                    const std::string& room_id = "") override;
+    bool SendCandidate(const std::string& sdp_mid, int sdp_mline_index,
+                      const std::string& candidate, const std::string& target_id = "",
+                      const std::string& room_id = "") override;
+    bool SendLeave() override;
+    void SetStateCallback(StateCallback callback) override;
+    void SetMessageCallback(MessageCallback callback) override;
+    bool IsConnected() const override;
+    std::string GetRoomId() const override;
+    std::string GetClientId() const override;
+    void ForgetPeer(const std::string& target_id, const std::string& room_id) override;
+
+    /**
+     * @brief 是否使用CBOR编码发送消息，需在Connect之前调用。
+     * 收到控制端的第一条消息后，发送编码自动跟随控制端。
+     * @param enabled 是否启用，默认使用JSON文本
+     */
+    void SetBinaryEncoding(bool enabled) { use_binary_ = enabled; }
+
+    /**
+     * @brief 设置单条入站消息的大小上限，需在Connect之前调用
+     * @param max_message_size 上限（字节）
+     */
+    void SetMaxMessageSize(size_t max_message_size) { max_message_size_ = max_message_size; }
+
+    /**
+     * @brief 判断URL是否指向本地UNIX域套接字
+     * @param url 信令地址
+     * @return 是否为unix:前缀
+     */
+    static bool IsUnixSocketUrl(const std::string& url);
+
+    /**
+     * @brief 获取当前连接的流量统计
+     * @return 统计信息
+     */
+    TrafficStats GetTrafficStats() const;
+
+private:
+    /**
+     * @brief 解析unix:地址
+     * @param url 信令地址
+     * @return 是否解析成功
+     */
+    bool ParseSocketUrl(const std::string& url);
+
+    /**
+     * @brief IO线程主循环：连接、收消息、在套接字可写时补发积压消息
+     */
+    void IoLoop();
+
+    /**
+     * @brief 连接控制端套接字
+     * @return 是否连接成功
+     */
+    bool ConnectSocket();
+
+    /**
+     * @brief 关闭当前连接并通知上层
+     * @param reason 断开原因
+     */
+    void Disconnect(const std::string& reason);
+
+    /**
+     * @brief 读取套接字中所有已到达的消息（在IO线程调用）
+     * @return 连接是否仍然有效
+     */
+    bool ReadMessages();
+
+    /**
+     * @brief 入队一条消息，连接可用时在调用线程上直接发送
+     * @param type 消息类型
+     * @param content 消息内容
+     * @param target_id 目标客户端ID（可选）
+     * @param room_id 所属房间（可选，为空时使用第一个房间）
+     * @return 是否成功入队
+     */
+    bool SendMessage(MessageType type, const Json::Value& content, const std::string& target_id = "",
+                     const std::string& room_id = "");
+
+    /**
+     * @brief 发送某个房间的register消息
+     * @param room_id 房间ID
+     * @return 是否成功入队
+     */
+    bool SendRegister(const std::string& room_id);
+
+    /**
+     * @brief 连接建立后重新加入所有房间：注册消息排在发送队列最前面，
+     * 由调用方在公开套接字后一并发出
+     */
+    void RegisterAllRooms();
+
+    /**
+     * @brief 把发送队列中当前可发的消息写入套接字，调用方需持有send_mutex_
+     */
+    void FlushOutboundQueue();
+
+    /**
+     * @brief 解析消息并执行上层消息回调（在分发线程调用）
+     * @param message 消息内容
+     */
+    void DispatchReceivedMessage(const std::string& message);
+
+    /**
+     * @brief 将状态变化投递到分发线程，保证与消息回调的先后顺序
+     * @param connected 是否已连接
+     * @param message 状态描述
+     */
+    void PostStateChange(bool connected, const std::string& message);
+
+    /**
+     * @brief 唤醒IO线程（退出或需要关注可写事件时）
+     */
+    void WakeIoThread();
+
+    // 套接字地址
+    std::string socket_path_;
+    bool abstract_namespace_;
+
+    // 连接与线程
+    int socket_fd_;
+    int wake_fd_;  // eventfd，用于唤醒阻塞在poll上的IO线程
+    std::thread io_thread_;
+    std::atomic<bool> should_exit_;
+    std::atomic<bool> is_connected_;
+    std::atomic<bool> write_blocked_;  // 发送缓冲区已满，等待可写事件
+    int reconnect_attempts_;
+
+    // 发送队列：SDP优先，候选者按对端合并；send_mutex_保证整条消息的发送顺序
+    OutboundMessageQueue outbound_queue_;
+    std::mutex send_mutex_;
+    std::atomic<bool> peer_supports_batching_;
+
+    // 编码
+    std::atomic<bool> use_binary_;
+    size_t max_message_size_;
+
+    // 流量统计
+    std::atomic<uint64_t> tx_messages_;
+    std::atomic<uint64_t> tx_bytes_;
+    std::atomic<uint64_t> rx_messages_;
+    std::atomic<uint64_t> rx_bytes_;
+    std::atomic<uint64_t> dropped_messages_;
+
+    // 房间和客户端信息
+    RoomMembership rooms_;
+    std::string client_id_;
+    mutable std::mutex info_mutex_;
+
+    // 回调函数
+    StateCallback state_callback_;
+    MessageCallback message_callback_;
+    std::mutex callback_mutex_;
+
+    // 入站消息分发器：上层回调在独立线程执行，不阻塞IO线程
+    SignalingDispatcher dispatcher_;
+};
@@ -1,15 +1,33 @@
 #include "signaling_client_ws.h"
+#include "signaling_message.h"
+#include "../common/thread_profile.h"
 #include <iostream>
 #include <chrono>
 #include <cstring>
 #include <regex>
-#include <sstream>
 #include <random>
+#include <algorithm>
 
 // 静态成员初始化
 std::unordered_map<struct lws*, WebSocketSignalingClient*> WebSocketSignalingClient::instance_map_;
 std::mutex WebSocketSignalingClient::instance_map_mutex_;
 
+// 辅助函数：获取单调时钟时间（微秒）
+static int64_t GetMonotonicTimeUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 子协议名：JSON文本与CBOR二进制
+static const char kJsonProtocol[] = "webrtc-signaling";
+static const char kCborProtocol[] = "webrtc-signaling-cbor";
+
+// permessage-deflate压缩扩展
+static const struct lws_extension kExtensions[] = {
+    {"permessage-deflate", lws_extension_callback_pm_deflate, "permessage-deflate; client_max_window_bits"},
+    {nullptr, nullptr, nullptr}
+};
+
 // 使用C++11 <random> 生成随机ID
 static std::string GenerateRandomId(int length = 8) {
     static const char alphanum[] =
@@ -32,12 +50,22 @@ static std::string GenerateRandomId(int length = 8) {
 WebSocketSignalingClient::WebSocketSignalingClient()
     : is_connected_(false), is_connecting_(false), should_reconnect_(false),
       should_exit_(false), port_(0), reconnect_attempts_(0),
-      context_(nullptr), websocket_connection_(nullptr) {
+      max_reconnect_attempts_(0), max_reconnect_backoff_ms_(10000), next_reconnect_us_(0),
+      context_(nullptr), websocket_connection_(nullptr),
+      server_supports_batching_(false),
+      keepalive_interval_ms_(5000), keepalive_timeout_ms_(3000),
+      last_ping_sent_us_(0), ping_outstanding_(false),
+      last_rtt_us_(-1), smoothed_rtt_us_(-1),
+      binary_encoding_enabled_(true), compression_enabled_(true), use_binary_(false),
+      tx_messages_(0), tx_bytes_(0), rx_messages_(0), rx_bytes_(0),
+      encode_us_(0), decode_us_(0) {
     memset(&protocols_, 0, sizeof(protocols_));
-    protocols_[0].name = "webrtc-signaling";
+    protocols_[0].name = kJsonProtocol;
     protocols_[0].callback = WebSocketCallback;
     protocols_[0].per_session_data_size = 0;
     protocols_[0].rx_buffer_size = 65536;
+    protocols_[1] = protocols_[0];
+    protocols_[1].name = kCborProtocol;
 }
 
 // 析构函数：确保资源被释放
@@ -59,17 +87,33 @@ bool WebSocketSignalingClient::Connect(const std::string& url) {
 void WebSocketSignalingClient::Close() {
     StopWebSocketThread();
 
-    // 清空消息队列
-    {
-        std::lock_guard<std::mutex> lock(message_queue_mutex_);
-        std::queue<Message> empty;
-        std::swap(message_queue_, empty);
+    // lws线程退出后再停止分发线程，未处理的入站消息随之丢弃
+    dispatcher_.Stop();
+    const MessageAssembler::Stats& rx_stats = rx_assembler_.GetStats();
+    if (rx_stats.fragmented_messages > 0 || rx_stats.dropped_messages > 0) {
+        std::cout << "[INFO] Signaling reassembly stats: " << rx_stats.messages << " messages, "
+                  << rx_stats.fragmented_messages << " fragmented, " << rx_stats.dropped_messages
+                  << " dropped, largest " << rx_stats.max_message_size << " bytes" << std::endl;
     }
+    rx_assembler_.Reset();
+
+    SignalingDispatcher::Stats stats = dispatcher_.GetStats();
+    if (stats.dispatched > 0) {
+        std::cout << "[INFO] Signaling dispatch stats: " << stats.dispatched << " callbacks"
+                  << ", queue delay avg/max " << stats.avg_queue_delay_us << "/" << stats.max_queue_delay_us << " us"
+                  << ", callback avg/max " << stats.avg_callback_us << "/" << stats.max_callback_us << " us"
+                  << ", max pending " << stats.max_pending << std::endl;
+    }
+
+    // 清空消息队列
+    outbound_queue_.Clear();
+    server_supports_batching_ = false;
     
     is_connected_ = false;
     is_connecting_ = false;
     should_reconnect_ = false;
     reconnect_attempts_ = 0;
+    next_reconnect_us_ = 0;
 }
 
 // 使用正则表达式解析URL
@@ -95,8 +139,12 @@ bool WebSocketSignalingClient::StartWebSocketThread() {
     
     should_exit_ = false;
     is_connecting_ = true;
+
+    // 先启动分发线程，确保连接建立后的第一条消息就能被及时处理
+    dispatcher_.Start();
     
     websocket_thread_ = std::thread([this]() {
+        ThreadProfile::Instance().RegisterCurrentThread(ThreadProfile::Role::kSignalingIo, "sig-ws");
         if (!CreateWebSocketConnection()) {
             is_connecting_ = false;
             // ... 省略回调通知 ...
@@ -105,51 +153,15 @@ bool WebSocketSignalingClient::StartWebSocketThread() {
         
         // WebSocket事件主循环
         while (!should_exit_) {
-            lws_service(context_, 100);
+            // 等待重连期间上下文已销毁，只按循环末尾的间隔空转
+            if (context_) {
+                lws_service(context_, 100);
+            }
             
-            // 处理待发送的消息队列 (优化后的逻辑)
+            // 处理待发送的消息队列，并维持保活
             if (is_connected_ && websocket_connection_) {
-                std::queue<Message> messages_to_send;
-                {
-                    std::lock_guard<std::mutex> lock(message_queue_mutex_);
-                    if (!message_queue_.empty()) {
-                        std::swap(messages_to_send, message_queue_);
-                    }
-                }
-                
-                while (!messages_to_send.empty() && !should_exit_) {
-                    const auto& msg = messages_to_send.front();
-                    
-                    // 1. 构造最终的JSON对象
-                    Json::Value final_json = msg.content;
-                    final_json["type"] = MessageTypeToString(msg.type);
-                    {
-                        std::lock_guard<std::mutex> lock(info_mutex_);
-                        final_json["roomId"] = room_id_;
-                        if (!msg.target_id.empty()) {
-                            final_json["to"] = msg.target_id;
-                        }
-                    }
-                    
-                    // 2. 序列化并发送
-                    Json::StreamWriterBuilder writer;
-                    writer["indentation"] = "";
-                    std::string json_str = Json::writeString(writer, final_json);
-                    
-                    size_t len = json_str.length();
-                    unsigned char* buf = new unsigned char[LWS_PRE + len];
-                    memcpy(buf + LWS_PRE, json_str.c_str(), len);
-                    
-                    int ret = lws_write(websocket_connection_, buf + LWS_PRE, len, LWS_WRITE_TEXT);
-                    delete[] buf;
-                    
-                    if (ret < 0) { // 发送失败则重新入队
-                        std::lock_guard<std::mutex> lock(message_queue_mutex_);
-                        message_queue_.push(msg);
-                        break;
-                    }
-                    messages_to_send.pop();
-                }
+                FlushOutboundQueue();
+                CheckKeepalive();
             }
             
             // 检查是否需要重连
@@ -187,6 +199,7 @@ bool WebSocketSignalingClient::CreateWebSocketConnection() {
     memset(&info, 0, sizeof(info));
     info.port = CONTEXT_PORT_NO_LISTEN;
     info.protocols = protocols_;
+    info.extensions = compression_enabled_ ? kExtensions : nullptr;
     
     context_ = lws_create_context(&info);
     if (!context_) return false;
@@ -199,7 +212,8 @@ bool WebSocketSignalingClient::CreateWebSocketConnection() {
     connect_info.path = path_.c_str();
     connect_info.host = host_.c_str();
     connect_info.origin = host_.c_str();
-    connect_info.protocol = protocols_[0].name;
+    // JSON排在前面：不认识CBOR的旧服务器默认选第一个子协议，仍能正常工作
+    connect_info.protocol = binary_encoding_enabled_ ? "webrtc-signaling,webrtc-signaling-cbor" : kJsonProtocol;
     connect_info.ssl_connection = (scheme_ == "wss") ? LCCSCF_USE_SSL : 0;
     connect_info.opaque_user_data = this; // 关键：将this指针传递给lws
 
@@ -212,26 +226,116 @@ bool WebSocketSignalingClient::CreateWebSocketConnection() {
     return true;
 }
 
-// 尝试重连，有最大次数限制
+// 尝试重连。退避时间从500ms开始倍增，封顶max_reconnect_backoff_ms_，并加入随机抖动：
+// 网络短暂抖动后能在一秒内恢复，服务器长时间宕机时则以较低频率持续重试，
+// 恢复后各接收端也不会在同一时刻涌入。等待期间不阻塞lws线程，Close可以立即退出
 void WebSocketSignalingClient::TryReconnect() {
-    if (reconnect_attempts_ >= max_reconnect_attempts_) {
-        should_reconnect_ = false;
+    int64_t now_us = GetMonotonicTimeUs();
+    if (next_reconnect_us_ == 0) {
+        if (max_reconnect_attempts_ > 0 && reconnect_attempts_ >= max_reconnect_attempts_) {
+            std::cerr << "[WARN] Giving up reconnecting to signaling server after " << reconnect_attempts_
+                      << " attempts" << std::endl;
+            should_reconnect_ = false;
+            return;
+        }
+        reconnect_attempts_++;
+
+        if (context_) {
+            lws_context_destroy(context_);
+            context_ = nullptr;
+        }
+
+        int exponent = std::min(reconnect_attempts_ - 1, 16);
+        int backoff_ms = static_cast<int>(std::min<int64_t>(500LL << exponent, max_reconnect_backoff_ms_));
+        thread_local static std::mt19937 gen(std::random_device{}());
+        backoff_ms = std::uniform_int_distribution<int>(backoff_ms / 2, backoff_ms)(gen);
+        next_reconnect_us_ = now_us + static_cast<int64_t>(backoff_ms) * 1000;
+        std::cout << "[INFO] Reconnecting to signaling server in " << backoff_ms << " ms (attempt "
+                  << reconnect_attempts_;
+        if (max_reconnect_attempts_ > 0) {
+            std::cout << "/" << max_reconnect_attempts_;
+        }
+        std::cout << ")" << std::endl;
         return;
     }
-    reconnect_attempts_++;
-    
-    if (context_) {
-        lws_context_destroy(context_);
-        context_ = nullptr;
+    if (now_us < next_reconnect_us_) {
+        return;
     }
-    
-    std::this_thread::sleep_for(std::chrono::seconds(2));
+
+    next_reconnect_us_ = 0;
     is_connecting_ = true;
     if (!CreateWebSocketConnection()) {
         is_connecting_ = false;
     }
 }
 
+void WebSocketSignalingClient::SetReconnectPolicy(int max_attempts, int max_backoff_ms) {
+    max_reconnect_attempts_ = std::max(0, max_attempts);
+    max_reconnect_backoff_ms_ = std::max(500, max_backoff_ms);
+}
+
+void WebSocketSignalingClient::SetKeepalive(int interval_ms, int timeout_ms) {
+    keepalive_interval_ms_ = interval_ms;
+    keepalive_timeout_ms_ = timeout_ms;
+}
+
+// 周期性发送ping；若上一个ping超时仍未收到pong，说明NAT映射或链路已失效，
+// 不再等待TCP超时（可能长达数分钟），直接关闭连接触发重连
+void WebSocketSignalingClient::CheckKeepalive() {
+    if (keepalive_interval_ms_ <= 0) {
+        return;
+    }
+    int64_t now_us = GetMonotonicTimeUs();
+
+    if (ping_outstanding_) {
+        if (now_us - last_ping_sent_us_ > static_cast<int64_t>(keepalive_timeout_ms_) * 1000) {
+            std::cerr << "[WARN] Signaling keepalive timed out after " << keepalive_timeout_ms_
+                      << " ms, reconnecting" << std::endl;
+            ping_outstanding_ = false;
+            is_connected_ = false;
+            reconnect_attempts_ = 0;
+            lws_set_timeout(websocket_connection_, PENDING_TIMEOUT_USER_OK, LWS_TO_KILL_ASYNC);
+        }
+        return;
+    }
+
+    if (now_us - last_ping_sent_us_ < static_cast<int64_t>(keepalive_interval_ms_) * 1000) {
+        return;
+    }
+
+    // ping负载携带发送时间，pong原样返回后即可计算RTT
+    unsigned char buf[LWS_PRE + sizeof(int64_t)];
+    memcpy(buf + LWS_PRE, &now_us, sizeof(now_us));
+    if (lws_write(websocket_connection_, buf + LWS_PRE, sizeof(now_us), LWS_WRITE_PING) < 0) {
+        return;
+    }
+    last_ping_sent_us_ = now_us;
+    ping_outstanding_ = true;
+}
+
+void WebSocketSignalingClient::HandlePong(const void* data, size_t len) {
+    if (len != sizeof(int64_t)) {
+        return;
+    }
+    int64_t sent_us;
+    memcpy(&sent_us, data, sizeof(sent_us));
+    if (sent_us != last_ping_sent_us_) {
+        return; // 过期的pong
+    }
+    ping_outstanding_ = false;
+
+    int64_t rtt_us = GetMonotonicTimeUs() - sent_us;
+    last_rtt_us_ = rtt_us;
+    // 与TCP的SRTT相同的指数平滑（alpha = 1/8）
+    int64_t smoothed = smoothed_rtt_us_;
+    smoothed_rtt_us_ = smoothed < 0 ? rtt_us : smoothed + (rtt_us - smoothed) / 8;
+}
+
+int WebSocketSignalingClient::GetRttMs() const {
+    int64_t smoothed = smoothed_rtt_us_;
+    return smoothed < 0 ? -1 : static_cast<int>(smoothed / 1000);
+}
+
 // 公共接口：注册到房间
 bool WebSocketSignalingClient::Register(const std::string& room_id, const std::string& client_id) {
     // {
@@ -249,7 +353,6 @@ bool WebSocketSignalingClient::Register(const std::string& room_id, const std::s
     // 步骤 1：无论何时调用，都先把注册信息保存下来。
     {
         std::lock_guard<std::mutex> lock(info_mutex_);
-        room_id_ = room_id;
         // 如果外部没有提供client_id，我们才生成一个随机的。
         if (!client_id.empty()) {
             client_id_ = client_id;
@@ -257,6 +360,7 @@ bool WebSocketSignalingClient::Register(const std::string& room_id, const std::s
             client_id_ = GenerateRandomId();
         }
     }
+    rooms_.Add(room_id);
     
     // 步骤 2：【核心修改】检查当前是否已连接。
     // 如果还没连接，就不发送任何消息，仅仅保存信息并返回。
@@ -265,56 +369,98 @@ bool WebSocketSignalingClient::Register(const std::string& room_id, const std::s
         return true; // 因为信息已经成功保存，所以操作是“成功”的。
     }
     
-    // 步骤 3：如果已经连接（这是在连接成功后的自动回调中执行的路径），则发送注册消息。
+    // 步骤 3：如果已经连接，则发送注册消息。
     std::cout << "[INFO] Client is connected, sending register message now." << std::endl;
-    Json::Value content;
-    content["roomId"] = GetRoomId();
-    content["clientId"] = GetClientId();
-    
-    return SendMessage(MessageType::REGISTER, content);
+    return SendRegister(room_id);
+}
+
+// 公共接口：通过同一连接加入另一个房间
+bool WebSocketSignalingClient::JoinRoom(const std::string& room_id) {
+    if (room_id.empty()) {
+        return false;
+    }
+    if (!rooms_.Add(room_id)) {
+        return true; // 已在房间中
+    }
+    std::cout << "[INFO] Joining room " << room_id << std::endl;
+    if (!IsConnected()) {
+        return true; // 连接建立后由RegisterAllRooms加入
+    }
+    return SendRegister(room_id);
+}
+
+// 公共接口：离开一个房间
+bool WebSocketSignalingClient::LeaveRoom(const std::string& room_id) {
+    if (!rooms_.Remove(room_id)) {
+        std::cerr << "[WARN] Not a member of room " << room_id << std::endl;
+        return false;
+    }
+    std::cout << "[INFO] Leaving room " << room_id << std::endl;
+    if (!IsConnected()) {
+        return true;
+    }
+    return SendMessage(MessageType::LEAVE, Json::Value(Json::objectValue), "", room_id);
+}
+
+std::vector<std::string> WebSocketSignalingClient::GetRoomIds() const {
+    return rooms_.List();
+}
+
+bool WebSocketSignalingClient::SendRegister(const std::string& room_id) {
+    return SendMessage(MessageType::REGISTER, signaling_message::BuildRegister(room_id, GetClientId()), "", room_id);
+}
+
+void WebSocketSignalingClient::RegisterAllRooms() {
+    for (const auto& room_id : rooms_.List()) {
+        SendRegister(room_id);
+    }
 }
 
 // 公共接口：发送SDP Offer
-bool WebSocketSignalingClient::SendOffer(const std::string& sdp, const std::string& target_id) {
+bool WebSocketSignalingClient::SendOffer(const std::string& sdp, const std::string& target_id,
+                                         const std::string& room_id) {
     Json::Value content;
     content["sdp"] = sdp;
-    return SendMessage(MessageType::OFFER, content, target_id);
+    return SendMessage(MessageType::OFFER, content, target_id, room_id);
 }
 
 // 公共接口：发送SDP Answer
-bool WebSocketSignalingClient::SendAnswer(const std::string& sdp, const std::string& target_id) {
+bool WebSocketSignalingClient::SendAnswer(const std::string& sdp, const std::string& target_id,
+                                          const std::string& room_id) {
     Json::Value content;
     content["sdp"] = sdp;
-    return SendMessage(MessageType::ANSWER, content, target_id);
+    return SendMessage(MessageType::ANSWER, content, target_id, room_id);
 }
 
 // 公共接口：发送ICE Candidate
 bool WebSocketSignalingClient::SendCandidate(const std::string& sdp_mid, int sdp_mline_index,
-                                           const std::string& candidate, const std::string& target_id) {
+                                           const std::string& candidate, const std::string& target_id,
+                                           const std::string& room_id) {
     Json::Value content;
     content["candidate"] = candidate;
     content["sdpMid"] = sdp_mid;
     content["sdpMLineIndex"] = sdp_mline_index;
-    return SendMessage(MessageType::CANDIDATE, content, target_id);
+    return SendMessage(MessageType::CANDIDATE, content, target_id, room_id);
 }
 
-// 公共接口：发送离开消息
+// 公共接口：发送离开消息，每个房间各发一条
 bool WebSocketSignalingClient::SendLeave() {
-    Json::Value content; // 内容为空
-    return SendMessage(MessageType::LEAVE, content);
+    bool ok = true;
+    for (const auto& room_id : rooms_.List()) {
+        ok = SendMessage(MessageType::LEAVE, Json::Value(Json::objectValue), "", room_id) && ok;
+    }
+    return ok;
 }
 
 // 将消息放入队列，并请求lws进行一次写操作
-bool WebSocketSignalingClient::SendMessage(MessageType type, const Json::Value& content, const std::string& target_id) {
-    Message msg;
+bool WebSocketSignalingClient::SendMessage(MessageType type, const Json::Value& content, const std::string& target_id,
+                                           const std::string& room_id) {
+    OutboundMessage msg;
     msg.type = type;
     msg.content = content;
     msg.target_id = target_id;
-    
-    {
-        std::lock_guard<std::mutex> lock(message_queue_mutex_);
-        message_queue_.push(std::move(msg));
-    }
+    msg.room_id = room_id;
+    outbound_queue_.Push(std::move(msg));
     
     if (is_connected_ && websocket_connection_) {
         lws_callback_on_writable(websocket_connection_);
@@ -322,15 +468,63 @@ bool WebSocketSignalingClient::SendMessage(MessageType type, const Json::Value&
     return true;
 }
 
-// 处理从服务器接收到的消息
-void WebSocketSignalingClient::HandleReceivedMessage(const std::string& message) {
-    Json::CharReaderBuilder reader;
-    Json::Value json;
-    std::string errors;
-    std::istringstream message_stream(message);
+// 按优先级逐帧发送：SDP先于候选者，同一对端的候选者合并为一帧
+void WebSocketSignalingClient::FlushOutboundQueue() {
+    OutboundMessage msg;
+    while (!should_exit_ && outbound_queue_.Pop(&msg, server_supports_batching_)) {
+        if (!WriteMessage(msg)) { // 发送失败则放回队首，下一轮重试
+            outbound_queue_.PushFront(std::move(msg));
+            break;
+        }
+        outbound_queue_.OnSent(msg);
+    }
+}
+
+bool WebSocketSignalingClient::WriteMessage(const OutboundMessage& msg) {
+    int64_t encode_start_us = GetMonotonicTimeUs();
+
+    // 1. 序列化：协商了CBOR时使用二进制帧，否则使用JSON文本帧
+    bool binary = use_binary_;
+    std::string payload(LWS_PRE, '\0'); // 预留lws需要的头部空间，避免再次拷贝
+    signaling_message::Encode(msg, GetRoomId(), binary, &payload);
+    encode_us_ += GetMonotonicTimeUs() - encode_start_us;
     
-    if (!Json::parseFromStream(reader, message_stream, &json, &errors)) return;
-    if (!json.isMember("type") || !json["type"].isString()) return;
+    // 2. 发送
+    size_t len = payload.size() - LWS_PRE;
+    unsigned char* buf = reinterpret_cast<unsigned char*>(&payload[0]);
+    int ret = lws_write(websocket_connection_, buf + LWS_PRE, len, binary ? LWS_WRITE_BINARY : LWS_WRITE_TEXT);
+    if (ret < 0) {
+        return false;
+    }
+    tx_messages_++;
+    tx_bytes_ += len;
+    return true;
+}
+
+// 处理一个接收片段：大消息可能被拆成多次回调，只有最后一个片段到达时才解析
+void WebSocketSignalingClient::HandleReceivedFragment(struct lws* wsi, const char* data, size_t len) {
+    bool is_final = lws_is_final_fragment(wsi) && lws_remaining_packet_payload(wsi) == 0;
+    if (rx_assembler_.Append(data, len, is_final) == MessageAssembler::Result::kComplete) {
+        HandleReceivedMessage(rx_assembler_.TakeMessage(), lws_frame_is_binary(wsi) != 0);
+    }
+}
+
+// 处理从服务器接收到的消息：lws线程上只做投递，解析和回调都交给分发线程
+void WebSocketSignalingClient::HandleReceivedMessage(std::string message, bool binary) {
+    rx_messages_++;
+    rx_bytes_ += message.size();
+    dispatcher_.Post([this, message = std::move(message), binary]() {
+        DispatchReceivedMessage(message, binary);
+    });
+}
+
+// 在分发线程上解析消息并通知上层，这里允许执行阻塞的WebRTC调用
+void WebSocketSignalingClient::DispatchReceivedMessage(const std::string& message, bool binary) {
+    int64_t decode_start_us = GetMonotonicTimeUs();
+    Json::Value json;
+    if (!signaling_message::Decode(message.data(), message.size(), binary, &json)) return;
+    // 这是消息唯一的一次解析，上层回调直接使用解码结果
+    decode_us_ += GetMonotonicTimeUs() - decode_start_us;
     
     std::string type_str = json["type"].asString();
     
@@ -339,14 +533,64 @@ void WebSocketSignalingClient::HandleReceivedMessage(const std::string& message)
         std::lock_guard<std::mutex> lock(info_mutex_);
         client_id_ = json["clientId"].asString();
     }
+    // 服务器声明支持批量候选者后才启用合并，兼容旧版信令服务器
+    if (type_str == "register_success") {
+        server_supports_batching_ = signaling_message::SupportsCandidateBatching(json);
+    }
 
-    MessageType type = StringToMessageType(type_str);
+    MessageType type = signaling_message::TypeFromString(type_str);
     
-    // 通过回调将消息通知给上层业务逻辑
-    std::lock_guard<std::mutex> lock(callback_mutex_);
-    if (message_callback_) {
-        message_callback_(type, message);
+    // 通过回调将消息通知给上层业务逻辑。先拷贝回调再释放锁，
+    // 避免耗时回调期间阻塞SetMessageCallback等调用
+    MessageCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        callback = message_callback_;
+    }
+    if (callback) {
+        callback(type, json);
+    }
+}
+
+void WebSocketSignalingClient::PostStateChange(bool connected, const std::string& message) {
+    dispatcher_.Post([this, connected, message]() {
+        StateCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(callback_mutex_);
+            callback = state_callback_;
+        }
+        if (callback) {
+            callback(connected, message);
+        }
+    });
+}
+
+WebSocketSignalingClient::TrafficStats WebSocketSignalingClient::GetTrafficStats() const {
+    TrafficStats stats;
+    stats.tx_messages = tx_messages_;
+    stats.tx_bytes = tx_bytes_;
+    stats.rx_messages = rx_messages_;
+    stats.rx_bytes = rx_bytes_;
+    stats.encode_us = encode_us_;
+    stats.decode_us = decode_us_;
+    stats.binary = use_binary_;
+    return stats;
+}
+
+void WebSocketSignalingClient::ReportTrafficStats(const char* reason) {
+    TrafficStats stats = GetTrafficStats();
+    if (stats.tx_messages > 0 || stats.rx_messages > 0) {
+        std::cout << "[INFO] Signaling session " << reason << " (" << (stats.binary ? "cbor" : "json") << "): "
+                  << "tx " << stats.tx_messages << " msgs/" << stats.tx_bytes << " bytes, "
+                  << "rx " << stats.rx_messages << " msgs/" << stats.rx_bytes << " bytes, "
+                  << "encode " << stats.encode_us << " us, decode " << stats.decode_us << " us" << std::endl;
     }
+    tx_messages_ = 0;
+    tx_bytes_ = 0;
+    rx_messages_ = 0;
+    rx_bytes_ = 0;
+    encode_us_ = 0;
+    decode_us_ = 0;
 }
 
 // --- Getter/Setter ---
@@ -365,8 +609,7 @@ bool WebSocketSignalingClient::IsConnected() const {
 }
 
 std::string WebSocketSignalingClient::GetRoomId() const {
-    std::lock_guard<std::mutex> lock(info_mutex_);
-    return room_id_;
+    return rooms_.Primary();
 }
 
 std::string WebSocketSignalingClient::GetClientId() const {
@@ -374,6 +617,14 @@ std::string WebSocketSignalingClient::GetClientId() const {
     return client_id_;
 }
 
+void WebSocketSignalingClient::ForgetPeer(const std::string& target_id, const std::string& room_id) {
+    size_t dropped = outbound_queue_.DropPeer(target_id, room_id);
+    if (dropped > 0) {
+        std::cout << "[INFO] Dropped " << dropped << " pending candidate message(s) for closed peer "
+                  << target_id << std::endl;
+    }
+}
+
 // lws的静态回调函数，所有WebSocket事件的入口
 int WebSocketSignalingClient::WebSocketCallback(struct lws* wsi, enum lws_callback_reasons reason,
                                               void* user, void* in, size_t len) {
@@ -386,33 +637,41 @@ int WebSocketSignalingClient::WebSocketCallback(struct lws* wsi, enum lws_callba
 
     switch (reason) {
         case LWS_CALLBACK_CLIENT_ESTABLISHED:
+            instance->rx_assembler_.Reset();
+            {
+                // 服务器选中的子协议决定本次连接的编码方式
+                const struct lws_protocols* protocol = lws_get_protocol(wsi);
+                instance->use_binary_ = protocol && protocol->name && strcmp(protocol->name, kCborProtocol) == 0;
+            }
+            instance->ping_outstanding_ = false;
+            instance->last_ping_sent_us_ = GetMonotonicTimeUs();
             instance->is_connected_ = true;
             instance->is_connecting_ = false;
             instance->reconnect_attempts_ = 0;
             // 通知上层连接成功
-            {
-                std::lock_guard<std::mutex> lock(instance->callback_mutex_);
-                if (instance->state_callback_) instance->state_callback_(true, "Connected");
-            }
-            // 自动注册
-            instance->Register(instance->GetRoomId(), instance->GetClientId());
+            instance->PostStateChange(true, "Connected");
+            // 自动重新加入所有房间
+            instance->RegisterAllRooms();
             lws_callback_on_writable(wsi); // 请求发送
             break;
 
         case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
+        case LWS_CALLBACK_CLIENT_CLOSED:
         case LWS_CALLBACK_CLOSED:
             instance->is_connected_ = false;
             instance->is_connecting_ = false;
             if (!instance->should_exit_) instance->should_reconnect_ = true;
+            instance->ReportTrafficStats("closed");
             // 通知上层连接断开
-             {
-                std::lock_guard<std::mutex> lock(instance->callback_mutex_);
-                if (instance->state_callback_) instance->state_callback_(false, "Disconnected");
-            }
+            instance->PostStateChange(false, "Disconnected");
             break;
 
         case LWS_CALLBACK_CLIENT_RECEIVE:
-            instance->HandleReceivedMessage(std::string(static_cast<const char*>(in), len));
+            instance->HandleReceivedFragment(wsi, static_cast<const char*>(in), len);
+            break;
+
+        case LWS_CALLBACK_CLIENT_RECEIVE_PONG:
+            instance->HandlePong(in, len);
             break;
 
         case LWS_CALLBACK_CLIENT_WRITEABLE:
@@ -424,27 +683,3 @@ int WebSocketSignalingClient::WebSocketCallback(struct lws* wsi, enum lws_callba
     }
     return 0;
 }
-
-// --- 类型转换辅助函数 ---
-std::string WebSocketSignalingClient::MessageTypeToString(MessageType type) {
-    switch (type) {
-        case MessageType::REGISTER:    return "register";
-        case MessageType::OFFER:       return "offer";
-        case MessageType::ANSWER:      return "answer";
-        case MessageType::CANDIDATE:   return "candidate";
-        case MessageType::LEAVE:       return "leave";
-        default:                       return "unknown";
-    }
-}
-
-SignalingClient::MessageType WebSocketSignalingClient::StringToMessageType(const std::string& type_str) {
-        // [新逻辑] 把所有与注册、客户端状态相关的消息都暂时归为REGISTER类型
-    if (type_str == "register_success" || type_str == "client_exists" || type_str == "client_joined") {
-        return MessageType::REGISTER;
-    }
-    if (type_str == "offer") return MessageType::OFFER;
-    if (type_str == "answer") return MessageType::ANSWER;
-    if (type_str == "candidate") return MessageType::CANDIDATE;
-    if (type_str == "leave" || type_str == "client_left") return MessageType::LEAVE;
-    return MessageType::ERROR;
-}
\ No newline at end of file
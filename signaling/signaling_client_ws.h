@@ -1,8 +1,13 @@
 #pragma once
 #include "signaling_client.h"
+#include "signaling_dispatcher.h"
+#include "message_assembler.h"
+#include "outbound_message_queue.h"
+#include "room_membership.h"
 #include <libwebsockets.h>
 #include <json/json.h>
 #include <thread>
+#include <vector>
 #include <mutex>
 #include <queue>
 #include <atomic>
@@ -16,6 +21,19 @@
  */
 class WebSocketSignalingClient : public SignalingClient {
 public:
+    /**
+     * @brief 单个WebSocket会话（一次连接）的流量与编解码统计
+     */
+    struct TrafficStats {
+        uint64_t tx_messages = 0;
+        uint64_t tx_bytes = 0;     // 发送的消息负载字节数（压缩前）
+        uint64_t rx_messages = 0;
+        uint64_t rx_bytes = 0;     // 接收的消息负载字节数（解压后）
+        int64_t encode_us = 0;     // 序列化累计耗时
+        int64_t decode_us = 0;     // 反序列化累计耗时
+        bool binary = false;       // 是否协商了CBOR编码
+    };
+
     WebSocketSignalingClient();
     ~WebSocketSignalingClient() override;
 
@@ -23,27 +41,83 @@ public:
     bool Connect(const std::string& url) override;
     void Close() override;
     bool Register(const std::string& room_id, const std::string& client_id = "") override;
-    bool SendOffer(const std::string& sdp, const std::string& target_id = "") override;
-    bool SendAnswer(const std::string& sdp, const std::string& target_id = "") override;
+    bool JoinRoom(const std::string& room_id) override;
+    bool LeaveRoom(const std::string& room_id) override;
+    std::vector<std::string> GetRoomIds() const override;
+    bool SendOffer(const std::string& sdp, const std::string& target_id = "",
+                   const std::string& room_id = "") override;
+    bool SendAnswer(const std::string& sdp, const std::string& target_id = "",
+                    const std::string& room_id = "") override;
     bool SendCandidate(const std::string& sdp_mid, int sdp_mline_index,
-                      const std::string& candidate, const std::string& target_id = "") override;
+                      const std::string& candidate, const std::string& target_id = "",
+                      const std::string& room_id = "") override;
     bool SendLeave() override;
     void SetStateCallback(StateCallback callback) override;
     void SetMessageCallback(MessageCallback callback) override;
     bool IsConnected() const override;
     std::string GetRoomId() const override;
     std::string GetClientId() const override;
+    int GetRttMs() const override;
+    void ForgetPeer(const std::string& target_id, const std::string& room_id) override;
 
-private:
     /**
-     * @brief 消息结构体
+     * @brief 配置WebSocket保活
+     * 
+     * 每隔interval_ms发送一次ping，超过timeout_ms未收到pong即判定连接已死并立即重连。
+     * 需在Connect之前调用。
+     * @param interval_ms ping间隔（毫秒），0表示关闭保活
+     * @param timeout_ms pong超时（毫秒）
      */
-    struct Message {
-        MessageType type;
-        Json::Value content; // 直接存储JSON对象，而非字符串std::string content;
-        std::string target_id;
-    };
+    void SetKeepalive(int interval_ms, int timeout_ms);
+
+    /**
+     * @brief 配置断线重连策略，需在Connect之前调用
+     *
+     * 退避时间从500ms开始倍增，封顶max_backoff_ms，并在[一半, 全部]之间随机抖动，
+     * 避免大量接收端在服务器重启后同时重连。
+     * @param max_attempts 连续失败多少次后放弃，0表示无限重试（默认）
+     * @param max_backoff_ms 退避时间上限（毫秒），默认10秒
+     */
+    void SetReconnectPolicy(int max_attempts, int max_backoff_ms);
+
+    /**
+     * @brief 获取最近一次测得的往返时延
+     * @return RTT（毫秒），尚未测得时返回-1
+     */
+    int GetLastRttMs() const { return last_rtt_us_ < 0 ? -1 : static_cast<int>(last_rtt_us_ / 1000); }
+
+    /**
+     * @brief 获取入站消息分发统计（排队时延、回调耗时）
+     * @return 分发统计信息
+     */
+    SignalingDispatcher::Stats GetDispatchStats() const { return dispatcher_.GetStats(); }
+
+    /**
+     * @brief 设置单条入站消息的大小上限，需在Connect之前调用
+     * @param max_message_size 上限（字节）
+     */
+    void SetMaxMessageSize(size_t max_message_size) { rx_assembler_.SetMaxMessageSize(max_message_size); }
 
+    /**
+     * @brief 是否向服务器请求CBOR二进制编码子协议，需在Connect之前调用。
+     * 服务器不支持时自动回退到JSON文本。
+     * @param enabled 是否启用，默认启用
+     */
+    void SetBinaryEncoding(bool enabled) { binary_encoding_enabled_ = enabled; }
+
+    /**
+     * @brief 是否协商permessage-deflate压缩扩展，需在Connect之前调用
+     * @param enabled 是否启用，默认启用
+     */
+    void SetCompression(bool enabled) { compression_enabled_ = enabled; }
+
+    /**
+     * @brief 获取当前WebSocket会话的流量与编解码统计
+     * @return 统计信息
+     */
+    TrafficStats GetTrafficStats() const;
+
+private:
     /**
      * @brief 启动WebSocket客户端线程
      * @return 是否成功启动
@@ -73,21 +147,87 @@ private:
      * @param type 消息类型
      * @param content 消息内容
      * @param target_id 目标客户端ID（可选）
+     * @param room_id 所属房间（可选，为空时使用第一个房间）
      * @return 是否成功发送
      */
-    bool SendMessage(MessageType type, const Json::Value& content, const std::string& target_id = "");
+    bool SendMessage(MessageType type, const Json::Value& content, const std::string& target_id = "",
+                     const std::string& room_id = "");
+
+    /**
+     * @brief 发送某个房间的register消息
+     * @param room_id 房间ID
+     * @return 是否成功入队
+     */
+    bool SendRegister(const std::string& room_id);
+
+    /**
+     * @brief 连接建立后重新加入所有房间
+     */
+    void RegisterAllRooms();
+
+    /**
+     * @brief 把发送队列中当前可发的消息写入WebSocket（在lws线程调用）
+     */
+    void FlushOutboundQueue();
+
+    /**
+     * @brief 序列化一条消息并写成一个WebSocket帧
+     * @param msg 待发送消息
+     * @return 是否写入成功
+     */
+    bool WriteMessage(const OutboundMessage& msg);
     
     /**
-     * @brief 处理接收到的消息
+     * @brief 处理一个接收片段，消息完整后再交给HandleReceivedMessage
+     * @param wsi WebSocket实例
+     * @param data 片段数据
+     * @param len 片段长度
+     */
+    void HandleReceivedFragment(struct lws* wsi, const char* data, size_t len);
+
+    /**
+     * @brief 处理接收到的完整消息（在lws线程调用，仅投递给分发线程）
+     * @param message 消息内容
+     */
+    void HandleReceivedMessage(std::string message, bool binary);
+
+    /**
+     * @brief 解析消息并执行上层消息回调（在分发线程调用）
      * @param message 消息内容
+     * @param binary 是否为CBOR编码的二进制消息
+     */
+    void DispatchReceivedMessage(const std::string& message, bool binary);
+
+    /**
+     * @brief 输出并清零当前会话的流量统计
+     * @param reason 输出原因
+     */
+    void ReportTrafficStats(const char* reason);
+
+    /**
+     * @brief 将状态变化投递到分发线程，保证与消息回调的先后顺序
+     * @param connected 是否已连接
+     * @param message 状态描述
      */
-    void HandleReceivedMessage(const std::string& message);
+    void PostStateChange(bool connected, const std::string& message);
 
     /**
      * @brief 尝试重新连接
      */
     void TryReconnect();
 
+    /**
+     * @brief 发送保活ping并检查pong是否超时（在lws线程调用）
+     */
+    void CheckKeepalive();
+
+    /**
+     * @brief 处理收到的pong，计算RTT（在lws线程调用）
+     * @param data pong负载
+     * @param len 负载长度
+     */
+    void HandlePong(const void* data, size_t len);
+
     /**
      * @brief WebSocket回调函数
      * @param wsi WebSocket实例
@@ -100,20 +240,6 @@ private:
     static int WebSocketCallback(struct lws* wsi, enum lws_callback_reasons reason,
                                 void* user, void* in, size_t len);
 
-    /**
-     * @brief 将消息类型转换为字符串
-     * @param type 消息类型
-     * @return 类型字符串
-     */
-    static std::string MessageTypeToString(MessageType type);
-
-    /**
-     * @brief 将字符串转换为消息类型
-     * @param type_str 类型字符串
-     * @return 消息类型
-     */
-    static MessageType StringToMessageType(const std::string& type_str);
-
     // WebSocket相关
     std::string scheme_;
     std::string host_;
@@ -121,7 +247,7 @@ private:
     std::string path_;
     struct lws_context* context_;
     struct lws* websocket_connection_;
-    struct lws_protocols protocols_[2];  // 一个用于WebSocket，一个用于NULL终止
+    struct lws_protocols protocols_[3];  // JSON文本、CBOR二进制两个子协议，以及NULL终止
     std::thread websocket_thread_;
     std::atomic<bool> should_exit_;
 
@@ -130,14 +256,25 @@ private:
     std::atomic<bool> is_connecting_;
     std::atomic<bool> should_reconnect_;
     int reconnect_attempts_;
-    static const int max_reconnect_attempts_ = 5;
+    int max_reconnect_attempts_;     // 0表示无限重试
+    int max_reconnect_backoff_ms_;
+    int64_t next_reconnect_us_;      // 已安排的下次重连时间，0表示尚未安排（仅在lws线程访问）
+
+    // 保活与RTT（时间戳仅在lws线程访问）
+    int keepalive_interval_ms_;
+    int keepalive_timeout_ms_;
+    int64_t last_ping_sent_us_;   // 最近一次ping的发送时间
+    bool ping_outstanding_;       // 是否有尚未收到pong的ping
+    std::atomic<int64_t> last_rtt_us_;
+    std::atomic<int64_t> smoothed_rtt_us_;
 
-    // 消息队列
-    std::queue<Message> message_queue_;
-    std::mutex message_queue_mutex_;
+    // 发送队列：SDP优先，候选者按对端合并
+    OutboundMessageQueue outbound_queue_;
+    // 服务器是否支持批量候选者消息（由register_success中的capabilities告知）
+    std::atomic<bool> server_supports_batching_;
 
     // 房间和客户端信息
-    std::string room_id_;
+    RoomMembership rooms_;
     std::string client_id_;
     mutable std::mutex info_mutex_; // 标记为mutable以便在const方法中加锁
 
@@ -146,6 +283,25 @@ private:
     MessageCallback message_callback_;
     std::mutex callback_mutex_;
 
+    // 编码与压缩
+    bool binary_encoding_enabled_;
+    bool compression_enabled_;
+    std::atomic<bool> use_binary_;  // 当前连接是否协商了CBOR
+
+    // 流量统计（按连接重置）
+    std::atomic<uint64_t> tx_messages_;
+    std::atomic<uint64_t> tx_bytes_;
+    std::atomic<uint64_t> rx_messages_;
+    std::atomic<uint64_t> rx_bytes_;
+    std::atomic<int64_t> encode_us_;
+    std::atomic<int64_t> decode_us_;
+
+    // 入站消息重组（仅在lws线程访问）
+    MessageAssembler rx_assembler_;
+
+    // 入站消息分发器：上层回调在独立线程执行，不阻塞lws事件循环
+    SignalingDispatcher dispatcher_;
+
     // 实例映射（用于静态回调）
     static std::unordered_map<struct lws*, WebSocketSignalingClient*> instance_map_;
     static std::mutex instance_map_mutex_;
@@ -0,0 +1,192 @@
+#include "signaling_dispatcher.h"
+#include "../common/thread_profile.h"
+#include <iostream>
+#include <chrono>
+
+// 辅助函数：获取单调时钟时间（微秒）
+static int64_t GetMonotonicTimeUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 辅助函数：无锁地更新最大值
+template <typename T>
+static void UpdateMax(std::atomic<T>& target, T value) {
+    T current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+SignalingDispatcher::SignalingDispatcher()
+    : head_(&stub_), tail_(&stub_),
+      pending_(0), sleeping_(false),
+      running_(false), should_exit_(false),
+      dispatched_(0), max_pending_(0),
+      total_queue_delay_us_(0), max_queue_delay_us_(0),
+      total_callback_us_(0), max_callback_us_(0),
+      slow_callback_threshold_us_(50000) {  // 默认超过50ms告警
+}
+
+SignalingDispatcher::~SignalingDispatcher() {
+    Stop();
+    DrainAndDelete();
+}
+
+bool SignalingDispatcher::Start() {
+    if (running_) {
+        return false;
+    }
+    should_exit_ = false;
+    running_ = true;
+    thread_ = std::thread(&SignalingDispatcher::Run, this);
+    return true;
+}
+
+void SignalingDispatcher::Stop() {
+    if (!running_) {
+        return;
+    }
+    should_exit_ = true;
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+    // 如果在回调内部调用Stop（例如上层在回调中关闭信令），不能join自己
+    if (thread_.joinable()) {
+        if (IsCurrent()) {
+            thread_.detach();
+        } else {
+            thread_.join();
+        }
+    }
+    running_ = false;
+
+    // 丢弃尚未执行的任务
+    if (!IsCurrent()) {
+        DrainAndDelete();
+    }
+}
+
+void SignalingDispatcher::Post(Task task) {
+    Node* node = new Node();
+    node->task = std::move(task);
+    node->enqueue_time_us = GetMonotonicTimeUs();
+    Push(node);
+
+    uint64_t depth = pending_.fetch_add(1) + 1;
+    UpdateMax(max_pending_, depth);
+
+    // 只有分发线程处于休眠状态时才需要加锁唤醒，常态下投递完全无锁
+    if (sleeping_.load()) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+}
+
+bool SignalingDispatcher::IsCurrent() const {
+    return std::this_thread::get_id() == thread_.get_id();
+}
+
+SignalingDispatcher::Stats SignalingDispatcher::GetStats() const {
+    Stats stats;
+    stats.dispatched = dispatched_.load();
+    stats.pending = pending_.load();
+    stats.max_pending = max_pending_.load();
+    stats.max_queue_delay_us = max_queue_delay_us_.load();
+    stats.max_callback_us = max_callback_us_.load();
+    if (stats.dispatched > 0) {
+        stats.avg_queue_delay_us = total_queue_delay_us_.load() / static_cast<int64_t>(stats.dispatched);
+        stats.avg_callback_us = total_callback_us_.load() / static_cast<int64_t>(stats.dispatched);
+    }
+    return stats;
+}
+
+// 生产者：原子地把节点挂到队尾（可多线程并发调用）
+void SignalingDispatcher::Push(Node* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+}
+
+// 消费者：取出队首节点，仅允许分发线程（或线程停止后的清理逻辑）调用
+SignalingDispatcher::Node* SignalingDispatcher::Pop() {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+        if (!next) {
+            return nullptr;
+        }
+        tail_ = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next) {
+        tail_ = next;
+        return tail;
+    }
+    // 生产者已交换head_但尚未链接next，稍后重试
+    Node* head = head_.load(std::memory_order_acquire);
+    if (tail != head) {
+        return nullptr;
+    }
+    Push(&stub_);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next) {
+        tail_ = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+void SignalingDispatcher::DrainAndDelete() {
+    while (pending_.load() > 0) {
+        Node* node = Pop();
+        if (!node) {
+            std::this_thread::yield();
+            continue;
+        }
+        pending_.fetch_sub(1);
+        delete node;
+    }
+}
+
+// 分发线程主循环
+void SignalingDispatcher::Run() {
+    ThreadProfile::Instance().RegisterCurrentThread(ThreadProfile::Role::kDispatcher, "sig-dispatch");
+    while (!should_exit_) {
+        Node* node = Pop();
+        if (!node) {
+            if (pending_.load() > 0) {
+                // 生产者正在入队的中间状态，让出CPU后重试
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            sleeping_.store(true);
+            wake_cv_.wait(lock, [this]() { return pending_.load() > 0 || should_exit_; });
+            sleeping_.store(false);
+            continue;
+        }
+        pending_.fetch_sub(1);
+
+        int64_t start_us = GetMonotonicTimeUs();
+        int64_t queue_delay_us = start_us - node->enqueue_time_us;
+        if (node->task) {
+            node->task();
+        }
+        int64_t callback_us = GetMonotonicTimeUs() - start_us;
+        delete node;
+
+        dispatched_.fetch_add(1);
+        total_queue_delay_us_.fetch_add(queue_delay_us);
+        total_callback_us_.fetch_add(callback_us);
+        UpdateMax(max_queue_delay_us_, queue_delay_us);
+        UpdateMax(max_callback_us_, callback_us);
+
+        int64_t threshold = slow_callback_threshold_us_.load();
+        if (threshold > 0 && callback_us > threshold) {
+            std::cerr << "[WARN] Slow signaling callback: " << callback_us / 1000.0
+                      << " ms (queued " << queue_delay_us / 1000.0 << " ms)" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief 信令消息分发器
+ *
+ * 在独立线程上执行上层回调，使libwebsockets服务线程只负责收发数据，
+ * 不会被WebRTC的阻塞调用（如SetRemoteDescription）拖住，
+ * 从而保证ping/pong和待发送的候选者不受影响。
+ * 生产者通过无锁MPSC队列投递任务，分发线程按投递顺序依次执行。
+ */
+class SignalingDispatcher {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief 分发统计信息
+     */
+    struct Stats {
+        uint64_t dispatched = 0;         // 已执行的任务数
+        uint64_t pending = 0;            // 当前队列中等待的任务数
+        uint64_t max_pending = 0;        // 历史最大排队深度
+        int64_t avg_queue_delay_us = 0;  // 平均排队时延（投递到开始执行）
+        int64_t max_queue_delay_us = 0;  // 最大排队时延
+        int64_t avg_callback_us = 0;     // 平均回调执行耗时
+        int64_t max_callback_us = 0;     // 最大回调执行耗时
+    };
+
+    SignalingDispatcher();
+    ~SignalingDispatcher();
+
+    SignalingDispatcher(const SignalingDispatcher&) = delete;
+    SignalingDispatcher& operator=(const SignalingDispatcher&) = delete;
+
+    /**
+     * @brief 启动分发线程
+     * @return 是否成功启动（已在运行时返回false）
+     */
+    bool Start();
+
+    /**
+     * @brief 停止分发线程，尚未执行的任务将被丢弃
+     */
+    void Stop();
+
+    /**
+     * @brief 投递一个任务（可在任意线程调用，不会阻塞）
+     * @param task 要在分发线程上执行的任务
+     */
+    void Post(Task task);
+
+    /**
+     * @brief 当前调用是否发生在分发线程上
+     */
+    bool IsCurrent() const;
+
+    /**
+     * @brief 获取分发统计信息
+     */
+    Stats GetStats() const;
+
+    /**
+     * @brief 设置慢回调告警阈值，超过该耗时的回调会打印告警
+     * @param threshold_us 阈值（微秒），0表示关闭告警
+     */
+    void SetSlowCallbackThresholdUs(int64_t threshold_us) { slow_callback_threshold_us_ = threshold_us; }
+
+private:
+    // 无锁队列节点（Vyukov intrusive MPSC）
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        Task task;
+        int64_t enqueue_time_us = 0;
+    };
+
+    void Push(Node* node);
+    Node* Pop();
+    void DrainAndDelete();
+    void Run();
+
+    // 队列：生产者交换head_，唯一的消费者（分发线程）维护tail_
+    std::atomic<Node*> head_;
+    Node* tail_;
+    Node stub_;
+
+    // 唤醒机制：仅在分发线程空闲休眠时才使用互斥锁
+    std::atomic<uint64_t> pending_;
+    std::atomic<bool> sleeping_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<bool> should_exit_;
+
+    // 统计（仅分发线程写入）
+    std::atomic<uint64_t> dispatched_;
+    std::atomic<uint64_t> max_pending_;
+    std::atomic<int64_t> total_queue_delay_us_;
+    std::atomic<int64_t> max_queue_delay_us_;
+    std::atomic<int64_t> total_callback_us_;
+    std::atomic<int64_t> max_callback_us_;
+    std::atomic<int64_t> slow_callback_threshold_us_;
+};
@@ -0,0 +1,87 @@
+#include "signaling_message.h"
+#include "cbor_codec.h"
+#include <iostream>
+#include <memory>
+
+namespace signaling_message {
+
+std::string TypeToString(SignalingClient::MessageType type) {
+    using MessageType = SignalingClient::MessageType;
+    switch (type) {
+        case MessageType::REGISTER:    return "register";
+        case MessageType::OFFER:       return "offer";
+        case MessageType::ANSWER:      return "answer";
+        case MessageType::CANDIDATE:   return "candidate";
+        case MessageType::LEAVE:       return "leave";
+        default:                       return "unknown";
+    }
+}
+
+SignalingClient::MessageType TypeFromString(const std::string& type_str) {
+    using MessageType = SignalingClient::MessageType;
+    // 把所有与注册、客户端状态相关的消息都暂时归为REGISTER类型
+    if (type_str == "register_success" || type_str == "client_exists" || type_str == "client_joined") {
+        return MessageType::REGISTER;
+    }
+    if (type_str == "offer") return MessageType::OFFER;
+    if (type_str == "answer") return MessageType::ANSWER;
+    if (type_str == "candidate" || type_str == "candidates") return MessageType::CANDIDATE;
+    if (type_str == "leave" || type_str == "client_left") return MessageType::LEAVE;
+    return MessageType::ERROR;
+}
+
+void Encode(const OutboundMessage& msg, const std::string& room_id, bool binary, std::string* out) {
+    // 1. 构造最终的JSON对象
+    Json::Value final_json = msg.content;
+    final_json["type"] = msg.coalesced ? "candidates" : TypeToString(msg.type);
+    final_json["roomId"] = msg.room_id.empty() ? room_id : msg.room_id;
+    if (!msg.target_id.empty()) {
+        final_json["to"] = msg.target_id;
+    }
+
+    // 2. 序列化
+    if (binary) {
+        cbor::Encode(final_json, out);
+    } else {
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        out->append(Json::writeString(writer, final_json));
+    }
+}
+
+bool Decode(const char* data, size_t len, bool binary, Json::Value* json) {
+    if (binary) {
+        if (!cbor::Decode(reinterpret_cast<const uint8_t*>(data), len, json)) {
+            std::cerr << "Failed to decode CBOR signaling message (" << len << " bytes)" << std::endl;
+            return false;
+        }
+    } else {
+        Json::CharReaderBuilder builder;
+        std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+        std::string errors;
+        if (!reader->parse(data, data + len, json, &errors)) {
+            return false;
+        }
+    }
+    return json->isMember("type") && (*json)["type"].isString();
+}
+
+Json::Value BuildRegister(const std::string& room_id, const std::string& client_id) {
+    Json::Value content;
+    content["roomId"] = room_id;
+    content["clientId"] = client_id;
+    // 声明本端能够接收批量候选者消息
+    content["capabilities"].append("candidates");
+    return content;
+}
+
+bool SupportsCandidateBatching(const Json::Value& json) {
+    for (const auto& capability : json["capabilities"]) {
+        if (capability.isString() && capability.asString() == "candidates") {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace signaling_message
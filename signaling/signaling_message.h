@@ -0,0 +1,64 @@
+#pragma once
+#include "signaling_client.h"
+#include "outbound_message_queue.h"
+#include <json/json.h>
+#include <string>
+
+/**
+ * @brief 信令消息模型的公共部分
+ *
+ * WebSocket与本地IPC两种传输使用同一套消息格式：一个带"type"字段的JSON对象，
+ * 编码为JSON文本或CBOR。这里集中了消息类型与字符串的互相转换、
+ * 出站消息的组装以及入站消息的解码，保证各传输之间的行为一致。
+ */
+namespace signaling_message {
+
+/**
+ * @brief 将消息类型转换为字符串
+ * @param type 消息类型
+ * @return 类型字符串
+ */
+std::string TypeToString(SignalingClient::MessageType type);
+
+/**
+ * @brief 将字符串转换为消息类型
+ * @param type_str 类型字符串
+ * @return 消息类型
+ */
+SignalingClient::MessageType TypeFromString(const std::string& type_str);
+
+/**
+ * @brief 组装一条完整的出站消息并序列化
+ * @param msg 待发送消息
+ * @param room_id 消息未指定房间时使用的房间ID
+ * @param binary 是否编码为CBOR，否则为紧凑JSON文本
+ * @param out 输出缓冲区（追加写入，调用方可预留头部空间）
+ */
+void Encode(const OutboundMessage& msg, const std::string& room_id, bool binary, std::string* out);
+
+/**
+ * @brief 解码一条入站消息，结果直接交给上层回调，不再转换为JSON文本
+ * @param data 消息数据
+ * @param len 数据长度
+ * @param binary 是否为CBOR编码
+ * @param json 输出解析后的JSON对象
+ * @return 是否解码成功且包含字符串类型的"type"字段
+ */
+bool Decode(const char* data, size_t len, bool binary, Json::Value* json);
+
+/**
+ * @brief 构造加入房间的register消息内容
+ * @param room_id 房间ID
+ * @param client_id 客户端ID
+ * @return 消息内容
+ */
+Json::Value BuildRegister(const std::string& room_id, const std::string& client_id);
+
+/**
+ * @brief 判断register_success消息是否声明支持批量候选者
+ * @param json register_success消息
+ * @return 是否支持
+ */
+bool SupportsCandidateBatching(const Json::Value& json);
+
+}  // namespace signaling_message
@@ -5,6 +5,11 @@
  * 1. 客户端注册和房间管理
  * 2. SDP Offer/Answer/ICE Candidate 的一对一转发
  * 3. 连接状态管理
+ * 4. 批量候选者（"candidates"）转发，对不支持批量的客户端自动拆分
+ * 5. 子协议协商：webrtc-signaling（JSON文本）/ webrtc-signaling-cbor（CBOR二进制），
+ *    并支持permessage-deflate压缩
+ * 6. 一个连接可加入多个房间：已注册的连接再次register即加入另一个房间，
+ *    转发按消息中的roomId选择房间，leave带roomId时只离开该房间
  *
  * 使用方法：
  * 1. 安装依赖: npm install ws
@@ -14,6 +19,11 @@
 
 const WebSocket = require('ws');
 const http = require('http');
+const cbor = require('./cbor');
+
+// 子协议
+const JSON_PROTOCOL = 'webrtc-signaling';
+const CBOR_PROTOCOL = 'webrtc-signaling-cbor';
 
 // 默认端口
 const PORT = process.argv[2] || 8080;
@@ -24,19 +34,32 @@ const server = http.createServer((req, res) => {
     res.end('WebRTC Signaling Server\n');
 });
 
-// 创建WebSocket服务器
-const wss = new WebSocket.Server({ server });
+// 创建WebSocket服务器：优先选择CBOR子协议，并启用permessage-deflate
+// （小于threshold的消息不压缩，候选者这类短消息压缩得不偿失）
+const wss = new WebSocket.Server({
+    server,
+    perMessageDeflate: { threshold: 256 },
+    handleProtocols: (protocols) => {
+        if (protocols.has(CBOR_PROTOCOL)) return CBOR_PROTOCOL;
+        if (protocols.has(JSON_PROTOCOL)) return JSON_PROTOCOL;
+        return false;
+    }
+});
 
 // 房间和客户端管理
 const rooms = new Map(); // 房间ID -> Set<WebSocket>
 const clients = new Map(); // WebSocket -> ClientInfo
 
+// 服务器支持的扩展能力
+const SERVER_CAPABILITIES = ['candidates'];
+
 // 客户端信息结构
 class ClientInfo {
-    constructor(ws, clientId, roomId) {
+    constructor(ws, clientId, capabilities) {
         this.ws = ws;
         this.clientId = clientId;
-        this.roomId = roomId;
+        this.rooms = new Set(); // 已加入的房间ID
+        this.capabilities = new Set(Array.isArray(capabilities) ? capabilities : []);
         this.timestamp = Date.now();
     }
 }
@@ -47,13 +70,37 @@ function log(message) {
     console.log(`[${timestamp}] ${message}`);
 }
 
-// 发送消息
+// 每个连接的流量统计：WebSocket -> { txBytes, rxBytes, txMessages, rxMessages, encodeNs, decodeNs }
+const trafficStats = new Map();
+
+// 发送消息，按连接协商的子协议选择编码
 function sendMessage(ws, message) {
     if (ws.readyState === WebSocket.OPEN) {
-        ws.send(JSON.stringify(message));
+        const start = process.hrtime.bigint();
+        const payload = ws.protocol === CBOR_PROTOCOL ? cbor.encode(message) : JSON.stringify(message);
+        const stats = trafficStats.get(ws);
+        if (stats) {
+            stats.encodeNs += process.hrtime.bigint() - start;
+            stats.txMessages++;
+            stats.txBytes += Buffer.byteLength(payload);
+        }
+        ws.send(payload);
     }
 }
 
+// 解码收到的消息：二进制帧为CBOR，文本帧为JSON
+function decodeMessage(ws, data, isBinary) {
+    const start = process.hrtime.bigint();
+    const message = isBinary ? cbor.decode(data) : JSON.parse(data);
+    const stats = trafficStats.get(ws);
+    if (stats) {
+        stats.decodeNs += process.hrtime.bigint() - start;
+        stats.rxMessages++;
+        stats.rxBytes += data.length;
+    }
+    return message;
+}
+
 // 发送错误消息
 function sendError(ws, message) {
     sendMessage(ws, {
@@ -62,6 +109,14 @@ function sendError(ws, message) {
     });
 }
 
+// 确定消息所属的房间：优先使用消息中的roomId，只加入一个房间的客户端可以省略
+function resolveRoom(clientInfo, message) {
+    if (message.roomId) {
+        return clientInfo.rooms.has(message.roomId) ? message.roomId : null;
+    }
+    return clientInfo.rooms.size === 1 ? clientInfo.rooms.values().next().value : null;
+}
+
 // 转发消息给指定客户端
 function forwardTo(fromWs, message) {
     const fromClientInfo = clients.get(fromWs);
@@ -70,7 +125,7 @@ function forwardTo(fromWs, message) {
         return;
     }
 
-    const { roomId, clientId: fromClientId } = fromClientInfo;
+    const { clientId: fromClientId } = fromClientInfo;
     const toClientId = message.to;
 
     // **【修改点】确保所有需要转发的消息都有目标ID**
@@ -79,9 +134,12 @@ function forwardTo(fromWs, message) {
         return;
     }
 
-    const room = rooms.get(roomId);
+    const roomId = resolveRoom(fromClientInfo, message);
+    const room = roomId && rooms.get(roomId);
     if (!room) {
-        sendError(fromWs, `Room ${roomId} not found.`);
+        sendError(fromWs, message.roomId
+            ? `Room ${message.roomId} not found or not joined.`
+            : 'Room ID ("roomId") is required when joined to multiple rooms.');
         return;
     }
 
@@ -90,9 +148,16 @@ function forwardTo(fromWs, message) {
         const toClientInfo = clients.get(clientWs);
         if (toClientInfo && toClientInfo.clientId === toClientId) {
             if (clientWs.readyState === WebSocket.OPEN) {
-                // 为转发的消息添加发送方信息
-                const forwardedMessage = { ...message, from: fromClientId };
-                sendMessage(clientWs, forwardedMessage);
+                if (message.type === 'candidates' && !toClientInfo.capabilities.has('candidates')) {
+                    // 目标客户端不支持批量候选者，拆分成逐条的candidate消息
+                    for (const candidate of message.candidates || []) {
+                        sendMessage(clientWs, { ...candidate, type: 'candidate', roomId, to: toClientId, from: fromClientId });
+                    }
+                } else {
+                    // 为转发的消息添加发送方和房间信息
+                    const forwardedMessage = { ...message, roomId, from: fromClientId };
+                    sendMessage(clientWs, forwardedMessage);
+                }
                 found = true;
                 log(`Forwarded message type "${message.type}" from ${fromClientId} to ${toClientId} in room ${roomId}`);
             }
@@ -105,18 +170,22 @@ function forwardTo(fromWs, message) {
     }
 }
 
-// 处理注册请求
+// 处理注册请求：首次注册创建客户端，已注册的连接再次注册则加入另一个房间
 function handleRegister(ws, message) {
     const { roomId } = message;
-    const clientId = message.clientId || `client_${Date.now()}_${Math.floor(Math.random() * 1000)}`;
 
     if (!roomId) {
         sendError(ws, 'Room ID is required for registration.');
         return;
     }
 
-    const clientInfo = new ClientInfo(ws, clientId, roomId);
-    clients.set(ws, clientInfo);
+    let clientInfo = clients.get(ws);
+    if (!clientInfo) {
+        const clientId = message.clientId || `client_${Date.now()}_${Math.floor(Math.random() * 1000)}`;
+        clientInfo = new ClientInfo(ws, clientId, message.capabilities);
+        clients.set(ws, clientInfo);
+    }
+    const { clientId } = clientInfo;
 
     if (!rooms.has(roomId)) {
         rooms.set(roomId, new Set());
@@ -126,7 +195,7 @@ function handleRegister(ws, message) {
     // 通知新客户端，房间里已有的其他客户端
     for (const otherWs of room) {
         const otherClientInfo = clients.get(otherWs);
-        if(otherClientInfo) {
+        if (otherClientInfo && otherWs !== ws) {
             sendMessage(ws, {
                 type: 'client_exists',
                 clientId: otherClientInfo.clientId,
@@ -135,37 +204,38 @@ function handleRegister(ws, message) {
         }
     }
 
+    const isNewMember = !room.has(ws);
     room.add(ws);
-    log(`Client ${clientId} registered in room ${roomId}. Total clients in room: ${room.size}`);
+    clientInfo.rooms.add(roomId);
+    log(`Client ${clientId} registered in room ${roomId}. Total clients in room: ${room.size}, rooms joined: ${clientInfo.rooms.size}`);
 
     sendMessage(ws, {
         type: 'register_success', // 使用更明确的类型
         clientId: clientId,
         roomId: roomId,
+        capabilities: SERVER_CAPABILITIES,
         message: `Registered successfully in room ${roomId} as ${clientId}`
     });
 
     // 通知房间中的其他客户端有新人加入
-    for (const otherWs of room) {
-        if (otherWs !== ws) {
-            sendMessage(otherWs, {
-                type: 'client_joined',
-                clientId: clientId,
-                roomId: roomId
-            });
+    if (isNewMember) {
+        for (const otherWs of room) {
+            if (otherWs !== ws) {
+                sendMessage(otherWs, {
+                    type: 'client_joined',
+                    clientId: clientId,
+                    roomId: roomId
+                });
+            }
         }
     }
 }
 
-// 处理离开或断线
-function handleLeave(ws) {
-    const clientInfo = clients.get(ws);
-    if (!clientInfo) {
-        return; // 该客户端可能从未成功注册
-    }
-
-    const { roomId, clientId } = clientInfo;
+// 从一个房间中移除客户端
+function leaveRoom(ws, clientInfo, roomId) {
+    const { clientId } = clientInfo;
     const room = rooms.get(roomId);
+    clientInfo.rooms.delete(roomId);
 
     if (room) {
         room.delete(ws);
@@ -185,23 +255,45 @@ function handleLeave(ws) {
             }
         }
     }
-    clients.delete(ws);
+}
+
+// 处理离开或断线：指定roomId时只离开该房间，否则离开所有房间
+function handleLeave(ws, roomId) {
+    const clientInfo = clients.get(ws);
+    if (!clientInfo) {
+        return; // 该客户端可能从未成功注册
+    }
+
+    if (roomId) {
+        if (clientInfo.rooms.has(roomId)) {
+            leaveRoom(ws, clientInfo, roomId);
+        }
+    } else {
+        for (const joinedRoomId of [...clientInfo.rooms]) {
+            leaveRoom(ws, clientInfo, joinedRoomId);
+        }
+    }
+
+    if (clientInfo.rooms.size === 0) {
+        clients.delete(ws);
+    }
 }
 
 
 // WebSocket连接处理
 wss.on('connection', (ws) => {
-    log('New client connected.');
+    log(`New client connected (protocol: ${ws.protocol || 'none'}, extensions: ${ws.extensions || 'none'}).`);
+    trafficStats.set(ws, { txBytes: 0, rxBytes: 0, txMessages: 0, rxMessages: 0, encodeNs: 0n, decodeNs: 0n });
 
     // 处理消息
-    ws.on('message', (data) => {
+    ws.on('message', (data, isBinary) => {
         let message;
         try {
-            // **【修改点】增强JSON解析的错误处理**
-            message = JSON.parse(data);
+            // **【修改点】增强解析的错误处理**
+            message = decodeMessage(ws, data, isBinary);
         } catch (e) {
-            log(`Received invalid JSON from a client. Error: ${e.message}`);
-            sendError(ws, 'Invalid JSON format. Please send a valid JSON string.');
+            log(`Received invalid ${isBinary ? 'CBOR' : 'JSON'} from a client. Error: ${e.message}`);
+            sendError(ws, 'Invalid message format. Please send valid JSON text or CBOR binary.');
             return;
         }
 
@@ -220,11 +312,12 @@ wss.on('connection', (ws) => {
             case 'offer':
             case 'answer':
             case 'candidate':
+            case 'candidates':
                 forwardTo(ws, message);
                 break;
 
             case 'leave':
-                handleLeave(ws);
+                handleLeave(ws, message.roomId);
                 break;
                 
             default:
@@ -236,7 +329,15 @@ wss.on('connection', (ws) => {
 
     // 处理连接关闭
     ws.on('close', () => {
-        log('Client disconnected.');
+        const stats = trafficStats.get(ws);
+        if (stats) {
+            log(`Client disconnected. Session traffic (${ws.protocol || 'none'}): ` +
+                `tx ${stats.txMessages} msgs/${stats.txBytes} bytes, rx ${stats.rxMessages} msgs/${stats.rxBytes} bytes, ` +
+                `encode ${Number(stats.encodeNs / 1000n)} us, decode ${Number(stats.decodeNs / 1000n)} us`);
+            trafficStats.delete(ws);
+        } else {
+            log('Client disconnected.');
+        }
         handleLeave(ws);
     });
 
@@ -0,0 +1,93 @@
+// 信令消息的CBOR与JSON编解码耗时：./cbor_codec_bench [迭代次数]
+// 消息是一条约4KB的offer（与真实的H.264 recvonly offer大小相当），走signaling_message的编解码路径
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "signaling/outbound_message_queue.h"
+#include "signaling/signaling_message.h"
+
+namespace {
+
+std::string MakeOfferSdp() {
+    std::string sdp =
+        "v=0\r\no=- 4611731400430051336 2 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\n"
+        "a=group:BUNDLE 0 1\r\na=extmap-allow-mixed\r\na=msid-semantic: WMS\r\n"
+        "m=video 9 UDP/TLS/RTP/SAVPF 96 97 102 103\r\nc=IN IP4 0.0.0.0\r\na=rtcp:9 IN IP4 0.0.0.0\r\n"
+        "a=ice-ufrag:Jx4b\r\na=ice-pwd:3kTq0Ls9VfXo1R8c2pWmYzHa\r\na=ice-options:trickle\r\n"
+        "a=fingerprint:sha-256 6B:8B:5D:EA:59:04:20:23:29:C8:87:1C:CD:87:32:BE:DD:8C:66:A5:8E:50:55:EA:"
+        "8C:D3:B6:5C:09:5E:D6:BC\r\na=setup:actpass\r\na=mid:0\r\na=recvonly\r\na=rtcp-mux\r\na=rtcp-rsize\r\n";
+    const char* kProfiles[] = {"42001f", "42e01f", "4d001f", "640032"};
+    for (int pt = 96, i = 0; i < 4; ++i, pt += 2) {
+        const std::string p = std::to_string(pt);
+        sdp += "a=rtpmap:" + p + " H264/90000\r\na=rtcp-fb:" + p + " goog-remb\r\na=rtcp-fb:" + p +
+               " transport-cc\r\na=rtcp-fb:" + p + " ccm fir\r\na=rtcp-fb:" + p + " nack\r\na=rtcp-fb:" + p +
+               " nack pli\r\na=fmtp:" + p +
+               " level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=" + kProfiles[i] +
+               "\r\na=rtpmap:" + std::to_string(pt + 1) + " rtx/90000\r\na=fmtp:" + std::to_string(pt + 1) +
+               " apt=" + p + "\r\n";
+    }
+    sdp += "m=audio 9 UDP/TLS/RTP/SAVPF 111 63 9 0 8\r\nc=IN IP4 0.0.0.0\r\na=rtcp:9 IN IP4 0.0.0.0\r\n"
+           "a=mid:1\r\na=recvonly\r\na=rtcp-mux\r\na=rtpmap:111 opus/48000/2\r\na=rtcp-fb:111 transport-cc\r\n"
+           "a=fmtp:111 minptime=10;useinbandfec=1\r\na=rtpmap:63 red/48000/2\r\na=fmtp:63 111/111\r\n"
+           "a=rtpmap:9 G722/8000\r\na=rtpmap:0 PCMU/8000\r\na=rtpmap:8 PCMA/8000\r\n";
+    for (int i = 1; sdp.size() < 3830; ++i) {
+        sdp += "a=extmap:" + std::to_string(i) + " http://www.webrtc.org/experiments/rtp-hdrext/ext-" +
+               std::to_string(i) + "\r\n";
+    }
+    return sdp;
+}
+
+template <typename Fn>
+double RunUs(Fn fn, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20000;
+
+    OutboundMessage offer;
+    offer.type = SignalingClient::MessageType::OFFER;
+    offer.target_id = "rk3566-receiver-01";
+    offer.content["sdp"] = MakeOfferSdp();
+    offer.content["from"] = "browser-sender-7f3a";
+
+    std::string json_text;
+    std::string cbor_bytes;
+    signaling_message::Encode(offer, "room-1", false, &json_text);
+    signaling_message::Encode(offer, "room-1", true, &cbor_bytes);
+    std::cout << "[INFO] offer: " << json_text.size() << " bytes JSON, " << cbor_bytes.size() << " bytes CBOR"
+              << std::endl;
+
+    size_t checksum = 0;
+    for (bool binary : {false, true}) {
+        const std::string& encoded = binary ? cbor_bytes : json_text;
+        double encode_us = RunUs(
+            [&] {
+                std::string out;
+                signaling_message::Encode(offer, "room-1", binary, &out);
+                checksum += out.size();
+            },
+            iterations);
+        double decode_us = RunUs(
+            [&] {
+                Json::Value json;
+                if (signaling_message::Decode(encoded.data(), encoded.size(), binary, &json)) {
+                    checksum += json["sdp"].asString().size();
+                }
+            },
+            iterations);
+        std::cout << "[Timing] " << (binary ? "CBOR" : "JSON") << ": encode " << encode_us << " us, decode "
+                  << decode_us << " us" << std::endl;
+    }
+    return checksum > 0 ? 0 : 1;
+}
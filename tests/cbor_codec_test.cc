@@ -0,0 +1,142 @@
+// CBOR编解码：与cbor.js共用的测试向量（tests/fixtures/cbor_vectors.json），
+// 以及各种整数/浮点/嵌套值的往返、截断、多余字节、超大长度和过深嵌套的拒绝
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "signaling/cbor_codec.h"
+#include "tests/test_util.h"
+
+#ifndef CBOR_VECTORS_PATH
+#define CBOR_VECTORS_PATH "tests/fixtures/cbor_vectors.json"
+#endif
+
+namespace {
+
+std::string ToHex(const std::string& bytes) {
+    static const char kDigits[] = "0123456789abcdef";
+    std::string hex;
+    for (unsigned char c : bytes) {
+        hex.push_back(kDigits[c >> 4]);
+        hex.push_back(kDigits[c & 0xf]);
+    }
+    return hex;
+}
+
+std::string FromHex(const std::string& hex) {
+    std::string bytes;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        bytes.push_back(static_cast<char>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+    }
+    return bytes;
+}
+
+bool Decode(const std::string& bytes, Json::Value* out) {
+    return cbor::Decode(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size(), out);
+}
+
+std::string Encode(const Json::Value& value) {
+    std::string out;
+    cbor::Encode(value, &out);
+    return out;
+}
+
+// 编码后再解码，类型和值都应保持不变
+bool RoundTrips(const Json::Value& value) {
+    Json::Value decoded;
+    return Decode(Encode(value), &decoded) && decoded.type() == value.type() && decoded == value;
+}
+
+bool LoadVectors(const std::string& path, Json::Value* vectors) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    Json::CharReaderBuilder builder;
+    std::string errors;
+    return Json::parseFromStream(builder, file, vectors, &errors);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    // 1. 共用测试向量：编码结果逐字节一致，解码得到同样的值，非法输入全部拒绝
+    Json::Value vectors;
+    const std::string path = argc > 1 ? argv[1] : CBOR_VECTORS_PATH;
+    EXPECT_TRUE(LoadVectors(path, &vectors));
+    EXPECT_TRUE(vectors["valid"].size() > 0);
+    for (const auto& vector : vectors["valid"]) {
+        const std::string name = vector["name"].asString();
+        const std::string bytes = FromHex(vector["cbor"].asString());
+        EXPECT_EQ(vector["cbor"].asString(), ToHex(Encode(vector["value"])));
+        Json::Value decoded;
+        if (!Decode(bytes, &decoded) || !(decoded == vector["value"])) {
+            std::cerr << "valid vector not decoded: " << name << std::endl;
+            TestFailures()++;
+        }
+        // 任何截断的前缀都不是完整的值
+        for (size_t len = 0; len < bytes.size(); ++len) {
+            if (Decode(bytes.substr(0, len), &decoded)) {
+                std::cerr << "truncated vector accepted: " << name << " at " << len << " bytes" << std::endl;
+                TestFailures()++;
+                break;
+            }
+        }
+    }
+    for (const auto& vector : vectors["invalid"]) {
+        Json::Value decoded("untouched");
+        if (Decode(FromHex(vector["cbor"].asString()), &decoded)) {
+            std::cerr << "invalid vector accepted: " << vector["name"].asString() << std::endl;
+            TestFailures()++;
+        }
+        EXPECT_EQ(std::string("untouched"), decoded.asString());
+    }
+
+    // 2. 往返：整数边界、uint64、负数、浮点、嵌套
+    EXPECT_TRUE(RoundTrips(Json::Value(static_cast<Json::Int64>(0))));
+    EXPECT_TRUE(RoundTrips(Json::Value(std::numeric_limits<Json::Int64>::max())));
+    EXPECT_TRUE(RoundTrips(Json::Value(std::numeric_limits<Json::Int64>::min())));
+    EXPECT_TRUE(RoundTrips(Json::Value(static_cast<Json::Int64>(-24))));
+    EXPECT_TRUE(RoundTrips(Json::Value(static_cast<Json::Int64>(-25))));
+    EXPECT_TRUE(RoundTrips(Json::Value(std::numeric_limits<Json::UInt64>::max())));
+    EXPECT_EQ(std::string("1bffffffffffffffff"), ToHex(Encode(Json::Value(std::numeric_limits<Json::UInt64>::max()))));
+    EXPECT_EQ(std::string("3b7fffffffffffffff"), ToHex(Encode(Json::Value(std::numeric_limits<Json::Int64>::min()))));
+    EXPECT_TRUE(RoundTrips(Json::Value(0.0)));
+    EXPECT_TRUE(RoundTrips(Json::Value(-1.0e-300)));
+    EXPECT_TRUE(RoundTrips(Json::Value(3.141592653589793)));
+    EXPECT_TRUE(RoundTrips(Json::Value(std::numeric_limits<double>::infinity())));
+
+    Json::Value nested(Json::objectValue);
+    nested["sdp"] = std::string("v=0\r\n\0binary", 13);
+    nested["list"].append(static_cast<Json::Int64>(-7));
+    nested["list"].append(2.5);
+    nested["list"].append(Json::Value(Json::nullValue));
+    nested["list"].append(Json::Value(Json::objectValue));
+    nested["deep"]["er"]["est"] = true;
+    EXPECT_TRUE(RoundTrips(nested));
+
+    // 浮点的半精度/单精度形式也能解码（本端只编码双精度）
+    Json::Value decoded;
+    EXPECT_TRUE(Decode(FromHex("f93e00"), &decoded) && decoded.asDouble() == 1.5);
+    EXPECT_TRUE(Decode(FromHex("fa3fc00000"), &decoded) && decoded.asDouble() == 1.5);
+    EXPECT_TRUE(Decode(FromHex("f9fc00"), &decoded) && std::isinf(decoded.asDouble()) && decoded.asDouble() < 0);
+
+    // 3. 嵌套深度：64层以内可以，更深的拒绝
+    std::string depth_ok(64, static_cast<char>(0x81));
+    depth_ok.push_back(static_cast<char>(0x80));
+    EXPECT_TRUE(Decode(depth_ok, &decoded));
+    EXPECT_TRUE(!Decode(std::string(100000, static_cast<char>(0x81)) + std::string(1, static_cast<char>(0x80)),
+                        &decoded));
+    EXPECT_TRUE(!Decode(std::string(100000, static_cast<char>(0xa1)), &decoded));
+
+    // 4. 超大长度：声明的元素数远超数据时立即拒绝，不预先分配
+    EXPECT_TRUE(!Decode(FromHex("9bffffffffffffffff"), &decoded));
+    EXPECT_TRUE(!Decode(FromHex("bbffffffffffffffff"), &decoded));
+    EXPECT_TRUE(!Decode(FromHex("5bffffffffffffffff00"), &decoded));
+
+    return TestResult("cbor_codec_test");
+}
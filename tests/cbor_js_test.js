@@ -0,0 +1,45 @@
+// signaling/cbor.js 与C++端共用的测试向量：node tests/cbor_js_test.js [向量文件]
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const { encode, decode } = require('../signaling/cbor');
+
+const vectorsPath = process.argv[2] || path.join(__dirname, 'fixtures', 'cbor_vectors.json');
+const vectors = JSON.parse(fs.readFileSync(vectorsPath, 'utf8'));
+let failures = 0;
+
+function check(name, fn) {
+    try {
+        fn();
+    } catch (err) {
+        console.error(`${name}: ${err.message}`);
+        failures++;
+    }
+}
+
+for (const vector of vectors.valid) {
+    check(vector.name, () => {
+        assert.strictEqual(encode(vector.value).toString('hex'), vector.cbor);
+        assert.deepStrictEqual(decode(Buffer.from(vector.cbor, 'hex')), vector.value);
+    });
+}
+
+for (const vector of vectors.invalid) {
+    check(vector.name, () => {
+        assert.throws(() => decode(Buffer.from(vector.cbor, 'hex')));
+    });
+}
+
+// 仅JS端：超出安全整数的值拒绝，"__proto__"键拒绝以免原型污染
+check('uint64 beyond safe integer', () => {
+    assert.throws(() => decode(Buffer.from('1bffffffffffffffff', 'hex')));
+});
+check('__proto__ key', () => {
+    assert.throws(() => decode(Buffer.from('a1695f5f70726f746f5f5fa0', 'hex')));
+});
+
+if (failures > 0) {
+    console.log(`[FAIL] cbor_js_test: ${failures} failed check(s)`);
+    process.exit(1);
+}
+console.log('[PASS] cbor_js_test');
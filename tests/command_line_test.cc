@@ -0,0 +1,52 @@
+// 命令行解析：位置参数与--key=value，数值参数的严格校验
+#include <string>
+#include <vector>
+
+#include "common/command_line.h"
+#include "tests/test_util.h"
+
+namespace {
+
+CommandLine Parse(std::vector<std::string> args) {
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    return ParseCommandLine(static_cast<int>(argv.size()), argv.data());
+}
+
+}  // namespace
+
+int main() {
+    CommandLine cmd = Parse({"receiver", "ws://127.0.0.1:8080", "101", "--max-sessions=6", "--mlockall",
+                             "--vdec-capacity=120.5", "--config=a=b"});
+    EXPECT_EQ(static_cast<size_t>(2), cmd.positional.size());
+    EXPECT_TRUE(cmd.Has("mlockall"));
+    EXPECT_EQ(std::string(""), cmd.Get("mlockall"));
+    EXPECT_EQ(std::string("a=b"), cmd.Get("config"));
+    EXPECT_EQ(6, cmd.GetInt("max-sessions", 4));
+    EXPECT_EQ(4, cmd.GetInt("missing", 4));
+    EXPECT_EQ(120.5, cmd.GetDouble("vdec-capacity", 250));
+
+    std::string error;
+    EXPECT_TRUE(cmd.CheckNumbers({"max-sessions", "mlockall", "missing"}, {"vdec-capacity"}, &error));
+
+    // 非法数值：带单位、多余字符、越界、非数、前导空白
+    for (const char* bad : {"--max-sessions=4k", "--max-sessions=abc", "--max-sessions=99999999999",
+                            "--max-sessions=1.5", "--max-sessions= 4"}) {
+        CommandLine invalid = Parse({"receiver", bad});
+        error.clear();
+        EXPECT_TRUE(!invalid.CheckNumbers({"max-sessions"}, {}, &error));
+        EXPECT_TRUE(error.find("--max-sessions") != std::string::npos);
+        EXPECT_EQ(4, invalid.GetInt("max-sessions", 4));
+    }
+    CommandLine invalid = Parse({"receiver", "--vdec-capacity=nan"});
+    EXPECT_TRUE(!invalid.CheckNumbers({}, {"vdec-capacity"}, &error));
+
+    int value = 0;
+    EXPECT_TRUE(ParseInt("-5", &value));
+    EXPECT_EQ(-5, value);
+    EXPECT_TRUE(!ParseInt("", &value));
+
+    return TestResult("command_line_test");
+}
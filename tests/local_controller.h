@@ -0,0 +1,88 @@
+#pragma once
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+// 测试用的本地控制端：在抽象命名空间上监听SOCK_SEQPACKET，一次只服务一个连接
+class LocalController {
+public:
+    explicit LocalController(const std::string& name) : name_(name) { Listen(); }
+
+    ~LocalController() {
+        CloseConnection();
+        StopListening();
+    }
+
+    bool Listen() {
+        listen_fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path + 1, name_.data(), name_.size());
+        socklen_t addr_len = static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + 1 + name_.size());
+        if (bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), addr_len) < 0 || listen(listen_fd_, 4) < 0) {
+            close(listen_fd_);
+            listen_fd_ = -1;
+        }
+        return listen_fd_ >= 0;
+    }
+
+    // 模拟控制端退出：之后的连接请求都会失败，直到再次Listen
+    void StopListening() {
+        if (listen_fd_ >= 0) {
+            close(listen_fd_);
+            listen_fd_ = -1;
+        }
+    }
+
+    bool IsListening() const { return listen_fd_ >= 0; }
+    std::string Url() const { return "unix:@" + name_; }
+
+    // 等待客户端连接
+    bool Accept(int timeout_ms) {
+        CloseConnection();
+        if (!WaitReadable(listen_fd_, timeout_ms)) {
+            return false;
+        }
+        conn_fd_ = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        return conn_fd_ >= 0;
+    }
+
+    void CloseConnection() {
+        if (conn_fd_ >= 0) {
+            close(conn_fd_);
+            conn_fd_ = -1;
+        }
+    }
+
+    bool Send(const std::string& message) {
+        return send(conn_fd_, message.data(), message.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(message.size());
+    }
+
+    // 读取一条完整消息
+    bool Receive(std::string* message, int timeout_ms) {
+        if (!WaitReadable(conn_fd_, timeout_ms)) {
+            return false;
+        }
+        ssize_t len = recv(conn_fd_, nullptr, 0, MSG_PEEK | MSG_TRUNC);
+        if (len <= 0) {
+            return false;
+        }
+        message->resize(static_cast<size_t>(len));
+        return recv(conn_fd_, &(*message)[0], message->size(), 0) == len;
+    }
+
+private:
+    static bool WaitReadable(int fd, int timeout_ms) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        return fd >= 0 && poll(&pfd, 1, timeout_ms) > 0;
+    }
+
+    std::string name_;
+    int listen_fd_ = -1;
+    int conn_fd_ = -1;
+};
@@ -0,0 +1,75 @@
+// 重组约100KB的SDP：MessageAssembler对比逐条新建字符串再追加的旧做法
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "signaling/message_assembler.h"
+
+namespace {
+
+std::string MakeLargeSdp() {
+    std::string sdp = "v=0\r\no=- 1 2 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\n";
+    for (int i = 0; sdp.size() < 100 * 1024; ++i) {
+        sdp += "a=candidate:" + std::to_string(i) + " 1 udp 2122260223 192.168.1." + std::to_string(i % 250) +
+               " " + std::to_string(50000 + i) + " typ host generation 0 network-id 1\r\n";
+    }
+    return sdp;
+}
+
+// 旧做法：每个片段构造一个临时字符串，再追加到每条消息新建的缓冲区
+class StringAppendAssembler {
+public:
+    bool Append(const char* data, size_t len, bool is_final) {
+        pending_ += std::string(data, len);
+        if (!is_final) {
+            return false;
+        }
+        message_ = std::move(pending_);
+        pending_ = std::string();
+        return true;
+    }
+    std::string TakeMessage() { return std::move(message_); }
+
+private:
+    std::string pending_;
+    std::string message_;
+};
+
+template <typename Assembler, typename IsComplete>
+double RunUs(Assembler* assembler, IsComplete is_complete, const std::string& sdp, size_t fragment_size,
+             int iterations, size_t* checksum) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        for (size_t offset = 0; offset < sdp.size(); offset += fragment_size) {
+            size_t len = std::min(fragment_size, sdp.size() - offset);
+            if (is_complete(assembler->Append(sdp.data() + offset, len, offset + len == sdp.size()))) {
+                *checksum += assembler->TakeMessage().size();
+            }
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2000;
+    const std::string sdp = MakeLargeSdp();
+    size_t checksum = 0;
+
+    for (size_t fragment_size : {size_t(4096), size_t(1400), size_t(sdp.size())}) {
+        MessageAssembler assembler(1024 * 1024);
+        StringAppendAssembler baseline;
+        double assembler_us = RunUs(
+            &assembler, [](MessageAssembler::Result r) { return r == MessageAssembler::Result::kComplete; }, sdp,
+            fragment_size, iterations, &checksum);
+        double baseline_us = RunUs(&baseline, [](bool complete) { return complete; }, sdp, fragment_size,
+                                   iterations, &checksum);
+        std::cout << "[Timing] " << sdp.size() << " byte SDP in " << fragment_size << " byte fragments: "
+                  << "assembler " << assembler_us << " us, string-append " << baseline_us << " us" << std::endl;
+    }
+    return checksum > 0 ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+// 信令消息重组：大消息多片段拼接、单片段快速路径、超限丢弃后恢复
+#include <algorithm>
+#include <string>
+
+#include "signaling/message_assembler.h"
+#include "tests/test_util.h"
+
+namespace {
+
+// 约100KB的SDP：大量候选者和编解码参数行
+std::string MakeLargeSdp() {
+    std::string sdp = "v=0\r\no=- 1 2 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\n";
+    for (int i = 0; sdp.size() < 100 * 1024; ++i) {
+        sdp += "a=candidate:" + std::to_string(i) + " 1 udp 2122260223 192.168.1." + std::to_string(i % 250) +
+               " " + std::to_string(50000 + i) + " typ host generation 0 network-id 1\r\n";
+    }
+    return sdp;
+}
+
+// 按fragment_size切片逐个追加，返回最后一个片段的结果
+MessageAssembler::Result AppendInFragments(MessageAssembler* assembler, const std::string& message,
+                                           size_t fragment_size) {
+    MessageAssembler::Result result = MessageAssembler::Result::kIncomplete;
+    for (size_t offset = 0; offset < message.size(); offset += fragment_size) {
+        size_t len = std::min(fragment_size, message.size() - offset);
+        bool is_final = offset + len == message.size();
+        result = assembler->Append(message.data() + offset, len, is_final);
+        if (!is_final) {
+            EXPECT_TRUE(result == MessageAssembler::Result::kIncomplete);
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+int main() {
+    const std::string sdp = MakeLargeSdp();
+
+    // 多片段大消息：按lws默认的4KB接收缓冲区切片
+    MessageAssembler assembler(256 * 1024);
+    EXPECT_TRUE(AppendInFragments(&assembler, sdp, 4096) == MessageAssembler::Result::kComplete);
+    EXPECT_TRUE(assembler.TakeMessage() == sdp);
+
+    // 单片段消息走快速路径
+    const std::string small = "{\"type\":\"ping\"}";
+    EXPECT_TRUE(assembler.Append(small.data(), small.size(), true) == MessageAssembler::Result::kComplete);
+    EXPECT_EQ(small, assembler.TakeMessage());
+
+    // 不按4KB对齐的片段大小，最后一个片段较短
+    EXPECT_TRUE(AppendInFragments(&assembler, sdp, 1021) == MessageAssembler::Result::kComplete);
+    EXPECT_TRUE(assembler.TakeMessage() == sdp);
+
+    // 超限：整条消息丢弃，之后的消息不受影响
+    MessageAssembler limited(64 * 1024);
+    EXPECT_TRUE(AppendInFragments(&limited, sdp, 4096) == MessageAssembler::Result::kDropped);
+    EXPECT_TRUE(limited.TakeMessage().empty());
+    EXPECT_TRUE(limited.Append(small.data(), small.size(), true) == MessageAssembler::Result::kComplete);
+    EXPECT_EQ(small, limited.TakeMessage());
+    const std::string medium = sdp.substr(0, 60 * 1024);
+    EXPECT_TRUE(AppendInFragments(&limited, medium, 4096) == MessageAssembler::Result::kComplete);
+    EXPECT_TRUE(limited.TakeMessage() == medium);
+
+    // 断开时Reset丢弃半条消息，下一条从头开始
+    limited.Append(sdp.data(), 100, false);
+    limited.Reset();
+    EXPECT_TRUE(limited.Append(small.data(), small.size(), true) == MessageAssembler::Result::kComplete);
+    EXPECT_EQ(small, limited.TakeMessage());
+
+    const MessageAssembler::Stats& stats = assembler.GetStats();
+    EXPECT_EQ(static_cast<uint64_t>(3), stats.messages);
+    EXPECT_EQ(static_cast<uint64_t>(2), stats.fragmented_messages);
+    EXPECT_EQ(sdp.size(), stats.max_message_size);
+    EXPECT_EQ(static_cast<uint64_t>(1), limited.GetStats().dropped_messages);
+    EXPECT_EQ(static_cast<uint64_t>(3), limited.GetStats().messages);
+
+    return TestResult("message_assembler_test");
+}
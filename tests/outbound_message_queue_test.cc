@@ -0,0 +1,103 @@
+// 发送队列：候选者在对端SDP发出前暂存，会话关闭或等待过久时丢弃，容量有上限
+#include <string>
+
+#include "signaling/outbound_message_queue.h"
+#include "tests/test_util.h"
+
+namespace {
+
+OutboundMessage Candidate(const std::string& target_id, const std::string& room_id, int index) {
+    OutboundMessage message;
+    message.type = SignalingClient::MessageType::CANDIDATE;
+    message.content["candidate"] = "candidate:" + std::to_string(index);
+    message.target_id = target_id;
+    message.room_id = room_id;
+    return message;
+}
+
+OutboundMessage Answer(const std::string& target_id, const std::string& room_id) {
+    OutboundMessage message;
+    message.type = SignalingClient::MessageType::ANSWER;
+    message.content["sdp"] = "v=0";
+    message.target_id = target_id;
+    message.room_id = room_id;
+    return message;
+}
+
+}  // namespace
+
+int main() {
+    OutboundMessage out;
+
+    // SDP发出前候选者被暂存，发出后合并成一条
+    {
+        OutboundMessageQueue queue;
+        queue.Push(Candidate("alice", "room", 0));
+        queue.Push(Candidate("alice", "room", 1));
+        EXPECT_TRUE(!queue.Pop(&out, true));
+        queue.Push(Answer("alice", "room"));
+        EXPECT_TRUE(queue.Pop(&out, true));
+        EXPECT_TRUE(out.type == SignalingClient::MessageType::ANSWER);
+        EXPECT_TRUE(queue.Pop(&out, true));
+        EXPECT_TRUE(out.coalesced);
+        EXPECT_EQ(2u, out.content["candidates"].size());
+        EXPECT_TRUE(queue.Empty());
+    }
+
+    // 会话关闭：暂存的候选者被丢弃，其他对端不受影响
+    {
+        OutboundMessageQueue queue;
+        queue.Push(Candidate("alice", "room", 0));
+        queue.Push(Candidate("alice", "room", 1));
+        queue.Push(Candidate("bob", "room", 2));
+        queue.Push(Candidate("alice", "other", 3));
+        EXPECT_EQ(static_cast<size_t>(2), queue.DropPeer("alice", "room"));
+        EXPECT_EQ(static_cast<size_t>(0), queue.DropPeer("alice", "room"));
+        queue.Push(Answer("bob", "room"));
+        queue.Pop(&out, true);
+        EXPECT_TRUE(queue.Pop(&out, true));
+        EXPECT_EQ(std::string("bob"), out.target_id);
+        EXPECT_TRUE(!queue.Pop(&out, true));
+        EXPECT_TRUE(!queue.Empty());
+    }
+
+    // 会话关闭后同名对端重新协商：新会话的候选者要等新的SDP发出
+    {
+        OutboundMessageQueue queue;
+        queue.Push(Answer("alice", "room"));
+        queue.Pop(&out, true);
+        queue.OnSent(out);
+        queue.DropPeer("alice", "room");
+        queue.Push(Candidate("alice", "room", 0));
+        EXPECT_TRUE(!queue.Pop(&out, true));
+    }
+
+    // 等待过久的暂存候选者在取出时被丢弃
+    {
+        OutboundMessageQueue queue;
+        OutboundMessage stale = Candidate("alice", "room", 0);
+        stale.enqueued_us = 1;
+        queue.Push(std::move(stale));
+        queue.Push(Candidate("alice", "room", 1));
+        EXPECT_TRUE(!queue.Pop(&out, true));
+        queue.Push(Answer("alice", "room"));
+        queue.Pop(&out, true);
+        EXPECT_TRUE(queue.Pop(&out, true));
+        EXPECT_TRUE(!out.coalesced);
+        EXPECT_EQ(std::string("candidate:1"), out.content["candidate"].asString());
+        EXPECT_TRUE(queue.Empty());
+    }
+
+    // 容量上限：满了以后丢弃最早暂存的候选者
+    {
+        OutboundMessageQueue queue;
+        const int total = static_cast<int>(OutboundMessageQueue::kMaxQueuedCandidates) + 10;
+        for (int i = 0; i < total; ++i) {
+            queue.Push(Candidate("ghost", "room", i));
+        }
+        EXPECT_EQ(OutboundMessageQueue::kMaxQueuedCandidates, queue.DropPeer("ghost", "room"));
+        EXPECT_TRUE(queue.Empty());
+    }
+
+    return TestResult("outbound_message_queue_test");
+}
@@ -0,0 +1,54 @@
+// 联播层解析：远端SDP中的畸形a=simulcast组（空组、只有"~"的rid）被忽略而不是导致崩溃
+#include <string>
+#include <vector>
+
+#include "tests/test_util.h"
+#include "webrtc/sdp_utils.h"
+
+namespace {
+
+std::string OfferWithSimulcast(const std::string& simulcast) {
+    return "v=0\r\n"
+           "m=video 9 UDP/TLS/RTP/SAVPF 96\r\n"
+           "a=rtpmap:96 H264/90000\r\n"
+           "a=rid:hi send max-width=1920;max-height=1080\r\n"
+           "a=rid:lo send max-width=640;max-height=360\r\n"
+           "a=simulcast:send " + simulcast + "\r\n";
+}
+
+std::vector<std::string> LayerRids(const std::string& simulcast) {
+    std::vector<std::string> rids;
+    for (const auto& layer : sdp_utils::GetSimulcastLayers(OfferWithSimulcast(simulcast))) {
+        rids.push_back(layer.rid);
+    }
+    return rids;
+}
+
+}  // namespace
+
+int main() {
+    // 正常情况：按声明顺序，带max-width，暂停前缀被去掉
+    std::vector<sdp_utils::SimulcastLayer> layers = sdp_utils::GetSimulcastLayers(OfferWithSimulcast("hi;~lo"));
+    EXPECT_EQ(static_cast<size_t>(2), layers.size());
+    if (layers.size() == 2) {
+        EXPECT_EQ(std::string("hi"), layers[0].rid);
+        EXPECT_EQ(1920, layers[0].max_width);
+        EXPECT_EQ(std::string("lo"), layers[1].rid);
+        EXPECT_EQ(360, layers[1].max_height);
+    }
+
+    // 备选rid：取组内第一个有效的
+    EXPECT_TRUE(LayerRids("~,hi;lo") == std::vector<std::string>({"hi", "lo"}));
+
+    // 畸形组：没有rid的组和只有"~"的rid被跳过
+    EXPECT_TRUE(LayerRids(",;hi") == std::vector<std::string>({"hi"}));
+    EXPECT_TRUE(LayerRids("~;lo") == std::vector<std::string>({"lo"}));
+    EXPECT_TRUE(LayerRids(",,;~;~,~").empty());
+    EXPECT_TRUE(LayerRids("").empty());
+
+    // 首选层改写同样不受畸形组影响
+    std::string rewritten = sdp_utils::PreferSimulcastLayer(OfferWithSimulcast(",;~;hi;lo"), "lo");
+    EXPECT_TRUE(rewritten.find("a=simulcast:send lo;") != std::string::npos);
+
+    return TestResult("sdp_utils_test");
+}
@@ -0,0 +1,163 @@
+// UnixSocketSignalingClient在回环SEQPACKET上的行为：消息边界、超大消息丢弃、断线重连与积压补发
+#include <unistd.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+
+#include "signaling/cbor_codec.h"
+#include "signaling/signaling_client_ipc.h"
+#include "tests/local_controller.h"
+#include "tests/test_util.h"
+
+namespace {
+
+const int kTimeoutMs = 3000;
+
+// 收集分发线程上的回调，测试线程按顺序等待
+class Events {
+public:
+    void OnState(bool connected) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        states_.push_back(connected);
+        cond_.notify_all();
+    }
+
+    void OnMessage(const Json::Value& message) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        messages_.push_back(message);
+        cond_.notify_all();
+    }
+
+    bool WaitState(bool connected) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cond_.wait_for(lock, std::chrono::milliseconds(kTimeoutMs), [this] { return !states_.empty(); })) {
+            return false;
+        }
+        bool state = states_.front();
+        states_.pop_front();
+        return state == connected;
+    }
+
+    bool WaitMessage(Json::Value* message) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cond_.wait_for(lock, std::chrono::milliseconds(kTimeoutMs), [this] { return !messages_.empty(); })) {
+            return false;
+        }
+        *message = messages_.front();
+        messages_.pop_front();
+        return true;
+    }
+
+    size_t PendingMessages() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return messages_.size();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<bool> states_;
+    std::deque<Json::Value> messages_;
+};
+
+std::string ToJson(const Json::Value& value) {
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    return Json::writeString(writer, value);
+}
+
+Json::Value Parse(const std::string& message) {
+    Json::Value json;
+    if (!message.empty() && message[0] == '{') {
+        Json::CharReaderBuilder builder;
+        std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+        std::string errors;
+        reader->parse(message.data(), message.data() + message.size(), &json, &errors);
+    } else {
+        cbor::Decode(reinterpret_cast<const uint8_t*>(message.data()), message.size(), &json);
+    }
+    return json;
+}
+
+Json::Value MakeAnswer(const std::string& sdp) {
+    Json::Value answer;
+    answer["type"] = "answer";
+    answer["roomId"] = "room-1";
+    answer["from"] = "controller";
+    answer["sdp"] = sdp;
+    return answer;
+}
+
+}  // namespace
+
+int main() {
+    LocalController controller("rk-ipc-test-" + std::to_string(getpid()));
+    EXPECT_TRUE(controller.IsListening());
+
+    Events events;
+    UnixSocketSignalingClient client;
+    client.SetMaxMessageSize(64 * 1024);
+    client.SetStateCallback([&events](bool connected, const std::string&) { events.OnState(connected); });
+    client.SetMessageCallback(
+        [&events](SignalingClient::MessageType, const Json::Value& message) { events.OnMessage(message); });
+    EXPECT_TRUE(UnixSocketSignalingClient::IsUnixSocketUrl(controller.Url()));
+    EXPECT_TRUE(client.Register("room-1", "receiver-1"));
+    EXPECT_TRUE(client.Connect(controller.Url()));
+
+    // 1. 连接后自动注册，一次recv恰好是一条完整消息
+    EXPECT_TRUE(controller.Accept(kTimeoutMs));
+    EXPECT_TRUE(events.WaitState(true));
+    std::string received;
+    EXPECT_TRUE(controller.Receive(&received, kTimeoutMs));
+    Json::Value json = Parse(received);
+    EXPECT_EQ(std::string("register"), json["type"].asString());
+    EXPECT_EQ(std::string("room-1"), json["roomId"].asString());
+
+    // 2. 连续发送的消息各自独立到达，JSON与CBOR混用，接近上限的大消息完整到达
+    const std::string large_sdp(60 * 1024, 'a');
+    EXPECT_TRUE(controller.Send(ToJson(MakeAnswer("small"))));
+    std::string cbor_answer;
+    cbor::Encode(MakeAnswer(large_sdp), &cbor_answer);
+    EXPECT_TRUE(controller.Send(cbor_answer));
+    EXPECT_TRUE(events.WaitMessage(&json));
+    EXPECT_EQ(std::string("small"), json["sdp"].asString());
+    EXPECT_TRUE(events.WaitMessage(&json));
+    EXPECT_EQ(large_sdp.size(), json["sdp"].asString().size());
+
+    // 控制端发来CBOR后，本端的发送编码随之切换
+    EXPECT_TRUE(client.SendAnswer("v=0\r\n", "controller"));
+    EXPECT_TRUE(controller.Receive(&received, kTimeoutMs));
+    EXPECT_TRUE(!received.empty() && received[0] != '{');
+    EXPECT_EQ(std::string("v=0\r\n"), Parse(received)["sdp"].asString());
+
+    // 3. 超过上限的消息整条丢弃，不影响后续消息
+    EXPECT_TRUE(controller.Send(ToJson(MakeAnswer(std::string(80 * 1024, 'b')))));
+    EXPECT_TRUE(controller.Send(ToJson(MakeAnswer("after-drop"))));
+    EXPECT_TRUE(events.WaitMessage(&json));
+    EXPECT_EQ(std::string("after-drop"), json["sdp"].asString());
+    EXPECT_EQ(uint64_t(1), client.GetTrafficStats().dropped_messages);
+    EXPECT_EQ(uint64_t(3), client.GetTrafficStats().rx_messages);
+
+    // 4. 控制端重启：本端通知断开，断线期间的消息排队，重连后先注册再补发
+    controller.StopListening();
+    controller.CloseConnection();
+    EXPECT_TRUE(events.WaitState(false));
+    EXPECT_TRUE(!client.IsConnected());
+    EXPECT_TRUE(client.SendOffer("queued-offer", "controller"));
+    EXPECT_TRUE(controller.Listen());
+    EXPECT_TRUE(controller.Accept(kTimeoutMs));
+    EXPECT_TRUE(events.WaitState(true));
+    EXPECT_TRUE(controller.Receive(&received, kTimeoutMs));
+    EXPECT_EQ(std::string("register"), Parse(received)["type"].asString());
+    EXPECT_TRUE(controller.Receive(&received, kTimeoutMs));
+    json = Parse(received);
+    EXPECT_EQ(std::string("offer"), json["type"].asString());
+    EXPECT_EQ(std::string("queued-offer"), json["sdp"].asString());
+
+    client.Close();
+    EXPECT_TRUE(!client.IsConnected());
+    EXPECT_EQ(size_t(0), events.PendingMessages());
+    return TestResult("signaling_client_ipc_test");
+}
@@ -0,0 +1,137 @@
+// 本地套接字信令的Offer→Answer往返延迟：./signaling_ipc_bench [迭代次数] [cbor]
+// 进程内的控制端线程收到Offer后立即回一条同样大小的Answer，计时从SendOffer到消息回调执行。
+// WebSocket路径的对比数据由tests/signaling_ws_bench.js在自带的node信令服务器上测得
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "signaling/cbor_codec.h"
+#include "signaling/signaling_client_ipc.h"
+#include "tests/local_controller.h"
+
+namespace {
+
+const size_t kSdpSize = 4096;
+
+// 控制端：完成注册后，对每条Offer回复一条Answer，编码跟随本端
+void RunController(LocalController* controller, int iterations) {
+    if (!controller->Accept(5000)) {
+        std::cerr << "Receiver did not connect" << std::endl;
+        return;
+    }
+    Json::CharReaderBuilder reader_builder;
+    std::unique_ptr<Json::CharReader> reader(reader_builder.newCharReader());
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+
+    Json::Value answer;
+    answer["type"] = "answer";
+    answer["roomId"] = "bench";
+    answer["from"] = "controller";
+    answer["sdp"] = std::string(kSdpSize, 'a');
+
+    std::string message;
+    for (int i = 0; i <= iterations && controller->Receive(&message, 5000);) {
+        bool binary = !message.empty() && message[0] != '{';
+        Json::Value json;
+        std::string errors;
+        bool ok = binary ? cbor::Decode(reinterpret_cast<const uint8_t*>(message.data()), message.size(), &json)
+                         : reader->parse(message.data(), message.data() + message.size(), &json, &errors);
+        if (!ok) {
+            continue;
+        }
+        std::string reply;
+        if (json["type"].asString() == "register") {
+            Json::Value registered;
+            registered["type"] = "register_success";
+            registered["roomId"] = "bench";
+            registered["clientId"] = json["clientId"];
+            reply = Json::writeString(writer, registered);
+        } else if (json["type"].asString() == "offer") {
+            if (binary) {
+                cbor::Encode(answer, &reply);
+            } else {
+                reply = Json::writeString(writer, answer);
+            }
+            ++i;
+        } else {
+            continue;
+        }
+        controller->Send(reply);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2000;
+    const bool binary = argc > 2 && strcmp(argv[2], "cbor") == 0;
+
+    LocalController controller("rk-ipc-bench-" + std::to_string(getpid()));
+    if (!controller.IsListening()) {
+        std::cerr << "Failed to listen on local socket" << std::endl;
+        return 1;
+    }
+    std::thread controller_thread(RunController, &controller, iterations);
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool registered = false;
+    int answers = 0;
+    std::chrono::steady_clock::time_point answered_at;
+
+    UnixSocketSignalingClient client;
+    client.SetBinaryEncoding(binary);
+    client.SetMessageCallback([&](SignalingClient::MessageType type, const Json::Value&) {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (type == SignalingClient::MessageType::REGISTER) {
+            registered = true;
+        } else if (type == SignalingClient::MessageType::ANSWER) {
+            answered_at = now;
+            answers++;
+        }
+        cond.notify_all();
+    });
+    client.Register("bench", "receiver");
+    client.Connect(controller.Url());
+
+    std::vector<double> samples_us;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!cond.wait_for(lock, std::chrono::seconds(5), [&] { return registered; })) {
+            std::cerr << "Registration timed out" << std::endl;
+        }
+    }
+    const std::string sdp(kSdpSize, 'o');
+    for (int i = 0; i < iterations && registered; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        client.SendOffer(sdp, "controller");
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!cond.wait_for(lock, std::chrono::seconds(5), [&] { return answers > i; })) {
+            std::cerr << "Answer timed out" << std::endl;
+            break;
+        }
+        samples_us.push_back(std::chrono::duration<double, std::micro>(answered_at - start).count());
+    }
+    client.Close();
+    controller_thread.join();
+
+    if (samples_us.empty()) {
+        return 1;
+    }
+    std::sort(samples_us.begin(), samples_us.end());
+    std::cout << "[Timing] " << samples_us.size() << " offer/answer round trips over UNIX socket ("
+              << (binary ? "CBOR" : "JSON") << ", " << kSdpSize << " byte SDP): p50 "
+              << samples_us[samples_us.size() / 2] << " us, p99 " << samples_us[samples_us.size() * 99 / 100]
+              << " us, max " << samples_us.back() << " us" << std::endl;
+    return 0;
+}
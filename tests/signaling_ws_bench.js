@@ -0,0 +1,97 @@
+// 经自带node信令服务器的Offer→Answer往返延迟，与tests/signaling_ipc_bench.cc对比：
+// node tests/signaling_ws_bench.js [迭代次数] [cbor]
+// 启动一个临时的signaling_server.js，两个ws客户端加入同一房间，一方发Offer，另一方立即回Answer
+const { spawn } = require('child_process');
+const path = require('path');
+const WebSocket = require(path.join(__dirname, '..', 'signaling', 'node_modules', 'ws'));
+const cbor = require('../signaling/cbor');
+
+const ITERATIONS = parseInt(process.argv[2], 10) || 2000;
+const BINARY = process.argv[3] === 'cbor';
+const PROTOCOL = BINARY ? 'webrtc-signaling-cbor' : 'webrtc-signaling';
+const PORT = 20000 + (process.pid % 20000);
+const SDP_SIZE = 4096;
+
+function encode(message) {
+    return BINARY ? cbor.encode(message) : JSON.stringify(message);
+}
+
+function decode(data, isBinary) {
+    return isBinary ? cbor.decode(data) : JSON.parse(data.toString());
+}
+
+function connect(clientId) {
+    return new Promise((resolve, reject) => {
+        const ws = new WebSocket(`ws://127.0.0.1:${PORT}`, PROTOCOL);
+        ws.once('error', reject);
+        ws.once('open', () => {
+            ws.send(encode({ type: 'register', roomId: 'bench', clientId }));
+        });
+        ws.on('message', function onRegistered(data, isBinary) {
+            if (decode(data, isBinary).type === 'register_success') {
+                ws.off('message', onRegistered);
+                resolve(ws);
+            }
+        });
+    });
+}
+
+async function waitForServer(server) {
+    return new Promise((resolve) => {
+        server.stdout.on('data', function onData(chunk) {
+            if (chunk.toString().includes('Signaling server running')) {
+                server.stdout.off('data', onData);
+                resolve();
+            }
+        });
+    });
+}
+
+async function main() {
+    const server = spawn(process.execPath, [path.join(__dirname, '..', 'signaling', 'signaling_server.js'), PORT],
+                         { stdio: ['ignore', 'pipe', 'inherit'] });
+    await waitForServer(server);
+    // 服务器每转发一条消息都会打印日志，持续读走输出，避免管道写满后阻塞
+    server.stdout.resume();
+
+    const controller = await connect('controller');
+    const receiver = await connect('receiver');
+    const answerSdp = 'a'.repeat(SDP_SIZE);
+    const offerSdp = 'o'.repeat(SDP_SIZE);
+    controller.on('message', (data, isBinary) => {
+        const message = decode(data, isBinary);
+        if (message.type === 'offer') {
+            controller.send(encode({ type: 'answer', roomId: 'bench', to: message.from, sdp: answerSdp }));
+        }
+    });
+
+    const samples = [];
+    for (let i = 0; i < ITERATIONS; i++) {
+        const start = process.hrtime.bigint();
+        await new Promise((resolve) => {
+            receiver.on('message', function onAnswer(data, isBinary) {
+                if (decode(data, isBinary).type === 'answer') {
+                    receiver.off('message', onAnswer);
+                    resolve();
+                }
+            });
+            receiver.send(encode({ type: 'offer', roomId: 'bench', to: 'controller', sdp: offerSdp }));
+        });
+        samples.push(Number(process.hrtime.bigint() - start) / 1000);
+    }
+
+    controller.close();
+    receiver.close();
+    server.kill();
+
+    samples.sort((a, b) => a - b);
+    const at = (q) => samples[Math.floor(samples.length * q)].toFixed(1);
+    console.log(`[Timing] ${samples.length} offer/answer round trips over websocket (${BINARY ? 'CBOR' : 'JSON'}, ` +
+                `${SDP_SIZE} byte SDP): p50 ${at(0.5)} us, p99 ${at(0.99)} us, ` +
+                `max ${samples[samples.length - 1].toFixed(1)} us`);
+}
+
+main().catch((err) => {
+    console.error(err);
+    process.exit(1);
+});
@@ -0,0 +1,120 @@
+// 联播Offer经ApplyRemoteOffer处理后，只接收适合显示尺寸的一层：
+// 以静态会话模式应用一个三层联播的Offer，检查选中的层和Answer中的层顺序
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "tests/test_util.h"
+#include "webrtc/audio_receiver_rockit.h"
+#include "webrtc/encoded_video_frame_handler_rockit.h"
+#include "webrtc/webrtc_client.h"
+
+namespace {
+
+const char kSimulcastOffer[] =
+    "v=0\r\n"
+    "o=- 4611731400430051336 2 IN IP4 127.0.0.1\r\n"
+    "s=-\r\n"
+    "t=0 0\r\n"
+    "a=group:BUNDLE 0\r\n"
+    "a=msid-semantic: WMS\r\n"
+    "m=video 9 UDP/TLS/RTP/SAVPF 96\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=rtcp:9 IN IP4 0.0.0.0\r\n"
+    "a=ice-ufrag:sImU\r\n"
+    "a=ice-pwd:simulcastofferpassword00\r\n"
+    "a=ice-options:trickle\r\n"
+    "a=fingerprint:sha-256 "
+    "8B:87:09:8A:5D:C2:F3:33:EF:C5:B1:F6:84:3A:3D:D6:A3:E2:9C:17:4C:E7:46:3B:1B:CE:84:98:DD:8E:AF:7B\r\n"
+    "a=setup:actpass\r\n"
+    "a=mid:0\r\n"
+    "a=extmap:1 urn:ietf:params:rtp-hdrext:sdes:mid\r\n"
+    "a=extmap:2 urn:ietf:params:rtp-hdrext:sdes:rtp-stream-id\r\n"
+    "a=extmap:3 urn:ietf:params:rtp-hdrext:sdes:repaired-rtp-stream-id\r\n"
+    "a=sendonly\r\n"
+    "a=msid:- video0\r\n"
+    "a=rtcp-mux\r\n"
+    "a=rtcp-rsize\r\n"
+    "a=rtpmap:96 H264/90000\r\n"
+    "a=rtcp-fb:96 nack\r\n"
+    "a=rtcp-fb:96 nack pli\r\n"
+    "a=fmtp:96 level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=42e01f\r\n"
+    "a=rid:hi send max-width=1920;max-height=1080\r\n"
+    "a=rid:mid send max-width=1280;max-height=720\r\n"
+    "a=rid:lo send max-width=640;max-height=360\r\n"
+    "a=simulcast:send hi;mid;lo\r\n";
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream file(path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+// Answer中a=simulcast:recv列出的第一层
+std::string FirstAnsweredRid(const std::string& answer) {
+    const std::string prefix = "a=simulcast:recv ";
+    size_t pos = answer.find(prefix);
+    if (pos == std::string::npos) {
+        return "";
+    }
+    pos += prefix.size();
+    size_t end = answer.find_first_of(";,\r\n", pos);
+    std::string rid = answer.substr(pos, end - pos);
+    return !rid.empty() && rid[0] == '~' ? rid.substr(1) : rid;
+}
+
+// 用给定的显示区域接收联播Offer，返回会话选中的层，answer为写出的Answer
+std::string ReceiveSimulcast(double display_width, double display_height, std::string* answer) {
+    const std::string offer_path = "simulcast_offer_test_offer.sdp";
+    const std::string answer_path = "simulcast_offer_test_answer.sdp";
+    std::ofstream(offer_path) << kSimulcastOffer;
+    std::remove(answer_path.c_str());
+
+    // 处理器不初始化：只用到显示尺寸，不创建VDEC/VO
+    auto video_handler = std::make_shared<EncodedVideoFrameHandler>();
+    if (display_width > 0) {
+        video_handler->SetDisplayRect(0.0, 0.0, display_width, display_height);
+    }
+    WebRTCClient client;
+    client.SetMediaHandlers(video_handler, std::make_shared<AudioReceiver>());
+    client.SetStaticSessionMode(true);
+    client.SetVideoPreconfigure(false);
+    client.SetLayerSelection(true, LayerSelector::Config());
+    EXPECT_TRUE(client.Initialize());
+    EXPECT_TRUE(client.StartStaticSession(offer_path, answer_path));
+
+    std::vector<PeerSession::Usage> usage = client.GetSessionUsage();
+    EXPECT_EQ(static_cast<size_t>(1), usage.size());
+    std::string rid = usage.empty() ? "" : usage[0].simulcast_rid;
+
+    // 静态会话在候选者收集完成后写出Answer
+    for (int i = 0; i < 100 && answer->empty(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        *answer = ReadFile(answer_path);
+    }
+    client.Cleanup();
+    std::remove(offer_path.c_str());
+    std::remove(answer_path.c_str());
+    return rid;
+}
+
+}  // namespace
+
+int main() {
+    // 画中画小窗（约460x259）：最小的一层已经够用
+    std::string answer;
+    EXPECT_EQ(std::string("lo"), ReceiveSimulcast(0.24, 0.24, &answer));
+    EXPECT_TRUE(!answer.empty());
+    EXPECT_EQ(std::string("lo"), FirstAnsweredRid(answer));
+
+    // 全屏（1920x1080）：接收最大的一层
+    answer.clear();
+    EXPECT_EQ(std::string("hi"), ReceiveSimulcast(0, 0, &answer));
+    EXPECT_EQ(std::string("hi"), FirstAnsweredRid(answer));
+
+    return TestResult("simulcast_offer_test");
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <iostream>
+
+// 极简断言：失败时输出位置并计数，不中断后续检查；main返回TestResult()
+inline int& TestFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define EXPECT_TRUE(condition)                                                                         \
+    do {                                                                                               \
+        if (!(condition)) {                                                                            \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": expected " << #condition << std::endl;     \
+            TestFailures()++;                                                                          \
+        }                                                                                              \
+    } while (0)
+
+#define EXPECT_EQ(expected, actual)                                                                    \
+    do {                                                                                               \
+        const auto& expected_value = (expected);                                                       \
+        const auto& actual_value = (actual);                                                           \
+        if (!(expected_value == actual_value)) {                                                       \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": expected " << #actual << " == " << expected_value \
+                      << ", got " << actual_value << std::endl;                                        \
+            TestFailures()++;                                                                          \
+        }                                                                                              \
+    } while (0)
+
+inline int TestResult(const char* name) {
+    if (TestFailures() == 0) {
+        std::cout << "[PASS] " << name << std::endl;
+        return 0;
+    }
+    std::cout << "[FAIL] " << name << ": " << TestFailures() << " failed check(s)" << std::endl;
+    return 1;
+}
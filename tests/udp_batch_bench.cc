@@ -0,0 +1,162 @@
+// 回环UDP接收基准：每次唤醒recvfrom一个包（PhysicalSocketServer的做法）对比UdpBatchReceiver
+// 用法：./udp_batch_bench [秒数] [批大小] [gro]
+// 发送线程以30fps的突发发送1200字节的包；gro模式下每个突发用UDP_SEGMENT一次发出，接收端启用GRO
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "webrtc/udp_batch_receiver.h"
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+namespace {
+
+constexpr size_t kPacketSize = 1200;
+constexpr int kFps = 30;
+
+struct Result {
+    uint64_t packets = 0;
+    uint64_t syscalls = 0;  // epoll_wait + 接收调用
+    double cpu_ms = 0;
+};
+
+int BindLoopback(sockaddr_in* address) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(address, 0, sizeof(*address));
+    address->sin_family = AF_INET;
+    address->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(*address);
+    bind(fd, reinterpret_cast<sockaddr*>(address), sizeof(*address));
+    getsockname(fd, reinterpret_cast<sockaddr*>(address), &length);
+    return fd;
+}
+
+double ThreadCpuMs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// 按码率发送：每帧一个突发，gso时整个突发一次sendmsg
+void SendBursts(int fd, const sockaddr_in& to, int kbps, int seconds, bool gso, std::atomic<bool>* done) {
+    const size_t packets_per_frame = std::max<size_t>(1, static_cast<size_t>(kbps) * 1000 / 8 / kFps / kPacketSize);
+    const std::string frame(packets_per_frame * kPacketSize, 'x');
+    auto next = std::chrono::steady_clock::now();
+    for (int frame_index = 0; frame_index < seconds * kFps; ++frame_index) {
+        if (gso) {
+            // 单个GSO发送不能超过64KB的UDP负载：每次最多48个段
+            for (size_t offset = 0; offset < frame.size(); offset += 48 * kPacketSize) {
+                size_t length = std::min(frame.size() - offset, 48 * kPacketSize);
+                iovec iov = {const_cast<char*>(frame.data() + offset), length};
+                char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+                msghdr msg = {};
+                msg.msg_name = const_cast<sockaddr_in*>(&to);
+                msg.msg_namelen = sizeof(to);
+                msg.msg_iov = &iov;
+                msg.msg_iovlen = 1;
+                msg.msg_control = control;
+                msg.msg_controllen = sizeof(control);
+                cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+                cmsg->cmsg_level = IPPROTO_UDP;
+                cmsg->cmsg_type = UDP_SEGMENT;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                uint16_t segment = kPacketSize;
+                memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+                sendmsg(fd, &msg, 0);
+            }
+        } else {
+            for (size_t i = 0; i < packets_per_frame; ++i) {
+                sendto(fd, frame.data() + i * kPacketSize, kPacketSize, 0, reinterpret_cast<const sockaddr*>(&to),
+                       sizeof(to));
+            }
+        }
+        next += std::chrono::microseconds(1000000 / kFps);
+        std::this_thread::sleep_until(next);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    *done = true;
+}
+
+// 接收线程：batch_size为0时每次唤醒recvfrom一个包，否则每次唤醒一次recvmmsg
+Result Receive(int fd, int batch_size, bool gro, std::atomic<bool>* done) {
+    Result result;
+    int epoll_fd = epoll_create1(0);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    UdpBatchReceiver receiver;
+    if (batch_size > 0) {
+        receiver.Configure(fd, batch_size, gro);
+    }
+    std::vector<char> buffer(2048);
+    const double start_ms = ThreadCpuMs();
+    while (!*done) {
+        epoll_event ready;
+        result.syscalls++;
+        if (epoll_wait(epoll_fd, &ready, 1, 20) <= 0) {
+            continue;
+        }
+        result.syscalls++;
+        if (batch_size > 0) {
+            if (receiver.Receive(fd) > 0) {
+                result.packets += receiver.packets().size();
+            }
+        } else if (recvfrom(fd, buffer.data(), buffer.size(), MSG_DONTWAIT, nullptr, nullptr) >= 0) {
+            result.packets++;
+        }
+    }
+    result.cpu_ms = ThreadCpuMs() - start_ms;
+    close(epoll_fd);
+    return result;
+}
+
+Result Run(int kbps, int seconds, int batch_size, bool gro) {
+    sockaddr_in receiver_address;
+    sockaddr_in sender_address;
+    int receiver_fd = BindLoopback(&receiver_address);
+    int sender_fd = BindLoopback(&sender_address);
+    int rcvbuf = 1 << 20;
+    setsockopt(receiver_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    std::atomic<bool> done{false};
+    Result result;
+    std::thread receiver([&]() { result = Receive(receiver_fd, batch_size, gro, &done); });
+    SendBursts(sender_fd, receiver_address, kbps, seconds, gro && batch_size > 0, &done);
+    receiver.join();
+    close(sender_fd);
+    close(receiver_fd);
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int seconds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 3;
+    const int batch_size = argc > 2 ? std::max(1, std::atoi(argv[2])) : 32;
+    const bool gro = argc > 3 && std::string(argv[3]) == "gro";
+
+    for (int kbps : {8000, 15000, 50000, 200000}) {
+        Result single = Run(kbps, seconds, 0, false);
+        Result batched = Run(kbps, seconds, batch_size, gro);
+        std::cout << "[Timing] " << kbps / 1000 << " Mbps: " << single.packets / seconds << " -> "
+                  << batched.packets / seconds << " pkts/s, syscalls/s " << single.syscalls / seconds << " -> "
+                  << batched.syscalls / seconds << ", CPU ms/s " << single.cpu_ms / seconds << " -> "
+                  << batched.cpu_ms / seconds << " (batch " << batch_size << (gro ? ", GRO" : "") << ")"
+                  << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+// 批量接收：recvmmsg一次取回多个数据报、按批大小分批、UDP GRO合并包按段长拆分
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "tests/test_util.h"
+#include "webrtc/udp_batch_receiver.h"
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+namespace {
+
+// 绑定到127.0.0.1的随机端口，返回套接字，address输出绑定的地址
+int BindLoopback(sockaddr_in* address) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(address, 0, sizeof(*address));
+    address->sin_family = AF_INET;
+    address->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(*address);
+    bind(fd, reinterpret_cast<sockaddr*>(address), sizeof(*address));
+    getsockname(fd, reinterpret_cast<sockaddr*>(address), &length);
+    return fd;
+}
+
+std::string Payload(size_t size, char seed) {
+    std::string payload(size, 0);
+    for (size_t i = 0; i < size; ++i) {
+        payload[i] = static_cast<char>(seed + i % 23);
+    }
+    return payload;
+}
+
+std::string PacketData(const UdpBatchReceiver::Packet& packet) {
+    return std::string(reinterpret_cast<const char*>(packet.data), packet.size);
+}
+
+uint16_t PacketPort(const UdpBatchReceiver::Packet& packet) {
+    return ntohs(reinterpret_cast<const sockaddr_in*>(packet.address)->sin_port);
+}
+
+// 以UDP_SEGMENT（GSO）发送一个超级包，由内核按segment_size切分
+bool SendSegmented(int fd, const sockaddr_in& to, const std::string& payload, uint16_t segment_size) {
+    iovec iov = {const_cast<char*>(payload.data()), payload.size()};
+    char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+    msghdr msg = {};
+    msg.msg_name = const_cast<sockaddr_in*>(&to);
+    msg.msg_namelen = sizeof(to);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = IPPROTO_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+    return sendmsg(fd, &msg, 0) == static_cast<ssize_t>(payload.size());
+}
+
+}  // namespace
+
+int main() {
+    sockaddr_in receiver_address;
+    sockaddr_in sender_address;
+    int receiver_fd = BindLoopback(&receiver_address);
+    int sender_fd = BindLoopback(&sender_address);
+    const sockaddr* to = reinterpret_cast<const sockaddr*>(&receiver_address);
+
+    // 一次recvmmsg取回队列中的全部数据报，内容、长度和来源地址都正确
+    {
+        UdpBatchReceiver receiver;
+        EXPECT_TRUE(!receiver.Configure(receiver_fd, 32, false));
+        std::vector<std::string> sent;
+        for (size_t size : {1200u, 300u, 1u, 1472u, 0u}) {
+            sent.push_back(Payload(size, static_cast<char>('a' + sent.size())));
+            sendto(sender_fd, sent.back().data(), sent.back().size(), 0, to, sizeof(receiver_address));
+        }
+        EXPECT_EQ(5, receiver.Receive(receiver_fd));
+        EXPECT_EQ(sent.size(), receiver.packets().size());
+        for (size_t i = 0; i < sent.size() && i < receiver.packets().size(); ++i) {
+            EXPECT_TRUE(PacketData(receiver.packets()[i]) == sent[i]);
+            EXPECT_EQ(ntohs(sender_address.sin_port), PacketPort(receiver.packets()[i]));
+        }
+        EXPECT_EQ(static_cast<uint64_t>(1200 + 300 + 1 + 1472), receiver.bytes());
+        EXPECT_EQ(-1, receiver.Receive(receiver_fd));
+        EXPECT_TRUE(receiver.packets().empty());
+    }
+
+    // 超过批大小的数据报分多次取回，不丢包
+    {
+        UdpBatchReceiver receiver;
+        receiver.Configure(receiver_fd, 4, false);
+        for (int i = 0; i < 10; ++i) {
+            std::string payload = Payload(100, static_cast<char>('A' + i));
+            sendto(sender_fd, payload.data(), payload.size(), 0, to, sizeof(receiver_address));
+        }
+        EXPECT_EQ(4, receiver.Receive(receiver_fd));
+        EXPECT_EQ(4, receiver.Receive(receiver_fd));
+        EXPECT_EQ(2, receiver.Receive(receiver_fd));
+        EXPECT_TRUE(PacketData(receiver.packets()[1]) == Payload(100, 'J'));
+        EXPECT_EQ(-1, receiver.Receive(receiver_fd));
+    }
+
+    // GRO：回环上以GSO发送的超级包保持合并交付，按段长拆回，最后一段更短
+    {
+        UdpBatchReceiver receiver;
+        if (!receiver.Configure(receiver_fd, 8, true)) {
+            std::cout << "[INFO] UDP_GRO not supported, skipping GRO split check" << std::endl;
+        } else {
+            const std::string payload = Payload(3 * 1200 + 500, 'g');
+            if (!SendSegmented(sender_fd, receiver_address, payload, 1200)) {
+                std::cout << "[INFO] UDP_SEGMENT not supported, skipping GRO split check" << std::endl;
+            } else {
+                EXPECT_EQ(1, receiver.Receive(receiver_fd));
+                EXPECT_EQ(static_cast<size_t>(4), receiver.packets().size());
+                size_t offset = 0;
+                for (const auto& packet : receiver.packets()) {
+                    size_t expected = std::min<size_t>(1200, payload.size() - offset);
+                    EXPECT_EQ(expected, packet.size);
+                    EXPECT_TRUE(PacketData(packet) == payload.substr(offset, expected));
+                    offset += packet.size;
+                }
+                EXPECT_EQ(payload.size(), offset);
+                EXPECT_EQ(static_cast<uint64_t>(payload.size()), receiver.bytes());
+            }
+            // 普通数据报在GRO套接字上不受影响
+            const std::string single = Payload(700, 's');
+            sendto(sender_fd, single.data(), single.size(), 0, to, sizeof(receiver_address));
+            EXPECT_EQ(1, receiver.Receive(receiver_fd));
+            EXPECT_EQ(static_cast<size_t>(1), receiver.packets().size());
+            EXPECT_TRUE(!receiver.packets().empty() && PacketData(receiver.packets()[0]) == single);
+        }
+    }
+
+    close(sender_fd);
+    close(receiver_fd);
+    return TestResult("udp_batch_receiver_test");
+}
@@ -1,4 +1,5 @@
 #include "audio_receiver_rockit.h"
+#include "../common/thread_profile.h"
 #include <iostream>
 #include <chrono>
 #include <thread>
@@ -135,9 +136,19 @@ void AudioReceiver::Reset() {
 }
 
 void AudioReceiver::SetTargetDelayMs(int delay_ms) {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
     target_delay_ms_ = delay_ms;
 }
 
+void AudioReceiver::SetMaxBufferFrames(size_t max_frames) {
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    max_buffer_size_ = std::max<size_t>(1, max_frames);
+    // 运行时切换到更小的缓冲时，多出的部分直接丢弃，延迟立即下降
+    while (audio_buffer_.size() > max_buffer_size_) {
+        audio_buffer_.pop();
+    }
+}
+
 int AudioReceiver::GetCurrentDelayMs() const {
     std::lock_guard<std::mutex> lock(buffer_mutex_);
     // 估算当前缓冲区的延迟（毫秒）
@@ -257,6 +268,7 @@ bool AudioReceiver::InitializeAudioDevice() {
 }
 
 void AudioReceiver::AudioProcessingThread() {
+    ThreadProfile::Instance().RegisterCurrentThread(ThreadProfile::Role::kAudio, "audio-playout");
     std::cout << "Audio processing thread started" << std::endl;
     
     while (is_running_) {
@@ -285,8 +297,11 @@ void AudioReceiver::AudioProcessingThread() {
                 NotifyAudioState(AUDIO_STATE_DEVICE_ERROR, "Failed to send audio frame to device");
             }
         } else {
-            // 缓冲区为空，等待一段时间
+            // 缓冲区为空，等待一段时间；记录唤醒迟到的时间，反映该线程的调度延迟
+            auto sleep_start = std::chrono::steady_clock::now();
             std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            ThreadProfile::Instance().RecordWakeupLatency(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - sleep_start).count() - 5000);
             
             // 检查是否长时间没有数据
             {
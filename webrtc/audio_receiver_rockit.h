@@ -76,6 +76,12 @@ public:
      */
     void SetTargetDelayMs(int delay_ms);
 
+    /**
+     * @brief 设置PCM缓冲队列上限，队列超出时立即丢弃最旧的帧
+     * @param max_frames 最大帧数（每帧10ms）
+     */
+    void SetMaxBufferFrames(size_t max_frames);
+
     /**
      * @brief 获取当前音频延迟
      * @return 当前延迟（毫秒）
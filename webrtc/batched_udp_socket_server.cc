@@ -0,0 +1,128 @@
+#include "batched_udp_socket_server.h"
+#include "rtc_base/socket_address.h"
+#include "udp_batch_receiver.h"
+#include <sys/socket.h>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+/**
+ * @brief 批量接收的UDP套接字
+ *
+ * 可读事件到来时由基类回调上层（AsyncUDPSocket），上层的第一次RecvFrom触发一次recvmmsg，
+ * 之后的RecvFrom直接从这一批中取包；基类回调返回后，只要批中还有包就继续通知上层读取，
+ * 因为这些包已经离开内核队列，不会再产生可读事件。
+ */
+class BatchedUdpSocket : public webrtc::SocketDispatcher {
+public:
+    explicit BatchedUdpSocket(BatchedUdpSocketServer* server)
+        : webrtc::SocketDispatcher(server), server_(server) {}
+
+    bool Create(int family, int type) override {
+        if (!webrtc::SocketDispatcher::Create(family, type)) {
+            return false;
+        }
+        const auto& options = server_->options();
+        if (options.receive_buffer_bytes > 0) {
+            int size = options.receive_buffer_bytes;
+            // SO_RCVBUFFORCE可以突破rmem_max（需要CAP_NET_ADMIN），失败时退回普通设置
+            if (setsockopt(s_, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) != 0) {
+                setsockopt(s_, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+            }
+        }
+        receiver_.Configure(s_, options.batch_size, options.enable_gro);
+        return true;
+    }
+
+    int RecvFrom(void* buffer, size_t length, webrtc::SocketAddress* out_addr, int64_t* timestamp) override {
+        if (!FillBatch()) {
+            return webrtc::SocketDispatcher::RecvFrom(buffer, length, out_addr, timestamp);
+        }
+        const UdpBatchReceiver::Packet& packet = receiver_.packets()[next_packet_++];
+        size_t copied = std::min(length, packet.size);
+        memcpy(buffer, packet.data, copied);
+        if (out_addr) webrtc::SocketAddressFromSockAddrStorage(*packet.address, out_addr);
+        if (timestamp) *timestamp = -1;
+        EnableEvents(webrtc::DE_READ);
+        return static_cast<int>(copied);
+    }
+
+    int RecvFrom(webrtc::Socket::ReceiveBuffer& buffer) override {
+        if (!FillBatch()) {
+            return webrtc::SocketDispatcher::RecvFrom(buffer);
+        }
+        const UdpBatchReceiver::Packet& packet = receiver_.packets()[next_packet_++];
+        buffer.payload.SetData(packet.data, packet.size);
+        webrtc::SocketAddressFromSockAddrStorage(*packet.address, &buffer.source_address);
+        EnableEvents(webrtc::DE_READ);
+        return static_cast<int>(packet.size);
+    }
+
+    void OnEvent(uint32_t ff, int err) override {
+        webrtc::SocketDispatcher::OnEvent(ff, err);
+        // 把已取回但尚未交给上层的包继续送出；上层未读取（例如已关闭）时停止
+        while ((ff & webrtc::DE_READ) && next_packet_ < receiver_.packets().size() && GetDescriptor() >= 0) {
+            size_t before = next_packet_;
+            SignalReadEvent(this);
+            if (next_packet_ == before) {
+                break;
+            }
+        }
+    }
+
+private:
+    // 当前批已取完时执行一次recvmmsg，返回是否有可交付的包
+    bool FillBatch() {
+        if (next_packet_ < receiver_.packets().size()) {
+            return true;
+        }
+        next_packet_ = 0;
+        int count = receiver_.Receive(s_);
+        if (count <= 0) {
+            return false;
+        }
+        server_->AddReceiveStats(count, receiver_.packets().size(), receiver_.bytes());
+        return !receiver_.packets().empty();
+    }
+
+    BatchedUdpSocketServer* server_;
+    UdpBatchReceiver receiver_;  // recvmmsg的缓冲区，整批复用
+    size_t next_packet_ = 0;     // 当前批中下一个待交付的包
+};
+
+}  // namespace
+
+BatchedUdpSocketServer::BatchedUdpSocketServer(const Options& options) : options_(options) {}
+
+webrtc::Socket* BatchedUdpSocketServer::CreateSocket(int family, int type) {
+    if (type != SOCK_DGRAM) {
+        return webrtc::PhysicalSocketServer::CreateSocket(family, type);
+    }
+    auto* socket = new BatchedUdpSocket(this);
+    if (!socket->Create(family, type)) {
+        delete socket;
+        return nullptr;
+    }
+    return socket;
+}
+
+void BatchedUdpSocketServer::AddReceiveStats(uint64_t datagrams, uint64_t packets, uint64_t bytes) {
+    recv_calls_++;
+    datagrams_ += datagrams;
+    packets_ += packets;
+    bytes_ += bytes;
+    if (packets > max_batch_) {
+        max_batch_ = packets;
+    }
+}
+
+BatchedUdpSocketServer::Stats BatchedUdpSocketServer::GetStats() const {
+    Stats stats;
+    stats.recv_calls = recv_calls_;
+    stats.datagrams = datagrams_;
+    stats.packets = packets_;
+    stats.bytes = bytes_;
+    stats.max_batch = max_batch_;
+    return stats;
+}
@@ -0,0 +1,234 @@
+#include "control_channel.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+int64_t NowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+// 每条DataChannel一个观察者，记录自己属于哪种模式
+class ControlChannel::ChannelObserver : public webrtc::DataChannelObserver {
+public:
+    ChannelObserver(ControlChannel* owner, Mode mode) : owner_(owner), mode_(mode) {}
+
+    void OnStateChange() override {}
+
+    void OnMessage(const webrtc::DataBuffer& buffer) override {
+        owner_->OnFrame(buffer.data.cdata(), buffer.data.size(), mode_);
+    }
+
+    // 直接在网络线程回调，省去切换到信令线程的一次排队
+    bool IsOkToCallOnTheNetworkThread() override { return true; }
+
+private:
+    ControlChannel* owner_;
+    Mode mode_;
+};
+
+ControlChannel::ControlChannel() = default;
+
+ControlChannel::~ControlChannel() {
+    Close();
+}
+
+bool ControlChannel::Create(webrtc::PeerConnectionInterface* peer_connection) {
+    webrtc::DataChannelInit reliable_init;
+    reliable_init.ordered = true;
+    auto reliable = peer_connection->CreateDataChannelOrError(kReliableLabel, &reliable_init);
+    if (!reliable.ok()) {
+        std::cerr << "Failed to create control channel: " << reliable.error().message() << std::endl;
+        return false;
+    }
+    webrtc::DataChannelInit unreliable_init;
+    unreliable_init.ordered = false;
+    unreliable_init.maxRetransmits = 0;
+    auto unreliable = peer_connection->CreateDataChannelOrError(kUnreliableLabel, &unreliable_init);
+    if (!unreliable.ok()) {
+        std::cerr << "Failed to create telemetry channel: " << unreliable.error().message() << std::endl;
+        return false;
+    }
+    Bind(reliable.MoveValue(), Mode::kReliable);
+    Bind(unreliable.MoveValue(), Mode::kUnreliable);
+    return true;
+}
+
+bool ControlChannel::Attach(webrtc::scoped_refptr<webrtc::DataChannelInterface> channel) {
+    const std::string label = channel->label();
+    if (label == kReliableLabel) {
+        Bind(std::move(channel), Mode::kReliable);
+    } else if (label == kUnreliableLabel) {
+        Bind(std::move(channel), Mode::kUnreliable);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void ControlChannel::Bind(webrtc::scoped_refptr<webrtc::DataChannelInterface> channel, Mode mode) {
+    Endpoint previous;
+    Endpoint endpoint;
+    endpoint.observer = std::make_unique<ChannelObserver>(this, mode);
+    endpoint.channel = std::move(channel);
+    endpoint.channel->RegisterObserver(endpoint.observer.get());
+    {
+        std::lock_guard<std::mutex> lock(channels_mutex_);
+        Endpoint& current = mode == Mode::kReliable ? reliable_ : unreliable_;
+        previous = std::move(current);
+        current = std::move(endpoint);
+    }
+    // 对端重新创建了同名通道
+    if (previous.channel) {
+        previous.channel->UnregisterObserver();
+    }
+}
+
+void ControlChannel::SetHandler(uint8_t type, Handler handler) {
+    std::lock_guard<std::mutex> lock(handlers_mutex_);
+    handlers_[type] = std::move(handler);
+}
+
+void ControlChannel::SetRttCallback(RttCallback callback) {
+    std::lock_guard<std::mutex> lock(handlers_mutex_);
+    rtt_callback_ = std::move(callback);
+}
+
+bool ControlChannel::Send(uint8_t type, const void* data, size_t size, Mode mode) {
+    webrtc::scoped_refptr<webrtc::DataChannelInterface> channel;
+    {
+        std::lock_guard<std::mutex> lock(channels_mutex_);
+        const Endpoint& preferred = mode == Mode::kReliable ? reliable_ : unreliable_;
+        if (preferred.channel && preferred.channel->state() == webrtc::DataChannelInterface::kOpen) {
+            channel = preferred.channel;
+        } else if (reliable_.channel && reliable_.channel->state() == webrtc::DataChannelInterface::kOpen) {
+            channel = reliable_.channel;
+        }
+    }
+    if (!channel) {
+        send_failures_++;
+        return false;
+    }
+
+    // 头部和负载一次写入同一块缓冲区，只拷贝一次
+    const uint16_t seq = next_seq_++;
+    webrtc::CopyOnWriteBuffer frame(kHeaderSize + size);
+    uint8_t* out = frame.MutableData();
+    out[0] = type;
+    out[1] = 0;
+    out[2] = static_cast<uint8_t>(seq >> 8);
+    out[3] = static_cast<uint8_t>(seq & 0xFF);
+    if (size > 0) {
+        memcpy(out + kHeaderSize, data, size);
+    }
+    if (!channel->Send(webrtc::DataBuffer(frame, true))) {
+        send_failures_++;
+        return false;
+    }
+    tx_messages_++;
+    tx_bytes_ += kHeaderSize + size;
+    return true;
+}
+
+bool ControlChannel::SendPing(Mode mode) {
+    uint8_t payload[8];
+    int64_t now_us = NowUs();
+    for (int i = 0; i < 8; ++i) {
+        payload[i] = static_cast<uint8_t>(static_cast<uint64_t>(now_us) >> (56 - 8 * i));
+    }
+    return Send(kTypePing, payload, sizeof(payload), mode);
+}
+
+void ControlChannel::OnFrame(const uint8_t* frame, size_t size, Mode mode) {
+    if (size < kHeaderSize) {
+        unhandled_++;
+        return;
+    }
+    rx_messages_++;
+    rx_bytes_ += size;
+
+    Message message;
+    message.type = frame[0];
+    message.seq = static_cast<uint16_t>((frame[2] << 8) | frame[3]);
+    message.data = frame + kHeaderSize;
+    message.size = size - kHeaderSize;
+    message.mode = mode;
+
+    if (message.type == kTypePing) {
+        // 原样带回发送时间，由发起方计算往返时延
+        Send(kTypePong, message.data, message.size, mode);
+        return;
+    }
+    if (message.type == kTypePong) {
+        if (message.size < 8) {
+            unhandled_++;
+            return;
+        }
+        uint64_t sent_us = 0;
+        for (int i = 0; i < 8; ++i) {
+            sent_us = (sent_us << 8) | message.data[i];
+        }
+        int64_t rtt_us = NowUs() - static_cast<int64_t>(sent_us);
+        last_rtt_us_ = rtt_us;
+        RttCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(handlers_mutex_);
+            callback = rtt_callback_;
+        }
+        if (callback) {
+            callback(rtt_us);
+        }
+        return;
+    }
+
+    Handler handler;
+    {
+        std::lock_guard<std::mutex> lock(handlers_mutex_);
+        handler = handlers_[message.type];
+    }
+    if (!handler) {
+        unhandled_++;
+        return;
+    }
+    handler(message);
+}
+
+bool ControlChannel::IsOpen(Mode mode) const {
+    std::lock_guard<std::mutex> lock(channels_mutex_);
+    const Endpoint& endpoint = mode == Mode::kReliable ? reliable_ : unreliable_;
+    return endpoint.channel && endpoint.channel->state() == webrtc::DataChannelInterface::kOpen;
+}
+
+ControlChannel::Stats ControlChannel::GetStats() const {
+    Stats stats;
+    stats.tx_messages = tx_messages_;
+    stats.tx_bytes = tx_bytes_;
+    stats.rx_messages = rx_messages_;
+    stats.rx_bytes = rx_bytes_;
+    stats.send_failures = send_failures_;
+    stats.unhandled = unhandled_;
+    stats.last_rtt_us = last_rtt_us_;
+    return stats;
+}
+
+void ControlChannel::Close() {
+    // 注销观察者会等待网络线程上正在执行的回调，而回调里的回复需要获取channels_mutex_，
+    // 所以先把通道取出再在锁外关闭
+    Endpoint endpoints[2];
+    {
+        std::lock_guard<std::mutex> lock(channels_mutex_);
+        endpoints[0] = std::move(reliable_);
+        endpoints[1] = std::move(unreliable_);
+    }
+    for (Endpoint& endpoint : endpoints) {
+        if (endpoint.channel) {
+            endpoint.channel->UnregisterObserver();
+            endpoint.channel->Close();
+        }
+    }
+}
@@ -0,0 +1,167 @@
+#pragma once
+#include "api/data_channel_interface.h"
+#include "api/peer_connection_interface.h"
+#include "api/scoped_refptr.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief 基于DataChannel的二进制控制通道
+ *
+ * 与媒体并行传输云台控制、布局切换、遥测等短消息。每个会话最多两条DataChannel：
+ * - "control"：可靠有序，用于必须送达的命令；
+ * - "telemetry"：无序、不重传，用于只关心最新值的遥测，丢包时不阻塞后续消息。
+ *
+ * 帧格式（大端）：类型(1字节) | 标志(1字节，保留为0) | 序号(2字节) | 负载。
+ * 类型0xF0/0xF1保留给内置的ping/pong，用于测量往返时延；
+ * 0xF2/0xF3为帧时间戳与端到端延迟回报（测试发送端使用，见PeerSession）。
+ * 消息在网络线程上直接交给处理函数，负载指向DataChannel的接收缓冲区，不做拷贝；
+ * 处理函数需尽快返回，需要保留数据时自行拷贝。
+ */
+class ControlChannel {
+public:
+    enum class Mode {
+        kReliable,    // 可靠有序
+        kUnreliable   // 无序、不重传
+    };
+
+    static constexpr const char* kReliableLabel = "control";
+    static constexpr const char* kUnreliableLabel = "telemetry";
+    static constexpr size_t kHeaderSize = 4;
+    static constexpr uint8_t kTypePing = 0xF0;
+    static constexpr uint8_t kTypePong = 0xF1;
+    // 发送端告知某帧的发出时间：RTP时间戳(4) | steady_clock微秒(8)
+    static constexpr uint8_t kTypeFrameTiming = 0xF2;
+    // 接收端回报该帧的单向延迟：RTP时间戳(4) | 延迟微秒(8)
+    static constexpr uint8_t kTypeFrameLatency = 0xF3;
+
+    /**
+     * @brief 收到的一条消息，data在处理函数返回后失效
+     */
+    struct Message {
+        uint8_t type = 0;
+        uint16_t seq = 0;
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        Mode mode = Mode::kReliable;
+    };
+
+    /**
+     * @brief 通道统计
+     */
+    struct Stats {
+        uint64_t tx_messages = 0;
+        uint64_t tx_bytes = 0;
+        uint64_t rx_messages = 0;
+        uint64_t rx_bytes = 0;
+        uint64_t send_failures = 0;     // 通道未打开或发送缓冲已满
+        uint64_t unhandled = 0;         // 没有处理函数或格式错误的消息
+        int64_t last_rtt_us = -1;       // 最近一次ping的往返时延
+    };
+
+    using Handler = std::function<void(const Message& message)>;
+    using RttCallback = std::function<void(int64_t rtt_us)>;
+
+    ControlChannel();
+    ~ControlChannel();
+
+    ControlChannel(const ControlChannel&) = delete;
+    ControlChannel& operator=(const ControlChannel&) = delete;
+
+    /**
+     * @brief 在本端创建两条DataChannel（需在生成Offer之前调用）
+     * @param peer_connection PeerConnection
+     * @return 是否创建成功
+     */
+    bool Create(webrtc::PeerConnectionInterface* peer_connection);
+
+    /**
+     * @brief 接管远端创建的DataChannel，按标签区分可靠与不可靠通道
+     * @param channel 远端创建的通道
+     * @return 标签不属于控制通道时返回false
+     */
+    bool Attach(webrtc::scoped_refptr<webrtc::DataChannelInterface> channel);
+
+    /**
+     * @brief 注册某一消息类型的处理函数（在网络线程调用）
+     * @param type 消息类型（0xF0及以上保留）
+     * @param handler 处理函数，为空时取消注册
+     */
+    void SetHandler(uint8_t type, Handler handler);
+
+    /**
+     * @brief 设置收到pong时的回调（在网络线程调用）
+     */
+    void SetRttCallback(RttCallback callback);
+
+    /**
+     * @brief 发送一条消息。不可靠通道未打开时退回可靠通道
+     * @param type 消息类型
+     * @param data 负载
+     * @param size 负载长度
+     * @param mode 发送模式
+     * @return 是否已交给DataChannel
+     */
+    bool Send(uint8_t type, const void* data, size_t size, Mode mode = Mode::kReliable);
+
+    /**
+     * @brief 发送ping，对端自动回复pong，往返时延通过RTT回调和统计给出
+     * @param mode 测量哪条通道
+     * @return 是否已发送
+     */
+    bool SendPing(Mode mode = Mode::kReliable);
+
+    /**
+     * @brief 指定通道是否已打开
+     */
+    bool IsOpen(Mode mode) const;
+
+    /**
+     * @brief 获取统计
+     */
+    Stats GetStats() const;
+
+    /**
+     * @brief 关闭两条通道并注销观察者
+     */
+    void Close();
+
+private:
+    class ChannelObserver;
+
+    /**
+     * @brief 解析一帧并分发（在网络线程调用）
+     */
+    void OnFrame(const uint8_t* frame, size_t size, Mode mode);
+
+    /**
+     * @brief 保存通道并注册观察者
+     */
+    void Bind(webrtc::scoped_refptr<webrtc::DataChannelInterface> channel, Mode mode);
+
+    struct Endpoint {
+        webrtc::scoped_refptr<webrtc::DataChannelInterface> channel;
+        std::unique_ptr<ChannelObserver> observer;
+    };
+
+    Endpoint reliable_;
+    Endpoint unreliable_;
+    mutable std::mutex channels_mutex_;
+
+    Handler handlers_[256];
+    RttCallback rtt_callback_;
+    std::mutex handlers_mutex_;
+
+    std::atomic<uint16_t> next_seq_{0};
+    std::atomic<uint64_t> tx_messages_{0};
+    std::atomic<uint64_t> tx_bytes_{0};
+    std::atomic<uint64_t> rx_messages_{0};
+    std::atomic<uint64_t> rx_bytes_{0};
+    std::atomic<uint64_t> send_failures_{0};
+    std::atomic<uint64_t> unhandled_{0};
+    std::atomic<int64_t> last_rtt_us_{-1};
+};
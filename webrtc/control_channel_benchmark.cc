@@ -0,0 +1,185 @@
+#include "control_channel_benchmark.h"
+#include "session_description_observers.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// 回环连接一端的观察者：记录ICE收集完成，并把对端创建的通道交给ControlChannel
+class LoopbackObserver : public webrtc::PeerConnectionObserver {
+public:
+    explicit LoopbackObserver(ControlChannel* channel) : channel_(channel) {}
+
+    void OnSignalingChange(webrtc::PeerConnectionInterface::SignalingState) override {}
+    void OnDataChannel(webrtc::scoped_refptr<webrtc::DataChannelInterface> channel) override {
+        channel_->Attach(channel);
+    }
+    void OnIceGatheringChange(webrtc::PeerConnectionInterface::IceGatheringState new_state) override {
+        if (new_state == webrtc::PeerConnectionInterface::kIceGatheringComplete) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            gathering_complete_ = true;
+            cv_.notify_all();
+        }
+    }
+    void OnIceCandidate(const webrtc::IceCandidateInterface*) override {}
+
+    // 等待候选者收集完成，之后本地描述中包含全部候选者，可以一次交给对端
+    bool WaitGatheringComplete(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, timeout, [this]() { return gathering_complete_; });
+    }
+
+private:
+    ControlChannel* channel_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool gathering_complete_ = false;
+};
+
+// 同步执行CreateOffer/CreateAnswer + SetLocalDescription，返回包含全部候选者的本地SDP
+bool CreateLocalDescription(webrtc::PeerConnectionInterface* pc, LoopbackObserver* observer, bool offer,
+                            std::string* sdp) {
+    std::promise<bool> done;
+    auto on_created = [pc, &done](webrtc::SessionDescriptionInterface* desc) {
+        pc->SetLocalDescription(
+            SetSessionDescriptionObserver::Create(
+                [&done]() { done.set_value(true); },
+                [&done](webrtc::RTCError error) {
+                    std::cerr << "SetLocalDescription failed: " << error.message() << std::endl;
+                    done.set_value(false);
+                }).get(),
+            desc);
+    };
+    auto on_error = [&done](webrtc::RTCError error) {
+        std::cerr << "Create description failed: " << error.message() << std::endl;
+        done.set_value(false);
+    };
+    webrtc::PeerConnectionInterface::RTCOfferAnswerOptions options;
+    auto observer_ref = CreateSessionDescriptionObserver::Create(on_created, on_error);
+    if (offer) {
+        pc->CreateOffer(observer_ref.get(), options);
+    } else {
+        pc->CreateAnswer(observer_ref.get(), options);
+    }
+    if (!done.get_future().get() || !observer->WaitGatheringComplete(std::chrono::seconds(10))) {
+        return false;
+    }
+    return pc->local_description()->ToString(sdp);
+}
+
+bool SetRemoteDescription(webrtc::PeerConnectionInterface* pc, webrtc::SdpType type, const std::string& sdp) {
+    webrtc::SdpParseError error;
+    std::unique_ptr<webrtc::SessionDescriptionInterface> desc = webrtc::CreateSessionDescription(type, sdp, &error);
+    if (!desc) {
+        std::cerr << "Failed to parse loopback SDP: " << error.description << std::endl;
+        return false;
+    }
+    std::promise<bool> done;
+    pc->SetRemoteDescription(
+        SetSessionDescriptionObserver::Create(
+            [&done]() { done.set_value(true); },
+            [&done](webrtc::RTCError error) {
+                std::cerr << "SetRemoteDescription failed: " << error.message() << std::endl;
+                done.set_value(false);
+            }).get(),
+        desc.release());
+    return done.get_future().get();
+}
+
+int64_t Percentile(const std::vector<int64_t>& sorted, double fraction) {
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+}  // namespace
+
+ControlChannelBenchmark::ControlChannelBenchmark(webrtc::PeerConnectionFactoryInterface* factory)
+    : factory_(factory) {}
+
+bool ControlChannelBenchmark::Run(int count, ControlChannel::Mode mode, Result* result) {
+    const auto start = std::chrono::steady_clock::now();
+    ControlChannel sender_channel;
+    ControlChannel echo_channel;
+    LoopbackObserver sender_observer(&sender_channel);
+    LoopbackObserver echo_observer(&echo_channel);
+
+    // 两端在同一台机器上，只用主机候选者
+    webrtc::PeerConnectionInterface::RTCConfiguration config;
+    config.type = webrtc::PeerConnectionInterface::kNoRelay;
+    auto sender_pc = factory_->CreatePeerConnectionOrError(config, webrtc::PeerConnectionDependencies(&sender_observer));
+    auto echo_pc = factory_->CreatePeerConnectionOrError(config, webrtc::PeerConnectionDependencies(&echo_observer));
+    if (!sender_pc.ok() || !echo_pc.ok()) {
+        std::cerr << "Failed to create loopback PeerConnections" << std::endl;
+        return false;
+    }
+    auto sender = sender_pc.MoveValue();
+    auto echo = echo_pc.MoveValue();
+
+    bool connected = false;
+    std::string offer;
+    std::string answer;
+    if (sender_channel.Create(sender.get()) &&
+        CreateLocalDescription(sender.get(), &sender_observer, true, &offer) &&
+        SetRemoteDescription(echo.get(), webrtc::SdpType::kOffer, offer) &&
+        CreateLocalDescription(echo.get(), &echo_observer, false, &answer) &&
+        SetRemoteDescription(sender.get(), webrtc::SdpType::kAnswer, answer)) {
+        for (int i = 0; i < 1000 && !connected; ++i) {
+            connected = sender_channel.IsOpen(mode) && echo_channel.IsOpen(mode);
+            if (!connected) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+    }
+    result->setup_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<int64_t> samples;
+    if (connected) {
+        std::mutex mutex;
+        std::condition_variable cv;
+        int64_t last_rtt_us = -1;
+        sender_channel.SetRttCallback([&](int64_t rtt_us) {
+            std::lock_guard<std::mutex> lock(mutex);
+            last_rtt_us = rtt_us;
+            cv.notify_all();
+        });
+        // 一问一答，不让消息在通道里排队，测到的是单条消息的往返时延
+        for (int i = 0; i < count; ++i) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                last_rtt_us = -1;
+            }
+            if (!sender_channel.SendPing(mode)) {
+                break;
+            }
+            result->sent++;
+            std::unique_lock<std::mutex> lock(mutex);
+            if (cv.wait_for(lock, std::chrono::seconds(1), [&]() { return last_rtt_us >= 0; })) {
+                samples.push_back(last_rtt_us);
+            }
+        }
+        sender_channel.SetRttCallback(nullptr);
+    } else {
+        std::cerr << "Loopback control channel did not open" << std::endl;
+    }
+
+    sender_channel.Close();
+    echo_channel.Close();
+    sender->Close();
+    echo->Close();
+
+    result->received = static_cast<int>(samples.size());
+    if (samples.empty()) {
+        return false;
+    }
+    std::sort(samples.begin(), samples.end());
+    result->min_us = samples.front();
+    result->p50_us = Percentile(samples, 0.5);
+    result->p99_us = Percentile(samples, 0.99);
+    result->max_us = samples.back();
+    return true;
+}
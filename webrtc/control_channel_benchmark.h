@@ -0,0 +1,43 @@
+#pragma once
+#include "control_channel.h"
+#include "api/peer_connection_interface.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 控制通道往返时延测试
+ *
+ * 在本机建立两个互相连接的PeerConnection（主机候选者，不经过任何服务器），
+ * 由一端逐条发送ping、另一端的ControlChannel自动回复pong，统计往返时延的分布。
+ * 结果反映DataChannel本身（SCTP/DTLS/UDP与线程切换）的开销，不含网络传输。
+ */
+class ControlChannelBenchmark {
+public:
+    struct Result {
+        int sent = 0;
+        int received = 0;
+        int64_t min_us = 0;
+        int64_t p50_us = 0;
+        int64_t p99_us = 0;
+        int64_t max_us = 0;
+        double setup_ms = 0;  // 从创建连接到通道打开的耗时
+    };
+
+    /**
+     * @brief 构造函数
+     * @param factory 用于创建两端PeerConnection的工厂
+     */
+    explicit ControlChannelBenchmark(webrtc::PeerConnectionFactoryInterface* factory);
+
+    /**
+     * @brief 执行测试（阻塞，不能在信令线程调用）
+     * @param count ping次数
+     * @param mode 测试可靠或不可靠通道
+     * @param result 输出
+     * @return 连接建立成功且至少收到一个pong时返回true
+     */
+    bool Run(int count, ControlChannel::Mode mode, Result* result);
+
+private:
+    webrtc::PeerConnectionFactoryInterface* factory_;
+};
@@ -1,4 +1,5 @@
 #include "encoded_video_frame_handler_rockit.h"
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 
@@ -18,34 +19,40 @@ extern "C" {
 #include "rk_mpi_mb.h"   // [新增] 内存块模块API
 }
 
-// 视频状态码定义
-enum VideoStateCode {
-    VIDEO_STATE_INITIALIZED = 0,
-    VIDEO_STATE_STARTED = 1,
-    VIDEO_STATE_STOPPED = 2,
-    VIDEO_STATE_FIRST_FRAME = 3,
-    VIDEO_STATE_KEY_FRAME = 4,
-    VIDEO_STATE_DECODER_ERROR = -1,
-    VIDEO_STATE_DISPLAY_ERROR = -2,
-    VIDEO_STATE_SYNC_RESET = 10,
-};
-
 // 辅助函数：获取当前系统时间（毫秒）
 static int64_t GetCurrentTimeMs() {
     return std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::system_clock::now().time_since_epoch()).count();
 }
 
+std::mutex EncodedVideoFrameHandler::display_mutex_;
+int EncodedVideoFrameHandler::display_users_ = 0;
+int EncodedVideoFrameHandler::layer_width_ = 0;
+int EncodedVideoFrameHandler::layer_height_ = 0;
+
 EncodedVideoFrameHandler::EncodedVideoFrameHandler()
     : width_(1920)
     , height_(1080)
     , codec_type_("H264")
     , vdec_chn_(0)
     , vo_chn_(0)
+    , display_x_(0)
+    , display_y_(0)
+    , display_width_(0)
+    , display_height_(0)
+    , decoder_buffer_count_(8)
     , is_initialized_(false)
     , is_running_(false)
     , is_decoder_ready_(false)
     , is_display_ready_(false)
+    , frames_decoded_(0)
+    , bytes_decoded_(0)
+    , frames_dropped_(0)
+    , pending_max_temporal_layer_(-1)
+    , max_temporal_layer_(-1)
+    , max_temporal_index_seen_(0)
+    , frames_skipped_(0)
+    , bytes_skipped_(0)
     , first_frame_pts_(0)
     , first_frame_time_(0)
     , first_frame_received_(false) {
@@ -98,6 +105,13 @@ void EncodedVideoFrameHandler::Stop() {
     
     is_running_ = false;
     
+    // 先解除VDEC到VO的绑定，再销毁解码通道
+    if (is_display_ready_) {
+        MPP_CHN_S stSrcChn = {RK_ID_VDEC, 0, vdec_chn_};
+        MPP_CHN_S stDestChn = {RK_ID_VO, 0, vo_chn_};
+        RK_MPI_SYS_UnBind(&stSrcChn, &stDestChn);
+    }
+
     // 停止Rockit解码器
     if (is_decoder_ready_) {
         RK_MPI_VDEC_StopRecvStream(vdec_chn_);
@@ -105,10 +119,16 @@ void EncodedVideoFrameHandler::Stop() {
         is_decoder_ready_ = false;
     }
     
-    // 停止Rockit显示输出
+    // 停止Rockit显示输出；最后一个使用者负责关闭图层和设备
     if (is_display_ready_) {
         RK_MPI_VO_DisableChn(0, vo_chn_);
         is_display_ready_ = false;
+        display_hidden_ = false;
+        std::lock_guard<std::mutex> lock(display_mutex_);
+        if (--display_users_ == 0) {
+            RK_MPI_VO_DisableLayer(0);
+            RK_MPI_VO_Disable(0);
+        }
     }
     
     NotifyVideoState(VIDEO_STATE_STOPPED, "Video handler stopped");
@@ -121,11 +141,146 @@ void EncodedVideoFrameHandler::Reset() {
         first_frame_received_ = false;
         first_frame_pts_ = 0;
         first_frame_time_ = 0;
+        first_frame_arrival_us_ = -1;
+    }
+    first_picture_pending_ = false;
+    {
+        std::lock_guard<std::mutex> lock(arrival_mutex_);
+        last_arrival_us_ = -1;
     }
     
     NotifyVideoState(VIDEO_STATE_SYNC_RESET, "Video sync reset");
 }
 
+void EncodedVideoFrameHandler::Recycle() {
+    Reset();
+    {
+        std::lock_guard<std::mutex> lock(sync_mutex_);
+        recycle_time_us_ = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        decoder_recreated_ = false;
+    }
+    awaiting_key_frame_ = true;
+    preconfigured_ = false;
+    max_temporal_layer_ = -1;
+    pending_max_temporal_layer_ = -1;
+    max_temporal_index_seen_ = 0;
+    // 统计按会话计算：会话用量、关闭日志和层选择的码率都从零开始
+    frames_decoded_ = 0;
+    bytes_decoded_ = 0;
+    frames_dropped_ = 0;
+    frames_skipped_ = 0;
+    bytes_skipped_ = 0;
+    if (is_decoder_ready_) {
+        // 丢弃旧发送端尚未解码的码流，通道本身保留
+        RK_MPI_VDEC_StopRecvStream(vdec_chn_);
+        RK_MPI_VDEC_ResetChn(vdec_chn_);
+        RK_MPI_VDEC_StartRecvStream(vdec_chn_);
+    }
+    if (is_display_ready_ && !display_hidden_) {
+        // 不在屏幕上留下已离开的发送端的最后一帧
+        RK_MPI_VO_HideChn(0, vo_chn_);
+        display_hidden_ = true;
+    }
+    NotifyVideoState(VIDEO_STATE_SYNC_RESET, "Video channel recycled for the next session");
+}
+
+bool EncodedVideoFrameHandler::Preconfigure(const std::string& codec_type, int width, int height,
+                                            const std::vector<std::string>& parameter_sets) {
+    if (!is_initialized_ || width <= 0 || height <= 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(pipeline_mutex_);
+    const auto start = std::chrono::steady_clock::now();
+    const bool was_ready = is_decoder_ready_ && is_display_ready_;
+    if (is_decoder_ready_ && (codec_type != codec_type_ || width != width_ || height != height_)) {
+        // 沿用上一个会话的通道但参数不同：在这里而不是首帧时重建VDEC
+        codec_type_ = codec_type;
+        if (!ReconfigureDecoder(width, height)) {
+            return false;
+        }
+    } else if (!is_decoder_ready_) {
+        codec_type_ = codec_type;
+        width_ = width;
+        height_ = height;
+        if (!InitializeDecoder()) {
+            return false;
+        }
+    }
+    if (is_display_ready_) {
+        if (!was_ready) {
+            MPP_CHN_S stSrcChn = {RK_ID_VDEC, 0, vdec_chn_};
+            MPP_CHN_S stDestChn = {RK_ID_VO, 0, vo_chn_};
+            RK_MPI_SYS_Bind(&stSrcChn, &stDestChn);
+        }
+    } else if (!InitializeDisplay()) {
+        return false;
+    }
+
+    // 参数集以起始码拼接后送入解码器，不计入解码帧数
+    std::string annexb;
+    for (const auto& nal : parameter_sets) {
+        annexb.append("\x00\x00\x00\x01", 4);
+        annexb.append(nal);
+    }
+    const bool warmed = !annexb.empty() &&
+                        SendStream(reinterpret_cast<const uint8_t*>(annexb.data()), annexb.size(), 0);
+    preconfigured_ = true;
+    std::cout << "[Timing] VDEC chn " << vdec_chn_ << " pre-configured from offer: " << codec_type_ << " "
+              << width_ << "x" << height_ << (was_ready ? " (channels kept)" : "") << ", "
+              << (warmed ? std::to_string(parameter_sets.size()) + " parameter sets sent" : "no parameter sets")
+              << ", " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()
+              << " ms" << std::endl;
+    return true;
+}
+
+bool EncodedVideoFrameHandler::ReconfigureDecoder(int width, int height) {
+    const auto start = std::chrono::steady_clock::now();
+    MPP_CHN_S stSrcChn = {RK_ID_VDEC, 0, vdec_chn_};
+    MPP_CHN_S stDestChn = {RK_ID_VO, 0, vo_chn_};
+    if (is_display_ready_) {
+        RK_MPI_SYS_UnBind(&stSrcChn, &stDestChn);
+    }
+    RK_MPI_VDEC_StopRecvStream(vdec_chn_);
+    RK_MPI_VDEC_DestroyChn(vdec_chn_);
+    is_decoder_ready_ = false;
+
+    const int old_width = width_;
+    const int old_height = height_;
+    width_ = width;
+    height_ = height;
+    if (!InitializeDecoder()) {
+        return false;
+    }
+    if (is_display_ready_) {
+        int ret = RK_MPI_SYS_Bind(&stSrcChn, &stDestChn);
+        if (ret != RK_SUCCESS) {
+            RK_LOGE("Failed to rebind VDEC and VO, error code: %#x", ret);
+            return false;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(sync_mutex_);
+        decoder_recreated_ = true;
+    }
+    std::cout << "[INFO] VDEC chn " << vdec_chn_ << " reconfigured " << old_width << "x" << old_height << " -> "
+              << width_ << "x" << height_ << " in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()
+              << " ms, VO channel kept" << std::endl;
+    return true;
+}
+
+bool EncodedVideoFrameHandler::GetArrivalTimeUs(uint32_t rtp_timestamp, int64_t* arrival_us) const {
+    std::lock_guard<std::mutex> lock(arrival_mutex_);
+    for (const Arrival& arrival : arrivals_) {
+        if (arrival.time_us >= 0 && arrival.rtp_timestamp == rtp_timestamp) {
+            *arrival_us = arrival.time_us;
+            return true;
+        }
+    }
+    return false;
+}
+
 webrtc::EncodedImageCallback::Result EncodedVideoFrameHandler::OnEncodedImage(
     const webrtc::EncodedImage& encoded_image,
     const webrtc::CodecSpecificInfo* codec_specific_info) {
@@ -134,7 +289,81 @@ webrtc::EncodedImageCallback::Result EncodedVideoFrameHandler::OnEncodedImage(
         // 成功，但告知WebRTC我们不处理（虽然这里实际上不会发生）
         return webrtc::EncodedImageCallback::Result(webrtc::EncodedImageCallback::Result::OK, encoded_image.RtpTimestamp());
     }
+    {
+        std::lock_guard<std::mutex> lock(arrival_mutex_);
+        const int64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        Arrival& arrival = arrivals_[next_arrival_++ % kArrivalHistory];
+        arrival.rtp_timestamp = encoded_image.RtpTimestamp();
+        arrival.time_us = now_us;
+        if (last_arrival_us_ >= 0) {
+            const int64_t interval_us = now_us - last_arrival_us_;
+            if (avg_frame_interval_us_ > 0 &&
+                interval_us > std::max<int64_t>(3 * avg_frame_interval_us_, avg_frame_interval_us_ + 150000)) {
+                freeze_count_++;
+                total_freeze_ms_ += interval_us / 1000;
+            } else {
+                avg_frame_interval_us_ = avg_frame_interval_us_ > 0
+                                             ? (avg_frame_interval_us_ * 15 + interval_us) / 16
+                                             : interval_us;
+            }
+        }
+        last_arrival_us_ = now_us;
+    }
     
+    // 时间层选择：时间层0的帧和关键帧是切换点，超出限制的高时间层帧不送入解码器
+    int temporal_index = encoded_image.TemporalIndex().value_or(0);
+    if (temporal_index > max_temporal_index_seen_) {
+        max_temporal_index_seen_ = temporal_index;
+    }
+    if (temporal_index == 0 || encoded_image._frameType == webrtc::VideoFrameType::kVideoFrameKey) {
+        max_temporal_layer_ = pending_max_temporal_layer_.load();
+    }
+    int max_temporal_layer = max_temporal_layer_;
+    if (max_temporal_layer >= 0 && temporal_index > max_temporal_layer) {
+        frames_skipped_++;
+        bytes_skipped_ += encoded_image.size();
+        return webrtc::EncodedImageCallback::Result(webrtc::EncodedImageCallback::Result::OK, encoded_image.RtpTimestamp());
+    }
+
+    const bool is_key_frame = encoded_image._frameType == webrtc::VideoFrameType::kVideoFrameKey;
+    if (awaiting_key_frame_) {
+        // 回收后的通道只从新码流的关键帧开始解码
+        if (!is_key_frame) {
+            return webrtc::EncodedImageCallback::Result(webrtc::EncodedImageCallback::Result::OK, encoded_image.RtpTimestamp());
+        }
+        awaiting_key_frame_ = false;
+    }
+    if (first_picture_pending_ && is_decoder_ready_) {
+        // 解码器输出第一幅图像（已绑定VO，随即显示）时输出从首帧到达开始的耗时
+        VDEC_CHN_STATUS_S status;
+        memset(&status, 0, sizeof(status));
+        if (RK_MPI_VDEC_QueryStatus(vdec_chn_, &status) == RK_SUCCESS && status.u32DecodeStreamFrames > 0) {
+            first_picture_pending_ = false;
+            const int64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            std::cout << "[Timing] VDEC chn " << vdec_chn_ << " first frame to display: "
+                      << (now_us - first_frame_arrival_us_) / 1000 << " ms (" << pipeline_origin_ << ")" << std::endl;
+        }
+    }
+
+    // 通道创建与Preconfigure互斥；首帧到达时记录通道来源，用于对比首帧耗时
+    std::unique_lock<std::mutex> pipeline_lock(pipeline_mutex_);
+    if (!first_frame_received_ && first_frame_arrival_us_ < 0) {
+        first_frame_arrival_us_ = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        pipeline_origin_ = preconfigured_ ? "pipeline pre-configured from offer"
+                           : (is_decoder_ready_ && is_display_ready_) ? "pipeline kept from previous session"
+                                                                      : "pipeline created on first frame";
+    }
+    // 已有解码器但码流分辨率变化（新的发送端或发送端切换了分辨率）：只重建VDEC
+    if (is_decoder_ready_ && is_key_frame && encoded_image._encodedWidth > 0 && encoded_image._encodedHeight > 0 &&
+        (static_cast<int>(encoded_image._encodedWidth) != width_ || static_cast<int>(encoded_image._encodedHeight) != height_)) {
+        if (!ReconfigureDecoder(encoded_image._encodedWidth, encoded_image._encodedHeight)) {
+            return webrtc::EncodedImageCallback::Result(webrtc::EncodedImageCallback::Result::ERROR_SEND_FAILED, encoded_image.RtpTimestamp());
+        }
+    }
+
     // 【核心修改】检查解码器和显示是否已就绪
     if (!is_decoder_ready_ || !is_display_ready_) {
         // 从视频帧中获取真实的分辨率
@@ -144,24 +373,30 @@ webrtc::EncodedImageCallback::Result EncodedVideoFrameHandler::OnEncodedImage(
                   << width_ << "x" << height_ << std::endl;
 
         // 使用真实分辨率初始化解码器和显示
-        if (!InitializeDecoder()) {
+        if (!is_decoder_ready_ && !InitializeDecoder()) {
             std::cerr << "Failed to initialize decoder with dynamic resolution" << std::endl;
             return webrtc::EncodedImageCallback::Result(webrtc::EncodedImageCallback::Result::ERROR_SEND_FAILED, encoded_image.RtpTimestamp());
         }
-        if (!InitializeDisplay()) {
+        if (is_display_ready_) {
+            // 显示通道仍在（此前重建解码器失败）：只需重新绑定
+            MPP_CHN_S stSrcChn = {RK_ID_VDEC, 0, vdec_chn_};
+            MPP_CHN_S stDestChn = {RK_ID_VO, 0, vo_chn_};
+            RK_MPI_SYS_Bind(&stSrcChn, &stDestChn);
+        } else if (!InitializeDisplay()) {
             std::cerr << "Failed to initialize display with dynamic resolution" << std::endl;
             return webrtc::EncodedImageCallback::Result(webrtc::EncodedImageCallback::Result::ERROR_SEND_FAILED, encoded_image.RtpTimestamp());
         }
     }
+    pipeline_lock.unlock();
     // 获取编码数据
     const uint8_t* data = encoded_image.data();
     size_t size = encoded_image.size();
     // [修正3] 在新版API中，ntp_time_ms_ 和 capture_time_ms_ 都需要从 presentation_timestamp 中获取
     int64_t capture_time_ms = encoded_image.PresentationTimestamp().value_or(webrtc::Timestamp::MinusInfinity()).ms();
-    bool is_key_frame = encoded_image._frameType == webrtc::VideoFrameType::kVideoFrameKey;
     
     // 解码并显示帧
     if (!DecodeAndDisplayFrame(data, size, capture_time_ms, is_key_frame)) {
+        frames_dropped_++;
         std::cerr << "Failed to decode and display frame" << std::endl;
         return webrtc::EncodedImageCallback::Result(webrtc::EncodedImageCallback::Result::ERROR_SEND_FAILED, encoded_image.RtpTimestamp());
     }
@@ -190,7 +425,7 @@ bool EncodedVideoFrameHandler::InitializeDecoder() {
     // 设置图像信息
     vdec_attr.u32PicWidth = width_;
     vdec_attr.u32PicHeight = height_;
-    vdec_attr.u32FrameBufCnt = 8;  // 帧缓冲数量
+    vdec_attr.u32FrameBufCnt = decoder_buffer_count_;  // 帧缓冲数量，由延迟档位决定
     
     // 创建解码通道
     int ret = RK_MPI_VDEC_CreateChn(vdec_chn_, &vdec_attr);
@@ -212,55 +447,117 @@ bool EncodedVideoFrameHandler::InitializeDecoder() {
     return true;
 }
 
+bool EncodedVideoFrameHandler::GetDecoderBacklog(uint32_t* stream_frames, uint32_t* pictures) const {
+    if (!is_decoder_ready_) {
+        return false;
+    }
+    VDEC_CHN_STATUS_S status;
+    memset(&status, 0, sizeof(status));
+    if (RK_MPI_VDEC_QueryStatus(vdec_chn_, &status) != RK_SUCCESS) {
+        return false;
+    }
+    *stream_frames = status.u32LeftStreamFrames;
+    *pictures = status.u32LeftPics;
+    return true;
+}
+
+void EncodedVideoFrameHandler::GetDisplaySize(int* width, int* height) const {
+    int layer_width;
+    int layer_height;
+    {
+        std::lock_guard<std::mutex> lock(display_mutex_);
+        // 图层在第一路视频到达时才配置，之前按1080P输出估计
+        layer_width = layer_width_ > 0 ? layer_width_ : 1920;
+        layer_height = layer_height_ > 0 ? layer_height_ : 1080;
+    }
+    if (display_width_ > 0 && display_height_ > 0) {
+        *width = static_cast<int>(display_width_ * layer_width);
+        *height = static_cast<int>(display_height_ * layer_height);
+    } else {
+        *width = layer_width;
+        *height = layer_height;
+    }
+}
+
 bool EncodedVideoFrameHandler::InitializeDisplay() {
     // 定义要使用的VO设备和图层。对于RK356x，通常使用设备0（如HDMI）和图层0（主视频层）
     VO_DEV VoDev = 0;
     VO_LAYER VoLayer = 0; 
-    // 在绑定模式下，VO通道通常也用0
-    vo_chn_ = 0; 
-
-    // 1. 配置并启用显示设备 (Device)
-    VO_PUB_ATTR_S stVoPubAttr;
-    memset(&stVoPubAttr, 0, sizeof(stVoPubAttr));
-    // 设置接口类型，例如HDMI
-    stVoPubAttr.enIntfType = VO_INTF_HDMI;
-    // 设置时序/分辨率，例如1080P@60Hz
-    stVoPubAttr.enIntfSync = VO_OUTPUT_1080P60; 
-
-    int ret = RK_MPI_VO_SetPubAttr(VoDev, &stVoPubAttr);
-    if (ret != RK_SUCCESS) {
-        RK_LOGE("Failed to set VO public attributes, error code: %#x", ret);
-        return false;
-    }
+    int ret;
+
+    // 设备和图层只由第一个使用者配置，后续会话只在同一图层上占用自己的通道
+    std::lock_guard<std::mutex> lock(display_mutex_);
+    if (display_users_ == 0) {
+        // 1. 配置并启用显示设备 (Device)
+        VO_PUB_ATTR_S stVoPubAttr;
+        memset(&stVoPubAttr, 0, sizeof(stVoPubAttr));
+        // 设置接口类型，例如HDMI
+        stVoPubAttr.enIntfType = VO_INTF_HDMI;
+        // 设置时序/分辨率，例如1080P@60Hz
+        stVoPubAttr.enIntfSync = VO_OUTPUT_1080P60; 
+
+        ret = RK_MPI_VO_SetPubAttr(VoDev, &stVoPubAttr);
+        if (ret != RK_SUCCESS) {
+            RK_LOGE("Failed to set VO public attributes, error code: %#x", ret);
+            return false;
+        }
 
-    ret = RK_MPI_VO_Enable(VoDev);
-    if (ret != RK_SUCCESS) {
-        RK_LOGE("Failed to enable VO device, error code: %#x", ret);
-        return false;
-    }
+        ret = RK_MPI_VO_Enable(VoDev);
+        if (ret != RK_SUCCESS) {
+            RK_LOGE("Failed to enable VO device, error code: %#x", ret);
+            return false;
+        }
 
-    // 2. 配置并启用视频图层 (Layer)
-    VO_VIDEO_LAYER_ATTR_S stLayerAttr;
-    memset(&stLayerAttr, 0, sizeof(stLayerAttr));
-    // 设置图层的显示区域和画布大小，应与视频分辨率一致
-    stLayerAttr.stDispRect = {0, 0, static_cast<RK_U32>(width_), static_cast<RK_U32>(height_)};
-    stLayerAttr.stImageSize = {static_cast<RK_U32>(width_), static_cast<RK_U32>(height_)};
-    // 设置图层期望接收的像素格式，应与VDEC解码输出的格式一致
-    stLayerAttr.enPixFormat = RK_FMT_YUV420SP; 
-    stLayerAttr.u32DispFrmRt = 60; // 设置显示帧率
+        // 2. 配置并启用视频图层 (Layer)
+        VO_VIDEO_LAYER_ATTR_S stLayerAttr;
+        memset(&stLayerAttr, 0, sizeof(stLayerAttr));
+        // 设置图层的显示区域和画布大小，应与视频分辨率一致
+        stLayerAttr.stDispRect = {0, 0, static_cast<RK_U32>(width_), static_cast<RK_U32>(height_)};
+        stLayerAttr.stImageSize = {static_cast<RK_U32>(width_), static_cast<RK_U32>(height_)};
+        // 设置图层期望接收的像素格式，应与VDEC解码输出的格式一致
+        stLayerAttr.enPixFormat = RK_FMT_YUV420SP; 
+        stLayerAttr.u32DispFrmRt = 60; // 设置显示帧率
+
+        ret = RK_MPI_VO_SetLayerAttr(VoLayer, &stLayerAttr);
+        if (ret != RK_SUCCESS) {
+            RK_LOGE("Failed to set VO layer attributes, error code: %#x", ret);
+            RK_MPI_VO_Disable(VoDev); // 清理已启用的设备
+            return false;
+        }
 
-    ret = RK_MPI_VO_SetLayerAttr(VoLayer, &stLayerAttr);
-    if (ret != RK_SUCCESS) {
-        RK_LOGE("Failed to set VO layer attributes, error code: %#x", ret);
-        RK_MPI_VO_Disable(VoDev); // 清理已启用的设备
-        return false;
+        ret = RK_MPI_VO_EnableLayer(VoLayer);
+        if (ret != RK_SUCCESS) {
+            RK_LOGE("Failed to enable VO layer, error code: %#x", ret);
+            RK_MPI_VO_Disable(VoDev); // 清理已启用的设备
+            return false;
+        }
+        layer_width_ = width_;
+        layer_height_ = height_;
     }
 
-    ret = RK_MPI_VO_EnableLayer(VoLayer);
-    if (ret != RK_SUCCESS) {
-        RK_LOGE("Failed to enable VO layer, error code: %#x", ret);
-        RK_MPI_VO_Disable(VoDev); // 清理已启用的设备
-        return false;
+    // 指定了显示区域时，把通道放到图层上的对应位置（画中画/分屏）
+    bool chn_enabled = false;
+    if (display_width_ > 0 && display_height_ > 0) {
+        VO_CHN_ATTR_S stChnAttr;
+        memset(&stChnAttr, 0, sizeof(stChnAttr));
+        stChnAttr.stRect.s32X = static_cast<RK_S32>(display_x_ * layer_width_) & ~1;
+        stChnAttr.stRect.s32Y = static_cast<RK_S32>(display_y_ * layer_height_) & ~1;
+        stChnAttr.stRect.u32Width = static_cast<RK_U32>(display_width_ * layer_width_) & ~1u;
+        stChnAttr.stRect.u32Height = static_cast<RK_U32>(display_height_ * layer_height_) & ~1u;
+        stChnAttr.u32Priority = vo_chn_;
+        ret = RK_MPI_VO_SetChnAttr(VoLayer, vo_chn_, &stChnAttr);
+        if (ret == RK_SUCCESS) {
+            ret = RK_MPI_VO_EnableChn(VoLayer, vo_chn_);
+            chn_enabled = ret == RK_SUCCESS;
+        }
+        if (ret != RK_SUCCESS) {
+            RK_LOGE("Failed to enable VO channel %d, error code: %#x", vo_chn_, ret);
+            if (display_users_ == 0) {
+                RK_MPI_VO_DisableLayer(VoLayer);
+                RK_MPI_VO_Disable(VoDev);
+            }
+            return false;
+        }
     }
 
     // 3. 将VDEC通道绑定到VO图层上，实现零拷贝
@@ -277,12 +574,18 @@ bool EncodedVideoFrameHandler::InitializeDisplay() {
     ret = RK_MPI_SYS_Bind(&stSrcChn, &stDestChn);
     if (ret != RK_SUCCESS) {
         RK_LOGE("Failed to bind VDEC and VO, error code: %#x", ret);
-        // 清理已启用的图层和设备
-        RK_MPI_VO_DisableLayer(VoLayer);
-        RK_MPI_VO_Enable(VoDev);
+        // 清理本次启用的通道，以及已启用的图层和设备（仍有其他会话在用时保留）
+        if (chn_enabled) {
+            RK_MPI_VO_DisableChn(VoLayer, vo_chn_);
+        }
+        if (display_users_ == 0) {
+            RK_MPI_VO_DisableLayer(VoLayer);
+            RK_MPI_VO_Disable(VoDev);
+        }
         return false;
     }
     
+    display_users_++;
     is_display_ready_ = true;
     std::cout << "Display initialized and bound to VDEC successfully." << std::endl;
     return true;
@@ -290,21 +593,14 @@ bool EncodedVideoFrameHandler::InitializeDisplay() {
 
 }
 
-bool EncodedVideoFrameHandler::DecodeAndDisplayFrame(
-    const uint8_t* encoded_data, size_t encoded_size, int64_t pts, bool is_key_frame) {
-    
-    if (!is_decoder_ready_ || !is_display_ready_) {
-        std::cerr << "Decoder or display not ready" << std::endl;
-        return false;
-    }
-
+bool EncodedVideoFrameHandler::SendStream(const uint8_t* data, size_t size, int64_t pts) {
     // 1. 使用 C 标准库的 malloc 申请内存
-    void* buffer_data = malloc(encoded_size);
+    void* buffer_data = malloc(size);
     if (!buffer_data) {
         std::cerr << "Failed to malloc buffer for encoded data" << std::endl;
         return false;
     }
-    memcpy(buffer_data, encoded_data, encoded_size);
+    memcpy(buffer_data, data, size);
 
     // 2. 准备用户数据和回调函数，用于内存的自动释放
     UserData* userData = new UserData();
@@ -315,7 +611,7 @@ bool EncodedVideoFrameHandler::DecodeAndDisplayFrame(
     stMbExtConfig.pFreeCB = FreeCallback;    // 设置释放回调函数
     stMbExtConfig.pOpaque = userData;        // 传递用户数据指针
     stMbExtConfig.pu8VirAddr = (RK_U8*)buffer_data;
-    stMbExtConfig.u64Size = encoded_size;
+    stMbExtConfig.u64Size = size;
 
     // 3. 使用 RK_MPI_SYS_CreateMB 将我们自己的内存“包装”成一个 MB_BLK 句柄
     MB_BLK mb_handle = RK_NULL;
@@ -331,7 +627,7 @@ bool EncodedVideoFrameHandler::DecodeAndDisplayFrame(
     VDEC_STREAM_S stStream;
     memset(&stStream, 0, sizeof(VDEC_STREAM_S));
     stStream.pMbBlk = mb_handle;
-    stStream.u32Len = encoded_size;
+    stStream.u32Len = size;
     stStream.u64PTS = pts;
     stStream.bEndOfStream = RK_FALSE;
     stStream.bEndOfFrame = RK_TRUE;
@@ -350,6 +646,22 @@ bool EncodedVideoFrameHandler::DecodeAndDisplayFrame(
     //    注意：这里只释放句柄，真正的内存(buffer_data)所有权已经移交给MPI，
     //    将在MPI内部使用完毕后，通过我们设置的 FreeCallback 函数来释放。
     RK_MPI_MB_ReleaseMB(mb_handle);
+    return true;
+}
+
+bool EncodedVideoFrameHandler::DecodeAndDisplayFrame(
+    const uint8_t* encoded_data, size_t encoded_size, int64_t pts, bool is_key_frame) {
+    
+    if (!is_decoder_ready_ || !is_display_ready_) {
+        std::cerr << "Decoder or display not ready" << std::endl;
+        return false;
+    }
+
+    if (!SendStream(encoded_data, encoded_size, pts)) {
+        return false;
+    }
+    frames_decoded_++;
+    bytes_decoded_ += encoded_size;
     
     // 处理同步
     int64_t current_time = GetCurrentTimeMs();
@@ -360,6 +672,21 @@ bool EncodedVideoFrameHandler::DecodeAndDisplayFrame(
         first_frame_received_ = true;
         first_frame_pts_ = pts;
         first_frame_time_ = current_time;
+        first_picture_pending_ = first_frame_arrival_us_ >= 0;
+
+        // 回收后的首帧：恢复显示，输出从上一个会话结束到新画面的耗时
+        if (recycle_time_us_ >= 0) {
+            if (display_hidden_) {
+                RK_MPI_VO_ShowChn(0, vo_chn_);
+                display_hidden_ = false;
+            }
+            const int64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            std::cout << "[Timing] VDEC chn " << vdec_chn_ << " session turnover: "
+                      << (now_us - recycle_time_us_) / 1000 << " ms from previous session close to first frame ("
+                      << (decoder_recreated_ ? "decoder recreated" : "decoder reused") << ", VO kept)" << std::endl;
+            recycle_time_us_ = -1;
+        }
         
         NotifyVideoState(VIDEO_STATE_FIRST_FRAME, "First video frame received");
         
@@ -392,6 +719,7 @@ void EncodedVideoFrameHandler::NotifyVideoState(int state, const std::string& me
 }
 
 void EncodedVideoFrameHandler::OnDroppedFrame(DropReason reason) {
+    frames_dropped_++;
     // 暂时只打印日志，表示我们知道有帧被丢弃了
     // 注意：DropReason 是一个枚举，不能直接用 << 打印，需要转成整数
     std::cerr << "A video frame has been dropped, reason code: " << static_cast<int>(reason) << std::endl;
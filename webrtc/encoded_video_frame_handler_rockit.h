@@ -8,6 +8,20 @@
 #include <mutex>
 #include <atomic>
 #include <thread>
+#include <string>
+#include <vector>
+
+// 视频状态码定义（通过VideoStateCallback上报）
+enum VideoStateCode {
+    VIDEO_STATE_INITIALIZED = 0,
+    VIDEO_STATE_STARTED = 1,
+    VIDEO_STATE_STOPPED = 2,
+    VIDEO_STATE_FIRST_FRAME = 3,
+    VIDEO_STATE_KEY_FRAME = 4,
+    VIDEO_STATE_DECODER_ERROR = -1,
+    VIDEO_STATE_DISPLAY_ERROR = -2,
+    VIDEO_STATE_SYNC_RESET = 10,
+};
 
 /**
  * @brief 编码视频帧处理器类 - Rockit版本
@@ -66,6 +80,27 @@ public:
      */
     void Reset();
 
+    /**
+     * @brief 会话结束后留给下一个发送端复用：VDEC/VO通道不销毁，
+     * 清空解码器中旧码流、隐藏显示通道，之后只从关键帧开始送解码。
+     * 新码流分辨率不同时在其关键帧到达时只重建VDEC，VO图层与通道保持。
+     * 新码流的首帧送入解码器时输出从回收到首帧的耗时；帧数、字节数等统计清零，之后只计本会话
+     */
+    void Recycle();
+
+    /**
+     * @brief 按远端Offer中的提示预先创建VDEC/VO通道，让首个关键帧到达时直接送入解码器。
+     * 通道已按相同参数就绪时不做任何事，已就绪但分辨率或编码不同时只重建VDEC。
+     * 带参数集时先送入解码器，解码器在首帧之前就完成SPS/PPS解析
+     * @param codec_type "H264"或"H265"
+     * @param width 视频宽度
+     * @param height 视频高度
+     * @param parameter_sets 参数集NAL（不含起始码），可为空
+     * @return 通道是否就绪
+     */
+    bool Preconfigure(const std::string& codec_type, int width, int height,
+                      const std::vector<std::string>& parameter_sets);
+
     /**
      * @brief 设置音视频同步回调
      * @param callback 回调函数
@@ -78,6 +113,97 @@ public:
      */
     void SetVideoStateCallback(VideoStateCallback callback) { video_state_callback_ = std::move(callback); }
 
+    /**
+     * @brief 指定使用的VDEC通道和VO通道（多个会话同时解码时各占一个通道），需在首帧之前调用
+     * @param vdec_chn 解码通道号
+     * @param vo_chn 显示通道号
+     */
+    void SetChannels(int vdec_chn, int vo_chn) { vdec_chn_ = vdec_chn; vo_chn_ = vo_chn; }
+
+    /**
+     * @brief 指定VO通道在图层上的显示区域（相对图层尺寸的比例，0~1），未设置时铺满整个图层
+     */
+    void SetDisplayRect(double x, double y, double width, double height) {
+        display_x_ = x; display_y_ = y; display_width_ = width; display_height_ = height;
+    }
+
+    /**
+     * @brief 设置VDEC帧缓冲数量，在解码通道创建时生效（首帧或分辨率变化重建通道时）。
+     * 缓冲越少，解码输出到显示之间排队的帧越少，延迟越低
+     * @param count 帧缓冲数量
+     */
+    void SetDecoderBufferCount(int count) { decoder_buffer_count_ = count; }
+
+    /**
+     * @brief 查询解码器中尚未处理的码流帧数和已解码待显示的图像数
+     * @return 解码通道未就绪时返回false
+     */
+    bool GetDecoderBacklog(uint32_t* stream_frames, uint32_t* pictures) const;
+
+    /**
+     * @brief 获取解码通道号
+     */
+    int GetDecoderChannel() const { return vdec_chn_; }
+
+    /**
+     * @brief 获取已送入解码器的帧数和字节数
+     */
+    uint64_t GetFrameCount() const { return frames_decoded_; }
+    uint64_t GetByteCount() const { return bytes_decoded_; }
+
+    /**
+     * @brief 获取送入解码器失败或被WebRTC丢弃的帧数
+     */
+    uint64_t GetDroppedFrameCount() const { return frames_dropped_; }
+
+    /**
+     * @brief 限制送入解码器的最高时间层，-1表示全部送入。
+     * 在下一个时间层0的帧或关键帧处生效，高时间层的帧不被其他帧参考，丢弃后码流仍可解码
+     * @param layer 最高时间层
+     */
+    void SetMaxTemporalLayer(int layer) { pending_max_temporal_layer_ = layer; }
+
+    /**
+     * @brief 当前生效的最高时间层，-1表示全部送入
+     */
+    int GetMaxTemporalLayer() const { return max_temporal_layer_; }
+
+    /**
+     * @brief 码流中出现过的时间层数（没有时间层信息时为1）
+     */
+    int GetTemporalLayerCount() const { return max_temporal_index_seen_ + 1; }
+
+    /**
+     * @brief 因时间层限制而未送入解码器的帧数和字节数
+     */
+    uint64_t GetSkippedFrameCount() const { return frames_skipped_; }
+    uint64_t GetSkippedByteCount() const { return bytes_skipped_; }
+
+    /**
+     * @brief 查询某一帧到达处理器的时间（steady_clock，微秒），只保留最近kArrivalHistory帧
+     * @param rtp_timestamp 帧的RTP时间戳
+     * @param arrival_us 输出
+     * @return 该帧尚未到达或已超出记录范围时返回false
+     */
+    bool GetArrivalTimeUs(uint32_t rtp_timestamp, int64_t* arrival_us) const;
+
+    /**
+     * @brief 画面卡顿次数与累计时长（毫秒）。视频帧不经过WebRTC的解码器，inbound-rtp统计中没有
+     * freezeCount，这里按W3C的定义在帧到达时统计：帧间隔超过平均帧间隔的3倍且比平均值长150毫秒以上
+     */
+    uint64_t GetFreezeCount() const { return freeze_count_; }
+    uint64_t GetTotalFreezeMs() const { return total_freeze_ms_; }
+
+    /**
+     * @brief 获取解码分辨率（首帧之前为Initialize时的默认值）
+     */
+    void GetDecodedSize(int* width, int* height) const { *width = width_; *height = height_; }
+
+    /**
+     * @brief 获取本通道在屏幕上的显示尺寸（像素），未设置显示区域时为整个图层
+     */
+    void GetDisplaySize(int* width, int* height) const;
+
     // 实现EncodedImageCallback接口
     webrtc::EncodedImageCallback::Result OnEncodedImage(
         const webrtc::EncodedImage& encoded_image,
@@ -112,6 +238,18 @@ private:
      */
     bool InitializeDisplay();
 
+    /**
+     * @brief 按新分辨率重建VDEC通道并重新绑定到原VO通道
+     * @return 是否成功
+     */
+    bool ReconfigureDecoder(int width, int height);
+
+    /**
+     * @brief 把一段码流（直通模式，内存交给MPI释放）送入解码器
+     * @return 是否成功
+     */
+    bool SendStream(const uint8_t* data, size_t size, int64_t pts);
+
     /**
      * @brief 解码并显示视频帧
      * @param encoded_data 编码数据
@@ -138,6 +276,17 @@ private:
     // Rockit设备ID
     int vdec_chn_;  // 解码通道
     int vo_chn_;    // 显示通道
+    double display_x_;
+    double display_y_;
+    double display_width_;
+    double display_height_;
+    std::atomic<int> decoder_buffer_count_;
+
+    // VO设备和图层由所有处理器共享，只在第一个用户初始化、最后一个用户释放
+    static std::mutex display_mutex_;
+    static int display_users_;
+    static int layer_width_;
+    static int layer_height_;
 
     // 状态标志
     std::atomic<bool> is_initialized_;
@@ -145,6 +294,46 @@ private:
     std::atomic<bool> is_decoder_ready_;
     std::atomic<bool> is_display_ready_;
 
+    // 解码统计
+    std::atomic<uint64_t> frames_decoded_;
+    std::atomic<uint64_t> bytes_decoded_;
+    std::atomic<uint64_t> frames_dropped_;
+
+    // 时间层选择
+    std::atomic<int> pending_max_temporal_layer_;
+    std::atomic<int> max_temporal_layer_;
+    std::atomic<int> max_temporal_index_seen_;
+    std::atomic<uint64_t> frames_skipped_;
+    std::atomic<uint64_t> bytes_skipped_;
+
+    // 最近到达的帧：RTP时间戳与到达时间，用于测量端到端延迟
+    static constexpr size_t kArrivalHistory = 128;
+    struct Arrival {
+        uint32_t rtp_timestamp = 0;
+        int64_t time_us = -1;
+    };
+    Arrival arrivals_[kArrivalHistory];
+    size_t next_arrival_ = 0;
+    int64_t last_arrival_us_ = -1;       // 重置后为-1，下一帧不参与卡顿判断
+    int64_t avg_frame_interval_us_ = 0;  // 不含卡顿的平均帧间隔
+    mutable std::mutex arrival_mutex_;
+    std::atomic<uint64_t> freeze_count_{0};
+    std::atomic<uint64_t> total_freeze_ms_{0};
+
+    // 会话回收：等待新码流的关键帧，首帧时恢复显示并输出切换耗时
+    std::atomic<bool> awaiting_key_frame_{false};
+    int64_t recycle_time_us_ = -1;
+    bool decoder_recreated_ = false;
+    bool display_hidden_ = false;
+
+    // 通道创建/重建（首帧或Offer到达时），Preconfigure与OnEncodedImage在不同线程调用
+    std::mutex pipeline_mutex_;
+    // 首帧耗时：首帧到达时间、通道来源（预先创建/沿用/首帧时创建），首个解码图像出现前为true
+    std::atomic<bool> preconfigured_{false};
+    int64_t first_frame_arrival_us_ = -1;
+    const char* pipeline_origin_ = "";
+    std::atomic<bool> first_picture_pending_{false};
+
     // 同步相关
     int64_t first_frame_pts_;
     int64_t first_frame_time_;
@@ -0,0 +1,48 @@
+#include "frame_timing_transformer.h"
+#include <chrono>
+
+FrameTimingTransformer::FrameTimingTransformer(TimingCallback callback) : timing_callback_(std::move(callback)) {}
+
+void FrameTimingTransformer::Detach() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    timing_callback_ = nullptr;
+}
+
+void FrameTimingTransformer::Transform(std::unique_ptr<webrtc::TransformableFrameInterface> frame) {
+    webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = sink_callbacks_.find(frame->GetSsrc());
+        callback = it != sink_callbacks_.end() ? it->second : callback_;
+        // 持锁调用，Detach返回后不会再有回调
+        if (timing_callback_) {
+            timing_callback_(frame->GetTimestamp(), std::chrono::duration_cast<std::chrono::microseconds>(
+                                                        std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+    }
+    if (callback) {
+        callback->OnTransformedFrame(std::move(frame));
+    }
+}
+
+void FrameTimingTransformer::RegisterTransformedFrameCallback(
+    webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_ = std::move(callback);
+}
+
+void FrameTimingTransformer::RegisterTransformedFrameSinkCallback(
+    webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback, uint32_t ssrc) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sink_callbacks_[ssrc] = std::move(callback);
+}
+
+void FrameTimingTransformer::UnregisterTransformedFrameCallback() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_ = nullptr;
+}
+
+void FrameTimingTransformer::UnregisterTransformedFrameSinkCallback(uint32_t ssrc) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sink_callbacks_.erase(ssrc);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "api/frame_transformer_interface.h"
+#include "api/scoped_refptr.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+/**
+ * @brief 发送端编码帧的直通变换器
+ *
+ * 帧原样交给打包器，同时报告每帧的RTP时间戳与编码输出时间（steady_clock微秒），
+ * 用于测量端到端延迟：回环测试发送端经控制通道转告接收端，
+ * 网络仿真测试在同一进程内直接与接收端的到达时间配对。
+ */
+class FrameTimingTransformer : public webrtc::FrameTransformerInterface {
+public:
+    using TimingCallback = std::function<void(uint32_t rtp_timestamp, int64_t sent_us)>;
+
+    explicit FrameTimingTransformer(TimingCallback callback);
+
+    /**
+     * @brief 停止报告，之后的帧只做转发。回调引用的对象销毁之前调用
+     */
+    void Detach();
+
+    void Transform(std::unique_ptr<webrtc::TransformableFrameInterface> frame) override;
+    void RegisterTransformedFrameCallback(webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback) override;
+    void RegisterTransformedFrameSinkCallback(webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback,
+                                              uint32_t ssrc) override;
+    void UnregisterTransformedFrameCallback() override;
+    void UnregisterTransformedFrameSinkCallback(uint32_t ssrc) override;
+
+private:
+    TimingCallback timing_callback_;
+    webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback_;
+    std::map<uint32_t, webrtc::scoped_refptr<webrtc::TransformedFrameCallback>> sink_callbacks_;
+    std::mutex mutex_;
+};
@@ -0,0 +1,94 @@
+#include "ice_config.h"
+#include "p2p/base/port_allocator.h"
+#include <algorithm>
+#include <iostream>
+
+bool IceConfig::FromProfileName(const std::string& name, IceConfig* config) {
+    *config = IceConfig();
+    if (name.empty() || name == "default") {
+        return true;
+    }
+    if (name != "lan") {
+        return false;
+    }
+    config->profile = Profile::kLan;
+    config->servers.clear();
+    config->udp_only = true;
+    config->ipv4_only = true;
+    config->host_only = true;
+    // 局域网往返只有几毫秒，检查间隔和判定超时都可以大幅缩短
+    config->check_min_interval_ms = 10;
+    config->check_weak_interval_ms = 20;
+    config->receiving_timeout_ms = 1000;
+    config->unwritable_timeout_ms = 1000;
+    return true;
+}
+
+const char* IceConfig::ProfileName() const {
+    return profile == Profile::kLan ? "lan" : "default";
+}
+
+void IceConfig::Apply(webrtc::PeerConnectionInterface::RTCConfiguration* config) const {
+    config->servers.clear();
+    if (!host_only) {
+        for (const auto& uri : servers) {
+            webrtc::PeerConnectionInterface::IceServer ice_server;
+            ice_server.uri = uri;
+            if (uri.compare(0, 4, "turn") == 0) {
+                ice_server.username = username;
+                ice_server.password = password;
+            }
+            config->servers.push_back(ice_server);
+        }
+    }
+    config->type = host_only ? webrtc::PeerConnectionInterface::kNoRelay
+                             : webrtc::PeerConnectionInterface::kAll;
+    if (udp_only) {
+        config->tcp_candidate_policy = webrtc::PeerConnectionInterface::kTcpCandidatePolicyDisabled;
+    }
+    if (ipv4_only) {
+        config->max_ipv6_networks = 0;
+    }
+    config->port_allocator_config.flags = PortAllocatorFlags();
+
+    if (check_min_interval_ms >= 0) config->ice_check_min_interval = check_min_interval_ms;
+    if (check_weak_interval_ms >= 0) config->ice_check_interval_weak_connectivity = check_weak_interval_ms;
+    if (receiving_timeout_ms >= 0) config->ice_connection_receiving_timeout = receiving_timeout_ms;
+    if (unwritable_timeout_ms >= 0) config->ice_unwritable_timeout = unwritable_timeout_ms;
+}
+
+uint32_t IceConfig::PortAllocatorFlags() const {
+    uint32_t flags = 0;
+    if (udp_only) {
+        flags |= webrtc::PORTALLOCATOR_DISABLE_TCP;
+    }
+    if (host_only) {
+        flags |= webrtc::PORTALLOCATOR_DISABLE_STUN | webrtc::PORTALLOCATOR_DISABLE_RELAY;
+    }
+    return flags;
+}
+
+bool IceConfig::AllowsLoopback() const {
+    return std::find(interfaces.begin(), interfaces.end(), "lo") != interfaces.end();
+}
+
+InterfaceAllowListNetworkManager::InterfaceAllowListNetworkManager(const webrtc::Environment& env,
+                                                                   webrtc::SocketFactory* socket_factory,
+                                                                   std::vector<std::string> interfaces)
+    : webrtc::BasicNetworkManager(env, socket_factory), interfaces_(std::move(interfaces)) {}
+
+std::vector<const webrtc::Network*> InterfaceAllowListNetworkManager::GetNetworks() const {
+    std::vector<const webrtc::Network*> networks = webrtc::BasicNetworkManager::GetNetworks();
+    auto allowed_end = std::remove_if(networks.begin(), networks.end(), [this](const webrtc::Network* network) {
+        const std::string& name = network->name();
+        if (std::find(interfaces_.begin(), interfaces_.end(), name) != interfaces_.end()) {
+            return false;
+        }
+        if (filtered_.insert(name).second) {
+            std::cout << "[INFO] ICE ignoring interface " << name << " (not in --ice-interfaces)" << std::endl;
+        }
+        return true;
+    });
+    networks.erase(allowed_end, networks.end());
+    return networks;
+}
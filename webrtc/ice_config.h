@@ -0,0 +1,96 @@
+#pragma once
+#include "api/peer_connection_interface.h"
+#include "rtc_base/network.h"
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief ICE收集与连通性检查策略
+ *
+ * 默认档位沿用公网STUN；LAN档位面向与发送端处在同一局域网、没有外网的现场：
+ * 只收集主机候选者，只用UDP和IPv4，可限定网卡，并缩短连通性检查的间隔与超时，
+ * 不再等待STUN超时，也不在TCP/IPv6/中继候选者上浪费检查。
+ */
+struct IceConfig {
+    enum class Profile {
+        kDefault,  // 使用ICE服务器，收集全部候选者
+        kLan       // 仅局域网主机候选者，快速检查
+    };
+
+    Profile profile = Profile::kDefault;
+
+    // ICE服务器（stun:/turn: URI），为空时不查询服务器
+    std::vector<std::string> servers = {"stun:stun.l.google.com:19302"};
+    // TURN服务器的认证信息
+    std::string username;
+    std::string password;
+
+    // 允许使用的网卡名（如eth0），为空表示不限制
+    std::vector<std::string> interfaces;
+
+    bool udp_only = false;   // 不收集TCP候选者
+    bool ipv4_only = false;  // 不使用IPv6网络
+    bool host_only = false;  // 不收集服务器反射/中继候选者
+
+    // 连通性检查节奏（毫秒），小于0表示使用WebRTC默认值
+    int check_min_interval_ms = -1;
+    int check_weak_interval_ms = -1;
+    int receiving_timeout_ms = -1;
+    int unwritable_timeout_ms = -1;
+
+    /**
+     * @brief 按档位名生成配置
+     * @param name "default"或"lan"
+     * @param config 输出
+     * @return 档位名是否有效
+     */
+    static bool FromProfileName(const std::string& name, IceConfig* config);
+
+    /**
+     * @brief 档位名称，用于日志
+     */
+    const char* ProfileName() const;
+
+    /**
+     * @brief 写入RTC配置（ICE服务器、候选者类型、检查节奏）
+     * @param config RTC配置
+     */
+    void Apply(webrtc::PeerConnectionInterface::RTCConfiguration* config) const;
+
+    /**
+     * @brief 端口分配器标志位
+     */
+    uint32_t PortAllocatorFlags() const;
+
+    /**
+     * @brief 白名单中是否包含回环网卡（WebRTC默认忽略回环网卡）
+     */
+    bool AllowsLoopback() const;
+};
+
+/**
+ * @brief 只向端口分配器提供白名单网卡的网络管理器
+ *
+ * 每次端口分配器取网络列表（启动时以及每次网络变化后）都按网卡名过滤，
+ * 因此运行期间新出现的网卡（USB网卡、热插拔、VPN拨号）同样受白名单约束。
+ * 只在网络线程上使用。
+ */
+class InterfaceAllowListNetworkManager : public webrtc::BasicNetworkManager {
+public:
+    /**
+     * @brief 构造函数
+     * @param env WebRTC环境
+     * @param socket_factory 网络线程的套接字工厂
+     * @param interfaces 允许使用的网卡名
+     */
+    InterfaceAllowListNetworkManager(const webrtc::Environment& env, webrtc::SocketFactory* socket_factory,
+                                     std::vector<std::string> interfaces);
+
+    std::vector<const webrtc::Network*> GetNetworks() const override;
+
+private:
+    std::vector<std::string> interfaces_;
+    mutable std::set<std::string> filtered_;  // 已过滤过的网卡名，每个只记录一次日志
+};
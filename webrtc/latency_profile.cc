@@ -0,0 +1,56 @@
+#include "latency_profile.h"
+#include <optional>
+
+bool LatencyProfile::FromName(const std::string& name, LatencyProfile* profile) {
+    *profile = LatencyProfile();
+    if (name.empty() || name == "balanced") {
+        return true;
+    }
+    if (name == "ultra-low") {
+        profile->preset = Preset::kUltraLow;
+        // NetEq不再额外保留最小延迟，PCM队列最多60ms，VDEC只留参考帧加显示所需的缓冲
+        profile->jitter_buffer_min_delay_ms = 0;
+        profile->audio_target_delay_ms = 20;
+        profile->audio_max_buffer_frames = 6;
+        profile->video_decoder_buffers = 4;
+        return true;
+    }
+    if (name == "smooth") {
+        profile->preset = Preset::kSmooth;
+        profile->jitter_buffer_min_delay_ms = 200;
+        profile->audio_target_delay_ms = 120;
+        profile->audio_max_buffer_frames = 100;
+        profile->video_decoder_buffers = 12;
+        return true;
+    }
+    return false;
+}
+
+const char* LatencyProfile::Name() const {
+    switch (preset) {
+        case Preset::kUltraLow: return "ultra-low";
+        case Preset::kSmooth: return "smooth";
+        default: return "balanced";
+    }
+}
+
+LatencyProfile LatencyProfile::Next() const {
+    LatencyProfile next;
+    switch (preset) {
+        case Preset::kUltraLow: FromName("balanced", &next); break;
+        case Preset::kBalanced: FromName("smooth", &next); break;
+        default: FromName("ultra-low", &next); break;
+    }
+    return next;
+}
+
+void LatencyProfile::ApplyTo(webrtc::RtpReceiverInterface* receiver) const {
+    if (!receiver) {
+        return;
+    }
+    if (jitter_buffer_min_delay_ms < 0) {
+        receiver->SetJitterBufferMinimumDelay(std::nullopt);
+    } else {
+        receiver->SetJitterBufferMinimumDelay(jitter_buffer_min_delay_ms / 1000.0);
+    }
+}
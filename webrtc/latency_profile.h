@@ -0,0 +1,55 @@
+#pragma once
+#include "api/rtp_receiver_interface.h"
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief 接收端播放延迟档位
+ *
+ * 接收端链路上的缓冲有三处：WebRTC抖动缓冲（音频NetEq）、AudioReceiver的PCM队列、
+ * VDEC的帧缓冲。档位同时调整这三处：超低延迟档把缓冲压到最小，适合局域网和对讲；
+ * 平衡档沿用原有默认值；平滑档用更深的缓冲吸收公网抖动。
+ * 视频帧由VideoFrameTransformer直接送入VDEC，不经过WebRTC的视频抖动缓冲，
+ * 因此视频侧的延迟主要由VDEC帧缓冲数量决定。
+ */
+struct LatencyProfile {
+    enum class Preset {
+        kUltraLow,  // 最小缓冲，网络抖动时可能出现卡顿或爆音
+        kBalanced,  // 默认值
+        kSmooth     // 较深缓冲，优先保证流畅
+    };
+
+    Preset preset = Preset::kBalanced;
+
+    // 抖动缓冲最小延迟（毫秒），小于0表示交由WebRTC自适应
+    int jitter_buffer_min_delay_ms = -1;
+    // AudioReceiver的音视频同步目标延迟与PCM队列上限（每帧10ms）
+    int audio_target_delay_ms = 40;
+    size_t audio_max_buffer_frames = 100;
+    // VDEC帧缓冲数量，在解码通道创建时生效
+    int video_decoder_buffers = 8;
+
+    /**
+     * @brief 按档位名生成配置
+     * @param name "ultra-low"、"balanced"或"smooth"
+     * @param profile 输出
+     * @return 档位名是否有效
+     */
+    static bool FromName(const std::string& name, LatencyProfile* profile);
+
+    /**
+     * @brief 档位名称，用于日志
+     */
+    const char* Name() const;
+
+    /**
+     * @brief 下一个档位（运行时轮换档位用）
+     */
+    LatencyProfile Next() const;
+
+    /**
+     * @brief 设置一个RTP接收器的抖动缓冲最小延迟
+     * @param receiver 音频或视频接收器
+     */
+    void ApplyTo(webrtc::RtpReceiverInterface* receiver) const;
+};
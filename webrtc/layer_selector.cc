@@ -0,0 +1,101 @@
+#include "layer_selector.h"
+#include <algorithm>
+#include <numeric>
+
+double LayerSelector::DecodeLoad(const StreamLoad& stream, int max_temporal_layer) {
+    double load = static_cast<double>(stream.decoded_width) * stream.decoded_height * stream.input_fps;
+    // 常见的时间层结构每少一层帧率减半
+    int dropped = max_temporal_layer < 0 ? 0 : std::max(0, stream.temporal_layers - 1 - max_temporal_layer);
+    return load / (1 << dropped);
+}
+
+std::vector<int> LayerSelector::AllocateTemporalLayers(const std::vector<StreamLoad>& streams) const {
+    std::vector<int> layers;
+    double total = 0;
+    for (const auto& stream : streams) {
+        int layer = stream.max_temporal_layer;
+        if (layer < 0 || layer >= stream.temporal_layers - 1) {
+            layer = -1;
+        }
+        layers.push_back(layer);
+        total += DecodeLoad(stream, layer);
+    }
+    const double capacity = config_.vdec_capacity_mpps * 1e6;
+
+    // 显示面积小的会话优先降层，大画面最后才受影响
+    std::vector<size_t> order(streams.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&streams](size_t a, size_t b) {
+        return streams[a].display_width * streams[a].display_height <
+               streams[b].display_width * streams[b].display_height;
+    });
+
+    if (total > capacity) {
+        for (size_t i : order) {
+            while (total > capacity && streams[i].temporal_layers > 1 && layers[i] != 0) {
+                int lower = layers[i] < 0 ? streams[i].temporal_layers - 2 : layers[i] - 1;
+                total += DecodeLoad(streams[i], lower) - DecodeLoad(streams[i], layers[i]);
+                layers[i] = lower;
+            }
+        }
+        return layers;
+    }
+
+    // 有余量时每次只为一个会话恢复一层，从大画面开始
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        size_t i = *it;
+        if (layers[i] < 0) {
+            continue;
+        }
+        int higher = layers[i] + 1 >= streams[i].temporal_layers - 1 ? -1 : layers[i] + 1;
+        double raised = total + DecodeLoad(streams[i], higher) - DecodeLoad(streams[i], layers[i]);
+        if (raised <= capacity * config_.raise_ratio) {
+            layers[i] = higher;
+        }
+        break;
+    }
+    return layers;
+}
+
+void LayerSelector::EstimateLayerSize(const sdp_utils::SimulcastLayer& layer, int full_width, int full_height,
+                                      int* width, int* height) {
+    if (layer.max_width > 0 && layer.max_height > 0) {
+        *width = layer.max_width;
+        *height = layer.max_height;
+        return;
+    }
+    // q/h/f（四分之一/二分之一/完整）与lo/mid/hi是最常见的两种命名
+    double scale = 1.0;
+    const std::string& rid = layer.rid;
+    if (rid == "q" || rid == "l" || rid == "lo" || rid == "low") {
+        scale = 0.25;
+    } else if (rid == "h" || rid == "m" || rid == "mid") {
+        scale = 0.5;
+    }
+    *width = static_cast<int>(full_width * scale);
+    *height = static_cast<int>(full_height * scale);
+}
+
+int LayerSelector::ChooseSimulcastLayer(const std::vector<sdp_utils::SimulcastLayer>& layers, int display_width,
+                                        int display_height, int full_width, int full_height) {
+    int chosen = -1;
+    int chosen_pixels = 0;
+    int largest = -1;
+    int largest_pixels = 0;
+    for (size_t i = 0; i < layers.size(); ++i) {
+        int width = 0;
+        int height = 0;
+        EstimateLayerSize(layers[i], full_width, full_height, &width, &height);
+        int pixels = width * height;
+        if (pixels > largest_pixels) {
+            largest = static_cast<int>(i);
+            largest_pixels = pixels;
+        }
+        if (width >= display_width && height >= display_height && (chosen < 0 || pixels < chosen_pixels)) {
+            chosen = static_cast<int>(i);
+            chosen_pixels = pixels;
+        }
+    }
+    // 没有一层够大时接收最大的一层
+    return chosen >= 0 ? chosen : largest;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "sdp_utils.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief 按显示尺寸和VDEC解码能力选择接收的视频层
+ *
+ * 两种手段：
+ * - 联播（simulcast）：收到Offer时按该会话的显示区域选最小的够用的层，
+ *   改写远端Offer让WebRTC接收该层，其余层暂停，发送端不再编码发送；换层需要重新协商。
+ * - 时域分层（SVC的时间层）：总解码负载超过VDEC能力时，从显示面积最小的会话开始
+ *   逐级丢弃高时间层，负载回落后再逐级恢复；在时间层0的帧处切换，不需要重新协商。
+ */
+class LayerSelector {
+public:
+    struct Config {
+        double vdec_capacity_mpps = 250.0;  // VDEC解码能力（百万像素/秒），RK3566约为4K30
+        double raise_ratio = 0.7;           // 恢复一个时间层后总负载不超过能力的该比例才恢复
+    };
+
+    /**
+     * @brief 一个会话当前的视频负载
+     */
+    struct StreamLoad {
+        int decoded_width = 0;
+        int decoded_height = 0;
+        double input_fps = 0;         // 到达的帧率（含被丢弃的时间层）
+        int display_width = 0;        // 显示区域
+        int display_height = 0;
+        int temporal_layers = 1;      // 码流中出现过的时间层数
+        int max_temporal_layer = -1;  // 当前接收的最高时间层，-1表示全部
+    };
+
+    LayerSelector() = default;
+    explicit LayerSelector(const Config& config) : config_(config) {}
+
+    /**
+     * @brief 计算各会话应接收的最高时间层
+     * @param streams 各会话的负载
+     * @return 与streams一一对应的最高时间层，-1表示全部接收
+     */
+    std::vector<int> AllocateTemporalLayers(const std::vector<StreamLoad>& streams) const;
+
+    /**
+     * @brief 某个会话在指定最高时间层下的解码负载（像素/秒）
+     */
+    static double DecodeLoad(const StreamLoad& stream, int max_temporal_layer);
+
+    /**
+     * @brief 获取配置
+     */
+    const Config& config() const { return config_; }
+
+    /**
+     * @brief 选择满足显示区域的最小联播层
+     * @param layers Offer中的联播层
+     * @param display_width 显示区域宽度
+     * @param display_height 显示区域高度
+     * @param full_width 未声明尺寸时假定的最高层宽度
+     * @param full_height 未声明尺寸时假定的最高层高度
+     * @return 选中的层下标，没有联播时返回-1
+     */
+    static int ChooseSimulcastLayer(const std::vector<sdp_utils::SimulcastLayer>& layers, int display_width,
+                                    int display_height, int full_width = 1920, int full_height = 1080);
+
+    /**
+     * @brief 估计联播层的分辨率：优先使用a=rid声明的尺寸，否则按常见的rid命名推断缩放比例
+     */
+    static void EstimateLayerSize(const sdp_utils::SimulcastLayer& layer, int full_width, int full_height,
+                                  int* width, int* height);
+
+private:
+    Config config_;
+};
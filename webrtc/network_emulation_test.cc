@@ -0,0 +1,557 @@
+#include "network_emulation_test.h"
+#include "encoded_video_frame_handler_rockit.h"
+#include "audio_receiver_rockit.h"
+#include "peer_connection_observer_impl.h"
+#include "frame_timing_transformer.h"
+#include "ice_config.h"
+#include "session_description_observers.h"
+#include "../sender/synthetic_video_source.h"
+#include "api/audio_options.h"
+#include "api/create_peerconnection_factory.h"
+#include "api/audio_codecs/builtin_audio_decoder_factory.h"
+#include "api/audio_codecs/builtin_audio_encoder_factory.h"
+#include "api/video_codecs/builtin_video_decoder_factory.h"
+#include "api/video_codecs/builtin_video_encoder_factory.h"
+#include "api/environment/environment_factory.h"
+#include "api/stats/rtc_stats_collector_callback.h"
+#include "api/stats/rtcstats_objects.h"
+#include "api/test/create_network_emulation_manager.h"
+#include "api/test/network_emulation_manager.h"
+#include "api/test/simulated_network.h"
+#include "api/units/data_rate.h"
+#include "modules/audio_device/include/test_audio_device.h"
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/client/basic_port_allocator.h"
+#include "rtc_base/ref_counted_object.h"
+#include "rtc_base/thread.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+int64_t NowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 仿真链路一端的观察者：记录ICE收集完成与连通，接收端把远端轨道交给回调
+class EndpointObserver : public webrtc::PeerConnectionObserver {
+public:
+    using TrackCallback = std::function<void(webrtc::scoped_refptr<webrtc::RtpReceiverInterface>)>;
+
+    explicit EndpointObserver(TrackCallback on_track) : on_track_(std::move(on_track)) {}
+
+    void OnSignalingChange(webrtc::PeerConnectionInterface::SignalingState) override {}
+    void OnDataChannel(webrtc::scoped_refptr<webrtc::DataChannelInterface>) override {}
+    void OnIceCandidate(const webrtc::IceCandidateInterface*) override {}
+
+    void OnAddTrack(webrtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver,
+                    const std::vector<webrtc::scoped_refptr<webrtc::MediaStreamInterface>>&) override {
+        if (on_track_) {
+            on_track_(receiver);
+        }
+    }
+
+    void OnIceGatheringChange(webrtc::PeerConnectionInterface::IceGatheringState new_state) override {
+        if (new_state == webrtc::PeerConnectionInterface::kIceGatheringComplete) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            gathering_complete_ = true;
+            cv_.notify_all();
+        }
+    }
+
+    void OnIceConnectionChange(webrtc::PeerConnectionInterface::IceConnectionState new_state) override {
+        if (new_state == webrtc::PeerConnectionInterface::kIceConnectionConnected ||
+            new_state == webrtc::PeerConnectionInterface::kIceConnectionCompleted) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            connected_ = true;
+            cv_.notify_all();
+        }
+    }
+
+    bool WaitGatheringComplete(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, timeout, [this]() { return gathering_complete_; });
+    }
+
+    bool WaitConnected(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, timeout, [this]() { return connected_; });
+    }
+
+private:
+    TrackCallback on_track_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool gathering_complete_ = false;
+    bool connected_ = false;
+};
+
+// 同步执行CreateOffer/CreateAnswer + SetLocalDescription，返回包含全部候选者的本地SDP
+bool CreateLocalDescription(webrtc::PeerConnectionInterface* pc, EndpointObserver* observer, bool offer,
+                            std::string* sdp) {
+    std::promise<bool> done;
+    auto on_created = [pc, &done](webrtc::SessionDescriptionInterface* desc) {
+        pc->SetLocalDescription(
+            SetSessionDescriptionObserver::Create(
+                [&done]() { done.set_value(true); },
+                [&done](webrtc::RTCError error) {
+                    std::cerr << "SetLocalDescription failed: " << error.message() << std::endl;
+                    done.set_value(false);
+                }).get(),
+            desc);
+    };
+    auto on_error = [&done](webrtc::RTCError error) {
+        std::cerr << "Create description failed: " << error.message() << std::endl;
+        done.set_value(false);
+    };
+    webrtc::PeerConnectionInterface::RTCOfferAnswerOptions options;
+    auto observer_ref = CreateSessionDescriptionObserver::Create(on_created, on_error);
+    if (offer) {
+        pc->CreateOffer(observer_ref.get(), options);
+    } else {
+        pc->CreateAnswer(observer_ref.get(), options);
+    }
+    if (!done.get_future().get() || !observer->WaitGatheringComplete(std::chrono::seconds(10))) {
+        return false;
+    }
+    return pc->local_description()->ToString(sdp);
+}
+
+bool SetRemoteDescription(webrtc::PeerConnectionInterface* pc, webrtc::SdpType type, const std::string& sdp) {
+    webrtc::SdpParseError error;
+    std::unique_ptr<webrtc::SessionDescriptionInterface> desc = webrtc::CreateSessionDescription(type, sdp, &error);
+    if (!desc) {
+        std::cerr << "Failed to parse emulation SDP: " << error.description << std::endl;
+        return false;
+    }
+    std::promise<bool> done;
+    pc->SetRemoteDescription(
+        SetSessionDescriptionObserver::Create(
+            [&done]() { done.set_value(true); },
+            [&done](webrtc::RTCError error) {
+                std::cerr << "SetRemoteDescription failed: " << error.message() << std::endl;
+                done.set_value(false);
+            }).get(),
+        desc.release());
+    return done.get_future().get();
+}
+
+class BlockingStatsCallback : public webrtc::RTCStatsCollectorCallback {
+public:
+    void OnStatsDelivered(const webrtc::scoped_refptr<const webrtc::RTCStatsReport>& report) override {
+        promise_.set_value(report);
+    }
+    std::future<webrtc::scoped_refptr<const webrtc::RTCStatsReport>> GetFuture() { return promise_.get_future(); }
+
+private:
+    std::promise<webrtc::scoped_refptr<const webrtc::RTCStatsReport>> promise_;
+};
+
+webrtc::scoped_refptr<const webrtc::RTCStatsReport> GetStatsBlocking(webrtc::PeerConnectionInterface* pc) {
+    auto callback = webrtc::make_ref_counted<BlockingStatsCallback>();
+    auto future = callback->GetFuture();
+    pc->GetStats(callback.get());
+    if (future.wait_for(std::chrono::seconds(5)) != std::future_status::ready) {
+        return nullptr;
+    }
+    return future.get();
+}
+
+// 仿真链路的一端：网络线程和套接字由仿真层提供，工作/信令线程与工厂各自独立
+struct Endpoint {
+    webrtc::Thread* network_thread = nullptr;
+    std::unique_ptr<webrtc::Thread> worker_thread;
+    std::unique_ptr<webrtc::Thread> signaling_thread;
+    std::unique_ptr<webrtc::NetworkManager> network_manager;
+    std::unique_ptr<webrtc::BasicPacketSocketFactory> socket_factory;
+    webrtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> factory;
+    std::unique_ptr<EndpointObserver> observer;
+    webrtc::scoped_refptr<webrtc::PeerConnectionInterface> pc;
+};
+
+bool StartEndpoint(const std::string& name, webrtc::EmulatedNetworkManagerInterface* network,
+                   EndpointObserver::TrackCallback on_track, Endpoint* endpoint) {
+    endpoint->network_thread = network->network_thread();
+    endpoint->worker_thread = webrtc::Thread::Create();
+    endpoint->signaling_thread = webrtc::Thread::Create();
+    endpoint->worker_thread->SetName(name + "-worker", nullptr);
+    endpoint->signaling_thread->SetName(name + "-signaling", nullptr);
+    if (!endpoint->worker_thread->Start() || !endpoint->signaling_thread->Start()) {
+        std::cerr << "Failed to start " << name << " threads" << std::endl;
+        return false;
+    }
+    endpoint->network_manager = network->ReleaseNetworkManager();
+    endpoint->network_thread->BlockingCall([endpoint, network]() {
+        endpoint->socket_factory = std::make_unique<webrtc::BasicPacketSocketFactory>(network->socket_factory());
+    });
+
+    // 测试音频设备：采集脉冲噪声，按实时节奏取走并丢弃播放数据，接收端的NetEq因此按正常节奏解码
+    webrtc::scoped_refptr<webrtc::AudioDeviceModule> adm = endpoint->worker_thread->BlockingCall([]() {
+        return webrtc::TestAudioDeviceModule::Create(
+            webrtc::CreateEnvironment(),
+            webrtc::TestAudioDeviceModule::CreatePulsedNoiseCapturer(8000, 48000, 1),
+            webrtc::TestAudioDeviceModule::CreateDiscardRenderer(48000, 1));
+    });
+    endpoint->factory = webrtc::CreatePeerConnectionFactory(
+        endpoint->network_thread, endpoint->worker_thread.get(), endpoint->signaling_thread.get(),
+        adm,
+        webrtc::CreateBuiltinAudioEncoderFactory(),
+        webrtc::CreateBuiltinAudioDecoderFactory(),
+        webrtc::CreateBuiltinVideoEncoderFactory(),
+        webrtc::CreateBuiltinVideoDecoderFactory(),
+        nullptr, nullptr);
+    if (!endpoint->factory) {
+        std::cerr << "Failed to create " << name << " PeerConnectionFactory" << std::endl;
+        return false;
+    }
+
+    // 仿真网络只有一个接口，按LAN档位只收集UDP主机候选者
+    IceConfig ice;
+    IceConfig::FromProfileName("lan", &ice);
+    webrtc::PeerConnectionInterface::RTCConfiguration config;
+    config.sdp_semantics = webrtc::SdpSemantics::kUnifiedPlan;
+    ice.Apply(&config);
+    endpoint->observer = std::make_unique<EndpointObserver>(std::move(on_track));
+    webrtc::PeerConnectionDependencies dependencies(endpoint->observer.get());
+    auto allocator = std::make_unique<webrtc::BasicPortAllocator>(
+        webrtc::CreateEnvironment(), endpoint->network_manager.get(), endpoint->socket_factory.get());
+    allocator->set_flags(ice.PortAllocatorFlags());
+    dependencies.allocator = std::move(allocator);
+    auto result = endpoint->factory->CreatePeerConnectionOrError(config, std::move(dependencies));
+    if (!result.ok()) {
+        std::cerr << "Failed to create " << name << " PeerConnection: " << result.error().message() << std::endl;
+        return false;
+    }
+    endpoint->pc = result.MoveValue();
+    return true;
+}
+
+void StopEndpoint(Endpoint* endpoint) {
+    if (endpoint->pc) {
+        endpoint->pc->Close();
+        endpoint->pc = nullptr;
+    }
+    endpoint->factory = nullptr;
+    if (endpoint->network_thread) {
+        endpoint->network_thread->BlockingCall([endpoint]() {
+            endpoint->socket_factory.reset();
+            endpoint->network_manager.reset();
+        });
+    }
+    if (endpoint->worker_thread) {
+        endpoint->worker_thread->Stop();
+    }
+    if (endpoint->signaling_thread) {
+        endpoint->signaling_thread->Stop();
+    }
+    endpoint->observer.reset();
+}
+
+// 发送端只保留H.264（接收端的VDEC按H.264配置），以及重传和冗余编码
+void PreferH264(webrtc::PeerConnectionFactoryInterface* factory, webrtc::RtpTransceiverInterface* transceiver) {
+    webrtc::RtpCapabilities capabilities = factory->GetRtpSenderCapabilities(webrtc::MediaType::VIDEO);
+    std::vector<webrtc::RtpCodecCapability> codecs;
+    for (const auto& codec : capabilities.codecs) {
+        if (codec.name == "H264" || codec.name == "rtx" || codec.name == "red" || codec.name == "ulpfec") {
+            codecs.push_back(codec);
+        }
+    }
+    webrtc::RTCError error = transceiver->SetCodecPreferences(codecs);
+    if (!error.ok()) {
+        std::cerr << "[WARN] Failed to prefer H.264: " << error.message() << std::endl;
+    }
+}
+
+int64_t Percentile(const std::vector<int64_t>& sorted, double fraction) {
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+}  // namespace
+
+std::vector<NetworkEmulationTest::Scenario> NetworkEmulationTest::DefaultMatrix() {
+    std::vector<Scenario> matrix(9);
+    matrix[0].name = "clean";
+    matrix[0].delay_ms = 5;
+    matrix[1].name = "delay50";
+    matrix[1].delay_ms = 50;
+    matrix[1].jitter_ms = 5;
+    matrix[2].name = "loss1";
+    matrix[2].delay_ms = 20;
+    matrix[2].loss_percent = 1;
+    matrix[3].name = "loss5";
+    matrix[3].delay_ms = 20;
+    matrix[3].loss_percent = 5;
+    matrix[4].name = "burst";        // 连续丢包，NACK难以及时补回
+    matrix[4].delay_ms = 20;
+    matrix[4].loss_percent = 3;
+    matrix[4].burst_loss_length = 5;
+    matrix[5].name = "jitter30";     // 抖动但保持顺序，包在队列中排队
+    matrix[5].delay_ms = 40;
+    matrix[5].jitter_ms = 30;
+    matrix[6].name = "reorder";
+    matrix[6].delay_ms = 40;
+    matrix[6].jitter_ms = 30;
+    matrix[6].allow_reordering = true;
+    matrix[7].name = "cap2m";        // 瓶颈低于发送码率上限，考察带宽估计回落时的排队延迟
+    matrix[7].delay_ms = 20;
+    matrix[7].capacity_kbps = 2000;
+    matrix[7].queue_packets = 50;
+    matrix[8].name = "lte";
+    matrix[8].delay_ms = 60;
+    matrix[8].jitter_ms = 20;
+    matrix[8].loss_percent = 1;
+    matrix[8].capacity_kbps = 6000;
+    matrix[8].queue_packets = 100;
+    return matrix;
+}
+
+bool NetworkEmulationTest::SelectScenarios(const std::string& names, std::vector<Scenario>* scenarios) {
+    const std::vector<Scenario> matrix = DefaultMatrix();
+    if (names.empty()) {
+        *scenarios = matrix;
+        return true;
+    }
+    std::stringstream stream(names);
+    std::string name;
+    while (std::getline(stream, name, ',')) {
+        auto it = std::find_if(matrix.begin(), matrix.end(), [&name](const Scenario& s) { return s.name == name; });
+        if (it == matrix.end()) {
+            std::cerr << "Unknown network emulation scenario: " << name << std::endl;
+            return false;
+        }
+        scenarios->push_back(*it);
+    }
+    return !scenarios->empty();
+}
+
+NetworkEmulationTest::NetworkEmulationTest(std::shared_ptr<EncodedVideoFrameHandler> video_handler,
+                                           std::shared_ptr<AudioReceiver> audio_handler)
+    : video_handler_(std::move(video_handler)), audio_handler_(std::move(audio_handler)) {}
+
+bool NetworkEmulationTest::Run(const Scenario& scenario, const Config& config, Result* result) {
+    result->scenario = scenario.name;
+    const int64_t start_us = NowUs();
+
+    // 媒体方向按场景劣化；反方向（RTCP、NACK）同样丢包和抖动，但不限带宽
+    webrtc::BuiltInNetworkBehaviorConfig forward;
+    forward.queue_delay_ms = scenario.delay_ms;
+    forward.delay_standard_deviation_ms = scenario.jitter_ms;
+    forward.allow_reordering = scenario.allow_reordering;
+    forward.loss_percent = scenario.loss_percent;
+    forward.avg_burst_loss_length = scenario.burst_loss_length;
+    if (scenario.capacity_kbps > 0) {
+        forward.link_capacity = webrtc::DataRate::KilobitsPerSec(scenario.capacity_kbps);
+    }
+    if (scenario.queue_packets > 0) {
+        forward.queue_length_packets = scenario.queue_packets;
+    }
+    webrtc::BuiltInNetworkBehaviorConfig reverse = forward;
+    reverse.link_capacity = webrtc::DataRate::Infinity();
+    reverse.queue_length_packets = 0;
+
+    std::unique_ptr<webrtc::NetworkEmulationManager> emulation = webrtc::CreateNetworkEmulationManager();
+    webrtc::EmulatedEndpoint* sender_endpoint = emulation->CreateEndpoint(webrtc::EmulatedEndpointConfig());
+    webrtc::EmulatedEndpoint* receiver_endpoint = emulation->CreateEndpoint(webrtc::EmulatedEndpointConfig());
+    emulation->CreateRoute(sender_endpoint, {emulation->CreateEmulatedNode(forward)}, receiver_endpoint);
+    emulation->CreateRoute(receiver_endpoint, {emulation->CreateEmulatedNode(reverse)}, sender_endpoint);
+
+    // 接收端与正式会话相同：视频帧直接送入VDEC，PCM送入AudioReceiver，按档位设置抖动缓冲
+    video_handler_->SetDecoderBufferCount(config.latency_profile.video_decoder_buffers);
+    video_handler_->Reset();
+    if (audio_handler_) {
+        audio_handler_->SetTargetDelayMs(config.latency_profile.audio_target_delay_ms);
+        audio_handler_->SetMaxBufferFrames(config.latency_profile.audio_max_buffer_frames);
+        audio_handler_->Reset();
+    }
+    webrtc::scoped_refptr<webrtc::AudioTrackInterface> remote_audio;
+    auto on_track = [this, &config, &remote_audio](webrtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver) {
+        config.latency_profile.ApplyTo(receiver.get());
+        auto track = receiver->track();
+        if (track->kind() == webrtc::MediaStreamTrackInterface::kVideoKind) {
+            receiver->SetFrameTransformer(webrtc::make_ref_counted<VideoFrameTransformer>(video_handler_));
+        } else if (track->kind() == webrtc::MediaStreamTrackInterface::kAudioKind && audio_handler_) {
+            remote_audio = webrtc::scoped_refptr<webrtc::AudioTrackInterface>(
+                static_cast<webrtc::AudioTrackInterface*>(track.get()));
+            remote_audio->AddSink(audio_handler_.get());
+        }
+    };
+
+    Endpoint sender;
+    Endpoint receiver;
+    webrtc::scoped_refptr<SyntheticVideoSource> video_source;
+    webrtc::scoped_refptr<FrameTimingTransformer> timing_transformer;
+    // 发送端记录的帧发出时间，在主线程上与接收端的到达时间配对
+    std::vector<std::pair<uint32_t, int64_t>> sent_frames;
+    std::mutex sent_mutex;
+    std::vector<int64_t> latencies;
+    const uint64_t freezes_before = video_handler_->GetFreezeCount();
+    const uint64_t freeze_ms_before = video_handler_->GetTotalFreezeMs();
+    const uint64_t frames_before = video_handler_->GetFrameCount();
+
+    bool ok = StartEndpoint("emu-send", emulation->CreateEmulatedNetworkManagerInterface({sender_endpoint}),
+                            nullptr, &sender) &&
+              StartEndpoint("emu-recv", emulation->CreateEmulatedNetworkManagerInterface({receiver_endpoint}),
+                            on_track, &receiver);
+    if (ok) {
+        video_source = webrtc::make_ref_counted<SyntheticVideoSource>(config.width, config.height, config.fps);
+        auto video_track = sender.factory->CreateVideoTrack(video_source, "emulation_video");
+        auto audio_source = sender.factory->CreateAudioSource(webrtc::AudioOptions());
+        auto audio_track = sender.factory->CreateAudioTrack("emulation_audio", audio_source.get());
+        auto video_sender = sender.pc->AddTrack(video_track, {"emulation"});
+        ok = video_sender.ok() && sender.pc->AddTrack(audio_track, {"emulation"}).ok();
+        if (ok) {
+            auto rtp_sender = video_sender.value();
+            timing_transformer = webrtc::make_ref_counted<FrameTimingTransformer>(
+                [&sent_frames, &sent_mutex](uint32_t rtp_timestamp, int64_t sent_us) {
+                    std::lock_guard<std::mutex> lock(sent_mutex);
+                    sent_frames.emplace_back(rtp_timestamp, sent_us);
+                });
+            rtp_sender->SetEncoderToPacketizerFrameTransformer(timing_transformer);
+            webrtc::RtpParameters parameters = rtp_sender->GetParameters();
+            if (!parameters.encodings.empty()) {
+                parameters.encodings[0].max_bitrate_bps = config.max_bitrate_kbps * 1000;
+                rtp_sender->SetParameters(parameters);
+            }
+            for (const auto& transceiver : sender.pc->GetTransceivers()) {
+                if (transceiver->sender() == rtp_sender) {
+                    PreferH264(sender.factory.get(), transceiver.get());
+                }
+            }
+        }
+    }
+
+    std::string offer;
+    std::string answer;
+    ok = ok && CreateLocalDescription(sender.pc.get(), sender.observer.get(), true, &offer) &&
+         SetRemoteDescription(receiver.pc.get(), webrtc::SdpType::kOffer, offer) &&
+         CreateLocalDescription(receiver.pc.get(), receiver.observer.get(), false, &answer) &&
+         SetRemoteDescription(sender.pc.get(), webrtc::SdpType::kAnswer, answer) &&
+         receiver.observer->WaitConnected(std::chrono::seconds(15));
+    result->connected = ok;
+    result->setup_ms = (NowUs() - start_us) / 1000.0;
+
+    if (ok) {
+        video_source->Start();
+        const int64_t media_start_us = NowUs();
+        const int64_t end_us = media_start_us + static_cast<int64_t>(config.duration_s) * 1000000;
+        std::vector<std::pair<uint32_t, int64_t>> pending;
+        while (NowUs() < end_us) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            {
+                std::lock_guard<std::mutex> lock(sent_mutex);
+                pending.insert(pending.end(), sent_frames.begin(), sent_frames.end());
+                sent_frames.clear();
+            }
+            // 到达记录只保留最近的帧，配对要及时；2秒仍未到达的帧视为丢失
+            const int64_t now_us = NowUs();
+            auto it = pending.begin();
+            while (it != pending.end()) {
+                int64_t arrival_us = 0;
+                if (video_handler_->GetArrivalTimeUs(it->first, &arrival_us)) {
+                    latencies.push_back(arrival_us - it->second);
+                    it = pending.erase(it);
+                } else if (now_us - it->second > 2000000) {
+                    it = pending.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        const double media_s = (NowUs() - media_start_us) / 1e6;
+        video_source->Stop();
+        timing_transformer->Detach();
+
+        result->frames_sent = video_source->GetFrameCount();
+        result->frames_received = video_handler_->GetFrameCount() - frames_before;
+        result->freezes = video_handler_->GetFreezeCount() - freezes_before;
+        result->freeze_ms = video_handler_->GetTotalFreezeMs() - freeze_ms_before;
+        if (auto report = GetStatsBlocking(receiver.pc.get())) {
+            for (const auto* stats : report->GetStatsOfType<webrtc::RTCInboundRtpStreamStats>()) {
+                const std::string kind = stats->kind.value_or("");
+                if (kind == "video") {
+                    const double received = static_cast<double>(stats->packets_received.value_or(0));
+                    const double lost = static_cast<double>(std::max<int64_t>(0, stats->packets_lost.value_or(0)));
+                    result->video_loss_percent = received + lost > 0 ? lost * 100 / (received + lost) : 0;
+                    result->nacks = stats->nack_count.value_or(0);
+                    result->plis = stats->pli_count.value_or(0);
+                    result->video_kbps = stats->bytes_received.value_or(0) * 8 / media_s / 1000;
+                } else if (kind == "audio") {
+                    const uint64_t total = stats->total_samples_received.value_or(0);
+                    const uint64_t emitted = stats->jitter_buffer_emitted_count.value_or(0);
+                    result->audio_concealed_percent =
+                        total > 0 ? stats->concealed_samples.value_or(0) * 100.0 / total : 0;
+                    result->concealment_events = stats->concealment_events.value_or(0);
+                    result->audio_jitter_buffer_ms =
+                        emitted > 0 ? stats->jitter_buffer_delay.value_or(0) * 1000.0 / emitted : 0;
+                }
+            }
+        }
+    } else {
+        std::cerr << "[WARN] Network emulation scenario " << scenario.name << ": connection not established"
+                  << std::endl;
+    }
+
+    if (remote_audio) {
+        remote_audio->RemoveSink(audio_handler_.get());
+        remote_audio = nullptr;
+    }
+    if (timing_transformer) {
+        timing_transformer->Detach();
+    }
+    if (video_source) {
+        video_source->Stop();
+    }
+    StopEndpoint(&sender);
+    StopEndpoint(&receiver);
+    emulation.reset();
+
+    result->latency_samples = latencies.size();
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        result->latency_p50_us = Percentile(latencies, 0.5);
+        result->latency_p95_us = Percentile(latencies, 0.95);
+        result->latency_max_us = latencies.back();
+    }
+    std::cout << "[INFO] Netem " << scenario.name << " (" << config.latency_profile.Name() << "): "
+              << (result->connected ? "connected" : "FAILED") << " in " << static_cast<int>(result->setup_ms)
+              << " ms, video " << result->frames_received << "/" << result->frames_sent << " frames, "
+              << result->freezes << " freezes (" << result->freeze_ms << " ms), audio concealed "
+              << result->audio_concealed_percent << "%, e2e p50 " << result->latency_p50_us / 1000.0 << " ms"
+              << std::endl;
+    return result->connected && result->frames_received > 0;
+}
+
+void NetworkEmulationTest::LogResults(const std::string& profile_name, const std::vector<Result>& results) {
+    std::ostringstream table;
+    table << std::fixed << std::setprecision(1);
+    table << "[INFO] Network emulation results, latency profile " << profile_name << ":\n";
+    table << std::left << std::setw(10) << "scenario" << std::right << std::setw(8) << "setup" << std::setw(9)
+          << "frames" << std::setw(8) << "freeze" << std::setw(9) << "freezems" << std::setw(7) << "loss%"
+          << std::setw(6) << "nack" << std::setw(5) << "pli" << std::setw(7) << "kbps" << std::setw(8) << "conceal%"
+          << std::setw(7) << "events" << std::setw(7) << "ajb" << std::setw(8) << "p50" << std::setw(8) << "p95"
+          << std::setw(8) << "max" << "\n";
+    for (const Result& r : results) {
+        table << std::left << std::setw(10) << r.scenario << std::right;
+        if (!r.connected) {
+            table << "  not connected\n";
+            continue;
+        }
+        table << std::setw(8) << r.setup_ms << std::setw(9) << r.frames_received << std::setw(8) << r.freezes
+              << std::setw(9) << r.freeze_ms << std::setw(7) << r.video_loss_percent << std::setw(6) << r.nacks
+              << std::setw(5) << r.plis << std::setw(7) << r.video_kbps << std::setw(8) << r.audio_concealed_percent
+              << std::setw(7) << r.concealment_events << std::setw(7) << r.audio_jitter_buffer_ms << std::setw(8)
+              << r.latency_p50_us / 1000.0 << std::setw(8) << r.latency_p95_us / 1000.0 << std::setw(8)
+              << r.latency_max_us / 1000.0 << "\n";
+    }
+    table << "(setup/ajb/p50/p95/max in ms; ajb = audio jitter buffer; latency = encoder output to VDEC input)";
+    std::cout << table.str() << std::endl;
+}
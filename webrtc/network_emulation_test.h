@@ -0,0 +1,105 @@
+#pragma once
+#include "latency_profile.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class EncodedVideoFrameHandler;
+class AudioReceiver;
+
+/**
+ * @brief 网络劣化仿真测试
+ *
+ * 在同一进程内建立一对PeerConnection：发送端发送合成的H.264视频和脉冲噪声音频，
+ * 接收端走与正式会话相同的路径（VideoFrameTransformer送入VDEC、PCM送入AudioReceiver、
+ * 按延迟档位设置抖动缓冲）。两端之间的UDP包经过WebRTC的网络仿真层，
+ * 按场景加入丢包、时延抖动、乱序和带宽限制，不需要外场或tc netem。
+ * 每个场景结束时统计画面卡顿、音频丢包隐藏比例和端到端延迟，
+ * 同一组固定场景可用于比较不同延迟档位和性能改动的效果。
+ *
+ * 网络仿真属于WebRTC的测试代码，需要在libwebrtc.a中包含//test/network，
+ * 并以-DRK_NETWORK_EMULATION=ON配置本工程。
+ */
+class NetworkEmulationTest {
+public:
+    struct Scenario {
+        std::string name;
+        double loss_percent = 0;
+        int burst_loss_length = -1;   // 平均连续丢包数，小于0为独立丢包
+        int delay_ms = 0;             // 单向时延
+        int jitter_ms = 0;            // 时延标准差
+        bool allow_reordering = false;
+        int capacity_kbps = 0;        // 发送方向的带宽上限，0为不限
+        int queue_packets = 0;        // 瓶颈队列长度，0为不限
+    };
+
+    struct Config {
+        int duration_s = 20;          // 每个场景的媒体时长（不含建连）
+        int width = 1280;
+        int height = 720;
+        int fps = 30;
+        int max_bitrate_kbps = 4000;
+        LatencyProfile latency_profile;
+    };
+
+    struct Result {
+        std::string scenario;
+        bool connected = false;
+        double setup_ms = 0;
+        uint64_t frames_sent = 0;
+        uint64_t frames_received = 0;
+        uint64_t freezes = 0;
+        uint64_t freeze_ms = 0;
+        double video_loss_percent = 0;   // 网络丢包（重传之前）
+        uint64_t nacks = 0;
+        uint64_t plis = 0;
+        double video_kbps = 0;
+        double audio_concealed_percent = 0;
+        uint64_t concealment_events = 0;
+        double audio_jitter_buffer_ms = 0;
+        uint64_t latency_samples = 0;
+        int64_t latency_p50_us = 0;
+        int64_t latency_p95_us = 0;
+        int64_t latency_max_us = 0;
+    };
+
+    /**
+     * @brief 固定的场景矩阵：clean、delay50、loss1、loss5、burst、jitter30、reorder、cap2m、lte
+     */
+    static std::vector<Scenario> DefaultMatrix();
+
+    /**
+     * @brief 按名字从场景矩阵中选取
+     * @param names 逗号分隔的场景名，为空时选取全部
+     * @param scenarios 输出
+     * @return 所有名字都有效时返回true
+     */
+    static bool SelectScenarios(const std::string& names, std::vector<Scenario>* scenarios);
+
+    /**
+     * @brief 构造函数
+     * @param video_handler 已启动的视频处理器
+     * @param audio_handler 已启动的音频处理器
+     */
+    NetworkEmulationTest(std::shared_ptr<EncodedVideoFrameHandler> video_handler,
+                         std::shared_ptr<AudioReceiver> audio_handler);
+
+    /**
+     * @brief 执行一个场景（阻塞）
+     * @param scenario 场景
+     * @param config 配置
+     * @param result 输出
+     * @return 连接建立且收到视频帧时返回true
+     */
+    bool Run(const Scenario& scenario, const Config& config, Result* result);
+
+    /**
+     * @brief 输出所有场景的结果对照表
+     */
+    static void LogResults(const std::string& profile_name, const std::vector<Result>& results);
+
+private:
+    std::shared_ptr<EncodedVideoFrameHandler> video_handler_;
+    std::shared_ptr<AudioReceiver> audio_handler_;
+};
@@ -3,6 +3,7 @@
 #include "encoded_video_frame_handler_rockit.h"
 #include "audio_receiver_rockit.h"
 #include "api/video/encoded_image.h"         // [新增] 确保包含了 EncodedImage 的完整定义
+#include "api/video/video_frame_metadata.h"
 #include "rtc_base/ref_counted_object.h"   // [新增] 确保包含了 make_ref_counted
 #include <iostream>
 
@@ -46,12 +47,34 @@ void VideoFrameTransformer::Transform(std::unique_ptr<webrtc::TransformableFrame
     }
 
     encoded_image._frameType = video_frame->IsKeyFrame() ? webrtc::VideoFrameType::kVideoFrameKey : webrtc::VideoFrameType::kVideoFrameDelta;
+
+    // 分辨率只在关键帧上携带；时间层序号用于按解码能力丢弃高时间层
+    webrtc::VideoFrameMetadata metadata = video_frame->Metadata();
+    if (metadata.GetWidth() > 0 && metadata.GetHeight() > 0) {
+        encoded_image._encodedWidth = metadata.GetWidth();
+        encoded_image._encodedHeight = metadata.GetHeight();
+    }
+    encoded_image.SetTemporalIndex(metadata.GetTemporalIndex());
     
     handler_->OnEncodedImage(encoded_image, nullptr);
 }
 
 // 构造函数，初始化客户端指针。
-PeerConnectionObserverImpl::PeerConnectionObserverImpl(WebRTCClient* client) : client_(client) {}
+PeerConnectionObserverImpl::PeerConnectionObserverImpl(WebRTCClient* client, const std::string& room_id,
+                                                       const std::string& remote_id)
+    : client_(client), room_id_(room_id), remote_id_(remote_id) {}
+
+void PeerConnectionObserverImpl::BindSession(const std::string& room_id, const std::string& remote_id) {
+    std::lock_guard<std::mutex> lock(ids_mutex_);
+    room_id_ = room_id;
+    remote_id_ = remote_id;
+}
+
+void PeerConnectionObserverImpl::GetSessionIds(std::string* room_id, std::string* remote_id) const {
+    std::lock_guard<std::mutex> lock(ids_mutex_);
+    *room_id = room_id_;
+    *remote_id = remote_id_;
+}
 
 // 设置媒体处理器，将外部创建的handler注入到观察者内部。
 void PeerConnectionObserverImpl::SetMediaHandlers(
@@ -76,6 +99,11 @@ void PeerConnectionObserverImpl::OnAddTrack(
     if (!track) return;
     
     std::cout << "OnAddTrack: " << track->kind() << " track added with id: " << track->id() << std::endl;
+
+    // 按当前延迟档位设置该接收器的抖动缓冲最小延迟
+    if (client_) {
+        client_->GetLatencyProfile().ApplyTo(receiver.get());
+    }
     
     // 根据轨道的类型（音频或视频），分发给不同的处理函数。
     if (track->kind() == webrtc::MediaStreamTrackInterface::kVideoKind) {
@@ -95,6 +123,11 @@ void PeerConnectionObserverImpl::OnRemoveTrack(webrtc::scoped_refptr<webrtc::Rtp
 // 当数据通道被创建时调用。
 void PeerConnectionObserverImpl::OnDataChannel(webrtc::scoped_refptr<webrtc::DataChannelInterface> channel) {
     std::cout << "Data channel created, label: " << channel->label() << std::endl;
+    if (client_) {
+        std::string room_id, remote_id;
+        GetSessionIds(&room_id, &remote_id);
+        client_->OnDataChannel(room_id, remote_id, channel);
+    }
 }
 
 // 当需要重新协商SDP时调用。
@@ -104,8 +137,14 @@ void PeerConnectionObserverImpl::OnRenegotiationNeeded() {
 
 // 当ICE（网络穿透）连接状态改变时调用，非常重要。
 void PeerConnectionObserverImpl::OnIceConnectionChange(webrtc::PeerConnectionInterface::IceConnectionState new_state) {
-    std::cout << "ICE connection state changed to: " << webrtc::PeerConnectionInterface::AsString(new_state) << std::endl;
+    std::string room_id, remote_id;
+    GetSessionIds(&room_id, &remote_id);
+    std::cout << "ICE connection state changed to: " << webrtc::PeerConnectionInterface::AsString(new_state)
+              << " (peer " << remote_id << ")" << std::endl;
     if (client_) {
+        if (new_state == webrtc::PeerConnectionInterface::kIceConnectionConnected) {
+            client_->OnIceConnected(room_id, remote_id);
+        }
         // 当连接断开或失败时，重置音视频处理器。
         // 这是一个非常重要的健壮性设计，可以清空缓冲区，重置同步状态，为下一次连接做准备。
         if (new_state == webrtc::PeerConnectionInterface::kIceConnectionDisconnected ||
@@ -113,19 +152,30 @@ void PeerConnectionObserverImpl::OnIceConnectionChange(webrtc::PeerConnectionInt
             if (audio_receiver_) audio_receiver_->Reset();
             if (encoded_video_handler_) encoded_video_handler_->Reset();
         }
+        // 失败后不会自行恢复：关闭会话，让同一远端或新的发送端重新协商
+        if (new_state == webrtc::PeerConnectionInterface::kIceConnectionFailed) {
+            client_->OnIceFailed(room_id, remote_id);
+        }
     }
 }
 
 // 当ICE收集状态改变时调用。
 void PeerConnectionObserverImpl::OnIceGatheringChange(webrtc::PeerConnectionInterface::IceGatheringState new_state) {
     std::cout << "ICE gathering state changed to: " << webrtc::PeerConnectionInterface::AsString(new_state) << std::endl;
+    if (client_ && new_state == webrtc::PeerConnectionInterface::kIceGatheringComplete) {
+        std::string room_id, remote_id;
+        GetSessionIds(&room_id, &remote_id);
+        client_->OnIceGatheringComplete(room_id, remote_id);
+    }
 }
 
 // 当WebRTC引擎在本地发现一个可用的网络候选者（IP地址和端口）时调用。
 void PeerConnectionObserverImpl::OnIceCandidate(const webrtc::IceCandidateInterface* candidate) {
     // 将这个候选者信息通过主控类发送给信令服务器，由信令服务器转发给对端。
     if (client_) {
-        client_->SendIceCandidateToPeer(candidate);
+        std::string room_id, remote_id;
+        GetSessionIds(&room_id, &remote_id);
+        client_->SendIceCandidateToPeer(room_id, remote_id, candidate);
     }
 }
 
@@ -174,7 +224,10 @@ void PeerConnectionObserverImpl::ProcessVideoTrack(webrtc::VideoTrackInterface*
 // 音频轨道的具体处理逻辑。
 void PeerConnectionObserverImpl::ProcessAudioTrack(webrtc::AudioTrackInterface* track) {
     if (!audio_receiver_) {
-        std::cerr << "Audio receiver not set!" << std::endl;
+        // 音频输出设备只有一个，只有占用主会话槽位的对端才会播放音频
+        std::string room_id, remote_id;
+        GetSessionIds(&room_id, &remote_id);
+        std::cout << "No audio output assigned to peer " << remote_id << ", audio track ignored." << std::endl;
         return;
     }
     
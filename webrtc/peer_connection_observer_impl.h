@@ -3,6 +3,8 @@
 #include "api/scoped_refptr.h"           // [修改] 引入 webrtc::scoped_refptr
 #include "api/frame_transformer_interface.h" // [新增]
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>                         // [修改] 为 vector<...> 添加
 
 
@@ -40,8 +42,18 @@ public:
     /**
      * @brief 构造函数。
      * @param client 一个指向主WebRTCClient实例的指针，用于回调和通信。
+     * @param room_id 远端所在的房间ID
+     * @param remote_id 该PeerConnection对应的远端客户端ID，与房间ID一起用于区分会话。
      */
-    explicit PeerConnectionObserverImpl(WebRTCClient* client);
+    PeerConnectionObserverImpl(WebRTCClient* client, const std::string& room_id, const std::string& remote_id);
+
+    /**
+     * @brief 把预热的观察者绑定到实际会话。
+     * 预热的PeerConnection在Offer到达前就已创建，此时还不知道远端是谁。
+     * @param room_id 远端所在的房间ID
+     * @param remote_id 远端客户端ID
+     */
+    void BindSession(const std::string& room_id, const std::string& remote_id);
     
     /**
      * @brief 注入媒体处理器。
@@ -96,8 +108,18 @@ private:
      */
     void ProcessAudioTrack(webrtc::AudioTrackInterface* track);
 
+    /**
+     * @brief 读取当前绑定的会话（回调运行在信令线程，绑定发生在调用线程）
+     */
+    void GetSessionIds(std::string* room_id, std::string* remote_id) const;
+
     // 指向主控类WebRTCClient的指针，用于事件通知和回调。
     WebRTCClient* client_;
+
+    // 远端所在房间与客户端ID（一个观察者只服务一个会话）
+    std::string room_id_;
+    std::string remote_id_;
+    mutable std::mutex ids_mutex_;
     
     // 编码视频帧处理器，负责与Rockit VDEC交互。
     std::shared_ptr<EncodedVideoFrameHandler> encoded_video_handler_;
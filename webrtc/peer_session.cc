@@ -0,0 +1,439 @@
+#include "peer_session.h"
+#include "encoded_video_frame_handler_rockit.h"
+#include "audio_receiver_rockit.h"
+#include "sdp_utils.h"
+#include "api/stats/rtc_stats_collector_callback.h"
+#include "api/stats/rtcstats_objects.h"
+#include "rtc_base/ref_counted_object.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+/**
+ * @brief 收到接收统计后输出一行延迟分解：抖动缓冲平均延迟、目标延迟，
+ * 以及调用时采样的PCM队列深度和VDEC积压
+ */
+class LatencyStatsCallback : public webrtc::RTCStatsCollectorCallback {
+public:
+    LatencyStatsCallback(std::string label, int audio_buffer_ms, int64_t video_backlog_pics)
+        : label_(std::move(label)), audio_buffer_ms_(audio_buffer_ms), video_backlog_pics_(video_backlog_pics) {}
+
+    void OnStatsDelivered(const webrtc::scoped_refptr<const webrtc::RTCStatsReport>& report) override {
+        for (const auto* stats : report->GetStatsOfType<webrtc::RTCInboundRtpStreamStats>()) {
+            const std::string kind = stats->kind.value_or("");
+            uint64_t emitted = stats->jitter_buffer_emitted_count.value_or(0);
+            // 累计值除以输出的样本/帧数得到平均延迟
+            double jitter_ms = emitted > 0 ? stats->jitter_buffer_delay.value_or(0) * 1000.0 / emitted : 0;
+            double target_ms = emitted > 0 ? stats->jitter_buffer_target_delay.value_or(0) * 1000.0 / emitted : 0;
+            std::cout << "[INFO] Latency " << label_ << " " << kind << ": jitter buffer " << jitter_ms
+                      << " ms (target " << target_ms << " ms)";
+            if (kind == "audio" && audio_buffer_ms_ >= 0) {
+                std::cout << ", playout queue " << audio_buffer_ms_ << " ms, receiver total ~"
+                          << static_cast<int>(jitter_ms) + audio_buffer_ms_ << " ms";
+            } else if (kind == "video" && video_backlog_pics_ >= 0) {
+                double fps = stats->frames_per_second.value_or(0);
+                std::cout << ", decoder backlog " << video_backlog_pics_ << " frames";
+                if (fps > 0) {
+                    std::cout << " (~" << static_cast<int>(video_backlog_pics_ * 1000 / fps) << " ms at " << fps << " fps)";
+                }
+            }
+            std::cout << std::endl;
+        }
+    }
+
+private:
+    std::string label_;
+    int audio_buffer_ms_;
+    int64_t video_backlog_pics_;
+};
+
+}  // namespace
+
+PeerSession::PeerSession(WebRTCClient* client, const std::string& room_id, const std::string& remote_id, int slot,
+                         std::shared_ptr<EncodedVideoFrameHandler> video_handler,
+                         std::shared_ptr<AudioReceiver> audio_handler)
+    : client_(client), room_id_(room_id), remote_id_(remote_id), slot_(slot),
+      created_time_(std::chrono::steady_clock::now()),
+      video_handler_(std::move(video_handler)), audio_handler_(std::move(audio_handler)),
+      control_channel_(std::make_unique<ControlChannel>()) {
+    control_channel_->SetHandler(ControlChannel::kTypeFrameTiming,
+                                 [this](const ControlChannel::Message& message) { OnFrameTiming(message); });
+}
+
+PeerSession::~PeerSession() {
+    Close();
+}
+
+bool PeerSession::Prewarm(WebRTCClient* client, webrtc::PeerConnectionFactoryInterface* factory,
+                          const webrtc::PeerConnectionInterface::RTCConfiguration& config,
+                          std::unique_ptr<webrtc::PortAllocator> allocator,
+                          PrewarmedConnection* connection) {
+    connection->observer = std::make_unique<PeerConnectionObserverImpl>(client, "", "");
+    connection->created_time = std::chrono::steady_clock::now();
+
+    webrtc::PeerConnectionDependencies pc_deps(connection->observer.get());
+    pc_deps.allocator = std::move(allocator);
+    auto result = factory->CreatePeerConnectionOrError(config, std::move(pc_deps));
+    if (!result.ok()) {
+        std::cerr << "Failed to create PeerConnection: " << result.error().message() << std::endl;
+        connection->observer.reset();
+        return false;
+    }
+    connection->peer_connection = result.MoveValue();
+    return connection->peer_connection != nullptr;
+}
+
+bool PeerSession::Open(webrtc::PeerConnectionFactoryInterface* factory,
+                       const webrtc::PeerConnectionInterface::RTCConfiguration& config,
+                       std::unique_ptr<webrtc::PortAllocator> allocator) {
+    PrewarmedConnection connection;
+    if (!Prewarm(client_, factory, config, std::move(allocator), &connection)) {
+        std::cerr << "Failed to open session for peer " << remote_id_ << " in room " << room_id_ << std::endl;
+        return false;
+    }
+    prewarmed_ = false;
+    return Adopt(&connection);
+}
+
+bool PeerSession::Open(PrewarmedConnection* connection) {
+    prewarmed_ = true;
+    return Adopt(connection);
+}
+
+bool PeerSession::Adopt(PrewarmedConnection* connection) {
+    if (!connection->observer || !connection->peer_connection) {
+        return false;
+    }
+    // 远端轨道只在设置远端描述之后才会出现，此时绑定处理器不会错过OnAddTrack
+    observer_ = std::move(connection->observer);
+    observer_->BindSession(room_id_, remote_id_);
+    observer_->SetMediaHandlers(video_handler(), audio_handler());
+    std::lock_guard<std::mutex> lock(peer_connection_mutex_);
+    peer_connection_ = std::move(connection->peer_connection);
+    return true;
+}
+
+webrtc::scoped_refptr<webrtc::PeerConnectionInterface> PeerSession::peer_connection() const {
+    std::lock_guard<std::mutex> lock(peer_connection_mutex_);
+    return peer_connection_;
+}
+
+std::shared_ptr<EncodedVideoFrameHandler> PeerSession::video_handler() const {
+    std::lock_guard<std::mutex> lock(handlers_mutex_);
+    return video_handler_;
+}
+
+std::shared_ptr<AudioReceiver> PeerSession::audio_handler() const {
+    std::lock_guard<std::mutex> lock(handlers_mutex_);
+    return audio_handler_;
+}
+
+bool PeerSession::PreconfigureVideo(const std::string& offer, const std::string& answer) {
+    std::shared_ptr<EncodedVideoFrameHandler> video_handler = this->video_handler();
+    if (!video_handler) {
+        return false;
+    }
+    sdp_utils::VideoStreamHints hints;
+    if (!sdp_utils::GetVideoStreamHints(offer, answer, &hints)) {
+        std::cout << "[INFO] Session " << room_id_ << "/" << remote_id_
+                  << ": negotiated video codec is not H.264/H.265, VDEC created on first frame" << std::endl;
+        return false;
+    }
+    if (hints.width <= 0 || hints.height <= 0) {
+        std::cout << "[INFO] Session " << room_id_ << "/" << remote_id_ << ": no resolution hint in offer ("
+                  << hints.codec << (hints.profile_level_id.empty() ? "" : " " + hints.profile_level_id)
+                  << "), VDEC created on first frame" << std::endl;
+        return false;
+    }
+    std::cout << "[INFO] Session " << room_id_ << "/" << remote_id_ << " video hints: " << hints.codec << " pt "
+              << hints.payload_type << (hints.profile_level_id.empty() ? "" : " profile-level-id " + hints.profile_level_id)
+              << ", " << hints.width << "x" << hints.height << " from " << hints.size_source << ", "
+              << hints.parameter_sets.size() << " parameter sets" << std::endl;
+    return video_handler->Preconfigure(hints.codec, hints.width, hints.height, hints.parameter_sets);
+}
+
+void PeerSession::OnFrameTiming(const ControlChannel::Message& message) {
+    std::shared_ptr<EncodedVideoFrameHandler> video_handler = this->video_handler();
+    if (message.size < 12 || !video_handler) {
+        return;
+    }
+    FrameTiming timing;
+    timing.rtp_timestamp = 0;
+    for (int i = 0; i < 4; ++i) {
+        timing.rtp_timestamp = (timing.rtp_timestamp << 8) | message.data[i];
+    }
+    uint64_t sent_us = 0;
+    for (int i = 4; i < 12; ++i) {
+        sent_us = (sent_us << 8) | message.data[i];
+    }
+    timing.sent_us = static_cast<int64_t>(sent_us);
+    const int64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    // 时间戳走DataChannel，可能先于视频帧到达，配不上的留到下一条消息再试
+    std::lock_guard<std::mutex> lock(frame_timing_mutex_);
+    pending_frame_timings_.push_back(timing);
+    auto it = pending_frame_timings_.begin();
+    while (it != pending_frame_timings_.end()) {
+        int64_t arrival_us = 0;
+        if (video_handler->GetArrivalTimeUs(it->rtp_timestamp, &arrival_us)) {
+            const int64_t latency_us = arrival_us - it->sent_us;
+            latency_samples_++;
+            latency_sum_us_ += latency_us;
+            if (latency_us > latency_max_us_) {
+                latency_max_us_ = latency_us;
+            }
+            uint8_t reply[12];
+            for (int i = 0; i < 4; ++i) {
+                reply[i] = static_cast<uint8_t>(it->rtp_timestamp >> (24 - 8 * i));
+            }
+            for (int i = 0; i < 8; ++i) {
+                reply[4 + i] = static_cast<uint8_t>(static_cast<uint64_t>(latency_us) >> (56 - 8 * i));
+            }
+            control_channel_->Send(ControlChannel::kTypeFrameLatency, reply, sizeof(reply),
+                                   ControlChannel::Mode::kUnreliable);
+            it = pending_frame_timings_.erase(it);
+        } else if (now_us - it->sent_us > 2000000) {
+            it = pending_frame_timings_.erase(it);  // 丢失或被时间层选择跳过的帧
+        } else {
+            ++it;
+        }
+    }
+}
+
+void PeerSession::MarkOfferReceived() {
+    offer_time_us_ = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t PeerSession::GetMsSinceOffer() const {
+    int64_t offer_time_us = offer_time_us_;
+    if (offer_time_us < 0) {
+        return -1;
+    }
+    int64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return (now_us - offer_time_us) / 1000;
+}
+
+void PeerSession::ApplyLatencyProfile(const LatencyProfile& profile) {
+    // 在主线程（重载配置、SIGUSR1）调用，可能与信令线程上的Close交错：只使用持锁复制的处理器
+    std::shared_ptr<EncodedVideoFrameHandler> video_handler = this->video_handler();
+    std::shared_ptr<AudioReceiver> audio_handler = this->audio_handler();
+    if (video_handler) {
+        video_handler->SetDecoderBufferCount(profile.video_decoder_buffers);
+    }
+    if (audio_handler) {
+        audio_handler->SetTargetDelayMs(profile.audio_target_delay_ms);
+        audio_handler->SetMaxBufferFrames(profile.audio_max_buffer_frames);
+    }
+    if (auto pc = peer_connection()) {
+        for (const auto& receiver : pc->GetReceivers()) {
+            profile.ApplyTo(receiver.get());
+        }
+    }
+}
+
+void PeerSession::LogLatencyStats(const std::string& profile_name) const {
+    auto pc = peer_connection();
+    if (!pc) {
+        return;
+    }
+    std::shared_ptr<EncodedVideoFrameHandler> video_handler = this->video_handler();
+    std::shared_ptr<AudioReceiver> audio_handler = this->audio_handler();
+    int audio_buffer_ms = audio_handler ? audio_handler->GetCurrentDelayMs() : -1;
+    int64_t video_backlog = -1;
+    uint32_t stream_frames = 0;
+    uint32_t pictures = 0;
+    if (video_handler && video_handler->GetDecoderBacklog(&stream_frames, &pictures)) {
+        video_backlog = stream_frames + pictures;
+    }
+    std::string label = room_id_ + "/" + remote_id_ + " [" + profile_name + "]";
+    pc->GetStats(
+        webrtc::make_ref_counted<LatencyStatsCallback>(label, audio_buffer_ms, video_backlog).get());
+}
+
+ReceiveBitrateController::Decision PeerSession::UpdateBitrateControl(int64_t now_ms) {
+    // 与Close同在信令线程执行，已关闭的会话不再采样（处理器已交还给槽位的下一个会话）
+    std::shared_ptr<EncodedVideoFrameHandler> video_handler = this->video_handler();
+    if (!video_handler || !peer_connection()) {
+        return ReceiveBitrateController::Decision::kHold;
+    }
+    ReceiveBitrateController::Sample sample;
+    sample.time_ms = now_ms;
+    sample.frames = video_handler->GetFrameCount();
+    sample.bytes = video_handler->GetByteCount();
+    sample.dropped = video_handler->GetDroppedFrameCount();
+    uint32_t stream_frames = 0;
+    uint32_t pictures = 0;
+    if (video_handler->GetDecoderBacklog(&stream_frames, &pictures)) {
+        sample.backlog = stream_frames + pictures;
+    }
+    ReceiveBitrateController::Decision decision = bitrate_controller_.Update(sample);
+    bitrate_cap_kbps_ = bitrate_controller_.cap_kbps();
+    return decision;
+}
+
+bool PeerSession::SampleStreamLoad(int64_t now_ms, LayerSelector::StreamLoad* load) {
+    std::shared_ptr<EncodedVideoFrameHandler> video_handler = this->video_handler();
+    if (!video_handler) {
+        return false;
+    }
+    uint64_t input_frames = video_handler->GetFrameCount() + video_handler->GetSkippedFrameCount() +
+                            video_handler->GetDroppedFrameCount();
+    int64_t elapsed_ms = last_load_sample_ms_ < 0 ? 0 : now_ms - last_load_sample_ms_;
+    uint64_t frames = input_frames - last_input_frames_;
+    last_input_frames_ = input_frames;
+    last_load_sample_ms_ = now_ms;
+    if (elapsed_ms <= 0 || frames == 0) {
+        return false;
+    }
+    load->input_fps = frames * 1000.0 / elapsed_ms;
+    video_handler->GetDecodedSize(&load->decoded_width, &load->decoded_height);
+    video_handler->GetDisplaySize(&load->display_width, &load->display_height);
+    load->temporal_layers = video_handler->GetTemporalLayerCount();
+    load->max_temporal_layer = video_handler->GetMaxTemporalLayer();
+    return true;
+}
+
+void PeerSession::SetMaxTemporalLayer(int layer) {
+    std::shared_ptr<EncodedVideoFrameHandler> video_handler = this->video_handler();
+    if (video_handler) {
+        video_handler->SetMaxTemporalLayer(layer);
+    }
+}
+
+bool PeerSession::GetDisplaySize(int* width, int* height) const {
+    std::shared_ptr<EncodedVideoFrameHandler> video_handler = this->video_handler();
+    if (!video_handler) {
+        return false;
+    }
+    video_handler->GetDisplaySize(width, height);
+    return true;
+}
+
+bool PeerSession::StartEventLog(RtcEventLogWriter* writer) {
+    // 与Close同在信令线程执行；会话已关闭时不再打开日志文件
+    webrtc::scoped_refptr<webrtc::PeerConnectionInterface> pc = peer_connection();
+    if (!pc) {
+        return false;
+    }
+    // 重新开始记录时事件日志会先写出全部流配置，新文件可以单独解析
+    StopEventLog();
+    std::shared_ptr<RtcEventLogWriter::LogFile> file;
+    std::unique_ptr<webrtc::RtcEventLogOutput> output = writer->OpenOutput(room_id_ + "_" + remote_id_, &file);
+    if (!output) {
+        return false;
+    }
+    if (!pc->StartRtcEventLog(std::move(output), writer->config().output_period_ms)) {
+        std::cerr << "Failed to start RTC event log for " << room_id_ << "/" << remote_id_ << std::endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(event_log_mutex_);
+    event_log_file_ = std::move(file);
+    return true;
+}
+
+void PeerSession::StopEventLog() {
+    // 不持锁调用PeerConnection：调用会同步等待信令线程
+    std::shared_ptr<RtcEventLogWriter::LogFile> file;
+    {
+        std::lock_guard<std::mutex> lock(event_log_mutex_);
+        file = std::move(event_log_file_);
+    }
+    webrtc::scoped_refptr<webrtc::PeerConnectionInterface> pc = peer_connection();
+    if (file && pc) {
+        pc->StopRtcEventLog();
+    }
+}
+
+bool PeerSession::event_log_active() const {
+    std::lock_guard<std::mutex> lock(event_log_mutex_);
+    return event_log_file_ != nullptr;
+}
+
+bool PeerSession::event_log_full() const {
+    std::lock_guard<std::mutex> lock(event_log_mutex_);
+    return event_log_file_ && event_log_file_->full;
+}
+
+void PeerSession::Close() {
+    control_channel_->Close();
+    // 停止事件日志时最后一批数据交给输出对象，文件随之关闭
+    StopEventLog();
+    // 先从会话中取下再关闭：之后peer_connection()返回空，仍持有引用的回调只会在已关闭的对象上调用
+    webrtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection;
+    {
+        std::lock_guard<std::mutex> lock(peer_connection_mutex_);
+        peer_connection = std::move(peer_connection_);
+    }
+    if (peer_connection) {
+        peer_connection->Close();
+    }
+    // PeerConnection关闭后观察者不会再被回调
+    observer_.reset();
+
+    // 处理器的生命周期由WebRTCClient按槽位管理：这里只回收解码器和同步状态，
+    // VDEC/VO/AO通道留给该槽位的下一个会话，省去重新创建通道和使能VO的时间
+    // 先在锁内取下，其他线程此后只会拿到空指针；回收在锁外进行
+    std::shared_ptr<EncodedVideoFrameHandler> video_handler;
+    std::shared_ptr<AudioReceiver> audio_handler;
+    {
+        std::lock_guard<std::mutex> lock(handlers_mutex_);
+        video_handler = std::move(video_handler_);
+        audio_handler = std::move(audio_handler_);
+    }
+    if (video_handler) video_handler->Recycle();
+    if (audio_handler) audio_handler->Reset();
+}
+
+PeerSession::Usage PeerSession::GetUsage() const {
+    std::shared_ptr<EncodedVideoFrameHandler> video_handler = this->video_handler();
+    std::shared_ptr<AudioReceiver> audio_handler = this->audio_handler();
+    Usage usage;
+    usage.room_id = room_id_;
+    usage.remote_id = remote_id_;
+    usage.slot = slot_;
+    usage.age_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - created_time_).count();
+    usage.has_audio = audio_handler != nullptr;
+    if (video_handler) {
+        usage.vdec_chn = video_handler->GetDecoderChannel();
+        usage.video_frames = video_handler->GetFrameCount();
+        usage.video_bytes = video_handler->GetByteCount();
+    }
+    usage.bitrate_cap_kbps = bitrate_cap_kbps_;
+    {
+        std::lock_guard<std::mutex> lock(simulcast_mutex_);
+        usage.simulcast_rid = simulcast_rid_;
+    }
+    if (video_handler) {
+        usage.skipped_frames = video_handler->GetSkippedFrameCount();
+        usage.skipped_bytes = video_handler->GetSkippedByteCount();
+    }
+    usage.latency_samples = latency_samples_;
+    usage.latency_avg_us = usage.latency_samples > 0 ? latency_sum_us_ / static_cast<int64_t>(usage.latency_samples) : 0;
+    usage.latency_max_us = latency_max_us_;
+    return usage;
+}
+
+bool PeerSession::ReadProcessUsage(ProcessUsage* usage) {
+    std::ifstream status("/proc/self/status");
+    if (!status) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(status, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        if (key == "VmRSS:") {
+            fields >> usage->rss_kb;
+        } else if (key == "Threads:") {
+            fields >> usage->threads;
+        }
+    }
+    return true;
+}
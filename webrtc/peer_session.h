@@ -0,0 +1,331 @@
+#pragma once
+#include "api/peer_connection_interface.h"
+#include "api/scoped_refptr.h"
+#include "peer_connection_observer_impl.h"
+#include "latency_profile.h"
+#include "receive_bitrate_controller.h"
+#include "layer_selector.h"
+#include "control_channel.h"
+#include "rtc_event_log_writer.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class WebRTCClient;
+class EncodedVideoFrameHandler;
+class AudioReceiver;
+
+/**
+ * @brief 预先创建、尚未分配给远端的PeerConnection
+ *
+ * 配置了ice_candidate_pool_size时，PeerConnection创建后立即开始收集候选者
+ * （包括STUN查询），Offer到达时直接取用，Answer之后的候选者几乎立刻就能发出。
+ */
+struct PrewarmedConnection {
+    std::unique_ptr<PeerConnectionObserverImpl> observer;
+    webrtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection;
+    std::chrono::steady_clock::time_point created_time;
+};
+
+/**
+ * @brief 与一个远端发送端的会话
+ *
+ * 每个远端对端拥有独立的PeerConnection、观察者和媒体处理器，
+ * 由WebRTCClient在收到该对端的Offer时按需创建，在对端离开时销毁。
+ * 接收端可同时加入多个房间，会话由（房间ID，远端ID）唯一确定。
+ * 会话占用一个槽位：槽位0使用主媒体处理器（含音频输出），
+ * 其余槽位使用各自的解码/显示通道，不播放音频。
+ */
+class PeerSession {
+public:
+    /**
+     * @brief 会话的资源占用情况
+     */
+    struct Usage {
+        std::string room_id;
+        std::string remote_id;
+        int slot = 0;
+        int64_t age_ms = 0;          // 会话存在时长
+        int vdec_chn = -1;           // 占用的解码通道
+        bool has_audio = false;      // 是否占用音频输出
+        uint64_t video_frames = 0;   // 送入解码器的帧数
+        uint64_t video_bytes = 0;    // 送入解码器的字节数
+        int bitrate_cap_kbps = 0;    // 按解码余量设置的码率上限，0表示不限制
+        std::string simulcast_rid;   // 接收的联播层，未使用联播时为空
+        uint64_t skipped_frames = 0; // 按时间层丢弃、未送入解码器的帧数
+        uint64_t skipped_bytes = 0;
+        uint64_t latency_samples = 0;  // 测得端到端延迟的帧数（仅测试发送端提供帧时间戳时）
+        int64_t latency_avg_us = 0;
+        int64_t latency_max_us = 0;
+    };
+
+    /**
+     * @brief 进程级资源占用（来自/proc/self/status）
+     */
+    struct ProcessUsage {
+        int64_t rss_kb = 0;
+        int threads = 0;
+    };
+
+    /**
+     * @brief 构造函数
+     * @param client 主控类，观察者通过它发送信令
+     * @param room_id 远端所在房间ID
+     * @param remote_id 远端客户端ID
+     * @param slot 会话槽位
+     * @param video_handler 视频处理器
+     * @param audio_handler 音频处理器（可为空）
+     *
+     * 处理器由WebRTCClient按槽位持有并在会话之间复用，会话结束时只回收（保留VDEC/VO/AO通道）
+     */
+    PeerSession(WebRTCClient* client, const std::string& room_id, const std::string& remote_id, int slot,
+                std::shared_ptr<EncodedVideoFrameHandler> video_handler,
+                std::shared_ptr<AudioReceiver> audio_handler);
+    ~PeerSession();
+
+    PeerSession(const PeerSession&) = delete;
+    PeerSession& operator=(const PeerSession&) = delete;
+
+    /**
+     * @brief 创建PeerConnection
+     * @param factory PeerConnection工厂
+     * @param config RTC配置
+     * @return 是否创建成功
+     */
+    bool Open(webrtc::PeerConnectionFactoryInterface* factory,
+              const webrtc::PeerConnectionInterface::RTCConfiguration& config,
+              std::unique_ptr<webrtc::PortAllocator> allocator = nullptr);
+
+    /**
+     * @brief 接管一个预热的PeerConnection
+     * @param connection 预热的连接，调用后被移走
+     * @return 是否接管成功
+     */
+    bool Open(PrewarmedConnection* connection);
+
+    /**
+     * @brief 创建一个尚未分配给远端的PeerConnection
+     * @param client 主控类
+     * @param factory PeerConnection工厂
+     * @param config RTC配置（ice_candidate_pool_size决定预先收集的候选者数量）
+     * @param allocator 端口分配器，为空时使用工厂默认的分配器
+     * @param connection 输出
+     * @return 是否创建成功
+     */
+    static bool Prewarm(WebRTCClient* client, webrtc::PeerConnectionFactoryInterface* factory,
+                        const webrtc::PeerConnectionInterface::RTCConfiguration& config,
+                        std::unique_ptr<webrtc::PortAllocator> allocator,
+                        PrewarmedConnection* connection);
+
+    /**
+     * @brief 记录收到Offer的时间，用于统计Offer到ICE连通的耗时
+     */
+    void MarkOfferReceived();
+
+    /**
+     * @brief 距最近一次收到Offer的时间（毫秒），尚未收到Offer时返回-1
+     */
+    int64_t GetMsSinceOffer() const;
+
+    /**
+     * @brief 是否使用了预热的PeerConnection
+     */
+    bool prewarmed() const { return prewarmed_; }
+
+    /**
+     * @brief 应用延迟档位：已有接收器的抖动缓冲、音频队列和VDEC帧缓冲
+     * （之后新增的接收器由观察者在OnAddTrack时设置）
+     * @param profile 延迟档位
+     */
+    void ApplyLatencyProfile(const LatencyProfile& profile);
+
+    /**
+     * @brief 异步获取接收统计并输出接收端各级缓冲带来的延迟
+     * @param profile_name 当前档位名，用于日志
+     */
+    void LogLatencyStats(const std::string& profile_name) const;
+
+    /**
+     * @brief 设置码率控制参数（会话打开前调用）
+     */
+    void SetBitrateControlConfig(const ReceiveBitrateController::Config& config) {
+        bitrate_controller_ = ReceiveBitrateController(config);
+    }
+
+    /**
+     * @brief 采样解码积压与丢帧并运行一次码率控制（在信令线程周期调用）
+     * @param now_ms 当前时间（毫秒）
+     * @return 本周期的决定
+     */
+    ReceiveBitrateController::Decision UpdateBitrateControl(int64_t now_ms);
+
+    /**
+     * @brief 码率控制器（只在信令线程访问）
+     */
+    const ReceiveBitrateController& bitrate_controller() const { return bitrate_controller_; }
+
+    /**
+     * @brief 当前码率上限（kbps），0表示不限制；可在任意线程读取
+     */
+    int bitrate_cap_kbps() const { return bitrate_cap_kbps_; }
+
+    /**
+     * @brief 标记是否有尚未通过重新协商告知发送端的码率上限
+     */
+    void set_bandwidth_renegotiation_pending(bool pending) { bandwidth_renegotiation_pending_ = pending; }
+    bool bandwidth_renegotiation_pending() const { return bandwidth_renegotiation_pending_; }
+
+    /**
+     * @brief 采样当前的视频解码负载（在信令线程周期调用）
+     * @param now_ms 当前时间（毫秒）
+     * @param load 输出
+     * @return 有视频输入时返回true
+     */
+    bool SampleStreamLoad(int64_t now_ms, LayerSelector::StreamLoad* load);
+
+    /**
+     * @brief 限制送入解码器的最高时间层，-1表示全部
+     */
+    void SetMaxTemporalLayer(int layer);
+
+    /**
+     * @brief 获取视频的显示尺寸，没有视频处理器时返回false
+     */
+    bool GetDisplaySize(int* width, int* height) const;
+
+    /**
+     * @brief 记录从Offer中选择接收的联播层
+     */
+    void set_simulcast_rid(const std::string& rid) {
+        std::lock_guard<std::mutex> lock(simulcast_mutex_);
+        simulcast_rid_ = rid;
+    }
+
+    /**
+     * @brief 按协商结果预先创建本会话的VDEC/VO通道（在Answer发出后调用，不占用应答时间）
+     * @param offer 远端Offer
+     * @param answer 本端Answer
+     * @return 通道已就绪时返回true；编码不是H.264/H.265或Offer中没有尺寸提示时返回false，首帧到达时再创建
+     */
+    bool PreconfigureVideo(const std::string& offer, const std::string& answer);
+
+    /**
+     * @brief 会话的控制通道（远端创建"control"/"telemetry"通道后可用）
+     */
+    ControlChannel* control_channel() const { return control_channel_.get(); }
+
+    /**
+     * @brief 开始记录RTC事件日志（在信令线程调用），已在记录时先停止旧的，即轮转到新文件
+     * @param writer 日志写入器
+     * @return 是否开始记录
+     */
+    bool StartEventLog(RtcEventLogWriter* writer);
+
+    /**
+     * @brief 停止记录RTC事件日志（在信令线程调用，Close时也会调用）
+     */
+    void StopEventLog();
+
+    /**
+     * @brief 是否正在记录RTC事件日志
+     */
+    bool event_log_active() const;
+
+    /**
+     * @brief 当前日志文件已写满，需要轮转
+     */
+    bool event_log_full() const;
+
+    /**
+     * @brief 关闭PeerConnection并释放或重置媒体处理器
+     */
+    void Close();
+
+    const std::string& room_id() const { return room_id_; }
+    const std::string& remote_id() const { return remote_id_; }
+    int slot() const { return slot_; }
+
+    /**
+     * @brief 获取PeerConnection的引用，会话关闭后返回空。
+     * 异步回调应在发起时取得引用并持有，不要在回调中重新读取
+     */
+    webrtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection() const;
+
+    /**
+     * @brief 获取会话的资源占用
+     * @return 资源占用
+     */
+    Usage GetUsage() const;
+
+    /**
+     * @brief 读取当前进程的内存和线程数
+     * @param usage 输出
+     * @return 是否读取成功
+     */
+    static bool ReadProcessUsage(ProcessUsage* usage);
+
+private:
+    /**
+     * @brief 绑定观察者和媒体处理器并持有PeerConnection
+     */
+    bool Adopt(PrewarmedConnection* connection);
+
+    /**
+     * @brief 收到发送端的帧时间戳：与帧的到达时间配对，得到单向延迟并回报给发送端（在网络线程调用）。
+     * 两端在同一台机器上时steady_clock一致，延迟即编码输出到本端收齐一帧的时间
+     */
+    void OnFrameTiming(const ControlChannel::Message& message);
+
+    /**
+     * @brief 取当前的媒体处理器（持锁复制）。Close会在信令线程上清空它们，
+     * 其他线程（健康检查、延迟档位、网络线程）只通过这里取用，会话关闭后得到空指针
+     */
+    std::shared_ptr<EncodedVideoFrameHandler> video_handler() const;
+    std::shared_ptr<AudioReceiver> audio_handler() const;
+
+    WebRTCClient* client_;
+    std::string room_id_;
+    std::string remote_id_;
+    int slot_;
+    bool prewarmed_ = false;
+    std::chrono::steady_clock::time_point created_time_;
+    std::atomic<int64_t> offer_time_us_{-1};
+
+    // 按解码余量限制发送码率
+    ReceiveBitrateController bitrate_controller_;
+    std::atomic<int> bitrate_cap_kbps_{0};
+    std::atomic<bool> bandwidth_renegotiation_pending_{false};
+
+    // 层选择：上一次采样的帧数（含丢弃的时间层）与时间
+    uint64_t last_input_frames_ = 0;
+    int64_t last_load_sample_ms_ = -1;
+    std::string simulcast_rid_;
+    mutable std::mutex simulcast_mutex_;
+
+    // 端到端延迟：尚未配对的帧时间戳与统计
+    struct FrameTiming {
+        uint32_t rtp_timestamp;
+        int64_t sent_us;
+    };
+    std::vector<FrameTiming> pending_frame_timings_;
+    std::mutex frame_timing_mutex_;
+    std::atomic<uint64_t> latency_samples_{0};
+    std::atomic<int64_t> latency_sum_us_{0};
+    std::atomic<int64_t> latency_max_us_{0};
+
+    // RTC事件日志当前写入的文件，未记录时为空
+    std::shared_ptr<RtcEventLogWriter::LogFile> event_log_file_;
+    mutable std::mutex event_log_mutex_;
+
+    std::shared_ptr<EncodedVideoFrameHandler> video_handler_;
+    std::shared_ptr<AudioReceiver> audio_handler_;
+    mutable std::mutex handlers_mutex_;
+    std::unique_ptr<PeerConnectionObserverImpl> observer_;
+    std::unique_ptr<ControlChannel> control_channel_;
+    webrtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection_;
+    mutable std::mutex peer_connection_mutex_;
+};
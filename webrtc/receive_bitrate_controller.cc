@@ -0,0 +1,77 @@
+#include "receive_bitrate_controller.h"
+#include <algorithm>
+
+ReceiveBitrateController::Decision ReceiveBitrateController::Update(const Sample& sample) {
+    if (!has_last_sample_ || sample.time_ms <= last_sample_.time_ms) {
+        last_sample_ = sample;
+        has_last_sample_ = true;
+        return Decision::kHold;
+    }
+    const int64_t elapsed_ms = sample.time_ms - last_sample_.time_ms;
+    const uint64_t bytes = sample.bytes - last_sample_.bytes;
+    const uint64_t frames = sample.frames - last_sample_.frames;
+    const uint64_t dropped = sample.dropped - last_sample_.dropped;
+    last_sample_ = sample;
+
+    metrics_.rx_kbps = static_cast<int>(bytes * 8 / elapsed_ms);
+    metrics_.backlog = sample.backlog;
+    if (frames == 0 && dropped == 0) {
+        // 没有视频输入（暂停或尚未开始），不做判断
+        healthy_samples_ = 0;
+        return Decision::kHold;
+    }
+
+    const bool overloaded = sample.backlog > config_.backlog_high || dropped > 0;
+    if (overloaded) {
+        metrics_.overload_samples++;
+        healthy_samples_ = 0;
+    } else if (sample.backlog <= config_.backlog_low) {
+        healthy_samples_++;
+    } else {
+        healthy_samples_ = 0;
+    }
+
+    if (last_change_ms_ >= 0 && sample.time_ms - last_change_ms_ < config_.min_change_interval_ms) {
+        return Decision::kHold;
+    }
+
+    if (overloaded) {
+        // 以实际接收码率为基准下调，已有上限时至少再降一档
+        int base = metrics_.rx_kbps;
+        if (metrics_.cap_kbps > 0) {
+            base = std::min(base, metrics_.cap_kbps);
+        }
+        int cap = std::max(config_.min_kbps, static_cast<int>(base * config_.decrease_factor));
+        if (metrics_.cap_kbps > 0 && cap >= metrics_.cap_kbps) {
+            return Decision::kHold;  // 已经在下限
+        }
+        metrics_.cap_kbps = cap;
+        metrics_.decreases++;
+        last_change_ms_ = sample.time_ms;
+        return Decision::kDecrease;
+    }
+
+    if (metrics_.cap_kbps > 0 && healthy_samples_ >= config_.healthy_samples_to_increase) {
+        healthy_samples_ = 0;
+        last_change_ms_ = sample.time_ms;
+        int cap = static_cast<int>(metrics_.cap_kbps * config_.increase_factor);
+        if (cap >= config_.max_kbps) {
+            metrics_.cap_kbps = 0;
+            metrics_.releases++;
+            return Decision::kRelease;
+        }
+        metrics_.cap_kbps = cap;
+        metrics_.increases++;
+        return Decision::kIncrease;
+    }
+    return Decision::kHold;
+}
+
+const char* ReceiveBitrateController::DecisionName(Decision decision) {
+    switch (decision) {
+        case Decision::kDecrease: return "decrease";
+        case Decision::kIncrease: return "increase";
+        case Decision::kRelease: return "release";
+        default: return "hold";
+    }
+}
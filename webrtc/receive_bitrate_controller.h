@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief 按解码余量限制发送端码率的控制器
+ *
+ * 拥塞控制只看得到网络：多路解码或芯片降频时VDEC跟不上，发送端仍按满码率发送，
+ * 帧在解码器前越积越多。控制器按固定周期采样解码积压和丢帧：
+ * 积压超过上限或出现丢帧时，把上限降到当前接收码率的一定比例；
+ * 连续若干周期积压很低时逐步放宽上限，超过配置的最大值后取消限制。
+ * 上限通过SDP的b=AS重新协商告知发送端，两次调整之间保持最小间隔，避免频繁协商。
+ */
+class ReceiveBitrateController {
+public:
+    struct Config {
+        int min_kbps = 300;                   // 上限不低于该值
+        int max_kbps = 8000;                  // 放宽到该值以上时取消限制
+        uint32_t backlog_high = 3;            // 积压帧数超过该值视为过载
+        uint32_t backlog_low = 1;             // 积压帧数不超过该值视为有余量
+        double decrease_factor = 0.7;         // 过载时上限 = 接收码率 * 该系数
+        double increase_factor = 1.15;        // 有余量时每次放宽的比例
+        int healthy_samples_to_increase = 5;  // 连续有余量多少个周期后放宽
+        int min_change_interval_ms = 5000;    // 两次调整的最小间隔
+    };
+
+    /**
+     * @brief 一个周期的采样（帧数、字节数、丢帧数均为累计值）
+     */
+    struct Sample {
+        int64_t time_ms = 0;
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        uint64_t dropped = 0;
+        uint32_t backlog = 0;  // 解码器中待解码的码流帧与待显示的图像数
+    };
+
+    enum class Decision {
+        kHold,      // 不调整
+        kDecrease,  // 降低上限
+        kIncrease,  // 放宽上限
+        kRelease    // 取消上限
+    };
+
+    /**
+     * @brief 控制器的累计指标
+     */
+    struct Metrics {
+        int cap_kbps = 0;            // 当前上限，0表示不限制
+        int rx_kbps = 0;             // 最近一个周期的接收码率
+        uint32_t backlog = 0;        // 最近一个周期的积压
+        uint64_t overload_samples = 0;
+        uint64_t decreases = 0;
+        uint64_t increases = 0;
+        uint64_t releases = 0;
+    };
+
+    ReceiveBitrateController() = default;
+    explicit ReceiveBitrateController(const Config& config) : config_(config) {}
+
+    /**
+     * @brief 输入一个周期的采样
+     * @param sample 采样
+     * @return 本周期的决定；不为kHold时通过cap_kbps()读取新的上限
+     */
+    Decision Update(const Sample& sample);
+
+    /**
+     * @brief 当前上限（kbps），0表示不限制
+     */
+    int cap_kbps() const { return metrics_.cap_kbps; }
+
+    /**
+     * @brief 获取指标
+     */
+    const Metrics& metrics() const { return metrics_; }
+
+    /**
+     * @brief 决定的名称，用于日志
+     */
+    static const char* DecisionName(Decision decision);
+
+private:
+    Config config_;
+    Metrics metrics_;
+    Sample last_sample_;
+    bool has_last_sample_ = false;
+    int healthy_samples_ = 0;
+    int64_t last_change_ms_ = -1;
+};
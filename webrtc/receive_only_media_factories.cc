@@ -0,0 +1,95 @@
+#include "receive_only_media_factories.h"
+#include "api/audio_codecs/audio_decoder_factory_template.h"
+#include "api/audio_codecs/opus/audio_decoder_opus.h"
+#include "api/video_codecs/sdp_video_format.h"
+#include "api/video_codecs/video_decoder.h"
+#include "modules/video_coding/include/video_error_codes.h"
+#include "rtc_base/ref_counted_object.h"
+#include <atomic>
+#include <iostream>
+
+namespace {
+
+// 帧不会回到WebRTC的解码流程；WebRTC在会话开始时仍会预先创建一个解码器，这里给它一个空对象
+class PassthroughVideoDecoder : public webrtc::VideoDecoder {
+public:
+    bool Configure(const Settings& settings) override { return true; }
+
+    int32_t Decode(const webrtc::EncodedImage& input_image, int64_t render_time_ms) override {
+        static std::atomic<bool> warned{false};
+        if (!warned.exchange(true)) {
+            std::cerr << "[WARN] Frame reached the passthrough decoder; video is decoded by VDEC only" << std::endl;
+        }
+        return WEBRTC_VIDEO_CODEC_OK;
+    }
+
+    int32_t RegisterDecodeCompleteCallback(webrtc::DecodedImageCallback* callback) override {
+        return WEBRTC_VIDEO_CODEC_OK;
+    }
+
+    int32_t Release() override { return WEBRTC_VIDEO_CODEC_OK; }
+
+    DecoderInfo GetDecoderInfo() const override {
+        DecoderInfo info;
+        info.implementation_name = "rockit-vdec-passthrough";
+        info.is_hardware_accelerated = true;
+        return info;
+    }
+
+    const char* ImplementationName() const override { return "rockit-vdec-passthrough"; }
+};
+
+class PassthroughVideoDecoderFactory : public webrtc::VideoDecoderFactory {
+public:
+    std::vector<webrtc::SdpVideoFormat> GetSupportedFormats() const override {
+        // 声明VDEC能解码的全部编码（与EncodedVideoFrameHandler::InitializeDecoder一致）。
+        // H.264支持到High Profile Level 5.1；两种打包模式都声明，与浏览器的Offer匹配
+        std::vector<webrtc::SdpVideoFormat> formats;
+        for (const char* profile_level_id : {"42e033", "42001f", "4d0033", "640033"}) {
+            for (const char* packetization_mode : {"1", "0"}) {
+                formats.push_back(webrtc::SdpVideoFormat("H264", {{"level-asymmetry-allowed", "1"},
+                                                                  {"packetization-mode", packetization_mode},
+                                                                  {"profile-level-id", profile_level_id}}));
+            }
+        }
+        // H.265 Main Profile，Main Tier到Level 5.1（level-id = 30 * 5.1）；VDEC同样支持，与内置工厂的H.265一致
+        formats.push_back(webrtc::SdpVideoFormat("H265", {{"profile-id", "1"},
+                                                          {"tier-flag", "0"},
+                                                          {"level-id", "153"},
+                                                          {"tx-mode", "SRST"}}));
+        return formats;
+    }
+
+    std::unique_ptr<webrtc::VideoDecoder> Create(const webrtc::Environment& env,
+                                                 const webrtc::SdpVideoFormat& format) override {
+        return std::make_unique<PassthroughVideoDecoder>();
+    }
+};
+
+class EmptyAudioEncoderFactory : public webrtc::AudioEncoderFactory {
+public:
+    std::vector<webrtc::AudioCodecSpec> GetSupportedEncoders() override { return {}; }
+
+    std::optional<webrtc::AudioCodecInfo> QueryAudioEncoder(const webrtc::SdpAudioFormat& format) override {
+        return std::nullopt;
+    }
+
+    std::unique_ptr<webrtc::AudioEncoder> Create(const webrtc::Environment& env, const webrtc::SdpAudioFormat& format,
+                                                 Options options) override {
+        return nullptr;
+    }
+};
+
+}  // namespace
+
+std::unique_ptr<webrtc::VideoDecoderFactory> CreateReceiveOnlyVideoDecoderFactory() {
+    return std::make_unique<PassthroughVideoDecoderFactory>();
+}
+
+webrtc::scoped_refptr<webrtc::AudioDecoderFactory> CreateReceiveOnlyAudioDecoderFactory() {
+    return webrtc::CreateAudioDecoderFactory<webrtc::AudioDecoderOpus>();
+}
+
+webrtc::scoped_refptr<webrtc::AudioEncoderFactory> CreateReceiveOnlyAudioEncoderFactory() {
+    return webrtc::make_ref_counted<EmptyAudioEncoderFactory>();
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "api/audio_codecs/audio_decoder_factory.h"
+#include "api/audio_codecs/audio_encoder_factory.h"
+#include "api/scoped_refptr.h"
+#include "api/video_codecs/video_decoder_factory.h"
+#include <memory>
+
+/**
+ * @brief 只接收、硬件解码的媒体引擎所用的编解码器工厂
+ *
+ * 接收端不发送媒体，视频帧由VideoFrameTransformer直接送入VDEC，不经过WebRTC的解码器。
+ * 内置工厂会把libvpx、dav1d、OpenH264/FFmpeg以及全部音频编码器链接进来，
+ * 会话开始时还会预先创建一个软件解码器。这里只保留实际用到的部分：
+ * - 视频解码：只声明VDEC支持的H.264/H.265（SDP协商用），解码器为不做任何事的直通对象
+ * - 音频解码：只有Opus
+ * - 音频编码：空工厂（语音引擎要求非空），视频编码工厂直接传nullptr
+ * 由CMake选项RK_RECEIVE_ONLY_ENGINE控制，关闭时恢复内置工厂。
+ */
+
+/**
+ * @brief 只声明H.264/H.265的视频解码器工厂，创建的解码器不解码（帧已在变换器中交给VDEC）
+ */
+std::unique_ptr<webrtc::VideoDecoderFactory> CreateReceiveOnlyVideoDecoderFactory();
+
+/**
+ * @brief 只包含Opus的音频解码器工厂
+ */
+webrtc::scoped_refptr<webrtc::AudioDecoderFactory> CreateReceiveOnlyAudioDecoderFactory();
+
+/**
+ * @brief 不提供任何编码器的音频编码器工厂
+ */
+webrtc::scoped_refptr<webrtc::AudioEncoderFactory> CreateReceiveOnlyAudioEncoderFactory();
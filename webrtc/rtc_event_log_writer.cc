@@ -0,0 +1,250 @@
+#include "rtc_event_log_writer.h"
+#include "../common/thread_profile.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// 逐级创建目录
+bool MakeDirectories(const std::string& path) {
+    for (size_t pos = 1; pos <= path.size(); ++pos) {
+        if (pos != path.size() && path[pos] != '/') {
+            continue;
+        }
+        const std::string partial = path.substr(0, pos);
+        if (mkdir(partial.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+    }
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+int64_t ThreadCpuUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+}  // namespace
+
+// 交给RtcEventLog的输出对象，在事件日志的任务队列上被调用和销毁
+class RtcEventLogWriter::Output : public webrtc::RtcEventLogOutput {
+public:
+    Output(RtcEventLogWriter* writer, std::shared_ptr<LogFile> file) : writer_(writer), file_(std::move(file)) {}
+
+    ~Output() override {
+        Chunk chunk;
+        chunk.file = file_;
+        chunk.close = true;
+        writer_->Enqueue(std::move(chunk));
+    }
+
+    bool IsActive() const override { return true; }
+
+    bool Write(absl::string_view output) override {
+        Chunk chunk;
+        chunk.file = file_;
+        chunk.data.assign(output.data(), output.size());
+        if (writer_->Enqueue(std::move(chunk))) {
+            uint64_t bytes = file_->bytes += output.size();
+            if (bytes >= writer_->config().max_file_bytes) {
+                file_->full = true;
+            }
+        }
+        // 丢弃时同样返回true：返回false会让事件日志永久停止
+        return true;
+    }
+
+private:
+    RtcEventLogWriter* writer_;
+    std::shared_ptr<LogFile> file_;
+};
+
+RtcEventLogWriter::RtcEventLogWriter() = default;
+
+RtcEventLogWriter::~RtcEventLogWriter() {
+    Stop();
+}
+
+bool RtcEventLogWriter::Start(const Config& config) {
+    if (running_) {
+        return true;
+    }
+    config_ = config;
+    if (!MakeDirectories(config_.directory)) {
+        std::cerr << "Failed to create event log directory " << config_.directory << ": " << strerror(errno)
+                  << std::endl;
+        return false;
+    }
+
+    // 上次运行留下的日志也计入保留数量；文件名以时间开头，按名字排序即按时间排序
+    std::vector<std::string> existing;
+    if (DIR* dir = opendir(config_.directory.c_str())) {
+        while (struct dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > 7 && name.compare(name.size() - 7, 7, ".rtclog") == 0) {
+                existing.push_back(config_.directory + "/" + name);
+            }
+        }
+        closedir(dir);
+    }
+    std::sort(existing.begin(), existing.end());
+    finished_files_.assign(existing.begin(), existing.end());
+    PruneOldFiles();
+
+    running_ = true;
+    thread_ = std::thread(&RtcEventLogWriter::Run, this);
+    std::cout << "[INFO] RTC event log: " << config_.directory << ", " << (config_.max_file_bytes >> 20)
+              << " MB x " << config_.max_files << " files, queue " << (config_.max_pending_bytes >> 10) << " KB, output every "
+              << config_.output_period_ms << " ms" << std::endl;
+    return true;
+}
+
+void RtcEventLogWriter::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+std::unique_ptr<webrtc::RtcEventLogOutput> RtcEventLogWriter::OpenOutput(const std::string& name,
+                                                                         std::shared_ptr<LogFile>* file) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return nullptr;
+        }
+    }
+    std::string safe_name = name;
+    for (char& c : safe_name) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_') {
+            c = '_';
+        }
+    }
+    // 时间_序号_名字：同一秒内打开的文件按序号排序
+    char prefix[48];
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_r(&now, &local);
+    size_t len = strftime(prefix, sizeof(prefix), "%Y%m%d-%H%M%S", &local);
+    snprintf(prefix + len, sizeof(prefix) - len, "_%04u_", static_cast<unsigned>(file_seq_++ % 10000));
+
+    auto log_file = std::make_shared<LogFile>();
+    log_file->path = config_.directory + "/" + prefix + safe_name + ".rtclog";
+    *file = log_file;
+    return std::make_unique<Output>(this, std::move(log_file));
+}
+
+RtcEventLogWriter::Stats RtcEventLogWriter::GetStats() const {
+    Stats stats;
+    stats.written_bytes = written_bytes_;
+    stats.dropped_bytes = dropped_bytes_;
+    stats.dropped_writes = dropped_writes_;
+    stats.files_opened = files_opened_;
+    stats.files_deleted = files_deleted_;
+    stats.writer_cpu_us = writer_cpu_us_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.pending_bytes = pending_bytes_;
+    return stats;
+}
+
+bool RtcEventLogWriter::Enqueue(Chunk chunk) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 关闭标记总是入队，否则文件句柄不会释放
+        if (!chunk.close && (!running_ || pending_bytes_ + chunk.data.size() > config_.max_pending_bytes)) {
+            dropped_bytes_ += chunk.data.size();
+            dropped_writes_++;
+            return false;
+        }
+        pending_bytes_ += chunk.data.size();
+        queue_.push_back(std::move(chunk));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void RtcEventLogWriter::Run() {
+    ThreadProfile::Instance().RegisterCurrentThread(ThreadProfile::Role::kOther, "rtc-eventlog");
+    std::deque<Chunk> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return !queue_.empty() || !running_; });
+            if (queue_.empty()) {
+                break;  // 已停止且队列写完
+            }
+            batch.swap(queue_);
+        }
+        for (const Chunk& chunk : batch) {
+            WriteChunk(chunk);
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_bytes_ -= chunk.data.size();
+        }
+        batch.clear();
+        writer_cpu_us_ = ThreadCpuUs();
+    }
+    // 停止时仍未收到关闭标记的文件（对应的PeerConnection未关闭）也一并关闭
+    for (auto& entry : open_files_) {
+        fclose(entry.second);
+    }
+    open_files_.clear();
+}
+
+void RtcEventLogWriter::WriteChunk(const Chunk& chunk) {
+    auto it = open_files_.find(chunk.file.get());
+    if (chunk.close) {
+        if (it != open_files_.end()) {
+            fclose(it->second);
+            open_files_.erase(it);
+            finished_files_.push_back(chunk.file->path);
+        }
+        return;
+    }
+    if (it == open_files_.end()) {
+        FILE* fp = fopen(chunk.file->path.c_str(), "wb");
+        if (!fp) {
+            std::cerr << "Failed to open event log " << chunk.file->path << ": " << strerror(errno) << std::endl;
+            dropped_bytes_ += chunk.data.size();
+            dropped_writes_++;
+            return;
+        }
+        it = open_files_.emplace(chunk.file.get(), fp).first;
+        files_opened_++;
+        PruneOldFiles();
+    }
+    size_t written = fwrite(chunk.data.data(), 1, chunk.data.size(), it->second);
+    // 每批写完即刷到内核，进程异常退出时日志仍然可用
+    fflush(it->second);
+    written_bytes_ += written;
+    if (written < chunk.data.size()) {
+        dropped_bytes_ += chunk.data.size() - written;
+        dropped_writes_++;
+    }
+}
+
+void RtcEventLogWriter::PruneOldFiles() {
+    while (!finished_files_.empty() &&
+           finished_files_.size() + open_files_.size() > static_cast<size_t>(std::max(1, config_.max_files))) {
+        if (unlink(finished_files_.front().c_str()) == 0) {
+            files_deleted_++;
+        }
+        finished_files_.pop_front();
+    }
+}
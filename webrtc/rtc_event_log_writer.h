@@ -0,0 +1,131 @@
+#pragma once
+#include "api/rtc_event_log_output.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief RTC事件日志的异步文件写入器
+ *
+ * PeerConnection的RtcEventLog在自己的任务队列上编码RTP/RTCP包头、带宽估计、
+ * ICE事件等，每隔output_period_ms把一批编码结果交给输出对象。这里的输出对象
+ * 只把数据放进队列，由单独的写线程落盘，事件日志的任务队列不会阻塞在文件IO上。
+ * 队列中待写的数据有上限，写不过来时丢弃整批（日志仍可解析，只是缺少这一段事件）。
+ * 每个会话一个文件，写满max_file_bytes后由会话重新开始记录（新文件带完整的流配置），
+ * 目录中最多保留max_files个文件，超出时删除最旧的。
+ */
+class RtcEventLogWriter {
+public:
+    struct Config {
+        std::string directory = "/tmp/rtc_event_log";
+        uint64_t max_file_bytes = 16 << 20;    // 单个文件达到该大小后轮转
+        int max_files = 8;                     // 目录中保留的文件数（含正在写的）
+        size_t max_pending_bytes = 2 << 20;    // 写队列的内存上限
+        int64_t output_period_ms = 5000;       // 事件日志批量输出的间隔
+    };
+
+    /**
+     * @brief 写入统计
+     */
+    struct Stats {
+        uint64_t written_bytes = 0;   // 已写入文件的字节数
+        uint64_t dropped_bytes = 0;   // 队列已满时丢弃的字节数
+        uint64_t dropped_writes = 0;  // 丢弃的批次数
+        uint64_t files_opened = 0;
+        uint64_t files_deleted = 0;   // 超出保留数量被删除的旧文件
+        size_t pending_bytes = 0;     // 队列中尚未写入的字节数
+        int64_t writer_cpu_us = 0;    // 写线程累计占用的CPU时间
+    };
+
+    /**
+     * @brief 一个日志文件的状态，由输出对象与会话共享
+     */
+    struct LogFile {
+        std::string path;
+        std::atomic<uint64_t> bytes{0};   // 已交给写入器的字节数
+        std::atomic<bool> full{false};    // 已达到max_file_bytes，等待会话轮转
+    };
+
+    RtcEventLogWriter();
+    ~RtcEventLogWriter();
+
+    RtcEventLogWriter(const RtcEventLogWriter&) = delete;
+    RtcEventLogWriter& operator=(const RtcEventLogWriter&) = delete;
+
+    /**
+     * @brief 创建日志目录并启动写线程
+     * @param config 配置
+     * @return 目录不可用或线程启动失败时返回false
+     */
+    bool Start(const Config& config);
+
+    /**
+     * @brief 写完队列中剩余的数据，关闭所有文件并停止写线程。
+     * 需在所有输出对象销毁之后调用（即所有PeerConnection关闭之后）
+     */
+    void Stop();
+
+    /**
+     * @brief 为一个会话创建日志输出，交给PeerConnection::StartRtcEventLog
+     * @param name 文件名的一部分（如房间ID_远端ID），非法字符会被替换
+     * @param file 输出该文件的共享状态，用于判断是否需要轮转
+     * @return 输出对象，写线程未启动时返回nullptr
+     */
+    std::unique_ptr<webrtc::RtcEventLogOutput> OpenOutput(const std::string& name, std::shared_ptr<LogFile>* file);
+
+    const Config& config() const { return config_; }
+
+    /**
+     * @brief 获取写入统计
+     */
+    Stats GetStats() const;
+
+private:
+    class Output;
+
+    struct Chunk {
+        std::shared_ptr<LogFile> file;
+        std::string data;
+        bool close = false;   // 输出对象已销毁，写完之前的数据后关闭文件
+    };
+
+    /**
+     * @brief 把数据放入写队列（在事件日志的任务队列上调用）
+     * @return 队列已满而被丢弃时返回false
+     */
+    bool Enqueue(Chunk chunk);
+
+    // 写线程主循环
+    void Run();
+
+    // 以下只在写线程访问
+    void WriteChunk(const Chunk& chunk);
+    void PruneOldFiles();
+
+    Config config_;
+    std::thread thread_;
+    bool running_ = false;
+
+    std::deque<Chunk> queue_;
+    size_t pending_bytes_ = 0;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+
+    std::map<const LogFile*, FILE*> open_files_;
+    std::deque<std::string> finished_files_;   // 已关闭的文件，按创建先后排列
+    std::atomic<uint64_t> file_seq_{0};
+
+    std::atomic<uint64_t> written_bytes_{0};
+    std::atomic<uint64_t> dropped_bytes_{0};
+    std::atomic<uint64_t> dropped_writes_{0};
+    std::atomic<uint64_t> files_opened_{0};
+    std::atomic<uint64_t> files_deleted_{0};
+    std::atomic<int64_t> writer_cpu_us_{0};
+};
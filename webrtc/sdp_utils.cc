@@ -0,0 +1,462 @@
+#include "sdp_utils.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+namespace sdp_utils {
+
+namespace {
+
+// 按行拆分，去掉行尾的\r
+std::vector<std::string> SplitLines(const std::string& sdp) {
+    std::vector<std::string> lines;
+    std::istringstream stream(sdp);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            lines.push_back(line);
+        }
+    }
+    return lines;
+}
+
+bool StartsWith(const std::string& line, const char* prefix) {
+    return line.compare(0, std::char_traits<char>::length(prefix), prefix) == 0;
+}
+
+// 按分隔符拆分
+std::vector<std::string> Split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::istringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, separator)) {
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+// 联播层组内可能列出多个备选rid（逗号分隔），暂停的层带"~"前缀。
+// 远端SDP不可信：只有"~"或空的rid被忽略，整组都无效时返回空
+std::vector<std::string> GroupRids(const std::string& group) {
+    std::vector<std::string> rids;
+    for (auto rid : Split(group, ',')) {
+        if (rid[0] == '~') {
+            rid.erase(0, 1);
+        }
+        if (!rid.empty()) {
+            rids.push_back(rid);
+        }
+    }
+    return rids;
+}
+
+// 第一个视频m段的行（不含m=行本身），m_line输出m=行
+std::vector<std::string> FirstVideoSection(const std::string& sdp, std::string* m_line) {
+    std::vector<std::string> section;
+    bool in_video = false;
+    for (const auto& line : SplitLines(sdp)) {
+        if (StartsWith(line, "m=")) {
+            if (in_video) {
+                break;
+            }
+            in_video = StartsWith(line, "m=video");
+            if (in_video && m_line) {
+                *m_line = line;
+            }
+        } else if (in_video) {
+            section.push_back(line);
+        }
+    }
+    return section;
+}
+
+// "a=<name>:<pt> <value>"中载荷类型匹配时返回value
+bool GetPayloadAttribute(const std::string& line, const std::string& name, int payload_type, std::string* value) {
+    const std::string prefix = "a=" + name + ":" + std::to_string(payload_type) + " ";
+    if (!StartsWith(line, prefix.c_str())) {
+        return false;
+    }
+    *value = line.substr(prefix.size());
+    return true;
+}
+
+std::string DecodeBase64(const std::string& text) {
+    static const std::string kAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (char c : text) {
+        size_t value = kAlphabet.find(c);
+        if (value == std::string::npos) {
+            continue;  // 跳过填充的'='
+        }
+        buffer = (buffer << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast<char>((buffer >> bits) & 0xff));
+        }
+    }
+    return out;
+}
+
+// 按位读取RBSP（已去掉防竞争字节），越界时置failed
+class BitReader {
+public:
+    explicit BitReader(const std::string& data) : data_(data) {}
+
+    uint32_t ReadBits(int count) {
+        uint32_t value = 0;
+        for (int i = 0; i < count; ++i) {
+            if (position_ >= data_.size() * 8) {
+                failed_ = true;
+                return 0;
+            }
+            value = (value << 1) | ((static_cast<uint8_t>(data_[position_ / 8]) >> (7 - position_ % 8)) & 1);
+            position_++;
+        }
+        return value;
+    }
+
+    uint32_t ReadUe() {
+        int leading_zeros = 0;
+        while (!failed_ && ReadBits(1) == 0) {
+            if (++leading_zeros > 31) {
+                failed_ = true;
+                return 0;
+            }
+        }
+        return ((1u << leading_zeros) - 1) + ReadBits(leading_zeros);
+    }
+
+    int32_t ReadSe() {
+        uint32_t value = ReadUe();
+        return (value & 1) ? static_cast<int32_t>((value + 1) / 2) : -static_cast<int32_t>(value / 2);
+    }
+
+    bool failed() const { return failed_; }
+
+private:
+    const std::string& data_;
+    size_t position_ = 0;
+    bool failed_ = false;
+};
+
+// 从H.264 SPS（含NAL头）计算显示尺寸（已扣除裁剪）
+bool ParseH264SpsSize(const std::string& nal, int* width, int* height) {
+    if (nal.size() < 4 || (nal[0] & 0x1f) != 7) {
+        return false;
+    }
+    // 去掉防竞争字节00 00 03
+    std::string rbsp;
+    for (size_t i = 1; i < nal.size(); ++i) {
+        if (i + 2 < nal.size() && nal[i] == 0 && nal[i + 1] == 0 && nal[i + 2] == 3) {
+            rbsp.append(2, '\0');
+            i += 2;
+            continue;
+        }
+        rbsp.push_back(nal[i]);
+    }
+    BitReader reader(rbsp);
+    const uint32_t profile_idc = reader.ReadBits(8);
+    reader.ReadBits(16);  // constraint_set标志与level_idc
+    reader.ReadUe();      // seq_parameter_set_id
+    uint32_t chroma_format_idc = 1;
+    bool separate_colour_plane = false;
+    static const uint32_t kHighProfiles[] = {100, 110, 122, 244, 44, 83, 86, 118, 128, 138, 139, 134, 135};
+    if (std::find(std::begin(kHighProfiles), std::end(kHighProfiles), profile_idc) != std::end(kHighProfiles)) {
+        chroma_format_idc = reader.ReadUe();
+        if (chroma_format_idc == 3) {
+            separate_colour_plane = reader.ReadBits(1);
+        }
+        reader.ReadUe();      // bit_depth_luma_minus8
+        reader.ReadUe();      // bit_depth_chroma_minus8
+        reader.ReadBits(1);   // qpprime_y_zero_transform_bypass_flag
+        if (reader.ReadBits(1)) {  // seq_scaling_matrix_present_flag
+            const int lists = chroma_format_idc == 3 ? 12 : 8;
+            for (int i = 0; i < lists; ++i) {
+                if (!reader.ReadBits(1)) {
+                    continue;
+                }
+                const int size = i < 6 ? 16 : 64;
+                int last_scale = 8;
+                int next_scale = 8;
+                for (int j = 0; j < size && next_scale != 0; ++j) {
+                    next_scale = (last_scale + reader.ReadSe() + 256) % 256;
+                    last_scale = next_scale == 0 ? last_scale : next_scale;
+                }
+            }
+        }
+    }
+    reader.ReadUe();  // log2_max_frame_num_minus4
+    const uint32_t pic_order_cnt_type = reader.ReadUe();
+    if (pic_order_cnt_type == 0) {
+        reader.ReadUe();  // log2_max_pic_order_cnt_lsb_minus4
+    } else if (pic_order_cnt_type == 1) {
+        reader.ReadBits(1);
+        reader.ReadSe();
+        reader.ReadSe();
+        const uint32_t cycle = reader.ReadUe();
+        for (uint32_t i = 0; i < cycle && !reader.failed(); ++i) {
+            reader.ReadSe();
+        }
+    }
+    reader.ReadUe();      // max_num_ref_frames
+    reader.ReadBits(1);   // gaps_in_frame_num_value_allowed_flag
+    const uint32_t width_in_mbs = reader.ReadUe() + 1;
+    const uint32_t height_in_map_units = reader.ReadUe() + 1;
+    const uint32_t frame_mbs_only = reader.ReadBits(1);
+    if (!frame_mbs_only) {
+        reader.ReadBits(1);  // mb_adaptive_frame_field_flag
+    }
+    reader.ReadBits(1);      // direct_8x8_inference_flag
+    uint32_t crop_left = 0, crop_right = 0, crop_top = 0, crop_bottom = 0;
+    if (reader.ReadBits(1)) {
+        crop_left = reader.ReadUe();
+        crop_right = reader.ReadUe();
+        crop_top = reader.ReadUe();
+        crop_bottom = reader.ReadUe();
+    }
+    if (reader.failed()) {
+        return false;
+    }
+    const uint32_t array_type = separate_colour_plane ? 0 : chroma_format_idc;
+    const uint32_t crop_unit_x = (array_type == 1 || array_type == 2) ? 2 : 1;
+    const uint32_t crop_unit_y = (array_type == 1 ? 2 : 1) * (2 - frame_mbs_only);
+    *width = static_cast<int>(width_in_mbs * 16 - crop_unit_x * (crop_left + crop_right));
+    *height = static_cast<int>((2 - frame_mbs_only) * height_in_map_units * 16 - crop_unit_y * (crop_top + crop_bottom));
+    return *width > 0 && *height > 0;
+}
+
+}  // namespace
+
+std::string SetVideoBandwidth(const std::string& sdp, int kbps) {
+    std::string out;
+    bool in_video = false;
+    bool written = false;
+    for (const auto& line : SplitLines(sdp)) {
+        if (StartsWith(line, "m=")) {
+            in_video = StartsWith(line, "m=video");
+            written = false;
+        }
+        if (in_video && (StartsWith(line, "b=AS:") || StartsWith(line, "b=TIAS:"))) {
+            continue;
+        }
+        out += line;
+        out += "\r\n";
+        // 会话描述规定的顺序为m、i、c、b，带宽行紧跟在c=之后
+        if (in_video && !written && kbps > 0 && StartsWith(line, "c=")) {
+            out += "b=AS:" + std::to_string(kbps) + "\r\n";
+            out += "b=TIAS:" + std::to_string(static_cast<long long>(kbps) * 1000) + "\r\n";
+            written = true;
+        }
+    }
+    return out;
+}
+
+int GetVideoBandwidth(const std::string& sdp) {
+    bool in_video = false;
+    for (const auto& line : SplitLines(sdp)) {
+        if (StartsWith(line, "m=")) {
+            if (in_video) {
+                break;
+            }
+            in_video = StartsWith(line, "m=video");
+        } else if (in_video && StartsWith(line, "b=AS:")) {
+            return std::atoi(line.c_str() + 5);
+        }
+    }
+    return 0;
+}
+
+std::vector<SimulcastLayer> GetSimulcastLayers(const std::string& sdp) {
+    std::vector<SimulcastLayer> layers;
+    std::vector<SimulcastLayer> rids;
+    bool in_video = false;
+    bool seen_video = false;
+    for (const auto& line : SplitLines(sdp)) {
+        if (StartsWith(line, "m=")) {
+            if (in_video) {
+                break;
+            }
+            in_video = StartsWith(line, "m=video");
+            seen_video = seen_video || in_video;
+        } else if (in_video && StartsWith(line, "a=rid:")) {
+            // a=rid:<id> send [max-width=1280;max-height=720;...]
+            std::vector<std::string> fields = Split(line.substr(6), ' ');
+            if (fields.size() < 2 || fields[1] != "send") {
+                continue;
+            }
+            SimulcastLayer layer;
+            layer.rid = fields[0];
+            if (fields.size() > 2) {
+                for (const auto& param : Split(fields[2], ';')) {
+                    if (StartsWith(param, "max-width=")) {
+                        layer.max_width = std::atoi(param.c_str() + 10);
+                    } else if (StartsWith(param, "max-height=")) {
+                        layer.max_height = std::atoi(param.c_str() + 11);
+                    }
+                }
+            }
+            rids.push_back(layer);
+        } else if (in_video && StartsWith(line, "a=simulcast:send ")) {
+            for (const auto& group : Split(line.substr(17), ';')) {
+                std::vector<std::string> group_rids = GroupRids(group);
+                if (group_rids.empty()) {
+                    continue;
+                }
+                SimulcastLayer layer;
+                layer.rid = group_rids.front();
+                layers.push_back(layer);
+            }
+        }
+    }
+    for (auto& layer : layers) {
+        for (const auto& rid : rids) {
+            if (rid.rid == layer.rid) {
+                layer = rid;
+            }
+        }
+    }
+    return layers;
+}
+
+std::string PreferSimulcastLayer(const std::string& sdp, const std::string& rid) {
+    std::string out;
+    bool in_video = false;
+    for (const auto& line : SplitLines(sdp)) {
+        if (StartsWith(line, "m=")) {
+            in_video = StartsWith(line, "m=video");
+        }
+        if (in_video && StartsWith(line, "a=simulcast:send ")) {
+            std::vector<std::string> groups = Split(line.substr(17), ';');
+            for (size_t i = 1; i < groups.size(); ++i) {
+                std::vector<std::string> rids = GroupRids(groups[i]);
+                if (std::find(rids.begin(), rids.end(), rid) != rids.end()) {
+                    std::rotate(groups.begin(), groups.begin() + i, groups.begin() + i + 1);
+                    break;
+                }
+            }
+            std::string rewritten = "a=simulcast:send ";
+            for (size_t i = 0; i < groups.size(); ++i) {
+                rewritten += (i > 0 ? ";" : "") + groups[i];
+            }
+            out += rewritten + "\r\n";
+            continue;
+        }
+        out += line;
+        out += "\r\n";
+    }
+    return out;
+}
+
+bool GetVideoStreamHints(const std::string& offer, const std::string& answer, VideoStreamHints* hints) {
+    // Answer的m=行中第一个不是重传/冗余/前向纠错的载荷类型即为协商的编码
+    std::string m_line;
+    std::vector<std::string> answer_section = FirstVideoSection(answer, &m_line);
+    std::vector<std::string> fields = Split(m_line, ' ');
+    for (size_t i = 3; i < fields.size() && hints->codec.empty(); ++i) {
+        const int payload_type = std::atoi(fields[i].c_str());
+        for (const auto& line : answer_section) {
+            std::string rtpmap;
+            if (!GetPayloadAttribute(line, "rtpmap", payload_type, &rtpmap)) {
+                continue;
+            }
+            std::string codec = rtpmap.substr(0, rtpmap.find('/'));
+            std::transform(codec.begin(), codec.end(), codec.begin(), ::toupper);
+            if (codec == "RTX" || codec == "RED" || codec == "ULPFEC" || codec == "FLEXFEC-03") {
+                break;
+            }
+            if (codec != "H264" && codec != "H265") {
+                return false;
+            }
+            hints->codec = codec;
+            hints->payload_type = payload_type;
+            break;
+        }
+    }
+    if (hints->codec.empty()) {
+        return false;
+    }
+
+    for (const auto& line : FirstVideoSection(offer, nullptr)) {
+        std::string value;
+        if (GetPayloadAttribute(line, "fmtp", hints->payload_type, &value)) {
+            // H.264为sprop-parameter-sets=SPS,PPS；H.265为sprop-vps/sprop-sps/sprop-pps
+            for (const auto& param : Split(value, ';')) {
+                std::string key = param.substr(0, param.find('='));
+                key.erase(0, key.find_first_not_of(' '));
+                const std::string param_value = param.find('=') == std::string::npos ? "" : param.substr(param.find('=') + 1);
+                if (key == "profile-level-id") {
+                    hints->profile_level_id = param_value;
+                } else if (key == "sprop-parameter-sets" || key == "sprop-vps" || key == "sprop-sps" || key == "sprop-pps") {
+                    for (const auto& encoded : Split(param_value, ',')) {
+                        std::string nal = DecodeBase64(encoded);
+                        if (!nal.empty()) {
+                            hints->parameter_sets.push_back(nal);
+                        }
+                    }
+                }
+            }
+        } else if (hints->width == 0 && (GetPayloadAttribute(line, "imageattr", hints->payload_type, &value) ||
+                                         StartsWith(line, "a=imageattr:* "))) {
+            // a=imageattr:<pt> send [x=1280,y=720] recv ...：只取发送方向的第一个固定尺寸
+            if (value.empty()) {
+                value = line.substr(std::char_traits<char>::length("a=imageattr:* "));
+            }
+            size_t send = value.find("send");
+            if (send != std::string::npos) {
+                int x = 0;
+                int y = 0;
+                size_t x_pos = value.find("x=", send);
+                size_t y_pos = value.find("y=", send);
+                if (x_pos != std::string::npos && y_pos != std::string::npos) {
+                    x = std::atoi(value.c_str() + x_pos + 2);
+                    y = std::atoi(value.c_str() + y_pos + 2);
+                }
+                if (x > 0 && y > 0) {
+                    hints->width = x;
+                    hints->height = y;
+                    hints->size_source = "imageattr";
+                }
+            }
+        } else if (hints->width == 0 && GetPayloadAttribute(line, "framesize", hints->payload_type, &value)) {
+            // a=framesize:<pt> <宽>-<高>
+            size_t dash = value.find('-');
+            if (dash != std::string::npos && std::atoi(value.c_str()) > 0 && std::atoi(value.c_str() + dash + 1) > 0) {
+                hints->width = std::atoi(value.c_str());
+                hints->height = std::atoi(value.c_str() + dash + 1);
+                hints->size_source = "framesize";
+            }
+        }
+    }
+    if (hints->width == 0 && hints->codec == "H264") {
+        for (const auto& nal : hints->parameter_sets) {
+            if (ParseH264SpsSize(nal, &hints->width, &hints->height)) {
+                hints->size_source = "sps";
+                break;
+            }
+        }
+    }
+    if (hints->width == 0) {
+        // 联播时接收的是排在最前面的层，max-width/max-height是上限，作为最后的估计
+        std::vector<SimulcastLayer> layers = GetSimulcastLayers(offer);
+        if (!layers.empty() && layers.front().max_width > 0 && layers.front().max_height > 0) {
+            hints->width = layers.front().max_width;
+            hints->height = layers.front().max_height;
+            hints->size_source = "rid";
+        }
+    }
+    return true;
+}
+
+}  // namespace sdp_utils
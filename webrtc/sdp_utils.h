@@ -0,0 +1,79 @@
+#pragma once
+#include <string>
+#include <vector>
+
+/**
+ * @brief SDP文本处理
+ *
+ * 只做WebRTC允许的少量改写（带宽行、远端Offer的联播层顺序）和少量读取，不解析整份SDP。
+ */
+namespace sdp_utils {
+
+/**
+ * @brief 设置所有视频m段的带宽上限。
+ * 先删除已有的b=AS/b=TIAS行，kbps大于0时在c=行之后写入b=AS与b=TIAS；
+ * 远端按收到的描述中的带宽上限限制发送码率。
+ * @param sdp SDP文本
+ * @param kbps 上限（kbps），小于等于0表示取消上限
+ * @return 改写后的SDP
+ */
+std::string SetVideoBandwidth(const std::string& sdp, int kbps);
+
+/**
+ * @brief 读取第一个视频m段的b=AS值
+ * @param sdp SDP文本
+ * @return 上限（kbps），没有时返回0
+ */
+int GetVideoBandwidth(const std::string& sdp);
+
+/**
+ * @brief 发送端提供的一个联播（simulcast）层
+ */
+struct SimulcastLayer {
+    std::string rid;
+    int max_width = 0;   // a=rid中的max-width，未声明时为0
+    int max_height = 0;  // a=rid中的max-height，未声明时为0
+};
+
+/**
+ * @brief 读取第一个视频m段中a=simulcast:send声明的各层（按声明顺序）
+ * @param sdp 远端Offer
+ * @return 联播层，没有联播时为空
+ */
+std::vector<SimulcastLayer> GetSimulcastLayers(const std::string& sdp);
+
+/**
+ * @brief 把指定层移到a=simulcast:send的最前面。
+ * WebRTC作为接收端只接收联播的第一层，其余层在Answer中标记为暂停，发送端不再编码发送
+ * @param sdp 远端Offer
+ * @param rid 要接收的层
+ * @return 改写后的SDP
+ */
+std::string PreferSimulcastLayer(const std::string& sdp, const std::string& rid);
+
+/**
+ * @brief 协商结果中可用于预先配置解码器的视频流信息
+ */
+struct VideoStreamHints {
+    std::string codec;                        // "H264"或"H265"
+    int payload_type = -1;
+    std::string profile_level_id;             // H.264的profile-level-id，未声明时为空
+    std::vector<std::string> parameter_sets;  // sprop参数集NAL（已做base64解码，不含起始码）
+    int width = 0;                            // 尺寸未知时为0
+    int height = 0;
+    std::string size_source;                  // 尺寸来源：imageattr、framesize、sps或rid
+};
+
+/**
+ * @brief 读取第一个视频m段的协商编码和分辨率提示。
+ * 编码取本端Answer中的首选载荷类型；profile-level-id、sprop参数集、a=imageattr、
+ * a=framesize取自远端Offer中的同一载荷类型；都没有尺寸时从H.264的SPS中计算，
+ * 最后才用联播层的max-width/max-height
+ * @param offer 远端Offer
+ * @param answer 本端Answer
+ * @param hints 输出
+ * @return 协商的编码是H.264或H.265时返回true（尺寸可能仍未知）
+ */
+bool GetVideoStreamHints(const std::string& offer, const std::string& answer, VideoStreamHints* hints);
+
+}  // namespace sdp_utils
@@ -0,0 +1,41 @@
+#pragma once
+#include "api/jsep.h"
+#include "api/rtc_error.h"
+#include "api/scoped_refptr.h"
+#include "rtc_base/ref_counted_object.h"
+#include <functional>
+
+// SDP操作的回调适配：把WebRTC的观察者接口转换为std::function，
+// 供会话协商和本机回环测试共用
+class SetSessionDescriptionObserver : public webrtc::SetSessionDescriptionObserver {
+public:
+    static webrtc::scoped_refptr<SetSessionDescriptionObserver> Create(
+            std::function<void()> on_success,
+            std::function<void(webrtc::RTCError)> on_failure) {
+        return webrtc::make_ref_counted<SetSessionDescriptionObserver>(std::move(on_success), std::move(on_failure));
+    }
+    void OnSuccess() override { if (on_success_) on_success_(); }
+    void OnFailure(webrtc::RTCError error) override { if (on_failure_) on_failure_(std::move(error)); }
+protected:
+    SetSessionDescriptionObserver(std::function<void()> on_success, std::function<void(webrtc::RTCError)> on_failure)
+        : on_success_(std::move(on_success)), on_failure_(std::move(on_failure)) {}
+private:
+    std::function<void()> on_success_;
+    std::function<void(webrtc::RTCError)> on_failure_;
+};
+
+class CreateSessionDescriptionObserver : public webrtc::CreateSessionDescriptionObserver {
+public:
+    using SuccessCallback = std::function<void(webrtc::SessionDescriptionInterface*)>;
+    static webrtc::scoped_refptr<CreateSessionDescriptionObserver> Create(SuccessCallback on_success, std::function<void(webrtc::RTCError)> on_failure) {
+        return webrtc::make_ref_counted<CreateSessionDescriptionObserver>(std::move(on_success), std::move(on_failure));
+    }
+    void OnSuccess(webrtc::SessionDescriptionInterface* desc) override { if (on_success_) on_success_(desc); }
+    void OnFailure(webrtc::RTCError error) override { if (on_failure_) on_failure_(std::move(error)); }
+protected:
+    CreateSessionDescriptionObserver(SuccessCallback on_success, std::function<void(webrtc::RTCError)> on_failure)
+        : on_success_(std::move(on_success)), on_failure_(std::move(on_failure)) {}
+private:
+    SuccessCallback on_success_;
+    std::function<void(webrtc::RTCError)> on_failure_;
+};
@@ -0,0 +1,87 @@
+#include "udp_batch_receiver.h"
+#include <netinet/udp.h>
+#include <algorithm>
+#include <cstring>
+
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+namespace {
+
+// 每个数据报的接收缓冲区：启用GRO时一个合并包最大可达64KB
+constexpr size_t kDatagramSize = 2048;
+constexpr size_t kGroDatagramSize = 65536;
+constexpr size_t kControlSize = CMSG_SPACE(sizeof(int));
+
+}  // namespace
+
+bool UdpBatchReceiver::Configure(int fd, int batch_size, bool enable_gro) {
+    gro_enabled_ = false;
+    if (enable_gro) {
+        int on = 1;
+        gro_enabled_ = setsockopt(fd, IPPROTO_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+    }
+    slot_size_ = gro_enabled_ ? kGroDatagramSize : kDatagramSize;
+    size_t count = static_cast<size_t>(std::max(1, batch_size));
+    storage_.assign(count * slot_size_, 0);
+    addrs_.resize(count);
+    iovs_.resize(count);
+    msgs_.resize(count);
+    controls_.assign(count * kControlSize, 0);
+    packets_.clear();
+    packets_.reserve(count);
+    return gro_enabled_;
+}
+
+int UdpBatchReceiver::Receive(int fd) {
+    packets_.clear();
+    bytes_ = 0;
+    if (msgs_.empty()) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < msgs_.size(); ++i) {
+        iovs_[i].iov_base = &storage_[i * slot_size_];
+        iovs_[i].iov_len = slot_size_;
+        memset(&msgs_[i], 0, sizeof(msgs_[i]));
+        msgs_[i].msg_hdr.msg_name = &addrs_[i];
+        msgs_[i].msg_hdr.msg_namelen = sizeof(addrs_[i]);
+        msgs_[i].msg_hdr.msg_iov = &iovs_[i];
+        msgs_[i].msg_hdr.msg_iovlen = 1;
+        if (gro_enabled_) {
+            msgs_[i].msg_hdr.msg_control = &controls_[i * kControlSize];
+            msgs_[i].msg_hdr.msg_controllen = kControlSize;
+        }
+    }
+    int count = recvmmsg(fd, msgs_.data(), msgs_.size(), MSG_DONTWAIT, nullptr);
+    if (count <= 0) {
+        return -1;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const uint8_t* data = &storage_[i * slot_size_];
+        size_t length = msgs_[i].msg_len;
+        bytes_ += length;
+
+        // GRO合并包：按控制消息给出的段长拆回原始数据报，最后一段可以更短
+        size_t segment_size = length;
+        if (gro_enabled_) {
+            for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msgs_[i].msg_hdr); cmsg; cmsg = CMSG_NXTHDR(&msgs_[i].msg_hdr, cmsg)) {
+                if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+                    int gso_size = 0;
+                    memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+                    if (gso_size > 0) segment_size = static_cast<size_t>(gso_size);
+                }
+            }
+        }
+        if (length == 0) {
+            packets_.push_back({data, 0, &addrs_[i]});
+            continue;
+        }
+        for (size_t offset = 0; offset < length; offset += segment_size) {
+            packets_.push_back({data + offset, std::min(segment_size, length - offset), &addrs_[i]});
+        }
+    }
+    return count;
+}
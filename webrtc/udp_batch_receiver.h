@@ -0,0 +1,67 @@
+#pragma once
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 用recvmmsg批量接收UDP数据报，可选UDP GRO
+ *
+ * 一次Receive从内核队列取回最多batch_size个数据报；启用GRO时，内核把同一流的
+ * 等长包合并成一个超级包，这里按控制消息给出的段长拆回原始数据报。
+ * 缓冲区在Configure时一次分配，接收路径上不分配内存。不依赖WebRTC，
+ * 由BatchedUdpSocketServer的UDP套接字使用。
+ */
+class UdpBatchReceiver {
+public:
+    /**
+     * @brief 一个拆分后的数据报，指向内部缓冲区，在下一次Receive之前有效
+     */
+    struct Packet {
+        const uint8_t* data;
+        size_t size;
+        const sockaddr_storage* address;
+    };
+
+    /**
+     * @brief 为套接字分配接收缓冲区，按需启用UDP_GRO
+     * @param fd UDP套接字
+     * @param batch_size 每次recvmmsg最多取回的数据报数
+     * @param enable_gro 是否尝试启用UDP_GRO（Linux 5.0+）
+     * @return GRO是否已启用
+     */
+    bool Configure(int fd, int batch_size, bool enable_gro);
+
+    /**
+     * @brief 执行一次非阻塞的recvmmsg，替换上一批数据报
+     * @param fd UDP套接字
+     * @return 取回的数据报数（GRO合并包算一个），没有数据或出错时返回-1
+     */
+    int Receive(int fd);
+
+    /**
+     * @brief 最近一批拆分后的数据报
+     */
+    const std::vector<Packet>& packets() const { return packets_; }
+
+    /**
+     * @brief 最近一批的总字节数
+     */
+    uint64_t bytes() const { return bytes_; }
+
+    bool gro_enabled() const { return gro_enabled_; }
+
+private:
+    bool gro_enabled_ = false;
+    size_t slot_size_ = 0;
+
+    std::vector<uint8_t> storage_;
+    std::vector<sockaddr_storage> addrs_;
+    std::vector<iovec> iovs_;
+    std::vector<mmsghdr> msgs_;
+    std::vector<uint8_t> controls_;
+
+    std::vector<Packet> packets_;
+    uint64_t bytes_ = 0;
+};
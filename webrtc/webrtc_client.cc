@@ -1,47 +1,50 @@
 #include "webrtc_client.h"
 #include "../signaling/signaling_client_ws.h"
+#include "../signaling/signaling_client_ipc.h"
+#include "../common/thread_profile.h"
+#include "sdp_utils.h"
+#include "session_description_observers.h"
+#include "control_channel_benchmark.h"
 #include "api/create_peerconnection_factory.h"
+#ifdef WITH_RECEIVE_ONLY_ENGINE
+#include "receive_only_media_factories.h"
+#else
 #include "api/audio_codecs/builtin_audio_decoder_factory.h"
 #include "api/audio_codecs/builtin_audio_encoder_factory.h"
 #include "api/video_codecs/builtin_video_decoder_factory.h"
 #include "api/video_codecs/builtin_video_encoder_factory.h"
+#endif
+#include "api/units/time_delta.h"
+#include "api/environment/environment_factory.h"
+#include "p2p/client/basic_port_allocator.h"
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "rtc_base/network.h"
+#include "rtc_base/network_constants.h"
 #include "rtc_base/ref_counted_object.h"
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <fstream>
 
-// 辅助的 Observer 类 (和之前保持一致，是正确的)
-class SetSessionDescriptionObserver : public webrtc::SetSessionDescriptionObserver {
-public:
-    static webrtc::scoped_refptr<SetSessionDescriptionObserver> Create(
-            std::function<void()> on_success,
-            std::function<void(webrtc::RTCError)> on_failure) {
-        return webrtc::make_ref_counted<SetSessionDescriptionObserver>(std::move(on_success), std::move(on_failure));
-    }
-    void OnSuccess() override { if (on_success_) on_success_(); }
-    void OnFailure(webrtc::RTCError error) override { if (on_failure_) on_failure_(std::move(error)); }
-protected:
-    SetSessionDescriptionObserver(std::function<void()> on_success, std::function<void(webrtc::RTCError)> on_failure)
-        : on_success_(std::move(on_success)), on_failure_(std::move(on_failure)) {}
-private:
-    std::function<void()> on_success_;
-    std::function<void(webrtc::RTCError)> on_failure_;
-};
-
-class CreateSessionDescriptionObserver : public webrtc::CreateSessionDescriptionObserver {
-public:
-    using SuccessCallback = std::function<void(webrtc::SessionDescriptionInterface*)>;
-    static webrtc::scoped_refptr<CreateSessionDescriptionObserver> Create(SuccessCallback on_success, std::function<void(webrtc::RTCError)> on_failure) {
-        return webrtc::make_ref_counted<CreateSessionDescriptionObserver>(std::move(on_success), std::move(on_failure));
-    }
-    void OnSuccess(webrtc::SessionDescriptionInterface* desc) override { if (on_success_) on_success_(desc); }
-    void OnFailure(webrtc::RTCError error) override { if (on_failure_) on_failure_(std::move(error)); }
-protected:
-    CreateSessionDescriptionObserver(SuccessCallback on_success, std::function<void(webrtc::RTCError)> on_failure)
-        : on_success_(std::move(on_success)), on_failure_(std::move(on_failure)) {}
-private:
-    SuccessCallback on_success_;
-    std::function<void(webrtc::RTCError)> on_failure_;
-};
+// 把视频带宽上限写入本地描述，kbps为0时原样返回。接管desc的所有权
+static webrtc::SessionDescriptionInterface* WithVideoBandwidth(webrtc::SessionDescriptionInterface* desc, int kbps) {
+    if (kbps <= 0) {
+        return desc;
+    }
+    std::unique_ptr<webrtc::SessionDescriptionInterface> original(desc);
+    std::string sdp;
+    original->ToString(&sdp);
+    webrtc::SdpParseError error;
+    std::unique_ptr<webrtc::SessionDescriptionInterface> munged =
+        webrtc::CreateSessionDescription(original->GetType(), sdp_utils::SetVideoBandwidth(sdp, kbps), &error);
+    if (!munged) {
+        std::cerr << "Failed to apply bandwidth limit to SDP: " << error.description << std::endl;
+        return original.release();
+    }
+    return munged.release();
+}
 
 
 WebRTCClient::WebRTCClient() : is_initialized_(false), is_connected_to_signaling_(false) {}
@@ -56,16 +59,93 @@ void WebRTCClient::SetMediaHandlers(std::shared_ptr<EncodedVideoFrameHandler> vi
 }
 
 bool WebRTCClient::Initialize() {
+    bool ok = InitializeEngine();
+    // 唤醒在信令分发线程上等待的消息处理（成功或失败都要唤醒）
+    {
+        std::lock_guard<std::mutex> lock(init_mutex_);
+        init_finished_ = true;
+    }
+    init_cv_.notify_all();
+    return ok;
+}
+
+bool WebRTCClient::WaitForInitialization() {
+    std::unique_lock<std::mutex> lock(init_mutex_);
+    init_cv_.wait(lock, [this]() { return init_finished_ && media_ready_; });
+    return is_initialized_;
+}
+
+void WebRTCClient::DeferSignalingUntilMediaReady() {
+    std::lock_guard<std::mutex> lock(init_mutex_);
+    media_ready_ = false;
+}
+
+void WebRTCClient::SetMediaReady() {
+    {
+        std::lock_guard<std::mutex> lock(init_mutex_);
+        media_ready_ = true;
+    }
+    init_cv_.notify_all();
+}
+
+bool WebRTCClient::InitializeEngine() {
     if (is_initialized_) return true;
+    const auto init_start = std::chrono::steady_clock::now();
 
-    network_thread_ = webrtc::Thread::CreateWithSocketServer();
+    if (batched_udp_enabled_) {
+        auto socket_server = std::make_unique<BatchedUdpSocketServer>(batched_udp_options_);
+        batched_socket_server_ = socket_server.get();
+        network_thread_ = std::make_unique<webrtc::Thread>(std::move(socket_server));
+        std::cout << "[INFO] Network thread uses batched UDP receive (batch " << batched_udp_options_.batch_size
+                  << (batched_udp_options_.enable_gro ? ", GRO" : "") << ", rcvbuf "
+                  << batched_udp_options_.receive_buffer_bytes << ")" << std::endl;
+    } else {
+        network_thread_ = webrtc::Thread::CreateWithSocketServer();
+    }
     worker_thread_ = webrtc::Thread::Create();
     signaling_thread_ = webrtc::Thread::Create();
+    network_thread_->SetName("rtc-network", nullptr);
+    worker_thread_->SetName("rtc-worker", nullptr);
+    signaling_thread_->SetName("rtc-signaling", nullptr);
     if (!network_thread_->Start() || !worker_thread_->Start() || !signaling_thread_->Start()) {
         std::cerr << "Failed to start threads" << std::endl;
         return false;
     }
+    // 在各线程自身上应用绑核与调度配置
+    network_thread_->BlockingCall([]() {
+        ThreadProfile::Instance().RegisterCurrentThread(ThreadProfile::Role::kNetwork, "rtc-network");
+    });
+    worker_thread_->BlockingCall([]() {
+        ThreadProfile::Instance().RegisterCurrentThread(ThreadProfile::Role::kWorker, "rtc-worker");
+    });
+    signaling_thread_->BlockingCall([]() {
+        ThreadProfile::Instance().RegisterCurrentThread(ThreadProfile::Role::kSignaling, "rtc-signaling");
+    });
 
+    // 事件日志写入器：会话开始记录前就要能接收输出
+    if (event_log_enabled_) {
+        event_log_writer_ = std::make_unique<RtcEventLogWriter>();
+        if (!event_log_writer_->Start(event_log_config_)) {
+            std::cerr << "[WARN] RTC event log disabled" << std::endl;
+            event_log_writer_.reset();
+        }
+    }
+
+    // 工厂自带RtcEventLogFactory，各PeerConnection的StartRtcEventLog由它创建实际的事件日志
+    const auto factory_start = std::chrono::steady_clock::now();
+#ifdef WITH_RECEIVE_ONLY_ENGINE
+    // 只接收：不需要任何编码器，视频由VDEC解码，只声明H.264/H.265和Opus
+    const char* engine_name = "receive-only (H.264/H.265 passthrough, Opus)";
+    peer_connection_factory_ = webrtc::CreatePeerConnectionFactory(
+        network_thread_.get(), worker_thread_.get(), signaling_thread_.get(),
+        nullptr,
+        CreateReceiveOnlyAudioEncoderFactory(),
+        CreateReceiveOnlyAudioDecoderFactory(),
+        nullptr,
+        CreateReceiveOnlyVideoDecoderFactory(),
+        nullptr, nullptr);
+#else
+    const char* engine_name = "builtin codecs";
     peer_connection_factory_ = webrtc::CreatePeerConnectionFactory(
         network_thread_.get(), worker_thread_.get(), signaling_thread_.get(),
         nullptr,
@@ -74,191 +154,877 @@ bool WebRTCClient::Initialize() {
         webrtc::CreateBuiltinVideoEncoderFactory(),
         webrtc::CreateBuiltinVideoDecoderFactory(),
         nullptr, nullptr);
+#endif
+    const int64_t factory_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - factory_start).count();
 
     if (!peer_connection_factory_) {
         std::cerr << "Failed to create PeerConnectionFactory" << std::endl;
         return false;
     }
 
-    if (!CreatePeerConnection()) {
-        return false;
+    // 网卡类型过滤：WebRTC默认忽略回环网卡；LAN档位再忽略VPN和蜂窝网络
+    webrtc::PeerConnectionFactoryInterface::Options options;
+    if (ice_config_.AllowsLoopback()) {
+        options.network_ignore_mask &= ~webrtc::ADAPTER_TYPE_LOOPBACK;
+    }
+    if (ice_config_.profile == IceConfig::Profile::kLan) {
+        options.network_ignore_mask |= webrtc::ADAPTER_TYPE_VPN | webrtc::ADAPTER_TYPE_CELLULAR;
     }
+    peer_connection_factory_->SetOptions(options);
 
-    signaling_client_ = std::make_unique<WebSocketSignalingClient>();
-    
-    // [FIX] 使用正确的信令回调接口
-    signaling_client_->SetStateCallback([this](bool connected, const std::string& message) {
-        if (connected) {
-            is_connected_to_signaling_ = true;
-            NotifyStateChange("signaling_connected", message);
-        } else {
-            is_connected_to_signaling_ = false;
-            NotifyStateChange("signaling_disconnected", message);
-        }
-    });
-    
-    signaling_client_->SetMessageCallback([this](SignalingClient::MessageType type, const std::string& message) {
-        this->HandleSignalingMessage(type, message);
-    });
+    // 网卡白名单：不在白名单中的网卡不参与候选者收集，每次网络变化后都重新过滤
+    if (!ice_config_.interfaces.empty()) {
+        network_thread_->BlockingCall([this]() {
+            network_manager_ = std::make_unique<InterfaceAllowListNetworkManager>(
+                webrtc::CreateEnvironment(), network_thread_->socketserver(), ice_config_.interfaces);
+            socket_factory_ = std::make_unique<webrtc::BasicPacketSocketFactory>(network_thread_->socketserver());
+        });
+        std::cout << "[INFO] ICE restricted to " << ice_config_.interfaces.size() << " interface(s)" << std::endl;
+    }
+    std::cout << "[INFO] ICE profile: " << ice_config_.ProfileName() << std::endl;
+
+    // 启动开销：与关闭RK_RECEIVE_ONLY_ENGINE的构建对比可执行文件大小、初始化耗时和内存
+    struct stat exe_stat = {};
+    PeerSession::ProcessUsage usage;
+    PeerSession::ReadProcessUsage(&usage);
+    std::cout << "[Timing] Media engine " << engine_name << ": binary "
+              << (stat("/proc/self/exe", &exe_stat) == 0 ? exe_stat.st_size / 1024 : 0) << " kB, factory created in "
+              << factory_ms << " ms, client initialized in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - init_start).count()
+              << " ms, process RSS " << usage.rss_kb << " kB, threads " << usage.threads << std::endl;
 
+    // PeerConnection不再在这里创建：每个远端对端的Offer到达时按需创建各自的会话。
+    // 开启预热时先备好一个连接，让候选者收集（含STUN查询）不再占用Offer之后的时间
     is_initialized_ = true;
+    if (ice_candidate_pool_size_ > 0) {
+        signaling_thread_->PostTask([this]() {
+            PrewarmSpareConnection();
+            ScheduleSpareRefresh();
+        });
+    }
+    if ((bitrate_control_enabled_ && !static_session_mode_) || layer_selection_enabled_ || event_log_writer_) {
+        ScheduleMediaControl();
+    }
     std::cout << "WebRTCClient initialized successfully" << std::endl;
     return true;
 }
 
-bool WebRTCClient::CreatePeerConnection() {
+webrtc::PeerConnectionInterface::RTCConfiguration WebRTCClient::BuildRtcConfiguration() const {
     webrtc::PeerConnectionInterface::RTCConfiguration config;
     config.sdp_semantics = webrtc::SdpSemantics::kUnifiedPlan;
-    webrtc::PeerConnectionInterface::IceServer ice_server;
-    ice_server.uri = "stun:stun.l.google.com:19302";
-    config.servers.push_back(ice_server);
+    // 候选者池：PeerConnection创建后立即开始收集，设置本地描述时直接使用
+    config.ice_candidate_pool_size = ice_candidate_pool_size_;
+    EffectiveIceConfig().Apply(&config);
+    return config;
+}
 
-    pc_observer_ = std::make_unique<PeerConnectionObserverImpl>(this);
-    if(video_handler_ && audio_handler_){
-        pc_observer_->SetMediaHandlers(video_handler_, audio_handler_);
+IceConfig WebRTCClient::EffectiveIceConfig() const {
+    IceConfig ice = ice_config_;
+    if (static_session_mode_) {
+        // 点对点固定链路：只用主机候选者，不查询STUN，也不收集TCP候选者，
+        // 这样ICE收集几乎瞬间完成，Answer可以一次性携带全部候选者
+        ice.host_only = true;
+        ice.udp_only = true;
     }
+    return ice;
+}
+
+std::unique_ptr<webrtc::PortAllocator> WebRTCClient::CreatePortAllocator() const {
+    if (!network_manager_) {
+        return nullptr;
+    }
+    // PeerConnection只对工厂创建的分配器应用port_allocator_config，自带的分配器需自行设置
+    auto allocator = std::make_unique<webrtc::BasicPortAllocator>(
+        webrtc::CreateEnvironment(), network_manager_.get(), socket_factory_.get());
+    allocator->set_flags(EffectiveIceConfig().PortAllocatorFlags());
+    return allocator;
+}
 
-    // peer_connection_ = peer_connection_factory_->CreatePeerConnectionOrError(config, nullptr, nullptr, pc_observer_.get());
+std::string WebRTCClient::MakeSessionKey(const std::string& room_id, const std::string& remote_id) {
+    return room_id + "/" + remote_id;
+}
 
-    // if (!peer_connection_) {
-    //     std::cerr << "Failed to create PeerConnection" << std::endl;
-    //     return false;
-    // }
-    // return true;
+std::string WebRTCClient::GetMessageRoom(const Json::Value& message_json) const {
+    if (message_json.isMember("roomId") && message_json["roomId"].isString()) {
+        return message_json["roomId"].asString();
+    }
+    return signaling_client_ ? signaling_client_->GetRoomId() : std::string();
+}
 
-    // [修改] 调用 CreatePeerConnectionOrError
-    webrtc::PeerConnectionDependencies pc_deps(pc_observer_.get());
-    auto result = peer_connection_factory_->CreatePeerConnectionOrError(config, std::move(pc_deps));
-    
-    if (!result.ok()) {
-        std::cerr << "Failed to create PeerConnection: " << result.error().message() << std::endl;
-        peer_connection_ = nullptr;
-        return false;
+void WebRTCClient::PrewarmSpareConnection() {
+    if (!is_initialized_) {
+        return;
+    }
+    auto connection = std::make_unique<PrewarmedConnection>();
+    if (!PeerSession::Prewarm(this, peer_connection_factory_.get(), BuildRtcConfiguration(),
+                              CreatePortAllocator(), connection.get())) {
+        return;
+    }
+    std::unique_ptr<PrewarmedConnection> stale;
+    {
+        std::lock_guard<std::mutex> lock(spare_mutex_);
+        stale = std::move(spare_connection_);
+        spare_connection_ = std::move(connection);
+    }
+    if (stale && stale->peer_connection) {
+        stale->peer_connection->Close();
+    }
+}
+
+void WebRTCClient::ScheduleSpareRefresh() {
+    if (prewarm_refresh_s_ <= 0) {
+        return;
+    }
+    signaling_thread_->PostDelayedTask([this]() {
+        if (!is_initialized_) {
+            return;
+        }
+        PrewarmSpareConnection();
+        ScheduleSpareRefresh();
+    }, webrtc::TimeDelta::Seconds(prewarm_refresh_s_));
+}
+
+std::unique_ptr<PrewarmedConnection> WebRTCClient::TakeSpareConnection() {
+    std::unique_ptr<PrewarmedConnection> connection;
+    {
+        std::lock_guard<std::mutex> lock(spare_mutex_);
+        connection = std::move(spare_connection_);
+    }
+    if (connection) {
+        // 立即补充一个，供下一个发送端使用
+        signaling_thread_->PostTask([this]() { PrewarmSpareConnection(); });
+    }
+    return connection;
+}
+
+std::shared_ptr<PeerSession> WebRTCClient::FindSession(const std::string& room_id, const std::string& remote_id) const {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    auto it = sessions_.find(MakeSessionKey(room_id, remote_id));
+    return it == sessions_.end() ? nullptr : it->second;
+}
+
+std::shared_ptr<PeerSession> WebRTCClient::GetOrCreateSession(const std::string& room_id, const std::string& remote_id) {
+    const std::string key = MakeSessionKey(room_id, remote_id);
+    std::shared_ptr<PeerSession> session;
+    PeerSession::ProcessUsage before;
+    PeerSession::ReadProcessUsage(&before);
+    size_t active = 0;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        auto it = sessions_.find(key);
+        if (it != sessions_.end()) {
+            return it->second; // 已有会话：重新协商或ICE重启
+        }
+
+        // 分配最小的空闲槽位；槽位0使用主媒体处理器，其余槽位需要处理器工厂
+        std::vector<bool> used(max_sessions_, false);
+        int room_sessions = 0;
+        for (const auto& entry : sessions_) {
+            if (entry.second->slot() < max_sessions_) used[entry.second->slot()] = true;
+            if (entry.second->room_id() == room_id) room_sessions++;
+        }
+        if (max_sessions_per_room_ > 0 && room_sessions >= max_sessions_per_room_) {
+            std::cerr << "[WARN] Rejecting offer from " << remote_id << ": room " << room_id << " already has "
+                      << room_sessions << " sessions (limit " << max_sessions_per_room_ << ")" << std::endl;
+            return nullptr;
+        }
+        int slot = -1;
+        for (int i = 0; i < max_sessions_; ++i) {
+            if (!used[i] && (i == 0 || video_handler_factory_)) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0) {
+            std::cerr << "[WARN] Rejecting offer from " << remote_id << ": all " << sessions_.size()
+                      << " session slots are in use" << std::endl;
+            return nullptr;
+        }
+
+        if (slot == 0) {
+            session = std::make_shared<PeerSession>(this, room_id, remote_id, slot, video_handler_, audio_handler_);
+        } else {
+            // 额外槽位的处理器在第一次使用时创建，之后的会话复用其VDEC/VO通道
+            auto& video_handler = slot_video_handlers_[slot];
+            if (!video_handler) {
+                video_handler = video_handler_factory_(slot);
+                if (!video_handler) {
+                    slot_video_handlers_.erase(slot);
+                    std::cerr << "Failed to create video handler for session slot " << slot << std::endl;
+                    return nullptr;
+                }
+            }
+            session = std::make_shared<PeerSession>(this, room_id, remote_id, slot, video_handler, nullptr);
+        }
+        session->SetBitrateControlConfig(bitrate_control_config_);
+        for (const auto& entry : control_handlers_) {
+            session->control_channel()->SetHandler(entry.first, entry.second);
+        }
+        // 先占住槽位再在锁外创建PeerConnection：创建过程会同步等待信令线程，
+        // 而该线程上的观察者回调同样需要访问会话表
+        sessions_[key] = session;
+        active = sessions_.size();
+    }
+
+    const auto open_start = std::chrono::steady_clock::now();
+    std::unique_ptr<PrewarmedConnection> spare = TakeSpareConnection();
+    bool opened = spare ? session->Open(spare.get())
+                        : session->Open(peer_connection_factory_.get(), BuildRtcConfiguration(), CreatePortAllocator());
+    const int64_t open_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - open_start).count();
+    if (!opened) {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        sessions_.erase(key);
+        return nullptr;
+    }
+
+    session->ApplyLatencyProfile(GetLatencyProfile());
+    if (event_log_writer_ && event_logging_) {
+        signaling_thread_->PostTask([this, session]() {
+            if (event_logging_ && session->StartEventLog(event_log_writer_.get())) {
+                std::cout << "[INFO] RTC event log started for " << session->room_id() << "/"
+                          << session->remote_id() << std::endl;
+            }
+        });
+    }
+
+    PeerSession::ProcessUsage after;
+    PeerSession::ReadProcessUsage(&after);
+    std::cout << "[INFO] Session " << key << " opened in slot " << session->slot()
+              << (session->prewarmed() ? " with prewarmed connection" : "") << " in " << open_ms << " ms (" << active
+              << " active), process RSS " << after.rss_kb << " kB (+" << after.rss_kb - before.rss_kb
+              << "), threads " << after.threads << " (+" << after.threads - before.threads << ")" << std::endl;
+    NotifyStateChange("session_opened", key);
+    return session;
+}
+
+void WebRTCClient::CloseSession(const std::string& room_id, const std::string& remote_id, const std::string& reason) {
+    // 会话的拆除统一在信令线程执行，与协商、码率重协商和事件日志的回调互不交错；
+    // 调用方等待关闭完成，之后槽位和解码通道即可用于下一个会话
+    if (signaling_thread_ && !signaling_thread_->IsCurrent() && FindSession(room_id, remote_id)) {
+        signaling_thread_->BlockingCall([this, &room_id, &remote_id, &reason]() { CloseSession(room_id, remote_id, reason); });
+        return;
+    }
+    const std::string key = MakeSessionKey(room_id, remote_id);
+    std::shared_ptr<PeerSession> session;
+    size_t remaining = 0;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        auto it = sessions_.find(key);
+        if (it == sessions_.end()) {
+            return;
+        }
+        session = std::move(it->second);
+        sessions_.erase(it);
+        remaining = sessions_.size();
+    }
+
+    // 在锁外关闭：PeerConnection::Close会同步等待信令线程，而观察者回调也会访问会话表
+    PeerSession::Usage usage = session->GetUsage();
+    ControlChannel::Stats control = session->control_channel()->GetStats();
+    PeerSession::ProcessUsage before;
+    PeerSession::ReadProcessUsage(&before);
+    const auto close_start = std::chrono::steady_clock::now();
+    session->Close();
+    session.reset();
+    const int64_t close_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - close_start).count();
+    PeerSession::ProcessUsage after;
+    PeerSession::ReadProcessUsage(&after);
+
+    std::cout << "[INFO] Session " << key << " closed (" << reason << ") in " << close_ms << " ms after "
+              << usage.age_ms / 1000 << " s: slot " << usage.slot << ", VDEC chn " << usage.vdec_chn << (usage.has_audio ? ", audio" : "")
+              << ", " << usage.video_frames << " frames/" << usage.video_bytes << " bytes decoded"
+              << (usage.bitrate_cap_kbps > 0 ? ", capped at " + std::to_string(usage.bitrate_cap_kbps) + " kbps" : "")
+              << ", control " << control.rx_messages << " rx/" << control.tx_messages << " tx"
+              << (usage.latency_samples > 0 ? ", e2e latency avg " + std::to_string(usage.latency_avg_us / 1000) +
+                                                  " ms/max " + std::to_string(usage.latency_max_us / 1000) + " ms"
+                                            : "")
+              << "; "
+              << remaining << " remaining, process RSS " << after.rss_kb << " kB ("
+              << after.rss_kb - before.rss_kb << "), threads " << after.threads << std::endl;
+    // PeerConnection已关闭，不会再产生候选者；丢弃还在发送队列里等待SDP的那些
+    if (signaling_client_) {
+        signaling_client_->ForgetPeer(remote_id, room_id);
+    }
+    NotifyStateChange("session_closed", key);
+}
+
+std::vector<PeerSession::Usage> WebRTCClient::GetSessionUsage() const {
+    std::vector<PeerSession::Usage> usage;
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    for (const auto& entry : sessions_) {
+        usage.push_back(entry.second->GetUsage());
+    }
+    return usage;
+}
+
+void WebRTCClient::SetLatencyProfile(const LatencyProfile& profile) {
+    {
+        std::lock_guard<std::mutex> lock(latency_mutex_);
+        latency_profile_ = profile;
+    }
+    // 新会话在打开时应用档位；已有会话的接收器设置经由代理同步到信令线程执行，不能持有会话表锁
+    std::vector<std::shared_ptr<PeerSession>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (const auto& entry : sessions_) {
+            sessions.push_back(entry.second);
+        }
+    }
+    for (const auto& session : sessions) {
+        session->ApplyLatencyProfile(profile);
+    }
+    std::cout << "[INFO] Latency profile " << profile.Name() << ": jitter buffer min "
+              << profile.jitter_buffer_min_delay_ms << " ms, audio target " << profile.audio_target_delay_ms
+              << " ms / " << profile.audio_max_buffer_frames << " frames, VDEC buffers "
+              << profile.video_decoder_buffers << " (" << sessions.size() << " sessions)" << std::endl;
+    NotifyStateChange("latency_profile", profile.Name());
+}
+
+LatencyProfile WebRTCClient::GetLatencyProfile() const {
+    std::lock_guard<std::mutex> lock(latency_mutex_);
+    return latency_profile_;
+}
+
+void WebRTCClient::LogLatencyReport() const {
+    const std::string profile_name = GetLatencyProfile().Name();
+    std::vector<std::shared_ptr<PeerSession>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (const auto& entry : sessions_) {
+            sessions.push_back(entry.second);
+        }
+    }
+    for (const auto& session : sessions) {
+        session->LogLatencyStats(profile_name);
     }
-    peer_connection_ = result.MoveValue();
-    return peer_connection_ != nullptr;
 }
 
 void WebRTCClient::ConnectToSignalingServer(const std::string& url, const std::string& room_id, const std::string& client_id) {
-    if (!is_initialized_) return;
+    // 可以在Initialize之前或与之并发调用：连接与注册不依赖PeerConnectionFactory，
+    // 工厂就绪之前到达的消息在分发线程上等待（见HandleSignalingMessage）
+    // 信令客户端按需创建，静态会话模式下完全不会用到
+    if (!signaling_client_) {
+        // unix:地址表示同板上的控制程序，直接走本地套接字，不经过信令服务器
+        if (UnixSocketSignalingClient::IsUnixSocketUrl(url)) {
+            signaling_client_ = std::make_unique<UnixSocketSignalingClient>();
+        } else {
+            auto ws_client = std::make_unique<WebSocketSignalingClient>();
+            ws_client->SetKeepalive(keepalive_interval_ms_, keepalive_timeout_ms_);
+            signaling_client_ = std::move(ws_client);
+        }
+
+        // [FIX] 使用正确的信令回调接口
+        signaling_client_->SetStateCallback([this](bool connected, const std::string& message) {
+            if (connected) {
+                is_connected_to_signaling_ = true;
+                NotifyStateChange("signaling_connected", message);
+            } else {
+                is_connected_to_signaling_ = false;
+                NotifyStateChange("signaling_disconnected", message);
+            }
+        });
+
+        signaling_client_->SetMessageCallback([this](SignalingClient::MessageType type, const Json::Value& message) {
+            this->HandleSignalingMessage(type, message);
+        });
+    }
     signaling_client_->Connect(url);
     // 等待连接成功后自动注册
     signaling_client_->Register(room_id, client_id);
 }
 
+bool WebRTCClient::JoinRoom(const std::string& room_id) {
+    if (!signaling_client_) {
+        std::cerr << "Cannot join room " << room_id << ": not connected to signaling" << std::endl;
+        return false;
+    }
+    // 新房间复用已有的信令连接和PeerConnectionFactory，只在收到Offer时才创建会话
+    if (!signaling_client_->JoinRoom(room_id)) {
+        return false;
+    }
+    NotifyStateChange("room_joined", room_id);
+    return true;
+}
+
+bool WebRTCClient::LeaveRoom(const std::string& room_id) {
+    if (!signaling_client_) {
+        return false;
+    }
+    std::vector<std::string> remote_ids;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (const auto& entry : sessions_) {
+            if (entry.second->room_id() == room_id) {
+                remote_ids.push_back(entry.second->remote_id());
+            }
+        }
+    }
+    for (const auto& remote_id : remote_ids) {
+        CloseSession(room_id, remote_id, "left room");
+    }
+    if (!signaling_client_->LeaveRoom(room_id)) {
+        return false;
+    }
+    NotifyStateChange("room_left", room_id);
+    return true;
+}
+
 // [FIX] 将消息处理逻辑与信令回调对接
-void WebRTCClient::HandleSignalingMessage(SignalingClient::MessageType type, const std::string& message) {
-    // [FIX] 使用现代的JSON库API
-    Json::CharReaderBuilder builder;
-    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
-    Json::Value root;
-    std::string errors;
+void WebRTCClient::OnDataChannel(const std::string& room_id, const std::string& remote_id,
+                                 webrtc::scoped_refptr<webrtc::DataChannelInterface> channel) {
+    auto session = FindSession(room_id, remote_id);
+    if (!session) {
+        std::cerr << "[WARN] Data channel " << channel->label() << " from " << remote_id << ": no session" << std::endl;
+        return;
+    }
+    if (session->control_channel()->Attach(channel)) {
+        std::cout << "[INFO] Control channel '" << channel->label() << "' attached for "
+                  << MakeSessionKey(room_id, remote_id) << std::endl;
+    }
+}
+
+bool WebRTCClient::SendControl(const std::string& room_id, const std::string& remote_id, uint8_t type,
+                               const void* data, size_t size, ControlChannel::Mode mode) {
+    auto session = FindSession(room_id, remote_id);
+    return session && session->control_channel()->Send(type, data, size, mode);
+}
+
+bool WebRTCClient::RunControlChannelBenchmark(int count) {
+    if (!is_initialized_) {
+        return false;
+    }
+    ControlChannelBenchmark benchmark(peer_connection_factory_.get());
+    bool ok = true;
+    for (ControlChannel::Mode mode : {ControlChannel::Mode::kReliable, ControlChannel::Mode::kUnreliable}) {
+        ControlChannelBenchmark::Result result;
+        const char* name = mode == ControlChannel::Mode::kReliable ? "reliable" : "unreliable";
+        if (!benchmark.Run(count, mode, &result)) {
+            std::cerr << "[WARN] Control channel benchmark (" << name << ") failed" << std::endl;
+            ok = false;
+            continue;
+        }
+        std::cout << "[INFO] Control channel RTT (" << name << ", loopback): " << result.received << "/" << result.sent
+                  << " pongs, min " << result.min_us << " us, p50 " << result.p50_us << " us, p99 " << result.p99_us
+                  << " us, max " << result.max_us << " us; setup " << static_cast<int>(result.setup_ms) << " ms"
+                  << std::endl;
+    }
+    return ok;
+}
+
+void WebRTCClient::ScheduleMediaControl() {
+    signaling_thread_->PostDelayedTask([this]() {
+        if (!is_initialized_) {
+            return;
+        }
+        if (bitrate_control_enabled_ && !static_session_mode_) {
+            RunBitrateControl();
+        }
+        if (layer_selection_enabled_) {
+            RunLayerSelection();
+        }
+        if (event_log_writer_) {
+            RunEventLogMaintenance();
+        }
+        ScheduleMediaControl();
+    }, webrtc::TimeDelta::Seconds(1));
+}
+
+bool WebRTCClient::SetSessionEventLogging(const std::string& room_id, const std::string& remote_id, bool enabled) {
+    std::shared_ptr<PeerSession> session = FindSession(room_id, remote_id);
+    if (!session || !event_log_writer_) {
+        return false;
+    }
+    // 开始、停止与轮转都在信令线程执行，互不交错
+    return signaling_thread_->BlockingCall([this, &session, enabled]() {
+        if (!enabled) {
+            session->StopEventLog();
+            return true;
+        }
+        return session->event_log_active() || session->StartEventLog(event_log_writer_.get());
+    });
+}
 
-    if (!reader->parse(message.c_str(), message.c_str() + message.length(), &root, &errors)) {
-        std::cerr << "Failed to parse signaling message: " << errors << std::endl;
+void WebRTCClient::SetEventLogging(bool enabled) {
+    if (!event_log_writer_) {
+        std::cerr << "[WARN] RTC event log is not enabled (--event-log)" << std::endl;
         return;
     }
+    event_logging_ = enabled;
+    std::vector<std::shared_ptr<PeerSession>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (const auto& entry : sessions_) {
+            sessions.push_back(entry.second);
+        }
+    }
+    int changed = 0;
+    for (const auto& session : sessions) {
+        if (SetSessionEventLogging(session->room_id(), session->remote_id(), enabled)) {
+            changed++;
+        }
+    }
+    std::cout << "[INFO] RTC event log " << (enabled ? "started" : "stopped") << " for " << changed << "/"
+              << sessions.size() << " sessions" << std::endl;
+    NotifyStateChange("event_log", enabled ? "on" : "off");
+}
 
+void WebRTCClient::RunEventLogMaintenance() {
+    std::vector<std::shared_ptr<PeerSession>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (const auto& entry : sessions_) {
+            sessions.push_back(entry.second);
+        }
+    }
+    int active = 0;
+    for (const auto& session : sessions) {
+        if (session->event_log_full() && session->StartEventLog(event_log_writer_.get())) {
+            std::cout << "[INFO] RTC event log rotated for " << session->room_id() << "/" << session->remote_id()
+                      << std::endl;
+        }
+        if (session->event_log_active()) {
+            active++;
+        }
+    }
+
+    // 每30秒输出一次写入量与开销；进程CPU在开关日志前后对比即可得到编码的开销
+    if (++event_log_report_ticks_ < 30) {
+        return;
+    }
+    const int interval_s = event_log_report_ticks_;
+    event_log_report_ticks_ = 0;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    const int64_t process_cpu_us = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL +
+                                   usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+    RtcEventLogWriter::Stats stats = event_log_writer_->GetStats();
+    const uint64_t written = stats.written_bytes - last_event_log_stats_.written_bytes;
+    const uint64_t dropped = stats.dropped_bytes - last_event_log_stats_.dropped_bytes;
+    const int64_t writer_cpu_us = stats.writer_cpu_us - last_event_log_stats_.writer_cpu_us;
+    const int64_t total_cpu_us = process_cpu_us - last_event_log_process_cpu_us_;
+    const bool first_report = last_event_log_process_cpu_us_ == 0;
+    last_event_log_stats_ = stats;
+    last_event_log_process_cpu_us_ = process_cpu_us;
+    if (first_report || (active == 0 && written == 0 && dropped == 0)) {
+        return;
+    }
+    std::cout << "[INFO] RTC event log: " << active << " sessions, " << written / 1024 << " KB written ("
+              << written / 1024 / interval_s << " KB/s), " << dropped / 1024 << " KB dropped, queue "
+              << stats.pending_bytes / 1024 << " KB, writer CPU " << writer_cpu_us / 1000 << " ms ("
+              << writer_cpu_us / (interval_s * 10000.0) << "%), process CPU "
+              << total_cpu_us / (interval_s * 10000.0) << "%, " << stats.files_opened << " files opened, "
+              << stats.files_deleted << " deleted" << std::endl;
+}
+
+void WebRTCClient::RunBitrateControl() {
+    std::vector<std::shared_ptr<PeerSession>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (const auto& entry : sessions_) {
+            sessions.push_back(entry.second);
+        }
+    }
+    const int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    for (const auto& session : sessions) {
+        ReceiveBitrateController::Decision decision = session->UpdateBitrateControl(now_ms);
+        if (decision != ReceiveBitrateController::Decision::kHold) {
+            const ReceiveBitrateController::Metrics& metrics = session->bitrate_controller().metrics();
+            const std::string key = MakeSessionKey(session->room_id(), session->remote_id());
+            std::cout << "[INFO] Bitrate control " << key << ": " << ReceiveBitrateController::DecisionName(decision)
+                      << ", rx " << metrics.rx_kbps << " kbps, decoder backlog " << metrics.backlog
+                      << " -> cap " << (metrics.cap_kbps > 0 ? std::to_string(metrics.cap_kbps) + " kbps" : "none")
+                      << " (overloaded " << metrics.overload_samples << " s, " << metrics.decreases << " decreases, "
+                      << metrics.increases << " increases, " << metrics.releases << " releases)" << std::endl;
+            NotifyStateChange("bitrate_cap", key + " " + std::to_string(metrics.cap_kbps));
+            session->set_bandwidth_renegotiation_pending(true);
+        }
+        if (session->bandwidth_renegotiation_pending()) {
+            RenegotiateBandwidth(session);
+        }
+    }
+}
+
+void WebRTCClient::RunLayerSelection() {
+    std::vector<std::shared_ptr<PeerSession>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (const auto& entry : sessions_) {
+            sessions.push_back(entry.second);
+        }
+    }
+    const int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    std::vector<std::shared_ptr<PeerSession>> active;
+    std::vector<LayerSelector::StreamLoad> loads;
+    for (const auto& session : sessions) {
+        LayerSelector::StreamLoad load;
+        if (session->SampleStreamLoad(now_ms, &load)) {
+            active.push_back(session);
+            loads.push_back(load);
+        }
+    }
+    if (active.empty()) {
+        return;
+    }
+
+    std::vector<int> layers = layer_selector_.AllocateTemporalLayers(loads);
+    bool changed = false;
+    bool limited = false;
+    double full_load = 0;
+    double selected_load = 0;
+    for (size_t i = 0; i < active.size(); ++i) {
+        full_load += LayerSelector::DecodeLoad(loads[i], -1);
+        selected_load += LayerSelector::DecodeLoad(loads[i], layers[i]);
+        limited = limited || layers[i] >= 0;
+        if (layers[i] != loads[i].max_temporal_layer) {
+            changed = true;
+            active[i]->SetMaxTemporalLayer(layers[i]);
+            const std::string key = MakeSessionKey(active[i]->room_id(), active[i]->remote_id());
+            std::cout << "[INFO] Layer selection " << key << ": temporal layers "
+                      << (layers[i] < 0 ? loads[i].temporal_layers : layers[i] + 1) << "/" << loads[i].temporal_layers
+                      << " (" << loads[i].decoded_width << "x" << loads[i].decoded_height << " @ "
+                      << static_cast<int>(loads[i].input_fps) << " fps shown at " << loads[i].display_width << "x"
+                      << loads[i].display_height << ")" << std::endl;
+            NotifyStateChange("temporal_layer", key + " " + std::to_string(layers[i]));
+        }
+    }
+
+    // 有会话被降层时每10秒汇总一次节省的解码负载与码率
+    if (changed || (limited && ++layer_report_ticks_ >= 10)) {
+        layer_report_ticks_ = 0;
+        uint64_t skipped_frames = 0;
+        uint64_t skipped_bytes = 0;
+        int64_t age_ms = 0;
+        for (const auto& session : active) {
+            PeerSession::Usage usage = session->GetUsage();
+            skipped_frames += usage.skipped_frames;
+            skipped_bytes += usage.skipped_bytes;
+            age_ms = std::max(age_ms, usage.age_ms);
+        }
+        std::cout << "[INFO] Layer selection: decode load " << static_cast<int>(selected_load / 1e6) << "/"
+                  << static_cast<int>(full_load / 1e6) << " Mpx/s (VDEC budget "
+                  << static_cast<int>(layer_selector_.config().vdec_capacity_mpps) << "), skipped " << skipped_frames
+                  << " frames, avg " << (age_ms > 0 ? skipped_bytes * 8 / age_ms : 0) << " kbps not decoded" << std::endl;
+    }
+}
+
+std::string WebRTCClient::SelectSimulcastLayer(const std::shared_ptr<PeerSession>& session, const std::string& sdp) {
+    std::vector<sdp_utils::SimulcastLayer> layers = sdp_utils::GetSimulcastLayers(sdp);
+    int display_width = 0;
+    int display_height = 0;
+    if (layers.size() < 2 || !session->GetDisplaySize(&display_width, &display_height)) {
+        return sdp;
+    }
+    int chosen = LayerSelector::ChooseSimulcastLayer(layers, display_width, display_height);
+    int width = 0;
+    int height = 0;
+    int top_width = 0;
+    int top_height = 0;
+    LayerSelector::EstimateLayerSize(layers[chosen], 1920, 1080, &width, &height);
+    for (const auto& layer : layers) {
+        int layer_width = 0;
+        int layer_height = 0;
+        LayerSelector::EstimateLayerSize(layer, 1920, 1080, &layer_width, &layer_height);
+        if (layer_width * layer_height > top_width * top_height) {
+            top_width = layer_width;
+            top_height = layer_height;
+        }
+    }
+    std::cout << "[INFO] Simulcast " << MakeSessionKey(session->room_id(), session->remote_id()) << ": receiving layer '"
+              << layers[chosen].rid << "' (~" << width << "x" << height << ") of " << layers.size() << " for a "
+              << display_width << "x" << display_height << " display, "
+              << (top_width * top_height > 0 ? 100 * width * height / (top_width * top_height) : 100)
+              << "% of the top layer's pixels" << std::endl;
+    session->set_simulcast_rid(layers[chosen].rid);
+    return sdp_utils::PreferSimulcastLayer(sdp, layers[chosen].rid);
+}
+
+void WebRTCClient::RenegotiateBandwidth(const std::shared_ptr<PeerSession>& session) {
+    // 在信令线程执行，与CloseSession串行；回调使用这里取得的引用，会话关闭后不再发出Offer
+    webrtc::scoped_refptr<webrtc::PeerConnectionInterface> pc = session->peer_connection();
+    if (!pc || !signaling_client_ || !is_connected_to_signaling_) {
+        return;
+    }
+    // 正在协商时不插入新的Offer，保持pending到下一个周期
+    if (pc->signaling_state() != webrtc::PeerConnectionInterface::kStable) {
+        return;
+    }
+    session->set_bandwidth_renegotiation_pending(false);
+    webrtc::PeerConnectionInterface::RTCOfferAnswerOptions options;
+    pc->CreateOffer(
+        CreateSessionDescriptionObserver::Create(
+            [this, session, pc](webrtc::SessionDescriptionInterface* desc) {
+                desc = WithVideoBandwidth(desc, session->bitrate_cap_kbps());
+                pc->SetLocalDescription(
+                    SetSessionDescriptionObserver::Create(
+                        [this, session, desc]() {
+                            if (!session->peer_connection() || !signaling_client_) {
+                                return;
+                            }
+                            std::string sdp;
+                            desc->ToString(&sdp);
+                            signaling_client_->SendOffer(sdp, session->remote_id(), session->room_id());
+                        },
+                        [](webrtc::RTCError error) { std::cerr << "SetLocalDescription failed: " << error.message() << std::endl; }
+                    ).get(),
+                    desc);
+            },
+            [](webrtc::RTCError error) { std::cerr << "CreateOffer failed: " << error.message() << std::endl; }
+        ).get(),
+        options);
+}
+
+void WebRTCClient::OnAnswerReceived(const Json::Value& message_json) {
+    std::string room_id = GetMessageRoom(message_json);
+    std::string remote_id = message_json["from"].asString();
+    auto session = FindSession(room_id, remote_id);
+    if (!session || !message_json.isMember("sdp")) {
+        std::cerr << "Dropping answer from " << remote_id << " in room " << room_id << ": no session" << std::endl;
+        return;
+    }
+    webrtc::SdpParseError error;
+    std::unique_ptr<webrtc::SessionDescriptionInterface> session_description =
+        webrtc::CreateSessionDescription(webrtc::SdpType::kAnswer, message_json["sdp"].asString(), &error);
+    if (!session_description) {
+        std::cerr << "Failed to parse answer SDP: " << error.description << std::endl;
+        return;
+    }
+    webrtc::scoped_refptr<webrtc::PeerConnectionInterface> pc = session->peer_connection();
+    if (!pc) {
+        return;
+    }
+    pc->SetRemoteDescription(
+        SetSessionDescriptionObserver::Create(
+            [session]() {
+                std::cout << "[INFO] Bandwidth renegotiated with " << session->remote_id() << ": cap "
+                          << session->bitrate_cap_kbps() << " kbps" << std::endl;
+            },
+            [](webrtc::RTCError error) { std::cerr << "SetRemoteDescription failed: " << error.message() << std::endl; }
+        ).get(),
+        session_description.release());
+}
+
+void WebRTCClient::HandleSignalingMessage(SignalingClient::MessageType type, const Json::Value& root) {
+    // 信令与媒体引擎并行初始化时，Offer可能先于工厂到达：在分发线程上等待，消息顺序不变
+    if (!WaitForInitialization()) {
+        std::cerr << "Dropping signaling message: WebRTC client is not initialized" << std::endl;
+        return;
+    }
     switch (type) {
         case SignalingClient::MessageType::OFFER:
             OnOfferReceived(root);
             break;
-        case SignalingClient::MessageType::CANDIDATE:
-            OnCandidateReceived(root);
+        case SignalingClient::MessageType::CANDIDATE: {
+            std::string room_id = GetMessageRoom(root);
+            std::string remote_id = root["from"].asString();
+            auto session = FindSession(room_id, remote_id);
+            if (!session) {
+                std::cerr << "Dropping candidate from " << remote_id << " in room " << room_id << ": no session" << std::endl;
+                break;
+            }
+            OnCandidateReceived(session, root);
+            break;
+        }
+        case SignalingClient::MessageType::ANSWER:
+            OnAnswerReceived(root);
+            break;
+        case SignalingClient::MessageType::LEAVE:
+            OnPeerLeft(root);
             break;
         default:
             std::cout << "Ignoring message of type: " << static_cast<int>(type) << std::endl;
             break;
     }
 }
-#if 0
 void WebRTCClient::OnOfferReceived(const Json::Value& message_json) {
     if (!message_json.isMember("sdp") || !message_json.isMember("from")) {
         std::cerr << "Offer message missing required fields" << std::endl;
         return;
     }
-    
-    std::string sdp = message_json["sdp"].asString();
-    remote_client_id_ = message_json["from"].asString(); // 存储对端ID
-
-    webrtc::SdpParseError error;
-    std::unique_ptr<webrtc::SessionDescriptionInterface> session_description =
-        webrtc::CreateSessionDescription(webrtc::SdpType::kOffer, sdp, &error);
 
-    if (!session_description) {
-        std::cerr << "Failed to parse offer SDP: " << error.description << std::endl;
+    std::string room_id = GetMessageRoom(message_json);
+    std::string remote_id = message_json["from"].asString();
+    auto session = GetOrCreateSession(room_id, remote_id);
+    if (!session) {
+        NotifyStateChange("session_rejected", MakeSessionKey(room_id, remote_id));
         return;
     }
+    session->MarkOfferReceived();
+    ApplyRemoteOffer(session, message_json["sdp"].asString());
+}
 
-    peer_connection_->SetRemoteDescription(
-        SetSessionDescriptionObserver::Create(
-            [this]() {
-                std::cout << "SetRemoteDescription success, creating answer..." << std::endl;
-                webrtc::PeerConnectionInterface::RTCOfferAnswerOptions options;
-                peer_connection_->CreateAnswer(
-                    CreateSessionDescriptionObserver::Create(
-                        [this](webrtc::SessionDescriptionInterface* desc) {
-                            peer_connection_->SetLocalDescription(
-                                SetSessionDescriptionObserver::Create(
-                                    [this, desc]() {
-                                        std::string sdp;
-                                        desc->ToString(&sdp);
-                                        this->SendSdpAnswer(sdp);
-                                    },
-                                    [](webrtc::RTCError error){ std::cerr << "SetLocalDescription failed: " << error.message() << std::endl; }
-                                ),
-                                desc
-                            );
-                        },
-                        [](webrtc::RTCError error){ std::cerr << "CreateAnswer failed: " << error.message() << std::endl; }
-                    ),
-                    options);
-            },
-            [](webrtc::RTCError error) {
-                std::cerr << "SetRemoteDescription failed: " << error.message() << std::endl;
-            }
-        ),
-        session_description.release()
-    );
+void WebRTCClient::OnPeerLeft(const Json::Value& message_json) {
+    // 服务器广播的client_left携带clientId，对端主动发送的leave携带from
+    std::string remote_id = message_json.isMember("clientId") ? message_json["clientId"].asString()
+                                                              : message_json["from"].asString();
+    CloseSession(GetMessageRoom(message_json), remote_id, "peer left");
 }
-#endif
 
-void WebRTCClient::OnOfferReceived(const Json::Value& message_json) {
-    if (!message_json.isMember("sdp") || !message_json.isMember("from")) {
-        std::cerr << "Offer message missing required fields" << std::endl;
+void WebRTCClient::ApplyRemoteOffer(const std::shared_ptr<PeerSession>& session, const std::string& sdp) {
+    // 协商过程中对端可能离开、会话被关闭：各回调使用这里取得的PeerConnection引用，
+    // 不再重新读取会话（已关闭的PeerConnection上的调用只会返回错误）
+    webrtc::scoped_refptr<webrtc::PeerConnectionInterface> pc = session->peer_connection();
+    if (!pc) {
+        std::cerr << "Dropping offer from " << session->remote_id() << ": session is closed" << std::endl;
+        return;
+    }
+    if (pc->signaling_state() == webrtc::PeerConnectionInterface::kHaveLocalOffer) {
+        // 本端的带宽重协商与对端的Offer冲突：接收端让步，回滚本地Offer后再处理对端的，
+        // 当前上限随Answer一起发出
+        std::cout << "[INFO] Rolling back local offer to " << session->remote_id() << " for incoming offer" << std::endl;
+        pc->SetLocalDescription(
+            SetSessionDescriptionObserver::Create(
+                [this, session, sdp]() { ApplyRemoteOffer(session, sdp); },
+                [](webrtc::RTCError error) { std::cerr << "Rollback failed: " << error.message() << std::endl; }
+            ).get(),
+            webrtc::CreateSessionDescription(webrtc::SdpType::kRollback, "").release());
         return;
     }
 
-    std::string sdp = message_json["sdp"].asString();
-    remote_client_id_ = message_json["from"].asString();
-
+    // 联播时只保留适合显示尺寸的一层，每个新Offer（包括对端的重新协商）都重新选择
+    const std::string offer = layer_selection_enabled_ ? SelectSimulcastLayer(session, sdp) : sdp;
     webrtc::SdpParseError error;
     std::unique_ptr<webrtc::SessionDescriptionInterface> session_description =
-        webrtc::CreateSessionDescription(webrtc::SdpType::kOffer, sdp, &error);
+        webrtc::CreateSessionDescription(webrtc::SdpType::kOffer, offer, &error);
 
     if (!session_description) {
         std::cerr << "Failed to parse offer SDP: " << error.description << std::endl;
         return;
     }
 
-        // [修改] 调用接收裸指针的旧版API
-    peer_connection_->SetRemoteDescription(
+    // [修改] 调用接收裸指针的旧版API
+    pc->SetRemoteDescription(
         // 使用 .get() 传递裸指针
         SetSessionDescriptionObserver::Create(
-            [this]() {
+            [this, session, pc, offer]() {
                 std::cout << "SetRemoteDescription success, creating answer..." << std::endl;
                 webrtc::PeerConnectionInterface::RTCOfferAnswerOptions options;
-                peer_connection_->CreateAnswer(
+                pc->CreateAnswer(
                     // 使用 .get() 传递裸指针
                     CreateSessionDescriptionObserver::Create(
-                        [this](webrtc::SessionDescriptionInterface* desc) {
-                            peer_connection_->SetLocalDescription(
+                        [this, session, pc, offer](webrtc::SessionDescriptionInterface* desc) {
+                            // 已有码率上限时写入Answer，发送端据此限制发送码率
+                            desc = WithVideoBandwidth(desc, session->bitrate_cap_kbps());
+                            session->set_bandwidth_renegotiation_pending(false);
+                            pc->SetLocalDescription(
                                 // 使用 .get() 传递裸指针
                                 SetSessionDescriptionObserver::Create(
-                                    [this, desc]() {
-                                        std::string sdp;
-                                        desc->ToString(&sdp);
-                                        this->SendSdpAnswer(sdp);
+                                    [this, session, desc, offer]() {
+                                        // 回调与会话关闭都在信令线程执行：会话已关闭时不再发送Answer
+                                        if (!session->peer_connection()) {
+                                            return;
+                                        }
+                                        std::string answer;
+                                        desc->ToString(&answer);
+                                        this->SendSdpAnswer(session->room_id(), session->remote_id(), answer);
+                                        // Answer已发出，ICE/DTLS建立期间创建VDEC/VO，首个关键帧到达时直接解码
+                                        if (video_preconfigure_enabled_) {
+                                            session->PreconfigureVideo(offer, answer);
+                                        }
                                     },
                                     [](webrtc::RTCError error){ std::cerr << "SetLocalDescription failed: " << error.message() << std::endl; }
                                 ).get(),
@@ -277,7 +1043,15 @@ void WebRTCClient::OnOfferReceived(const Json::Value& message_json) {
     );
 }
 
-void WebRTCClient::OnCandidateReceived(const Json::Value& message_json) {
+void WebRTCClient::OnCandidateReceived(const std::shared_ptr<PeerSession>& session, const Json::Value& message_json) {
+    // 批量候选者消息：逐个展开处理
+    if (message_json.isMember("candidates") && message_json["candidates"].isArray()) {
+        for (const auto& candidate_json : message_json["candidates"]) {
+            OnCandidateReceived(session, candidate_json);
+        }
+        return;
+    }
+
     if (!message_json.isMember("candidate") || !message_json.isMember("sdpMid") || !message_json.isMember("sdpMLineIndex")) {
         std::cerr << "Candidate message missing required fields" << std::endl;
         return;
@@ -296,29 +1070,138 @@ void WebRTCClient::OnCandidateReceived(const Json::Value& message_json) {
         return;
     }
 
-    if (!peer_connection_->AddIceCandidate(candidate.get())) {
+    webrtc::scoped_refptr<webrtc::PeerConnectionInterface> pc = session->peer_connection();
+    if (!pc || !pc->AddIceCandidate(candidate.get())) {
         std::cerr << "Failed to add ICE candidate" << std::endl;
     }
 }
 
 // [FIX] 使用正确的信令接口发送Answer
-void WebRTCClient::SendSdpAnswer(const std::string& sdp) {
+void WebRTCClient::SendSdpAnswer(const std::string& room_id, const std::string& remote_id, const std::string& sdp) {
+    if (static_session_mode_) {
+        // 静态会话的Answer在ICE收集完成后连同候选者一起写出
+        return;
+    }
     if (!signaling_client_ || !is_connected_to_signaling_) {
         std::cerr << "Cannot send answer: SignalingClient not connected" << std::endl;
         return;
     }
-    signaling_client_->SendAnswer(sdp, remote_client_id_);
+    signaling_client_->SendAnswer(sdp, remote_id, room_id);
 }
 
 // [FIX] 使用正确的信令接口发送Candidate
-void WebRTCClient::SendIceCandidateToPeer(const webrtc::IceCandidateInterface* candidate) {
+void WebRTCClient::SendIceCandidateToPeer(const std::string& room_id, const std::string& remote_id,
+                                          const webrtc::IceCandidateInterface* candidate) {
+    if (static_session_mode_) {
+        return; // 候选者会包含在最终的Answer中
+    }
     if (!signaling_client_ || !is_connected_to_signaling_) {
         std::cerr << "Cannot send candidate: SignalingClient not connected" << std::endl;
         return;
     }
     std::string sdp;
     candidate->ToString(&sdp);
-    signaling_client_->SendCandidate(candidate->sdp_mid(), candidate->sdp_mline_index(), sdp, remote_client_id_);
+    signaling_client_->SendCandidate(candidate->sdp_mid(), candidate->sdp_mline_index(), sdp, remote_id, room_id);
+}
+
+bool WebRTCClient::StartStaticSession(const std::string& offer_path, const std::string& answer_path) {
+    if (!is_initialized_ || !static_session_mode_) {
+        std::cerr << "Static session requires Initialize() with static session mode enabled" << std::endl;
+        return false;
+    }
+
+    std::ifstream offer_file(offer_path);
+    if (!offer_file) {
+        std::cerr << "Failed to open offer file: " << offer_path << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << offer_file.rdbuf();
+    std::string sdp = buffer.str();
+
+    // 既支持纯SDP文本，也支持与信令消息相同的JSON格式 {"type":"offer","sdp":"..."}
+    if (!sdp.empty() && sdp[0] == '{') {
+        Json::CharReaderBuilder builder;
+        std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+        Json::Value root;
+        std::string errors;
+        if (!reader->parse(sdp.c_str(), sdp.c_str() + sdp.length(), &root, &errors) || !root["sdp"].isString()) {
+            std::cerr << "Invalid offer JSON in " << offer_path << ": " << errors << std::endl;
+            return false;
+        }
+        sdp = root["sdp"].asString();
+    }
+
+    auto session = GetOrCreateSession("", "static");
+    if (!session) {
+        return false;
+    }
+    session->MarkOfferReceived();
+    static_answer_path_ = answer_path;
+    NotifyStateChange("static_session", "Applying pre-provisioned offer from " + offer_path);
+    ApplyRemoteOffer(session, sdp);
+    return true;
+}
+
+void WebRTCClient::OnIceGatheringComplete(const std::string& room_id, const std::string& remote_id) {
+    auto session = FindSession(room_id, remote_id);
+    webrtc::scoped_refptr<webrtc::PeerConnectionInterface> pc = session ? session->peer_connection() : nullptr;
+    if (!pc) {
+        return;
+    }
+    int64_t elapsed_ms = session->GetMsSinceOffer();
+    if (elapsed_ms >= 0) {
+        std::cout << "[INFO] Session " << MakeSessionKey(room_id, remote_id) << " ICE gathering complete "
+                  << elapsed_ms << " ms after offer (profile " << ice_config_.ProfileName() << ")" << std::endl;
+    }
+    if (!static_session_mode_) {
+        return;
+    }
+    const webrtc::SessionDescriptionInterface* answer = pc->local_description();
+    if (!answer) {
+        return;
+    }
+    std::string sdp;
+    answer->ToString(&sdp);
+
+    if (static_answer_path_.empty()) {
+        std::cout << sdp << std::endl;
+    } else {
+        std::ofstream answer_file(static_answer_path_, std::ios::trunc);
+        if (!answer_file || !(answer_file << sdp)) {
+            std::cerr << "Failed to write answer to " << static_answer_path_ << std::endl;
+            return;
+        }
+    }
+    NotifyStateChange("static_answer_ready", static_answer_path_.empty() ? "stdout" : static_answer_path_);
+}
+
+void WebRTCClient::OnIceConnected(const std::string& room_id, const std::string& remote_id) {
+    auto session = FindSession(room_id, remote_id);
+    if (!session) {
+        return;
+    }
+    int64_t elapsed_ms = session->GetMsSinceOffer();
+    if (elapsed_ms < 0) {
+        return;
+    }
+    std::cout << "[INFO] Session " << MakeSessionKey(room_id, remote_id) << " ICE connected " << elapsed_ms
+              << " ms after offer (profile " << ice_config_.ProfileName() << ", " << (session->prewarmed() ? "prewarmed, candidate pool " +
+                 std::to_string(ice_candidate_pool_size_) : std::string("cold start")) << ")" << std::endl;
+    NotifyStateChange("ice_connected", MakeSessionKey(room_id, remote_id) + " " + std::to_string(elapsed_ms) + " ms");
+}
+
+void WebRTCClient::OnIceFailed(const std::string& room_id, const std::string& remote_id) {
+    // 观察者回调运行在信令线程上，关闭PeerConnection会同步等待该线程，因此投递到之后执行。
+    // 会话关闭后槽位和解码通道立即可用于下一个发送端，无需重启进程
+    if (!is_initialized_ || !signaling_thread_) {
+        return;
+    }
+    signaling_thread_->PostTask([this, room_id, remote_id]() {
+        if (is_initialized_) {
+            CloseSession(room_id, remote_id, "ICE failed");
+        }
+    });
 }
 
 void WebRTCClient::NotifyStateChange(const std::string& state, const std::string& description) {
@@ -330,19 +1213,75 @@ void WebRTCClient::NotifyStateChange(const std::string& state, const std::string
 void WebRTCClient::Cleanup() {
     is_initialized_ = false;
     is_connected_to_signaling_ = false;
-    if (peer_connection_) {
-        peer_connection_->Close();
-        peer_connection_ = nullptr;
+    // 不再等待初始化：分发线程上等待中的消息直接丢弃，关闭信令时才能停止该线程
+    {
+        std::lock_guard<std::mutex> lock(init_mutex_);
+        init_finished_ = true;
+        media_ready_ = true;
     }
+    init_cv_.notify_all();
+    // 先关闭信令：消息回调运行在信令分发线程上并会访问会话，
+    // 必须等该线程退出后才能释放各会话的PeerConnection
     if (signaling_client_) {
         signaling_client_->Close();
         signaling_client_.reset();
     }
+    std::vector<std::shared_ptr<PeerSession>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (const auto& entry : sessions_) {
+            sessions.push_back(entry.second);
+        }
+    }
+    for (const auto& session : sessions) {
+        CloseSession(session->room_id(), session->remote_id(), "shutdown");
+    }
+    // 所有会话都已关闭，此时才释放额外槽位的VDEC/VO通道
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (auto& entry : slot_video_handlers_) {
+            entry.second->Stop();
+        }
+        slot_video_handlers_.clear();
+    }
+    // 在信令线程上释放预热连接，与正在执行的刷新任务互斥；is_initialized_已清零，之后的刷新任务直接返回
+    if (signaling_thread_ && peer_connection_factory_) {
+        signaling_thread_->BlockingCall([this]() {
+            std::lock_guard<std::mutex> lock(spare_mutex_);
+            if (spare_connection_ && spare_connection_->peer_connection) {
+                spare_connection_->peer_connection->Close();
+            }
+            spare_connection_.reset();
+        });
+    }
+    if (network_thread_ && network_manager_) {
+        network_thread_->BlockingCall([this]() {
+            network_manager_.reset();
+            socket_factory_.reset();
+        });
+    }
     peer_connection_factory_ = nullptr;
+    // 所有PeerConnection都已关闭，输出对象已销毁，此时写完队列并关闭文件
+    if (event_log_writer_) {
+        event_log_writer_->Stop();
+        RtcEventLogWriter::Stats stats = event_log_writer_->GetStats();
+        std::cout << "[INFO] RTC event log: " << stats.written_bytes / 1024 << " KB written to "
+                  << stats.files_opened << " files, " << stats.dropped_bytes / 1024 << " KB dropped, writer CPU "
+                  << stats.writer_cpu_us / 1000 << " ms" << std::endl;
+        event_log_writer_.reset();
+    }
+    if (batched_socket_server_) {
+        BatchedUdpSocketServer::Stats stats = batched_socket_server_->GetStats();
+        std::cout << "[INFO] Batched UDP receive: " << stats.packets << " packets / " << stats.bytes << " bytes in "
+                  << stats.recv_calls << " recvmmsg calls (avg "
+                  << (stats.recv_calls ? static_cast<double>(stats.packets) / stats.recv_calls : 0)
+                  << ", max " << stats.max_batch << " per call, " << stats.datagrams << " datagrams before GRO split)"
+                  << std::endl;
+        batched_socket_server_ = nullptr;
+    }
     network_thread_->Stop();
     worker_thread_->Stop();
     signaling_thread_->Stop();
-    pc_observer_.reset();
     video_handler_.reset();
     audio_handler_.reset();
 }
\ No newline at end of file
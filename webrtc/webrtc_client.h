@@ -5,69 +5,325 @@
 #include "rtc_base/thread.h"
 #include "api/scoped_refptr.h"
 #include "peer_connection_observer_impl.h"
+#include "peer_session.h"
+#include "ice_config.h"
+#include "latency_profile.h"
+#include "batched_udp_socket_server.h"
+#include "rtc_event_log_writer.h"
 #include "../signaling/signaling_client.h"
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 #include <functional>
 #include <atomic> // [FIX] 引入 atomic 头文件
+#include <condition_variable>
 #include <json/json.h>
 
+namespace webrtc {
+class BasicNetworkManager;
+class BasicPacketSocketFactory;
+class PortAllocator;
+}
+
 class WebRTCClient {
 public:
     WebRTCClient();
     ~WebRTCClient();
 
-    // 初始化所有WebRTC组件
+    // 初始化所有WebRTC组件，可与ConnectToSignalingServer并发执行
     bool Initialize();
     
     // 清理所有资源
     void Cleanup();
 
-    // 连接到信令服务器
+    // 启用静态会话模式（需在Initialize之前调用）：不使用信令服务器，只收集主机候选者
+    void SetStaticSessionMode(bool enabled) { static_session_mode_ = enabled; }
+
+    // 从文件加载预先配置的远端Offer并建立会话。
+    // ICE收集完成后，把包含全部候选者的Answer写入answer_path（为空则打印到标准输出）
+    bool StartStaticSession(const std::string& offer_path, const std::string& answer_path);
+
+    // 信令消息的处理除了等待Initialize，还要等到SetMediaReady（并行启动时媒体处理器可能晚于工厂就绪）
+    void DeferSignalingUntilMediaReady();
+    void SetMediaReady();
+
+    // 连接到信令服务器（无需等待Initialize完成）
     void ConnectToSignalingServer(const std::string& url, const std::string& room_id, const std::string& client_id = "");
+
+    // 通过同一信令连接和同一PeerConnectionFactory再加入一个房间
+    bool JoinRoom(const std::string& room_id);
+
+    // 离开一个房间：关闭该房间内的所有会话，其余房间不受影响
+    bool LeaveRoom(const std::string& room_id);
     
-    // 由PeerConnectionObserver回调，用于发送信令消息
-    void SendIceCandidateToPeer(const webrtc::IceCandidateInterface* candidate);
+    // 由PeerConnectionObserver回调，用于把本地候选者发给对应的远端
+    void SendIceCandidateToPeer(const std::string& room_id, const std::string& remote_id,
+                                const webrtc::IceCandidateInterface* candidate);
+
+    // 由PeerConnectionObserver回调，某个会话的本地ICE候选者收集完成
+    void OnIceGatheringComplete(const std::string& room_id, const std::string& remote_id);
+
+    // 由PeerConnectionObserver回调，某个会话ICE连通，输出从收到Offer开始的耗时
+    void OnIceConnected(const std::string& room_id, const std::string& remote_id);
+
+    // 由PeerConnectionObserver回调，某个会话ICE失败：关闭该会话，回收PeerConnection与槽位
+    void OnIceFailed(const std::string& room_id, const std::string& remote_id);
+
+    // 由PeerConnectionObserver回调，远端创建了DataChannel
+    void OnDataChannel(const std::string& room_id, const std::string& remote_id,
+                       webrtc::scoped_refptr<webrtc::DataChannelInterface> channel);
+
+    // 注册控制通道消息的处理函数，作用于之后创建的所有会话（需在连接信令之前调用）。
+    // 处理函数在网络线程执行，消息负载只在调用期间有效
+    void SetControlHandler(uint8_t type, ControlChannel::Handler handler) { control_handlers_[type] = std::move(handler); }
+
+    // 通过控制通道向某个远端发送一条消息
+    bool SendControl(const std::string& room_id, const std::string& remote_id, uint8_t type,
+                     const void* data, size_t size, ControlChannel::Mode mode = ControlChannel::Mode::kReliable);
+
+    // 在本机建立一对回环连接，测量控制通道的往返时延（需在Initialize之后调用，阻塞）
+    bool RunControlChannelBenchmark(int count);
+
+    // 网络线程使用recvmmsg批量收包（需在Initialize之前调用）
+    void SetBatchedUdpReceive(const BatchedUdpSocketServer::Options& options) {
+        batched_udp_enabled_ = true;
+        batched_udp_options_ = options;
+    }
+
+    // 设置ICE服务器与候选者策略（需在Initialize之前调用）
+    void SetIceConfig(const IceConfig& config) { ice_config_ = config; }
+
+    // 启动时预热一个PeerConnection并预先收集pool_size个候选者（需在Initialize之前调用）。
+    // 每refresh_s秒重建一次，避免NAT映射过期；Offer到达时直接取用。pool_size为0表示关闭
+    void SetIcePrewarm(int pool_size, int refresh_s) {
+        ice_candidate_pool_size_ = pool_size;
+        prewarm_refresh_s_ = refresh_s;
+    }
 
     // 设置状态变化回调
     using StateChangeCallback = std::function<void(const std::string& state, const std::string& description)>;
     void SetStateChangeCallback(StateChangeCallback callback) { state_change_callback_ = std::move(callback); }
     
-    // 设置媒体处理器
+    // 配置信令WebSocket保活（需在Initialize之前调用），interval_ms为0表示关闭
+    void SetSignalingKeepalive(int interval_ms, int timeout_ms) {
+        keepalive_interval_ms_ = interval_ms;
+        keepalive_timeout_ms_ = timeout_ms;
+    }
+
+    // 获取信令往返时延（毫秒），尚未测得时返回-1
+    int GetSignalingRttMs() const { return signaling_client_ ? signaling_client_->GetRttMs() : -1; }
+
+    // 信令连接是否正常（健康检查用）
+    bool IsSignalingConnected() const { return signaling_client_ && signaling_client_->IsConnected(); }
+
+    // 当前加入的所有房间
+    std::vector<std::string> GetRoomIds() const {
+        return signaling_client_ ? signaling_client_->GetRoomIds() : std::vector<std::string>();
+    }
+    
+    // 设置主媒体处理器（会话槽位0使用，包含唯一的音频输出）
     void SetMediaHandlers(std::shared_ptr<EncodedVideoFrameHandler> video_handler, std::shared_ptr<AudioReceiver> audio_handler);
 
+    // 为额外的并发会话创建视频处理器（参数为槽位号，返回已初始化并启动的处理器）。
+    // 未设置时只能同时接收一个发送端
+    using VideoHandlerFactory = std::function<std::shared_ptr<EncodedVideoFrameHandler>(int slot)>;
+    void SetVideoHandlerFactory(VideoHandlerFactory factory) { video_handler_factory_ = std::move(factory); }
+
+    // 同时接收的发送端数量上限（含主会话）
+    void SetMaxSessions(int max_sessions) { max_sessions_ = max_sessions; }
+
+    // 单个房间内同时接收的发送端数量上限，避免一个房间占满所有解码通道；0表示不限制
+    void SetMaxSessionsPerRoom(int max_sessions) { max_sessions_per_room_ = max_sessions; }
+
+    // 获取所有会话的资源占用
+    std::vector<PeerSession::Usage> GetSessionUsage() const;
+
+    // 按解码积压和丢帧限制发送端码率（需在Initialize之前调用）：
+    // 上限写入SDP的b=AS，由接收端发起重新协商告知发送端
+    void SetReceiveBitrateControl(bool enabled, const ReceiveBitrateController::Config& config) {
+        bitrate_control_enabled_ = enabled;
+        bitrate_control_config_ = config;
+    }
+
+    // 按显示尺寸和VDEC解码能力选择接收的联播层与时间层（需在Initialize之前调用）
+    void SetLayerSelection(bool enabled, const LayerSelector::Config& config) {
+        layer_selection_enabled_ = enabled;
+        layer_selector_ = LayerSelector(config);
+    }
+
+    // 按Offer中的编码与分辨率提示在Answer发出后预先创建VDEC/VO（默认开启，需在Initialize之前调用）
+    void SetVideoPreconfigure(bool enabled) { video_preconfigure_enabled_ = enabled; }
+
+    // 设置播放延迟档位，可在运行时调用：立即作用于主处理器和所有已有会话
+    void SetLatencyProfile(const LatencyProfile& profile);
+
+    // 当前的播放延迟档位
+    LatencyProfile GetLatencyProfile() const;
+
+    // 输出每个会话各级接收缓冲的延迟（统计在信令线程异步返回）
+    void LogLatencyReport() const;
+
+    // 启用RTC事件日志（需在Initialize之前调用）：记录RTP/RTCP包头、带宽估计和ICE事件，
+    // 由后台线程写入config.directory。auto_start为true时每个会话打开后立即开始记录
+    void SetEventLog(const RtcEventLogWriter::Config& config, bool auto_start) {
+        event_log_config_ = config;
+        event_log_enabled_ = true;
+        event_logging_ = auto_start;
+    }
+
+    // 开始或停止记录某个会话的事件日志（在信令线程执行），会话不存在或未启用事件日志时返回false
+    bool SetSessionEventLogging(const std::string& room_id, const std::string& remote_id, bool enabled);
+
+    // 开始或停止记录所有会话（包括之后打开的会话）的事件日志
+    void SetEventLogging(bool enabled);
+    bool IsEventLogging() const { return event_logging_; }
+
 private:
-    // 创建PeerConnection
-    bool CreatePeerConnection();
+    // Initialize的实际内容：线程、工厂与网络配置
+    bool InitializeEngine();
+
+    // 等待Initialize结束（以及SetMediaReady），返回是否初始化成功
+    bool WaitForInitialization();
+
+    // 生成PeerConnection的RTC配置
+    webrtc::PeerConnectionInterface::RTCConfiguration BuildRtcConfiguration() const;
+
+    // 会话表的键：房间ID/远端ID
+    static std::string MakeSessionKey(const std::string& room_id, const std::string& remote_id);
+
+    // 消息所属的房间：服务器转发的消息带roomId，缺省时为第一个房间
+    std::string GetMessageRoom(const Json::Value& message_json) const;
+
+    // 查找会话，不存在时分配槽位并创建（槽位用尽、超过房间上限或创建失败返回nullptr）
+    std::shared_ptr<PeerSession> GetOrCreateSession(const std::string& room_id, const std::string& remote_id);
+
+    // 查找已存在的会话
+    std::shared_ptr<PeerSession> FindSession(const std::string& room_id, const std::string& remote_id) const;
+
+    // 关闭并移除会话，输出资源占用（在信令线程执行，其他线程调用时等待关闭完成）
+    void CloseSession(const std::string& room_id, const std::string& remote_id, const std::string& reason);
+
+    // 当前生效的ICE策略（静态会话模式强制只用主机UDP候选者）
+    IceConfig EffectiveIceConfig() const;
+
+    // 限定网卡时为每个PeerConnection创建端口分配器，否则返回nullptr使用工厂默认的分配器
+    std::unique_ptr<webrtc::PortAllocator> CreatePortAllocator() const;
+
+    // 创建新的预热连接替换旧的（在信令线程调用）
+    void PrewarmSpareConnection();
+
+    // 安排下一次预热连接的刷新
+    void ScheduleSpareRefresh();
+
+    // 取走预热连接，没有时返回nullptr
+    std::unique_ptr<PrewarmedConnection> TakeSpareConnection();
+    
+    // 安排下一次媒体控制（码率控制与层选择，每秒一次，在信令线程执行）
+    void ScheduleMediaControl();
+    // 对所有会话运行一次码率控制，上限变化时发起重新协商（在信令线程执行，与CloseSession串行）
+    void RunBitrateControl();
+
+    // 按总解码负载为各会话分配时间层
+    void RunLayerSelection();
+
+    // 轮转写满的事件日志文件，并定期输出写入量与CPU开销
+    void RunEventLogMaintenance();
+
+    // 远端Offer带联播时，按会话的显示尺寸选择接收的层并改写Offer
+    std::string SelectSimulcastLayer(const std::shared_ptr<PeerSession>& session, const std::string& sdp);
+
+    // 由接收端发起重新协商，把会话当前的码率上限写入Offer（在信令线程调用）
+    void RenegotiateBandwidth(const std::shared_ptr<PeerSession>& session);
     
     // 处理从信令服务器收到的消息
-    void HandleSignalingMessage(SignalingClient::MessageType type, const std::string& message);
+    void HandleSignalingMessage(SignalingClient::MessageType type, const Json::Value& root);
     void OnOfferReceived(const Json::Value& message_json);
-    void OnCandidateReceived(const Json::Value& message_json);
+    void OnCandidateReceived(const std::shared_ptr<PeerSession>& session, const Json::Value& message_json);
+    void OnPeerLeft(const Json::Value& message_json);
+    void OnAnswerReceived(const Json::Value& message_json);
+
+    // 设置远端Offer并创建、设置本地Answer，成功后通过SendSdpAnswer发出
+    void ApplyRemoteOffer(const std::shared_ptr<PeerSession>& session, const std::string& sdp);
 
     // 发送SDP Answer
-    void SendSdpAnswer(const std::string& sdp);
+    void SendSdpAnswer(const std::string& room_id, const std::string& remote_id, const std::string& sdp);
     
     // 通知状态变化
     void NotifyStateChange(const std::string& state, const std::string& description);
 
     // WebRTC线程
     std::unique_ptr<webrtc::Thread> network_thread_;
+    bool batched_udp_enabled_ = false;
+    BatchedUdpSocketServer::Options batched_udp_options_;
+    BatchedUdpSocketServer* batched_socket_server_ = nullptr;  // 由network_thread_持有
     std::unique_ptr<webrtc::Thread> worker_thread_;
     std::unique_ptr<webrtc::Thread> signaling_thread_;
     
     // WebRTC核心对象
     webrtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> peer_connection_factory_;
-    webrtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection_;
+
+    // ICE策略；限定网卡时使用自己的网络管理器过滤网卡（在网络线程创建和销毁）
+    IceConfig ice_config_;
+    std::unique_ptr<webrtc::BasicNetworkManager> network_manager_;
+    std::unique_ptr<webrtc::BasicPacketSocketFactory> socket_factory_;
+
+    // 每个远端对端一个会话：房间ID/远端ID -> 会话
+    std::map<std::string, std::shared_ptr<PeerSession>> sessions_;
+    mutable std::mutex sessions_mutex_;
+    int max_sessions_ = 4;
+    int max_sessions_per_room_ = 0;
+
+    // 预热的PeerConnection，Offer到达时取用
+    std::unique_ptr<PrewarmedConnection> spare_connection_;
+    std::mutex spare_mutex_;
+    int ice_candidate_pool_size_ = 0;
+    int prewarm_refresh_s_ = 60;
     
-    // 观察者与媒体处理器
-    std::unique_ptr<PeerConnectionObserverImpl> pc_observer_;
+    // 按解码余量的码率控制
+    bool bitrate_control_enabled_ = false;
+    ReceiveBitrateController::Config bitrate_control_config_;
+
+    // 按Offer预先创建VDEC/VO
+    bool video_preconfigure_enabled_ = true;
+
+    // 按显示尺寸与解码能力选择联播层和时间层
+    bool layer_selection_enabled_ = false;
+    LayerSelector layer_selector_;
+    int layer_report_ticks_ = 0;
+
+    // RTC事件日志
+    bool event_log_enabled_ = false;
+    RtcEventLogWriter::Config event_log_config_;
+    std::unique_ptr<RtcEventLogWriter> event_log_writer_;
+    std::atomic<bool> event_logging_{false};
+    int event_log_report_ticks_ = 0;
+    RtcEventLogWriter::Stats last_event_log_stats_;
+    int64_t last_event_log_process_cpu_us_ = 0;
+
+    // 控制通道消息处理函数：消息类型 -> 处理函数
+    std::map<uint8_t, ControlChannel::Handler> control_handlers_;
+
+    // 播放延迟档位
+    LatencyProfile latency_profile_;
+    mutable std::mutex latency_mutex_;
+    
+    // 主媒体处理器与额外会话的视频处理器工厂
     std::shared_ptr<EncodedVideoFrameHandler> video_handler_;
     std::shared_ptr<AudioReceiver> audio_handler_;
+    VideoHandlerFactory video_handler_factory_;
+    // 额外槽位的视频处理器：槽位 -> 处理器，跨会话复用（受sessions_mutex_保护）
+    std::map<int, std::shared_ptr<EncodedVideoFrameHandler>> slot_video_handlers_;
     
     // 信令客户端
     std::unique_ptr<SignalingClient> signaling_client_;
-    std::string remote_client_id_; // 用于存储通信对端的ID
+    int keepalive_interval_ms_ = 5000;
+    int keepalive_timeout_ms_ = 3000;
+
+    // 静态会话模式
+    bool static_session_mode_ = false;
+    std::string static_answer_path_;
     
     // 状态回调
     StateChangeCallback state_change_callback_;
@@ -75,4 +331,10 @@ private:
     // [FIX] 状态标志使用 atomic
     std::atomic<bool> is_initialized_;
     std::atomic<bool> is_connected_to_signaling_;
+
+    // Initialize结束（成功或失败）的通知，信令消息处理在此之前等待
+    std::mutex init_mutex_;
+    std::condition_variable init_cv_;
+    bool init_finished_ = false;
+    bool media_ready_ = true;
 };
\ No newline at end of file